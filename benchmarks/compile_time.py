@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+"""
+Measures the front-end cost of including vkbind under a matrix of configurations.
+
+Run it from the root of the repository:
+
+    python3 benchmarks/compile_time.py
+
+Each configuration is a tiny translation unit that does nothing but include the header. The matrix covers:
+
+    - C and C++
+    - VKBIND_IMPLEMENTATION on and off
+    - VKBIND_NO_GLOBAL_API on and off
+    - VKBIND_ENABLE_VIDEO on and off
+    - No optional features, and the features that generate the most code (VKBIND_ENUM_STRINGS, VKBIND_DEEP_COPY and VKBIND_HASH)
+    - No platform, and each VK_USE_PLATFORM_* macro found in the header
+    - Each header variant: vkbind.h, vkbind/vkbind.h (--split-headers) and any extra headers passed with --header
+    - GCC and Clang, whichever are installed
+
+When the split headers exist, each header in the vkbind directory is also measured on its own, such as vkbind/vk_khr_swapchain.h.
+These per-unit runs only cover C and C++ with nothing else defined, which is enough to see what each unit costs to include.
+
+For each configuration the best wall time of --repeat runs, the size of the preprocessed output and the peak memory of the
+compiler are recorded. Platforms whose system headers aren't installed are reported as unavailable rather than failing. Results
+are printed as a table and can be saved with --csv. Pass a previously saved file with --baseline to compare against it. The script
+returns a non-zero exit code if any configuration regressed by more than --tolerance.
+
+With --trace, Clang is run with -ftime-trace and GCC with -ftime-report and the output is kept in the trace directory for a
+detailed breakdown.
+
+Peak memory is only available on platforms that support os.wait4() (Linux, macOS, BSD).
+"""
+
+import argparse
+import csv
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def find_platforms(header_path):
+    platforms = []
+    with open(header_path, "r", encoding="utf-8", errors="replace") as f:
+        for match in re.finditer(r"^#ifdef (VK_USE_PLATFORM_\w+)", f.read(), re.MULTILINE):
+            if match.group(1) not in platforms:
+                platforms.append(match.group(1))
+    return platforms
+
+
+# The optional features that generate the most code. Features that enable others, such as VKBIND_OBJECT_CACHE, cost about the same
+# as the features they enable.
+FEATURE_SETS = {
+    "none": [],
+    "heavy": ["VKBIND_ENUM_STRINGS", "VKBIND_DEEP_COPY", "VKBIND_HASH"],
+}
+
+FIELDS = ["header", "compiler", "lang", "implementation", "no_global_api", "video", "features", "platform", "status", "time_ms", "preprocessed_kb", "peak_memory_kb"]
+KEY_FIELDS = FIELDS[:8]
+
+# Baselines saved before the video and features columns were added only measured with both off.
+KEY_DEFAULTS = {"video": "0", "features": "none"}
+
+
+def find_unit_headers(split_dir):
+    units = []
+    for name in sorted(os.listdir(split_dir)):
+        if name.endswith(".h") and name != "vkbind.h":
+            units.append(os.path.join(split_dir, name))
+    return units
+
+
+def find_compilers(requested):
+    compilers = []
+    for name, cc, cxx in (("gcc", "gcc", "g++"), ("clang", "clang", "clang++")):
+        if requested and name not in requested:
+            continue
+        if shutil.which(cc) and shutil.which(cxx):
+            compilers.append((name, cc, cxx))
+    return compilers
+
+
+def run(cmd):
+    """Runs a command and returns (exit code, wall time, peak memory in KB or None, stderr)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = b""
+    if hasattr(os, "wait4"):
+        # Read stderr before waiting so a chatty compiler can't fill the pipe and deadlock.
+        stderr = proc.stderr.read()
+        _, status, rusage = os.wait4(proc.pid, 0)
+        elapsed = time.perf_counter() - start
+        proc.returncode = os.waitstatus_to_exitcode(status)
+
+        # ru_maxrss is in kilobytes on Linux and bytes on macOS.
+        peak = rusage.ru_maxrss
+        if sys.platform == "darwin":
+            peak //= 1024
+        return proc.returncode, elapsed, peak, stderr.decode(errors="replace")
+    else:
+        _, stderr = proc.communicate()
+        elapsed = time.perf_counter() - start
+        return proc.returncode, elapsed, None, stderr.decode(errors="replace")
+
+
+def write_translation_unit(directory, header_file_name, lang, implementation):
+    path = os.path.join(directory, "vkbind_bench." + ("c" if lang == "c" else "cpp"))
+    with open(path, "w") as f:
+        if implementation:
+            f.write("#define VKBIND_IMPLEMENTATION\n")
+        f.write("#include \"" + header_file_name + "\"\n")
+        f.write("int vkbind_bench_dummy;\n")  # Avoids empty translation unit warnings.
+    return path
+
+
+def measure(cmd, tu, tmp, key, config, args):
+    """Compiles a translation unit and fills in the status and metrics of config."""
+
+    # Preprocessed size. This also tells us whether or not the platform headers are available.
+    preprocessed = os.path.join(tmp, "vkbind_bench.i")
+    code, _, _, stderr = run(cmd + ["-E", tu, "-o", preprocessed])
+    if code != 0:
+        config.update({"status": "unavailable", "time_ms": "", "preprocessed_kb": "", "peak_memory_kb": ""})
+        print("{:<90} unavailable".format(key))
+        return config
+
+    preprocessed_size = os.path.getsize(preprocessed)
+
+    best_time = None
+    best_memory = None
+    status = "ok"
+    for _ in range(max(1, args.repeat)):
+        code, elapsed, peak, stderr = run(cmd + ["-fsyntax-only", tu])
+        if code != 0:
+            status = "error"
+            print(stderr)
+            break
+        if best_time is None or elapsed < best_time:
+            best_time = elapsed
+        if peak is not None and (best_memory is None or peak < best_memory):
+            best_memory = peak
+
+    if args.trace and status == "ok":
+        trace_name = key.replace("/", "_").replace("=", "")
+        if config["compiler"] == "clang":
+            run(cmd + ["-c", "-ftime-trace", tu, "-o", os.path.join(args.trace, trace_name + ".o")])
+        else:
+            _, _, _, report = run(cmd + ["-fsyntax-only", "-ftime-report", tu])
+            with open(os.path.join(args.trace, trace_name + ".txt"), "w") as f:
+                f.write(report)
+
+    config.update({
+        "status": status,
+        "time_ms": "" if best_time is None else "{:.1f}".format(best_time * 1000),
+        "preprocessed_kb": "{:.1f}".format(preprocessed_size / 1024),
+        "peak_memory_kb": "" if best_memory is None else str(best_memory),
+    })
+    print("{:<90} {:>9} ms {:>9} KB pp {:>9} KB mem".format(key, config["time_ms"], config["preprocessed_kb"], config["peak_memory_kb"]))
+    return config
+
+
+def make_key(config):
+    return "{header}/{compiler}/{lang}/impl={implementation}/noglobal={no_global_api}/video={video}/{features}/{platform}".format(**config)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile-time benchmark for vkbind.")
+    parser.add_argument("--header", action="append", default=[], metavar="NAME=PATH", help="Additional header variant to measure. Can be used multiple times.")
+    parser.add_argument("--compiler", action="append", default=[], choices=["gcc", "clang"], help="Restrict to the given compiler. Can be used multiple times.")
+    parser.add_argument("--platform", action="append", default=[], metavar="MACRO", help="Restrict to the given VK_USE_PLATFORM_* macro. Use \"none\" for no platform.")
+    parser.add_argument("--video", action="append", default=[], choices=["off", "on"], help="Restrict to VKBIND_ENABLE_VIDEO off or on. Can be used multiple times.")
+    parser.add_argument("--features", action="append", default=[], choices=sorted(FEATURE_SETS.keys()), help="Restrict to the given set of optional features. Can be used multiple times.")
+    parser.add_argument("--no-units", action="store_true", help="Skip measuring each split header on its own.")
+    parser.add_argument("--repeat", type=int, default=3, help="Number of runs per configuration. The fastest is recorded.")
+    parser.add_argument("--csv", metavar="PATH", help="Save the results to a CSV file.")
+    parser.add_argument("--baseline", metavar="PATH", help="Compare against a CSV file saved with --csv.")
+    parser.add_argument("--tolerance", type=float, default=0.10, help="Allowed relative regression when comparing against a baseline. Defaults to 0.10.")
+    parser.add_argument("--trace", metavar="DIR", help="Keep -ftime-trace/-ftime-report output in this directory.")
+    args = parser.parse_args()
+
+    headers = []
+    if os.path.exists("vkbind.h"):
+        headers.append(("single", "vkbind.h"))
+    if os.path.exists(os.path.join("vkbind", "vkbind.h")):
+        headers.append(("split", os.path.join("vkbind", "vkbind.h")))
+    for header in args.header:
+        name, _, path = header.partition("=")
+        if not path or not os.path.exists(path):
+            print("Header not found: " + header)
+            return 1
+        headers.append((name, path))
+
+    if not headers:
+        print("No headers found. Run this from the root of the repository.")
+        return 1
+
+    compilers = find_compilers(args.compiler)
+    if not compilers:
+        print("No compilers found.")
+        return 1
+
+    if args.trace:
+        os.makedirs(args.trace, exist_ok=True)
+
+    video_values = [v for v in (False, True) if not args.video or ("on" if v else "off") in args.video]
+    feature_sets = [f for f in ("none", "heavy") if not args.features or f in args.features]
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for header_name, header_path in headers:
+            include_dir = os.path.dirname(os.path.abspath(header_path))
+            platforms = ["none"] + find_platforms(header_path)
+            if args.platform:
+                platforms = [p for p in platforms if p in args.platform]
+
+            for compiler_name, cc, cxx in compilers:
+                for lang in ("c", "c++"):
+                    for implementation in (False, True):
+                        tu = write_translation_unit(tmp, os.path.basename(header_path), lang, implementation)
+                        for no_global_api in (False, True):
+                            for video in video_values:
+                                for features in feature_sets:
+                                    for platform in platforms:
+                                        cmd = [cc if lang == "c" else cxx, "-std=c99" if lang == "c" else "-std=c++11", "-I" + include_dir]
+                                        if no_global_api:
+                                            cmd.append("-DVKBIND_NO_GLOBAL_API")
+                                        if video:
+                                            cmd.append("-DVKBIND_ENABLE_VIDEO")
+                                        for define in FEATURE_SETS[features]:
+                                            cmd.append("-D" + define)
+                                        if platform != "none":
+                                            cmd.append("-D" + platform)
+
+                                        config = {
+                                            "header": header_name,
+                                            "compiler": compiler_name,
+                                            "lang": lang,
+                                            "implementation": int(implementation),
+                                            "no_global_api": int(no_global_api),
+                                            "video": int(video),
+                                            "features": features,
+                                            "platform": platform,
+                                        }
+                                        results.append(measure(cmd, tu, tmp, make_key(config), config, args))
+
+        # Each split header on its own. The implementation lives in vkbind/vkbind.h so it's always off here.
+        split_dir = "vkbind"
+        if not args.no_units and os.path.isdir(split_dir):
+            for unit_path in find_unit_headers(split_dir):
+                include_dir = os.path.dirname(os.path.abspath(unit_path))
+                for compiler_name, cc, cxx in compilers:
+                    for lang in ("c", "c++"):
+                        tu = write_translation_unit(tmp, os.path.basename(unit_path), lang, False)
+                        cmd = [cc if lang == "c" else cxx, "-std=c99" if lang == "c" else "-std=c++11", "-I" + include_dir]
+                        config = {
+                            "header": "unit:" + os.path.basename(unit_path),
+                            "compiler": compiler_name,
+                            "lang": lang,
+                            "implementation": 0,
+                            "no_global_api": 0,
+                            "video": 0,
+                            "features": "none",
+                            "platform": "none",
+                        }
+                        results.append(measure(cmd, tu, tmp, make_key(config), config, args))
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=FIELDS)
+            writer.writeheader()
+            writer.writerows(results)
+
+    regressions = 0
+    if args.baseline:
+        baseline = {}
+        with open(args.baseline, newline="") as f:
+            for row in csv.DictReader(f):
+                baseline[tuple(row.get(k) or KEY_DEFAULTS.get(k, "") for k in KEY_FIELDS)] = row
+
+        print("\nComparison against " + args.baseline + ":")
+        for result in results:
+            old = baseline.get(tuple(str(result[k]) for k in KEY_FIELDS))
+            if old is None or old["status"] != "ok" or result["status"] != "ok":
+                continue
+
+            for metric in ("time_ms", "preprocessed_kb", "peak_memory_kb"):
+                if not old[metric] or not result[metric]:
+                    continue
+                before = float(old[metric])
+                after = float(result[metric])
+                if before > 0 and (after - before) / before > args.tolerance:
+                    regressions += 1
+                    print("  {}: {} {} -> {}".format(make_key(result), metric, old[metric], result[metric]))
+
+        if regressions == 0:
+            print("  No regressions.")
+
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,11 +3,14 @@
 #include <vector>
 #include <algorithm>
 #include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include <assert.h>
 
 #define VKB_BUILD_XML_PATH_VK       "../../resources/vk.xml"
 #define VKB_BUILD_XML_PATH_VIDEO    "../../resources/video.xml"
 #define VKB_BUILD_TEMPLATE_PATH     "../../source/vkbind_template.h"
+#define VKB_BUILD_VIDEO_PLATFORM_NAME "vkbind_video"   // The pseudo-platform extensions depending on video.xml are moved to. See vkbBuildGuardVideoExtensions().
 
 typedef int VkbResult;
 #define VKB_SUCCESS                 0
@@ -213,6 +216,95 @@ VkbResult vkbOpenAndWriteTextFile(const char* filePath, const char* text)
     return vkbOpenAndWriteFile(filePath, text, strlen(text));
 }
 
+/* Removes the "vkbind - vX.Y.Z.R - DATE" line. */
+std::string vkbRemoveVersionLine(const std::string &text)
+{
+    std::string result = text;
+
+    std::string::size_type versionBeg = result.find("vkbind - v");
+    if (versionBeg != std::string::npos) {
+        std::string::size_type versionEnd = result.find('\n', versionBeg);
+        result.erase(versionBeg, (versionEnd != std::string::npos) ? versionEnd - versionBeg : std::string::npos);
+    }
+
+    return result;
+}
+
+/*
+Only writes the file if the content has changed so the modified time is left alone and anything that includes it isn't rebuilt. The
+version line is ignored in the comparison because the revision and date change every time the generator is run.
+*/
+VkbResult vkbOpenAndWriteTextFileIfChanged(const char* filePath, const char* text)
+{
+    if (text == NULL) {
+        text = "";
+    }
+
+    size_t existingFileSize;
+    char* pExistingFileData;
+    if (vkbOpenAndReadTextFile(filePath, &existingFileSize, &pExistingFileData) == VKB_SUCCESS) {
+        bool isUnchanged = vkbRemoveVersionLine(pExistingFileData) == vkbRemoveVersionLine(text);
+        free(pExistingFileData);
+
+        if (isUnchanged) {
+            return VKB_SUCCESS;
+        }
+    }
+
+    return vkbOpenAndWriteTextFile(filePath, text);
+}
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include <errno.h>
+
+VkbResult vkbMakeDirectory(const char* directoryPath)
+{
+    int result;
+
+    if (directoryPath == NULL) {
+        return VKB_INVALID_ARGS;
+    }
+
+#ifdef _WIN32
+    result = _mkdir(directoryPath);
+#else
+    result = mkdir(directoryPath, 0777);
+#endif
+
+    /* It's not an error if the directory already exists. */
+    if (result != 0 && errno != EEXIST) {
+        return VKB_ERROR;
+    }
+
+    return VKB_SUCCESS;
+}
+
+/* Converts a path relative to the working directory to an absolute path. Returns the path as is if it can't be resolved. */
+std::string vkbGetAbsolutePath(const char* path)
+{
+    std::string result = path;
+
+#ifdef _WIN32
+    char* pAbsolutePath = _fullpath(NULL, path, 0);
+#else
+    char* pAbsolutePath = realpath(path, NULL);
+#endif
+    if (pAbsolutePath != NULL) {
+        result = pAbsolutePath;
+        free(pAbsolutePath);
+    }
+
+#ifdef _WIN32
+    std::replace(result.begin(), result.end(), '\\', '/');
+#endif
+
+    return result;
+}
+
 
 
 
@@ -239,6 +331,8 @@ struct vkbBuildFunctionParameter
     std::string arrayEnum;
     std::string optional;
     std::string externsync;
+    std::string len;            // The name of the parameter holding the length of the array, such as "pPropertyCount".
+    std::string altlen;         // A C expression for len when len is latexmath.
 };
 
 struct vkbBuildFunctionPointer
@@ -261,6 +355,7 @@ struct vkbBuildStructMember
     std::string optional;       // Attribute
     std::string noautovalidity; // Attribute
     std::string len;            // Attribute
+    std::string altlen;         // Attribute. A C expression for len when len is latexmath.
 };
 
 struct vkbBuildStruct
@@ -278,6 +373,8 @@ struct vkbBuildType
     std::string bitvalues;
     std::string returnedonly;
     std::string parent;
+    std::string objtypeenum;    // The VkObjectType value of a handle, such as VK_OBJECT_TYPE_SAMPLER.
+    std::string structextends;  // Comma separated list of the structs this struct can be chained to with pNext.
 
     // Type-specific data.
     vkbBuildFunctionPointer funcpointer;
@@ -309,6 +406,7 @@ struct vkbBuildCommand
     std::string alias;
     std::string successcodes;
     std::string errorcodes;
+    std::string tasks;          // Attribute. What the command does, such as "action", "state" or "indirection".
 };
 
 
@@ -366,9 +464,53 @@ struct vkbBuildExtension
     std::string supported;  // If "disabled", no code generated.
     std::string promotedto;
     std::string deprecatedby;
+    bool isDeprecated;      // True if the deprecatedby attribute is present. It's empty for extensions deprecated without a replacement.
     std::vector<vkbBuildRequire> requires;
 };
 
+struct vkbBuildFormatComponent
+{
+    std::string name;           // "R", "G", "B", "A", "D" or "S".
+    std::string bits;           // A number, or "compressed".
+    std::string numericFormat;  // "UNORM", "SFLOAT", etc.
+    std::string planeIndex;     // Only set for multi-planar formats.
+};
+
+struct vkbBuildFormatPlane
+{
+    std::string index;
+    std::string widthDivisor;
+    std::string heightDivisor;
+    std::string compatible;     // The single-plane format each plane is compatible with.
+};
+
+struct vkbBuildFormat
+{
+    std::string name;
+    std::string formatClass;
+    std::string blockSize;
+    std::string texelsPerBlock;
+    std::string blockExtent;    // Comma separated. Only set for block-compressed formats.
+    std::string packed;
+    std::string compressed;     // The compression scheme, such as "BC" or "ASTC LDR".
+    std::vector<vkbBuildFormatComponent> components;
+    std::vector<vkbBuildFormatPlane> planes;
+};
+
+struct vkbBuildSyncStage
+{
+    std::string name;
+    std::vector<std::string> queues;            // "graphics", "compute", etc. Empty if the stage is supported by every queue.
+    std::vector<std::string> equivalentStages;  // The stages a meta stage, such as VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, stands for.
+};
+
+struct vkbBuildSyncAccess
+{
+    std::string name;
+    std::vector<std::string> stages;            // The stages the access can be used with.
+    std::vector<std::string> equivalentAccesses;
+};
+
 struct VkbBuild
 {
     std::vector<vkbBuildPlatform> platforms;
@@ -378,19 +520,50 @@ struct VkbBuild
     std::vector<vkbBuildCommand> commands;
     std::vector<vkbBuildFeature> features;
     std::vector<vkbBuildExtension> extensions;
+    std::vector<vkbBuildFormat> formats;
+    std::vector<vkbBuildSyncStage> syncStages;
+    std::vector<vkbBuildSyncAccess> syncAccesses;
 
     struct CodeGenConfig
     {
         public: CodeGenConfig()
             : treatExtensionsAsSeparateHeaders(false)
+            , generateCppModule(false)
+            , api("vulkan")
+            , modern(false)
+            , generateCppHeader(false)
+            , generateReport(false)
         {
         }
 
-        bool treatExtensionsAsSeparateHeaders;  /* Will force include guards. */
+        bool treatExtensionsAsSeparateHeaders;  /* Outputs a directory with a header per feature and extension. Will force include guards. */
+        bool generateCppModule;                 /* Also outputs vkbind.cppm and vkbind_impl.cpp next to vkbind.h. */
+        std::string api;                        /* The API variant to generate ("vulkan" or "vulkansc"). Anything specific to another variant is dropped while parsing. */
+        bool modern;                            /* Culls extensions that have been promoted to core or deprecated. See vkbBuildCullExtensions(). */
+        bool generateCppHeader;                 /* Also outputs vkbind.hpp with C++ helpers (vkb::call(), vkb::Dispatch, vkb::StructChain). */
+        bool generateReport;                    /* Also outputs vkbind_report.txt with the size of each feature, extension and section. */
+        std::string depfilePath;                /* If set, a Make/Ninja depfile listing the inputs is written here. */
+        std::string profilePath;                /* The call-frequency profile passed with --profile. It's an input, so it goes in the depfile. */
+        std::vector<std::string> hotCommands;   /* Commands from the call-frequency profile (--profile), hottest first. These go first in VkbAPI and the global API. */
     } codegenConfig;
+
+    std::vector<vkbBuildExtension> culledExtensions;    /* Extensions removed in modern mode. Only used for outputting the legacy aliases. */
 };
 
 
+// Returns true if an "api" attribute includes the API variant being generated. Items without an "api" attribute are common to all variants.
+bool vkbBuildIsAPISupported(const VkbBuild &context, const char* api)
+{
+    if (api == NULL || context.codegenConfig.api == "") {
+        return true;
+    }
+
+    // The attribute is a comma separated list such as "vulkan,vulkansc".
+    std::string apiList = std::string(",") + vkbTrim(api) + ",";
+    return apiList.find("," + context.codegenConfig.api + ",") != std::string::npos;
+}
+
+
 // Parses the <platforms> tag.
 VkbResult vkbBuildParsePlatforms(VkbBuild &context, tinyxml2::XMLElement* pPlatformsElement)
 {
@@ -547,12 +720,14 @@ VkbResult vkbBuildParseStructMember(vkbBuildStructMember &member, tinyxml2::XMLE
     const char* optional = pMemberElement->Attribute("optional");
     const char* noautovalidity = pMemberElement->Attribute("noautovalidity");
     const char* len = pMemberElement->Attribute("len");
+    const char* altlen = pMemberElement->Attribute("altlen");
 
     member.api = (api != NULL) ? api : "";
     member.values = (values != NULL) ? values : "";
     member.optional = (optional != NULL) ? optional : "";
     member.noautovalidity = (noautovalidity != NULL) ? noautovalidity : "";
     member.len = (len != NULL) ? len : "";
+    member.altlen = (altlen != NULL) ? altlen : "";
 
     return VKB_SUCCESS;
 }
@@ -650,6 +825,11 @@ VkbResult vkbBuildParseTypes(VkbBuild &context, tinyxml2::XMLElement* pTagsEleme
             continue;
         }
 
+        // Ignore types for other API variants. Some types, such as VK_HEADER_VERSION, are defined once for each variant.
+        if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+            continue;
+        }
+
         const char* name = pChildElement->Attribute("name");
         const char* category = pChildElement->Attribute("category");
         const char* alias = pChildElement->Attribute("alias");
@@ -657,6 +837,8 @@ VkbResult vkbBuildParseTypes(VkbBuild &context, tinyxml2::XMLElement* pTagsEleme
         const char* bitvalues = pChildElement->Attribute("bitvalues");
         const char* returnedonly = pChildElement->Attribute("returnedonly");
         const char* parent = pChildElement->Attribute("parent");
+        const char* objtypeenum = pChildElement->Attribute("objtypeenum");
+        const char* structextends = pChildElement->Attribute("structextends");
 
         vkbBuildType type;
         type.name = (name != NULL) ? vkbTrim(name) : "";
@@ -666,6 +848,8 @@ VkbResult vkbBuildParseTypes(VkbBuild &context, tinyxml2::XMLElement* pTagsEleme
         type.bitvalues = (bitvalues != NULL) ? vkbTrim(bitvalues) : "";
         type.returnedonly = (returnedonly != NULL) ? returnedonly : "";
         type.parent = (parent != NULL) ? parent : "";
+        type.objtypeenum = (objtypeenum != NULL) ? vkbTrim(objtypeenum) : "";
+        type.structextends = (structextends != NULL) ? vkbTrim(structextends) : "";
 
         if (strcmp(type.category.c_str(), "funcpointer") == 0) {
             tinyxml2::XMLNode* pFirstChild = pChildElement->FirstChild();
@@ -711,6 +895,10 @@ VkbResult vkbBuildParseTypes(VkbBuild &context, tinyxml2::XMLElement* pTagsEleme
                         continue;   // Ignore <comment> tags.
                     }
 
+                    if (!vkbBuildIsAPISupported(context, pMemberElement->Attribute("api"))) {
+                        continue;   // Member is specific to another API variant.
+                    }
+
                     vkbBuildStructMember member;
                     vkbBuildParseStructMember(member, pMemberElement);
 
@@ -789,6 +977,10 @@ VkbResult vkbBuildParseEnums(VkbBuild &context, tinyxml2::XMLElement* pEnumsElem
         assert(pChildElement != NULL);
 
         if (strcmp(pChildElement->Name(), "enum") == 0) {
+            if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+                continue;
+            }
+
             const char* childName = pChildElement->Attribute("name");
             const char* childAlias = pChildElement->Attribute("alias");
             const char* childValue = pChildElement->Attribute("value");
@@ -855,14 +1047,18 @@ VkbResult vkbBuildParseCommandParam(vkbBuildFunctionParameter &param, tinyxml2::
 
     const char* optional = pParamElement->Attribute("optional");
     const char* externsync = pParamElement->Attribute("externsync");
+    const char* len = pParamElement->Attribute("len");
+    const char* altlen = pParamElement->Attribute("altlen");
 
     param.optional = (optional != NULL) ? optional : "";
     param.externsync = (externsync != NULL) ? externsync : "";
+    param.len = (len != NULL) ? len : "";
+    param.altlen = (altlen != NULL) ? altlen : "";
 
     return VKB_SUCCESS;
 }
 
-VkbResult vkbBuildParseCommand(vkbBuildCommand &command, tinyxml2::XMLElement* pCommandElement)
+VkbResult vkbBuildParseCommand(VkbBuild &context, vkbBuildCommand &command, tinyxml2::XMLElement* pCommandElement)
 {
     if (pCommandElement == NULL) {
         return VKB_INVALID_ARGS;
@@ -871,8 +1067,11 @@ VkbResult vkbBuildParseCommand(vkbBuildCommand &command, tinyxml2::XMLElement* p
     const char* successcodes = pCommandElement->Attribute("successcodes");
     const char* errorcodes = pCommandElement->Attribute("errorcodes");
 
+    const char* tasks = pCommandElement->Attribute("tasks");
+
     command.successcodes = (successcodes != NULL) ? successcodes : "";
     command.errorcodes = (errorcodes != NULL) ? errorcodes : "";
+    command.tasks = (tasks != NULL) ? tasks : "";
 
     for (tinyxml2::XMLNode* pChild = pCommandElement->FirstChild(); pChild != NULL; pChild = pChild->NextSibling()) {
         tinyxml2::XMLElement* pChildElement = pChild->ToElement();
@@ -883,6 +1082,10 @@ VkbResult vkbBuildParseCommand(vkbBuildCommand &command, tinyxml2::XMLElement* p
         }
 
         if (strcmp(pChildElement->Name(), "param") == 0) {
+            if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+                continue;
+            }
+
             vkbBuildFunctionParameter param;
             vkbBuildParseCommandParam(param, pChildElement);
 
@@ -924,8 +1127,12 @@ VkbResult vkbBuildParseCommands(VkbBuild &context, tinyxml2::XMLElement* pComman
         assert(pChildElement != NULL);
 
         if (strcmp(pChildElement->Name(), "command") == 0) {
+            if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+                continue;
+            }
+
             vkbBuildCommand command;
-            VkbResult result = vkbBuildParseCommand(command, pChildElement);
+            VkbResult result = vkbBuildParseCommand(context, command, pChildElement);
             if (result == VKB_SUCCESS) {
                 context.commands.push_back(command);
             }
@@ -993,7 +1200,7 @@ VkbResult vkbBuildParseRequireCommand(vkbBuildRequireCommand &command, tinyxml2:
     return VKB_SUCCESS;
 }
 
-VkbResult vkbBuildParseRequire(vkbBuildRequire &require, tinyxml2::XMLElement* pRequireElement)
+VkbResult vkbBuildParseRequire(VkbBuild &context, vkbBuildRequire &require, tinyxml2::XMLElement* pRequireElement)
 {
     if (pRequireElement == NULL) {
         return VKB_INVALID_ARGS;
@@ -1013,6 +1220,10 @@ VkbResult vkbBuildParseRequire(vkbBuildRequire &require, tinyxml2::XMLElement* p
             continue;
         }
 
+        if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+            continue;
+        }
+
         if (strcmp(pChildElement->Name(), "type") == 0) {
             vkbBuildRequireType type;
             vkbBuildParseRequireType(type, pChildElement);
@@ -1033,6 +1244,59 @@ VkbResult vkbBuildParseRequire(vkbBuildRequire &require, tinyxml2::XMLElement* p
     return VKB_SUCCESS;
 }
 
+void vkbBuildRemoveFromFeatures(VkbBuild &context, const vkbBuildRequire &remove)
+{
+    for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+        for (size_t iRequire = 0; iRequire < context.features[iFeature].requires.size(); ++iRequire) {
+            vkbBuildRequire &require = context.features[iFeature].requires[iRequire];
+
+            for (size_t iType = 0; iType < remove.types.size(); ++iType) {
+                for (size_t i = 0; i < require.types.size(); ) {
+                    if (require.types[i].name == remove.types[iType].name) {
+                        require.types.erase(require.types.begin() + i);
+                    } else {
+                        i += 1;
+                    }
+                }
+            }
+
+            for (size_t iEnum = 0; iEnum < remove.enums.size(); ++iEnum) {
+                for (size_t i = 0; i < require.enums.size(); ) {
+                    if (require.enums[i].name == remove.enums[iEnum].name) {
+                        require.enums.erase(require.enums.begin() + i);
+                    } else {
+                        i += 1;
+                    }
+                }
+            }
+
+            for (size_t iCommand = 0; iCommand < remove.commands.size(); ++iCommand) {
+                for (size_t i = 0; i < require.commands.size(); ) {
+                    if (require.commands[i].name == remove.commands[iCommand].name) {
+                        require.commands.erase(require.commands.begin() + i);
+                    } else {
+                        i += 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Enum values that are part of the core <enums> blocks also need to be removed.
+    for (size_t iEnum = 0; iEnum < remove.enums.size(); ++iEnum) {
+        for (size_t iEnums = 0; iEnums < context.enums.size(); ++iEnums) {
+            std::vector<vkbBuildEnum> &values = context.enums[iEnums].enums;
+            for (size_t i = 0; i < values.size(); ) {
+                if (values[i].name == remove.enums[iEnum].name && context.enums[iEnums].type != "") {
+                    values.erase(values.begin() + i);
+                } else {
+                    i += 1;
+                }
+            }
+        }
+    }
+}
+
 VkbResult vkbBuildParseFeature(VkbBuild &context, tinyxml2::XMLElement* pFeatureElement)
 {
     if (pFeatureElement == NULL) {
@@ -1044,6 +1308,11 @@ VkbResult vkbBuildParseFeature(VkbBuild &context, tinyxml2::XMLElement* pFeature
     const char* number = pFeatureElement->Attribute("number");
     const char* comment = pFeatureElement->Attribute("comment");
 
+    // Features for other API variants are ignored.
+    if (!vkbBuildIsAPISupported(context, api)) {
+        return VKB_SUCCESS;
+    }
+
     vkbBuildFeature feature;
     feature.api = (api != NULL) ? vkbTrim(api) : "";
     feature.name = (name != NULL) ? vkbTrim(name) : "";
@@ -1058,11 +1327,23 @@ VkbResult vkbBuildParseFeature(VkbBuild &context, tinyxml2::XMLElement* pFeature
 
         assert(pChildElement != NULL);
 
+        if (!vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
+            continue;
+        }
+
         if (strcmp(pChildElement->Name(), "require") == 0) {
             vkbBuildRequire require;
-            vkbBuildParseRequire(require, pChildElement);
+            vkbBuildParseRequire(context, require, pChildElement);
             feature.requires.push_back(require);
         }
+
+        // Vulkan SC removes some of the items required by earlier features. Since features are parsed in order we can just remove them from
+        // the features that have already been parsed.
+        if (strcmp(pChildElement->Name(), "remove") == 0) {
+            vkbBuildRequire remove;
+            vkbBuildParseRequire(context, remove, pChildElement);
+            vkbBuildRemoveFromFeatures(context, remove);
+        }
     }
 
     context.features.push_back(feature);
@@ -1095,6 +1376,11 @@ VkbResult vkbBuildParseExtension(VkbBuild &context, tinyxml2::XMLElement* pExten
     if (platform != NULL && strcmp(platform, "mir") == 0) {
         return VKB_INVALID_ARGS;
     }
+
+    // Extensions that aren't supported by the API variant being generated are ignored.
+    if (!vkbBuildIsAPISupported(context, supported)) {
+        return VKB_INVALID_ARGS;
+    }
     
     vkbBuildExtension extension;
     extension.name = (name != NULL) ? vkbTrim(name) : "";
@@ -1107,14 +1393,15 @@ VkbResult vkbBuildParseExtension(VkbBuild &context, tinyxml2::XMLElement* pExten
     extension.supported = (supported != NULL) ? vkbTrim(supported) : "";
     extension.promotedto = (promotedto != NULL) ? vkbTrim(promotedto) : "";
     extension.deprecatedby = (deprecatedby != NULL) ? vkbTrim(deprecatedby) : "";
+    extension.isDeprecated = deprecatedby != NULL;
 
     for (tinyxml2::XMLNode* pChild = pExtensionElement->FirstChild(); pChild != NULL; pChild = pChild->NextSibling()) {
         tinyxml2::XMLElement* pChildElement = pChild->ToElement();
         assert(pChildElement != NULL);
 
-        if (strcmp(pChildElement->Name(), "require") == 0) {
+        if (strcmp(pChildElement->Name(), "require") == 0 && vkbBuildIsAPISupported(context, pChildElement->Attribute("api"))) {
             vkbBuildRequire require;
-            vkbBuildParseRequire(require, pChildElement);
+            vkbBuildParseRequire(context, require, pChildElement);
             extension.requires.push_back(require);
         }
     }
@@ -1154,6 +1441,134 @@ VkbResult vkbBuildParseExtensions(VkbBuild &context, tinyxml2::XMLElement* pExte
 }
 
 
+VkbResult vkbBuildParseFormats(VkbBuild &context, tinyxml2::XMLElement* pFormatsElement)
+{
+    if (pFormatsElement == NULL) {
+        return VKB_INVALID_ARGS;
+    }
+
+    for (tinyxml2::XMLElement* pFormatElement = pFormatsElement->FirstChildElement("format"); pFormatElement != NULL; pFormatElement = pFormatElement->NextSiblingElement("format")) {
+        const char* name           = pFormatElement->Attribute("name");
+        const char* formatClass    = pFormatElement->Attribute("class");
+        const char* blockSize      = pFormatElement->Attribute("blockSize");
+        const char* texelsPerBlock = pFormatElement->Attribute("texelsPerBlock");
+        const char* blockExtent    = pFormatElement->Attribute("blockExtent");
+        const char* packed         = pFormatElement->Attribute("packed");
+        const char* compressed     = pFormatElement->Attribute("compressed");
+
+        vkbBuildFormat format;
+        format.name           = (name           != NULL) ? vkbTrim(name)           : "";
+        format.formatClass    = (formatClass    != NULL) ? vkbTrim(formatClass)    : "";
+        format.blockSize      = (blockSize      != NULL) ? vkbTrim(blockSize)      : "";
+        format.texelsPerBlock = (texelsPerBlock != NULL) ? vkbTrim(texelsPerBlock) : "";
+        format.blockExtent    = (blockExtent    != NULL) ? vkbTrim(blockExtent)    : "";
+        format.packed         = (packed         != NULL) ? vkbTrim(packed)         : "";
+        format.compressed     = (compressed     != NULL) ? vkbTrim(compressed)     : "";
+
+        for (tinyxml2::XMLElement* pChildElement = pFormatElement->FirstChildElement(); pChildElement != NULL; pChildElement = pChildElement->NextSiblingElement()) {
+            if (strcmp(pChildElement->Name(), "component") == 0) {
+                const char* componentName = pChildElement->Attribute("name");
+                const char* bits          = pChildElement->Attribute("bits");
+                const char* numericFormat = pChildElement->Attribute("numericFormat");
+                const char* planeIndex    = pChildElement->Attribute("planeIndex");
+
+                vkbBuildFormatComponent component;
+                component.name          = (componentName != NULL) ? vkbTrim(componentName) : "";
+                component.bits          = (bits          != NULL) ? vkbTrim(bits)          : "";
+                component.numericFormat = (numericFormat != NULL) ? vkbTrim(numericFormat) : "";
+                component.planeIndex    = (planeIndex    != NULL) ? vkbTrim(planeIndex)    : "";
+                format.components.push_back(component);
+            }
+            if (strcmp(pChildElement->Name(), "plane") == 0) {
+                const char* index         = pChildElement->Attribute("index");
+                const char* widthDivisor  = pChildElement->Attribute("widthDivisor");
+                const char* heightDivisor = pChildElement->Attribute("heightDivisor");
+                const char* compatible    = pChildElement->Attribute("compatible");
+
+                vkbBuildFormatPlane plane;
+                plane.index         = (index         != NULL) ? vkbTrim(index)         : "";
+                plane.widthDivisor  = (widthDivisor  != NULL) ? vkbTrim(widthDivisor)  : "";
+                plane.heightDivisor = (heightDivisor != NULL) ? vkbTrim(heightDivisor) : "";
+                plane.compatible    = (compatible    != NULL) ? vkbTrim(compatible)    : "";
+                format.planes.push_back(plane);
+            }
+        }
+
+        context.formats.push_back(format);
+    }
+
+    return VKB_SUCCESS;
+}
+
+std::vector<std::string> vkbSplitString(const std::string &str, const std::string &delimiter);
+
+// Splits a comma separated attribute into a trimmed list. A missing attribute gives an empty list.
+std::vector<std::string> vkbBuildSplitListAttribute(tinyxml2::XMLElement* pElement, const char* name)
+{
+    std::vector<std::string> items;
+
+    const char* value = pElement->Attribute(name);
+    if (value != NULL) {
+        std::vector<std::string> parts = vkbSplitString(value, ",");
+        for (size_t iPart = 0; iPart < parts.size(); ++iPart) {
+            std::string item = vkbTrim(parts[iPart]);
+            if (item != "") {
+                items.push_back(item);
+            }
+        }
+    }
+
+    return items;
+}
+
+VkbResult vkbBuildParseSync(VkbBuild &context, tinyxml2::XMLElement* pSyncElement)
+{
+    if (pSyncElement == NULL) {
+        return VKB_INVALID_ARGS;
+    }
+
+    // The <syncpipeline> elements describe the logical order of the stages. They aren't needed for anything we generate.
+    for (tinyxml2::XMLElement* pChildElement = pSyncElement->FirstChildElement(); pChildElement != NULL; pChildElement = pChildElement->NextSiblingElement()) {
+        const char* name = pChildElement->Attribute("name");
+        if (name == NULL) {
+            continue;
+        }
+
+        if (strcmp(pChildElement->Name(), "syncstage") == 0) {
+            vkbBuildSyncStage stage;
+            stage.name = vkbTrim(name);
+
+            for (tinyxml2::XMLElement* pInfoElement = pChildElement->FirstChildElement(); pInfoElement != NULL; pInfoElement = pInfoElement->NextSiblingElement()) {
+                if (strcmp(pInfoElement->Name(), "syncsupport") == 0) {
+                    stage.queues = vkbBuildSplitListAttribute(pInfoElement, "queues");
+                }
+                if (strcmp(pInfoElement->Name(), "syncequivalent") == 0) {
+                    stage.equivalentStages = vkbBuildSplitListAttribute(pInfoElement, "stage");
+                }
+            }
+
+            context.syncStages.push_back(stage);
+        }
+        if (strcmp(pChildElement->Name(), "syncaccess") == 0) {
+            vkbBuildSyncAccess access;
+            access.name = vkbTrim(name);
+
+            for (tinyxml2::XMLElement* pInfoElement = pChildElement->FirstChildElement(); pInfoElement != NULL; pInfoElement = pInfoElement->NextSiblingElement()) {
+                if (strcmp(pInfoElement->Name(), "syncsupport") == 0) {
+                    access.stages = vkbBuildSplitListAttribute(pInfoElement, "stage");
+                }
+                if (strcmp(pInfoElement->Name(), "syncequivalent") == 0) {
+                    access.equivalentAccesses = vkbBuildSplitListAttribute(pInfoElement, "access");
+                }
+            }
+
+            context.syncAccesses.push_back(access);
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
 bool vkbBuildFindTypeByName(VkbBuild &context, const char* name, size_t* pIndexOut)
 {
     if (name == NULL) {
@@ -1564,6 +1979,40 @@ struct vkbBuildCodeGenDependencies
     }
 };
 
+// Statistics about the code output by a feature or extension. Used by the size report (--report).
+struct vkbBuildCodeGenUnitStats
+{
+    std::string name;
+    std::string section;    // "core", "extension", "video std" or the platform macro for platform-specific extensions.
+    size_t lines;
+    size_t bytes;
+    size_t types;           // All types, including structs and enums.
+    size_t structs;         // Structs and unions.
+    size_t enums;
+    size_t defines;
+    size_t commands;        // Each command is a function pointer in VkbAPI.
+
+    vkbBuildCodeGenUnitStats()
+        : lines(0)
+        , bytes(0)
+        , types(0)
+        , structs(0)
+        , enums(0)
+        , defines(0)
+        , commands(0)
+    {
+    }
+};
+
+// A position in the output. The difference between two of these is what was generated between them.
+struct vkbBuildCodeGenMark
+{
+    size_t code;
+    size_t types;
+    size_t defines;
+    size_t commands;
+};
+
 // Keeps track of what has been output from the codegen stage. This is used for keeping track 
 struct vkbBuildCodeGenState
 {
@@ -1573,6 +2022,26 @@ struct vkbBuildCodeGenState
     std::vector<std::string> outputTypes;       // <-- Keeps track of types that have already been output (base types, struct, union, etc.).
     std::vector<std::string> outputCommands;    // <-- Keeps track of the commands that have already been output.
 
+    // Split-header mode needs to know which feature or extension each item was output in so it can #include the relevant header, and the
+    // C++ module needs it so it can wrap platform-specific #include's. These run parallel to the lists above.
+    std::string currentUnit;
+    std::vector<std::string> outputDefineUnits;
+    std::vector<std::string> outputTypeUnits;
+    std::vector<std::string> outputCommandUnits;
+
+    std::vector<vkbBuildCodeGenUnitStats> unitStats;
+
+    vkbBuildCodeGenMark GetMark(const std::string &codeOut) const
+    {
+        vkbBuildCodeGenMark mark;
+        mark.code     = codeOut.size();
+        mark.types    = outputTypes.size();
+        mark.defines  = outputDefines.size();
+        mark.commands = outputCommands.size();
+
+        return mark;
+    }
+
     bool HasOutputDefine(const std::string &name) const
     {
         return vkbContains(outputDefines, name);
@@ -1593,21 +2062,125 @@ struct vkbBuildCodeGenState
     {
         assert(!HasOutputDefine(name));
         outputDefines.push_back(name);
+        outputDefineUnits.push_back(currentUnit);
     }
 
     void MarkTypeAsOutput(const std::string &name)
     {
         assert(!HasOutputType(name));
         outputTypes.push_back(name);
+        outputTypeUnits.push_back(currentUnit);
     }
 
     void MarkCommandAsOutput(const std::string &name)
     {
         assert(!HasOutputCommand(name));
         outputCommands.push_back(name);
+        outputCommandUnits.push_back(currentUnit);
+    }
+
+
+    // Returns the name of the unit that output the given define, type or command, or an empty string if it hasn't been output.
+    std::string GetOutputUnit(const std::string &name) const
+    {
+        for (size_t i = 0; i < outputTypes.size(); ++i) {
+            if (outputTypes[i] == name) {
+                return outputTypeUnits[i];
+            }
+        }
+
+        for (size_t i = 0; i < outputDefines.size(); ++i) {
+            if (outputDefines[i] == name) {
+                return outputDefineUnits[i];
+            }
+        }
+
+        for (size_t i = 0; i < outputCommands.size(); ++i) {
+            if (outputCommands[i] == name) {
+                return outputCommandUnits[i];
+            }
+        }
+
+        return "";
     }
 };
 
+// Returns the platform macro that the given feature or extension is wrapped in, or an empty string if it's not platform-specific.
+std::string vkbBuildGetUnitProtect(VkbBuild &context, const std::string &unitName)
+{
+    size_t iExtension;
+    if (vkbBuildFindExtensionByName(context, unitName.c_str(), &iExtension)) {
+        for (size_t iPlatform = 0; iPlatform < context.platforms.size(); ++iPlatform) {
+            if (context.platforms[iPlatform].name == context.extensions[iExtension].platform) {
+                return context.platforms[iPlatform].protect;
+            }
+        }
+    }
+
+    return "";
+}
+
+// Wraps a line of code in the platform guard of the unit it belongs to. Consecutive lines with the same guard share a single #ifdef.
+// Passing an empty protect and line closes the last guard.
+void vkbBuildAppendGuardedLine(const std::string &protect, const std::string &line, std::string &currentProtect, std::string &codeOut)
+{
+    if (protect != currentProtect) {
+        if (currentProtect != "") {
+            codeOut += "#endif /*" + currentProtect + "*/\n";
+        }
+        if (protect != "") {
+            codeOut += "#ifdef " + protect + "\n";
+        }
+        currentProtect = protect;
+    }
+
+    codeOut += line;
+}
+
+// Adds everything output since the given mark to the statistics of the current unit. A unit can be output in more than one pass.
+void vkbBuildUpdateUnitStats(VkbBuild &context, vkbBuildCodeGenState &codegenState, const std::string &section, const vkbBuildCodeGenMark &mark, const std::string &codeOut)
+{
+    vkbBuildCodeGenUnitStats* pStats = NULL;
+    for (size_t iStats = 0; iStats < codegenState.unitStats.size(); ++iStats) {
+        if (codegenState.unitStats[iStats].name == codegenState.currentUnit) {
+            pStats = &codegenState.unitStats[iStats];
+            break;
+        }
+    }
+
+    if (pStats == NULL) {
+        vkbBuildCodeGenUnitStats stats;
+        stats.name    = codegenState.currentUnit;
+        stats.section = section;
+        codegenState.unitStats.push_back(stats);
+        pStats = &codegenState.unitStats.back();
+    }
+
+    for (size_t iChar = mark.code; iChar < codeOut.size(); ++iChar) {
+        if (codeOut[iChar] == '\n') {
+            pStats->lines += 1;
+        }
+    }
+    pStats->bytes += codeOut.size() - mark.code;
+
+    for (size_t iType = mark.types; iType < codegenState.outputTypes.size(); ++iType) {
+        pStats->types += 1;
+
+        size_t typeIndex;
+        if (vkbBuildFindTypeByName(context, codegenState.outputTypes[iType].c_str(), &typeIndex)) {
+            if (context.types[typeIndex].category == "struct" || context.types[typeIndex].category == "union") {
+                pStats->structs += 1;
+            }
+            if (context.types[typeIndex].category == "enum") {
+                pStats->enums += 1;
+            }
+        }
+    }
+
+    pStats->defines  += codegenState.outputDefines.size()  - mark.defines;
+    pStats->commands += codegenState.outputCommands.size() - mark.commands;
+}
+
 VkbResult vkbBuildGenerateCode_C_DependencyIncludes(VkbBuild &context, vkbBuildCodeGenState &codegenState, const vkbBuildCodeGenDependencies &dependencies, std::string &codeOut)
 {
     const std::vector<size_t> &typeIndices = dependencies.typeIndexes;
@@ -1745,6 +2318,17 @@ std::string vkbToUpper(const std::string &str)
     return result;
 }
 
+std::string vkbToLower(const std::string &str)
+{
+    std::string result;
+
+    for (size_t i = 0; i < str.length(); i += 1) {
+        result += (char)std::tolower(str[i]);
+    }
+
+    return result;
+}
+
 std::string vkbNameToUpperCaseStyle(const std::string &name)
 {
     std::string result = "VK"; // The final result will always start with "VK".
@@ -1917,7 +2501,7 @@ VkbResult vkbBuildGenerateCode_C_Dependencies(VkbBuild &context, vkbBuildCodeGen
                                         /* 64-bit enums. Cannot use an enum. */
                                         using64BitFlags = true;
                                         codeOut += "typedef "; codeOut += type.type; codeOut += " "; codeOut += enums.name; codeOut += ";\n";
-                                        enumValuePrefix = "static const "; enumValuePrefix += enums.name; enumValuePrefix += " ";
+                                        enumValuePrefix = "VKBIND_FLAGS64_CONST "; enumValuePrefix += enums.name; enumValuePrefix += " ";
                                     }
                                     
                                     for (size_t iEnumValue = 0; iEnumValue < enums.enums.size(); ++iEnumValue) {
@@ -2332,11 +2916,6 @@ VkbResult vkbBuildGenerateCode_C_Extension(VkbBuild &context, vkbBuildCodeGenSta
 
     vkbBuildExtension &extension = context.extensions[iExtension];
 
-    if (context.codegenConfig.treatExtensionsAsSeparateHeaders) {
-        codeOut += "#ifndef " + vkbToUpper(extension.name) + "_H_\n";
-        codeOut += "#define " + vkbToUpper(extension.name) + "_H_\n\n";
-    }
-
     // Extension-specific stuff. Extensions can define enums in #define style directly within the <require> tag. These need to be handled here.
     intermediaryCode += "\n#define " + extension.name + " 1\n";
 
@@ -2382,11 +2961,6 @@ VkbResult vkbBuildGenerateCode_C_Extension(VkbBuild &context, vkbBuildCodeGenSta
     }
 
     codeOut += "\n" + vkbTrim(intermediaryCode) + "\n";
-
-    if (context.codegenConfig.treatExtensionsAsSeparateHeaders) {
-        codeOut += "#endif /* " + vkbToUpper(extension.name) + "_H_ */\n\n";
-    }
-
     codeOut += "\n";
 
     return VKB_SUCCESS;
@@ -2408,7 +2982,8 @@ VkbResult vkbBuildReorderExtensions(VkbBuild &context)
         size_t iOldIndex;
         size_t iNewIndex;
         if (vkbBuildFindExtensionByName(context, promotedExtensions[iPromotedExtension].name.c_str(),       &iOldIndex) &&
-            vkbBuildFindExtensionByName(context, promotedExtensions[iPromotedExtension].promotedto.c_str(), &iNewIndex)) {
+            vkbBuildFindExtensionByName(context, promotedExtensions[iPromotedExtension].promotedto.c_str(), &iNewIndex) &&
+            iOldIndex < iNewIndex) {  // <-- Already located after the promoted extension. This keeps the reordering stable if run more than once.
             context.extensions.erase( context.extensions.begin() + iOldIndex);
             context.extensions.insert(context.extensions.begin() + iNewIndex, promotedExtensions[iPromotedExtension]);
         }
@@ -2417,10 +2992,9 @@ VkbResult vkbBuildReorderExtensions(VkbBuild &context)
     return VKB_SUCCESS;
 }
 
-VkbResult vkbBuildGenerateCode_C_Main(VkbBuild &context, std::string &codeOut)
+VkbResult vkbBuildGenerateCode_C_InitState(VkbBuild &context, vkbBuildCodeGenState &codegenState)
 {
     VkbResult result;
-    vkbBuildCodeGenState codegenState;
 
     // We need to reorder extensions so that any that have been promoted are located _after_ the promoted extension.
     result = vkbBuildReorderExtensions(context);
@@ -2450,23 +3024,188 @@ VkbResult vkbBuildGenerateCode_C_Main(VkbBuild &context, std::string &codeOut)
         codegenState.extensionDependencies.push_back(dependencies);
     }
 
+    return VKB_SUCCESS;
+}
 
-    // Features.
+// Finds the feature or extension that requires the given enum value. Returns false if it's not required by anything that's being output.
+bool vkbBuildFindRequireEnumUnit(VkbBuild &context, const std::string &name, std::string &unitOut)
+{
     for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
-        result = vkbBuildGenerateCode_C_Feature(context, codegenState, iFeature, codeOut);
-        if (result != VKB_SUCCESS) {
-            return result;
+        for (size_t iRequire = 0; iRequire < context.features[iFeature].requires.size(); ++iRequire) {
+            const vkbBuildRequire &require = context.features[iFeature].requires[iRequire];
+            for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                if (require.enums[iRequireEnum].name == name) {
+                    unitOut = context.features[iFeature].name;
+                    return true;
+                }
+            }
+        }
+    }
+
+    for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+        for (size_t iRequire = 0; iRequire < context.extensions[iExtension].requires.size(); ++iRequire) {
+            const vkbBuildRequire &require = context.extensions[iExtension].requires[iRequire];
+            for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                if (require.enums[iRequireEnum].name == name) {
+                    unitOut = context.extensions[iExtension].name;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+In modern mode the extensions that were culled are replaced with aliases of their core equivalents so existing code still compiles.
+Types are aliased with a typedef and enum values and commands are aliased with a #define. The command #define's cover both the
+global function pointer and the VkbAPI member. Nothing is output for items that don't have a core equivalent. The names of the units
+the aliases refer to are output to targetUnitsOut so split-header mode knows what to #include.
+*/
+VkbResult vkbBuildGenerateCode_C_LegacyAliases(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::vector<std::string> &targetUnitsOut, std::string &codeOut)
+{
+    std::string aliasCode;
+    std::string currentProtect;
+    std::vector<std::string> outputAliases;
+
+    for (size_t iExtension = 0; iExtension < context.culledExtensions.size(); ++iExtension) {
+        vkbBuildExtension &extension = context.culledExtensions[iExtension];
+        for (size_t iRequire = 0; iRequire < extension.requires.size(); ++iRequire) {
+            vkbBuildRequire &require = extension.requires[iRequire];
+
+            // Types.
+            for (size_t iRequireType = 0; iRequireType < require.types.size(); ++iRequireType) {
+                const std::string &name = require.types[iRequireType].name;
+                if (codegenState.HasOutputType(name) || vkbContains(outputAliases, name)) {
+                    continue;
+                }
+
+                // Follow the alias until we find a type that has been output.
+                std::string target = name;
+                size_t iType;
+                for (size_t iDepth = 0; iDepth < context.types.size() && vkbBuildFindTypeByName(context, target.c_str(), &iType) && context.types[iType].alias != ""; ++iDepth) {
+                    target = context.types[iType].alias;
+                    if (codegenState.HasOutputType(target)) {
+                        break;
+                    }
+                }
+
+                if (target == name || !codegenState.HasOutputType(target)) {
+                    continue;
+                }
+
+                std::string targetUnit = codegenState.GetOutputUnit(target);
+                vkbBuildAppendGuardedLine(vkbBuildGetUnitProtect(context, targetUnit), "typedef " + target + " " + name + ";\n", currentProtect, aliasCode);
+                outputAliases.push_back(name);
+                if (!vkbContains(targetUnitsOut, targetUnit)) {
+                    targetUnitsOut.push_back(targetUnit);
+                }
+            }
+
+            // Enum values. Only those extending an enum are aliases of core values. The rest are things like the extension name.
+            for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                const vkbBuildRequireEnum &requireEnum = require.enums[iRequireEnum];
+                if (requireEnum.alias == "" || requireEnum.extends == "" || !codegenState.HasOutputType(requireEnum.extends) || vkbContains(outputAliases, requireEnum.name)) {
+                    continue;
+                }
+
+                std::string unit;
+                if (vkbBuildFindRequireEnumUnit(context, requireEnum.name, unit)) {
+                    continue;   // <-- Still output by something that wasn't culled.
+                }
+
+                // The target will be either a value added by a feature or extension, or one of the enum's own values.
+                std::string targetUnit = codegenState.GetOutputUnit(requireEnum.extends);
+                vkbBuildFindRequireEnumUnit(context, requireEnum.alias, targetUnit);
+
+                vkbBuildAppendGuardedLine(vkbBuildGetUnitProtect(context, targetUnit), "#define " + requireEnum.name + " " + requireEnum.alias + "\n", currentProtect, aliasCode);
+                outputAliases.push_back(requireEnum.name);
+                if (!vkbContains(targetUnitsOut, targetUnit)) {
+                    targetUnitsOut.push_back(targetUnit);
+                }
+            }
+
+            // Commands.
+            for (size_t iRequireCommand = 0; iRequireCommand < require.commands.size(); ++iRequireCommand) {
+                const std::string &name = require.commands[iRequireCommand].name;
+                if (codegenState.HasOutputCommand(name) || vkbContains(outputAliases, name)) {
+                    continue;
+                }
+
+                std::string target = name;
+                size_t iCommand;
+                for (size_t iDepth = 0; iDepth < context.commands.size() && vkbBuildFindCommandByName(context, target.c_str(), &iCommand) && context.commands[iCommand].alias != ""; ++iDepth) {
+                    target = context.commands[iCommand].alias;
+                    if (codegenState.HasOutputCommand(target)) {
+                        break;
+                    }
+                }
+
+                if (target == name || !codegenState.HasOutputCommand(target)) {
+                    continue;
+                }
+
+                std::string targetUnit = codegenState.GetOutputUnit(target);
+                std::string targetProtect = vkbBuildGetUnitProtect(context, targetUnit);
+                vkbBuildAppendGuardedLine(targetProtect, "#define PFN_" + name + " PFN_" + target + "\n", currentProtect, aliasCode);
+                vkbBuildAppendGuardedLine(targetProtect, "#define " + name + " " + target + "\n", currentProtect, aliasCode);
+                outputAliases.push_back(name);
+                if (!vkbContains(targetUnitsOut, targetUnit)) {
+                    targetUnitsOut.push_back(targetUnit);
+                }
+            }
+        }
+    }
+
+    vkbBuildAppendGuardedLine("", "", currentProtect, aliasCode);
+
+    if (aliasCode != "") {
+        codeOut += "/*\n";
+        codeOut += "Aliases for promoted and deprecated extensions that have been removed by modern mode. Commands refer to the core entry\n";
+        codeOut += "points, which are only loaded when the instance or device supports the core version. They're NULL on a Vulkan 1.0 device\n";
+        codeOut += "even when it supports the extension.\n";
+        codeOut += "*/\n";
+        codeOut += "#ifndef VKBIND_NO_LEGACY_ALIASES\n";
+        codeOut += aliasCode;
+        codeOut += "#endif /*VKBIND_NO_LEGACY_ALIASES*/\n\n";
+    }
+
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_Main(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    VkbResult result;
+
+    result = vkbBuildGenerateCode_C_InitState(context, codegenState);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+
+    // Features.
+    for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+        codegenState.currentUnit = context.features[iFeature].name;
+        vkbBuildCodeGenMark mark = codegenState.GetMark(codeOut);
+        result = vkbBuildGenerateCode_C_Feature(context, codegenState, iFeature, codeOut);
+        if (result != VKB_SUCCESS) {
+            return result;
         }
+        vkbBuildUpdateUnitStats(context, codegenState, "core", mark, codeOut);
     }
 
     // Cross-platform extensions.
     for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
         vkbBuildExtension &extension = context.extensions[iExtension];
         if (extension.platform == "") {
+            codegenState.currentUnit = extension.name;
+            vkbBuildCodeGenMark mark = codegenState.GetMark(codeOut);
             result = vkbBuildGenerateCode_C_Extension(context, codegenState, iExtension, codeOut);
             if (result != VKB_SUCCESS) {
                 return result;
             }
+            vkbBuildUpdateUnitStats(context, codegenState, "extension", mark, codeOut);
         }
     }
 
@@ -2485,35 +3224,347 @@ VkbResult vkbBuildGenerateCode_C_Main(VkbBuild &context, std::string &codeOut)
             // "include" parts are done slightly differently for platform-specific extensions.
             for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
                 if (context.extensions[iExtension].platform == platform.name) {
+                    codegenState.currentUnit = context.extensions[iExtension].name;
+                    vkbBuildCodeGenMark mark = codegenState.GetMark(codeOut);
                     result = vkbBuildGenerateCode_C_DependencyIncludes(context, codegenState, codegenState.extensionDependencies[iExtension], codeOut);
                     if (result != VKB_SUCCESS) {
                         return result;
                     }
+                    vkbBuildUpdateUnitStats(context, codegenState, platform.protect, mark, codeOut);
                 }
             }
 
             for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
                 vkbBuildExtension &extension = context.extensions[iExtension];
                 if (extension.platform == platform.name) {
+                    codegenState.currentUnit = extension.name;
+                    vkbBuildCodeGenMark mark = codegenState.GetMark(codeOut);
                     result = vkbBuildGenerateCode_C_Extension(context, codegenState, iExtension, codeOut);
                     if (result != VKB_SUCCESS) {
                         return result;
                     }
+                    vkbBuildUpdateUnitStats(context, codegenState, platform.protect, mark, codeOut);
                 }
             }
         }
         codeOut += "#endif /*" + platform.protect + "*/\n\n";
     }
 
+    // Legacy aliases for modern mode. These need to come last because they can refer to anything.
+    if (context.culledExtensions.size() > 0) {
+        std::vector<std::string> targetUnits;
+        codegenState.currentUnit = "VKBIND_LEGACY_ALIASES";
+        vkbBuildCodeGenMark mark = codegenState.GetMark(codeOut);
+        result = vkbBuildGenerateCode_C_LegacyAliases(context, codegenState, targetUnits, codeOut);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+        vkbBuildUpdateUnitStats(context, codegenState, "legacy aliases", mark, codeOut);
+    }
+
+
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_Main(VkbBuild &context, std::string &codeOut)
+{
+    vkbBuildCodeGenState codegenState;
+    return vkbBuildGenerateCode_C_Main(context, codegenState, codeOut);
+}
+
+// The code and state from the main pass over vk.xml and video.xml. This is generated once and then shared by every tag since most of
+// them need to know what was output.
+struct vkbBuildCodeGenOutput
+{
+    vkbBuildCodeGenState vkState;
+    vkbBuildCodeGenState videoState;
+    std::string vkCode;
+    std::string videoCode;
+};
+
+VkbResult vkbBuildGenerateCode_C_Output(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenOutput &output)
+{
+    VkbResult result;
+
+    result = vkbBuildGenerateCode_C_Main(video, output.videoState, output.videoCode);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    return vkbBuildGenerateCode_C_Main(vk, output.vkState, output.vkCode);
+}
+
+// A single header in split-header mode. There is one of these for each feature and extension.
+struct vkbBuildCodeGenUnit
+{
+    std::string name;                   // The name of the feature or extension ("VK_VERSION_1_0", "VK_KHR_surface", etc.)
+    std::string protect;                // The platform macro the unit needs to be wrapped in, if any.
+    std::vector<std::string> includes;  // The names of the other units this unit depends on, in output order.
+    std::vector<std::string> commands;  // The commands output by this unit. Used for declaring the global function pointers.
+    bool requiresVideo;                 // Whether or not the unit references the video std types.
+    std::string code;
+
+    vkbBuildCodeGenUnit()
+        : requiresVideo(false)
+    {
+    }
+};
+
+std::string vkbBuildGetUnitFileName(const std::string &unitName)
+{
+    return vkbToLower(unitName) + ".h";
+}
+
+void vkbBuildAddUnitIncludes(VkbBuild &context, const vkbBuildCodeGenState &codegenState, const std::vector<size_t> &typeIndices, const std::vector<size_t> &enumIndices, vkbBuildCodeGenUnit &unit)
+{
+    for (size_t iType = 0; iType < typeIndices.size(); ++iType) {
+        vkbBuildType &type = context.types[typeIndices[iType]];
+
+        // The video std types come from video.xml which is output as its own header.
+        if (type.category == "include" && type.name.find("vk_video/") != std::string::npos) {
+            unit.requiresVideo = true;
+        }
+
+        std::string ownerUnit = codegenState.GetOutputUnit(type.name);
+        if (ownerUnit != "" && ownerUnit != unit.name && !vkbContains(unit.includes, ownerUnit)) {
+            unit.includes.push_back(ownerUnit);
+        }
+    }
+
+    for (size_t iEnum = 0; iEnum < enumIndices.size(); ++iEnum) {
+        std::string ownerUnit = codegenState.GetOutputUnit(context.enums[enumIndices[iEnum]].name);
+        if (ownerUnit != "" && ownerUnit != unit.name && !vkbContains(unit.includes, ownerUnit)) {
+            unit.includes.push_back(ownerUnit);
+        }
+    }
+}
+
+VkbResult vkbBuildResolveUnit(VkbBuild &context, const vkbBuildCodeGenState &codegenState, const vkbBuildCodeGenDependencies &dependencies, const std::vector<vkbBuildRequire> &requires, const std::vector<vkbBuildCodeGenUnit> &prevUnits, vkbBuildCodeGenUnit &unit)
+{
+    std::vector<std::string> includes;
+
+    vkbBuildAddUnitIncludes(context, codegenState, dependencies.typeIndexes, dependencies.enumIndexes, unit);
+
+    for (size_t iRequire = 0; iRequire < requires.size(); ++iRequire) {
+        for (size_t iRequireCommand = 0; iRequireCommand < requires[iRequire].commands.size(); ++iRequireCommand) {
+            const std::string &commandName = requires[iRequire].commands[iRequireCommand].name;
+
+            for (size_t iOutputCommand = 0; iOutputCommand < codegenState.outputCommands.size(); ++iOutputCommand) {
+                if (codegenState.outputCommands[iOutputCommand] == commandName && codegenState.outputCommandUnits[iOutputCommand] == unit.name) {
+                    if (!vkbContains(unit.commands, commandName)) {
+                        unit.commands.push_back(commandName);
+                    }
+                }
+            }
+
+            // Aliased commands are output with the full declaration of the base command, but the dependency list is only built from
+            // the alias which doesn't have any parameters. We need to pull in the types of the base command.
+            size_t iCommand;
+            if (vkbBuildFindCommandByName(context, commandName.c_str(), &iCommand) && context.commands[iCommand].alias != "") {
+                std::vector<size_t> baseTypeIndices;
+                std::vector<size_t> baseEnumIndices;
+                vkbBuildAddCommandDependencies(context, context.commands[iCommand].alias.c_str(), baseTypeIndices, baseEnumIndices);
+                vkbBuildAddUnitIncludes(context, codegenState, baseTypeIndices, baseEnumIndices, unit);
+            }
+        }
+    }
+
+    // Includes need to be in the same order as the units themselves.
+    for (size_t iPrevUnit = 0; iPrevUnit < prevUnits.size(); ++iPrevUnit) {
+        if (vkbContains(unit.includes, prevUnits[iPrevUnit].name)) {
+            includes.push_back(prevUnits[iPrevUnit].name);
+        }
+    }
+
+    unit.includes = includes;
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_Units(VkbBuild &context, std::vector<vkbBuildCodeGenUnit> &unitsOut)
+{
+    VkbResult result;
+    vkbBuildCodeGenState codegenState;
+
+    result = vkbBuildGenerateCode_C_InitState(context, codegenState);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    // Features.
+    for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+        vkbBuildCodeGenUnit unit;
+        unit.name = context.features[iFeature].name;
+        codegenState.currentUnit = unit.name;
+
+        result = vkbBuildGenerateCode_C_Feature(context, codegenState, iFeature, unit.code);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        result = vkbBuildResolveUnit(context, codegenState, codegenState.featureDependencies[iFeature], context.features[iFeature].requires, unitsOut, unit);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        unitsOut.push_back(unit);
+    }
+
+    // Extensions. This needs to be done in the same order as the single-header output: cross-platform extensions first, then each
+    // platform in turn. Platform-specific includes are output by the extension itself rather than at the top of the platform section.
+    for (size_t iPlatform = 0; iPlatform <= context.platforms.size(); ++iPlatform) {
+        std::string platformName;
+        std::string platformProtect;
+        if (iPlatform > 0) {
+            platformName    = context.platforms[iPlatform-1].name;
+            platformProtect = context.platforms[iPlatform-1].protect;
+        }
+
+        for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+            vkbBuildExtension &extension = context.extensions[iExtension];
+            if (extension.platform != platformName) {
+                continue;
+            }
+
+            vkbBuildCodeGenUnit unit;
+            unit.name = extension.name;
+            unit.protect = platformProtect;
+            codegenState.currentUnit = unit.name;
+
+            result = vkbBuildGenerateCode_C_Extension(context, codegenState, iExtension, unit.code);
+            if (result != VKB_SUCCESS) {
+                return result;
+            }
+
+            result = vkbBuildResolveUnit(context, codegenState, codegenState.extensionDependencies[iExtension], extension.requires, unitsOut, unit);
+            if (result != VKB_SUCCESS) {
+                return result;
+            }
+
+            unitsOut.push_back(unit);
+        }
+    }
+
+    // Legacy aliases for modern mode. This is its own header so it can include only the headers that define the alias targets.
+    if (context.culledExtensions.size() > 0) {
+        vkbBuildCodeGenUnit unit;
+        unit.name = "VKBIND_LEGACY_ALIASES";
+        codegenState.currentUnit = unit.name;
+
+        std::vector<std::string> targetUnits;
+        result = vkbBuildGenerateCode_C_LegacyAliases(context, codegenState, targetUnits, unit.code);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        // Includes need to be in the same order as the units themselves.
+        for (size_t iPrevUnit = 0; iPrevUnit < unitsOut.size(); ++iPrevUnit) {
+            if (vkbContains(targetUnits, unitsOut[iPrevUnit].name)) {
+                unit.includes.push_back(unitsOut[iPrevUnit].name);
+            }
+        }
+
+        if (unit.code != "") {
+            unitsOut.push_back(unit);
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
+// Finds the feature or extension that outputs the given command. Returns false if it's not required by anything that's being output.
+bool vkbBuildFindRequireCommandUnit(VkbBuild &context, const std::string &name, std::string &unitOut)
+{
+    for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+        for (size_t iRequire = 0; iRequire < context.features[iFeature].requires.size(); ++iRequire) {
+            const vkbBuildRequire &require = context.features[iFeature].requires[iRequire];
+            for (size_t iRequireCommand = 0; iRequireCommand < require.commands.size(); ++iRequireCommand) {
+                if (require.commands[iRequireCommand].name == name) {
+                    unitOut = context.features[iFeature].name;
+                    return true;
+                }
+            }
+        }
+    }
+
+    for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+        for (size_t iRequire = 0; iRequire < context.extensions[iExtension].requires.size(); ++iRequire) {
+            const vkbBuildRequire &require = context.extensions[iExtension].requires[iRequire];
+            for (size_t iRequireCommand = 0; iRequireCommand < require.commands.size(); ++iRequireCommand) {
+                if (require.commands[iRequireCommand].name == name) {
+                    unitOut = context.extensions[iExtension].name;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+Outputs the commands from the call-frequency profile, hottest first, so the ones called the most are packed into as few cache lines as
+possible at the start of VkbAPI and the global API. Platform-specific commands are wrapped in their platform guard. Commands that aren't
+being output (another platform's, or culled by modern mode) are skipped.
+*/
+VkbResult vkbBuildGenerateCode_C_FuncPointersDeclHot(VkbBuild &context, int indentation, bool withExtern, std::vector<std::string> &outputCommands, std::string &codeOut)
+{
+    std::string currentProtect;
+
+    for (size_t iHotCommand = 0; iHotCommand < context.codegenConfig.hotCommands.size(); ++iHotCommand) {
+        const std::string &name = context.codegenConfig.hotCommands[iHotCommand];
+
+        std::string unit;
+        size_t iCommand;
+        if (vkbContains(outputCommands, name) || !vkbBuildFindRequireCommandUnit(context, name, unit) || !vkbBuildFindCommandByName(context, name.c_str(), &iCommand)) {
+            continue;
+        }
+
+        std::string protect = vkbBuildGetUnitProtect(context, unit);
+        if (protect != currentProtect) {
+            if (currentProtect != "") {
+                codeOut += "\n#endif /*" + currentProtect + "*/";
+            }
+            if (protect != "") {
+                codeOut += "\n#ifdef " + protect;
+            }
+            currentProtect = protect;
+        }
+
+        // New line if required.
+        if (outputCommands.size() > 0 || currentProtect != "") {
+            codeOut += "\n";
+            for (int iSpace = 0; iSpace < indentation; ++iSpace) {
+                codeOut += " ";
+            }
+        }
+
+        if (withExtern) {
+            codeOut += "extern ";
+        }
+
+        codeOut += "PFN_" + context.commands[iCommand].name + " " + context.commands[iCommand].name + ";";
+
+        outputCommands.push_back(name);
+    }
+
+    if (currentProtect != "") {
+        codeOut += "\n#endif /*" + currentProtect + "*/";
+    }
 
     return VKB_SUCCESS;
 }
 
 VkbResult vkbBuildGenerateCode_C_FuncPointersDeclGlobal(VkbBuild &context, int indentation, bool withExtern, std::string &codeOut)
 {
-    // This should be in a nice order. Features first, then platform-independent extensions, then platform-specific extensions.
+    // This should be in a nice order. Features first, then platform-independent extensions, then platform-specific extensions. The
+    // exception is the commands from the call-frequency profile which always go first.
     std::vector<std::string> outputCommands;
 
+    VkbResult result = vkbBuildGenerateCode_C_FuncPointersDeclHot(context, indentation, withExtern, outputCommands, codeOut);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
     // Features.
     for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
         vkbBuildFeature &feature = context.features[iFeature];
@@ -3260,12 +4311,13 @@ std::vector<std::string> vkbSplitString(const std::string &str, const std::strin
 
 VkbResult vkbBuildGetVulkanVersion(VkbBuild &context, std::string &versionOut)
 {
-    // The version can be retrieved from the last "feature" section that is not VulkanSC and the value of VK_HEADER_VERSION.
-    versionOut = std::find_if(context.features.rbegin(), context.features.rend(), [](const vkbBuildFeature& feature) {
-        /* If the "api" does contains a "vulkan" item, return true. */
+    // The version can be retrieved from the last "feature" section for the API variant being generated and the value of VK_HEADER_VERSION.
+    const std::string targetAPI = (context.codegenConfig.api != "") ? context.codegenConfig.api : "vulkan";
+    versionOut = std::find_if(context.features.rbegin(), context.features.rend(), [&targetAPI](const vkbBuildFeature& feature) {
+        /* If the "api" contains the target API, return true. */
         auto apis = vkbSplitString(feature.api, ",");
         for (auto api : apis) {
-            if (api == "vulkan") {
+            if (api == targetAPI) {
                 return true;
             }
         }
@@ -3289,18 +4341,4333 @@ VkbResult vkbBuildGetVulkanVersion(VkbBuild &context, std::string &versionOut)
     return VKB_SUCCESS;
 }
 
-VkbResult vkbBuildGenerateCode_C_VulkanVersion(VkbBuild &context, std::string &codeOut)
+/*
+Retrieves the values of an enum in the order they're output, excluding aliases. This includes the values added by features and
+extensions. The values are returned as strings exactly as they're output, except for bit positions which are returned as a hex
+string of the value.
+*/
+void vkbBuildGetEnumValues(VkbBuild &context, const std::string &enumsName, std::vector<std::string> &namesOut, std::vector<std::string> &valuesOut)
 {
-    std::string version;
-    VkbResult result = vkbBuildGetVulkanVersion(context, version);
-    if (result != VKB_SUCCESS) {
-        return result;
+    size_t iEnums;
+    if (vkbBuildFindEnumByName(context, enumsName.c_str(), &iEnums)) {
+        for (size_t iEnumValue = 0; iEnumValue < context.enums[iEnums].enums.size(); ++iEnumValue) {
+            const vkbBuildEnum &enumValue = context.enums[iEnums].enums[iEnumValue];
+            if (enumValue.alias == "" && !vkbContains(namesOut, enumValue.name)) {
+                namesOut.push_back(enumValue.name);
+                valuesOut.push_back((enumValue.bitpos != "") ? vkbBuildBitPosToHexString(atoi(enumValue.bitpos.c_str())) : enumValue.value);
+            }
+        }
     }
 
-    codeOut += version;
-
-    return VKB_SUCCESS;
-}
+    for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+        for (size_t iRequire = 0; iRequire < context.features[iFeature].requires.size(); ++iRequire) {
+            vkbBuildRequire &require = context.features[iFeature].requires[iRequire];
+            for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                vkbBuildRequireEnum &requireEnum = require.enums[iRequireEnum];
+                if (requireEnum.extends == enumsName && requireEnum.alias == "" && !vkbContains(namesOut, requireEnum.name)) {
+                    namesOut.push_back(requireEnum.name);
+                    if (requireEnum.bitpos != "") {
+                        valuesOut.push_back(vkbBuildBitPosToHexString(atoi(requireEnum.bitpos.c_str())));
+                    } else {
+                        valuesOut.push_back((requireEnum.value != "") ? requireEnum.value : vkbBuildCalculateExtensionEnumValue(requireEnum));
+                    }
+                }
+            }
+        }
+    }
+
+    for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+        vkbBuildExtension &extension = context.extensions[iExtension];
+        for (size_t iRequire = 0; iRequire < extension.requires.size(); ++iRequire) {
+            vkbBuildRequire &require = extension.requires[iRequire];
+            for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                vkbBuildRequireEnum &requireEnum = require.enums[iRequireEnum];
+                if (requireEnum.extends == enumsName && requireEnum.alias == "" && !vkbContains(namesOut, requireEnum.name)) {
+                    namesOut.push_back(requireEnum.name);
+                    if (requireEnum.bitpos != "") {
+                        valuesOut.push_back(vkbBuildBitPosToHexString(atoi(requireEnum.bitpos.c_str())));
+                    } else {
+                        valuesOut.push_back((requireEnum.value != "") ? requireEnum.value : vkbBuildCalculateExtensionEnumValue(requireEnum, (requireEnum.extnumber != "") ? requireEnum.extnumber : extension.number));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Returns the VkStructureType value a struct is identified by, or an empty string if the struct doesn't have an sType. Aliases are followed.
+std::string vkbBuildGetStructTypeValue(VkbBuild &context, const std::string &structName, std::string* pResolvedNameOut)
+{
+    size_t iType;
+    std::string name = structName;
+    for (size_t iDepth = 0; iDepth < context.types.size() && vkbBuildFindTypeByName(context, name.c_str(), &iType); ++iDepth) {
+        vkbBuildType &type = context.types[iType];
+        if (type.alias != "") {
+            name = type.alias;
+            continue;
+        }
+
+        if (pResolvedNameOut != NULL) {
+            *pResolvedNameOut = name;
+        }
+
+        for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+            if (type.structData.members[iMember].name == "sType" && type.structData.members[iMember].values != "") {
+                std::string values = type.structData.members[iMember].values;
+                return values.substr(0, values.find(','));
+            }
+        }
+
+        break;
+    }
+
+    return "";
+}
+
+/*
+Outputs the structure type metadata used by vkbGetStructInfo() and friends. There is one entry for every VkStructureType value. Core
+values are small and dense so they map directly to an index. Extension values are 1000000000 + (extension number - 1) * 1000 + offset
+so the index is found with a table of the first index of each extension's block. This keeps the lookup constant time without needing
+a hash table. Structs that are behind a platform macro still get an entry, but without a name or size unless the macro is defined.
+*/
+VkbResult vkbBuildGenerateCode_C_StructInfo(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    std::vector<std::string> valueNames;
+    std::vector<std::string> values;
+    vkbBuildGetEnumValues(context, "VkStructureType", valueNames, values);
+
+    // Map each value to the struct it identifies.
+    std::vector<std::string> valueStructs(valueNames.size());
+    for (size_t iType = 0; iType < context.types.size(); ++iType) {
+        vkbBuildType &type = context.types[iType];
+        if (type.category != "struct" || type.alias != "" || !codegenState.HasOutputType(type.name)) {
+            continue;
+        }
+
+        std::string sType = vkbBuildGetStructTypeValue(context, type.name, NULL);
+        for (size_t iValue = 0; iValue < valueNames.size(); ++iValue) {
+            if (valueNames[iValue] == sType && valueStructs[iValue] == "") {
+                valueStructs[iValue] = type.name;
+            }
+        }
+    }
+
+    // Split the values into the core range and the extension blocks.
+    long long coreCount = 0;
+    std::vector<long long> blockCounts;
+    for (size_t iValue = 0; iValue < values.size(); ++iValue) {
+        long long value = atoll(values[iValue].c_str());
+        if (value < 0) {
+            continue;
+        }
+
+        if (value < 1000000000) {
+            if (value + 1 > coreCount) {
+                coreCount = value + 1;
+            }
+        } else {
+            size_t block = (size_t)((value - 1000000000) / 1000);
+            long long offset = (value - 1000000000) % 1000;
+            if (block >= blockCounts.size()) {
+                blockCounts.resize(block + 1, 0);
+            }
+            if (offset + 1 > blockCounts[block]) {
+                blockCounts[block] = offset + 1;
+            }
+        }
+    }
+
+    // The dense list of values. Holes are left empty.
+    std::vector<long long> blockFirsts(blockCounts.size(), 0);
+    std::vector<long long> denseValues;
+    for (long long value = 0; value < coreCount; ++value) {
+        denseValues.push_back(value);
+    }
+    for (size_t iBlock = 0; iBlock < blockCounts.size(); ++iBlock) {
+        blockFirsts[iBlock] = (long long)denseValues.size();
+        for (long long offset = 0; offset < blockCounts[iBlock]; ++offset) {
+            denseValues.push_back(1000000000 + (long long)iBlock * 1000 + offset);
+        }
+    }
+
+    // The list of structs each struct can extend. These go into a single array which each entry points into.
+    std::string extendsCode;
+    std::vector<size_t> extendsFirsts(valueNames.size(), 0);
+    std::vector<size_t> extendsCounts(valueNames.size(), 0);
+    size_t extendsTotal = 0;
+    for (size_t iValue = 0; iValue < valueNames.size(); ++iValue) {
+        size_t iType;
+        if (valueStructs[iValue] == "" || !vkbBuildFindTypeByName(context, valueStructs[iValue].c_str(), &iType)) {
+            continue;
+        }
+
+        extendsFirsts[iValue] = extendsTotal;
+
+        std::vector<std::string> bases = vkbSplitString(context.types[iType].structextends, ",");
+        for (size_t iBase = 0; iBase < bases.size(); ++iBase) {
+            std::string baseType = vkbBuildGetStructTypeValue(context, vkbTrim(bases[iBase]), NULL);
+            if (baseType != "" && vkbContains(valueNames, baseType)) {
+                extendsCode += "    " + baseType + ",\n";
+                extendsCounts[iValue] += 1;
+                extendsTotal += 1;
+            }
+        }
+    }
+
+    codeOut += "#define VKB_STRUCT_TYPE_CORE_COUNT  " + std::to_string(coreCount) + "\n";
+    codeOut += "\n";
+
+    codeOut += "static const VkStructureType g_vkbStructExtends[] = {\n";
+    codeOut += extendsCode;
+    codeOut += "    VK_STRUCTURE_TYPE_MAX_ENUM  /* Terminator. Also makes sure the array is never empty. */\n";
+    codeOut += "};\n";
+    codeOut += "\n";
+
+    codeOut += "static const struct\n";
+    codeOut += "{\n";
+    codeOut += "    uint16_t first;\n";
+    codeOut += "    uint16_t count;\n";
+    codeOut += "} g_vkbStructTypeBlocks[] = {\n";
+    for (size_t iBlock = 0; iBlock < blockCounts.size(); ++iBlock) {
+        codeOut += "    {" + std::to_string(blockFirsts[iBlock]) + ", " + std::to_string(blockCounts[iBlock]) + "},\n";
+    }
+    codeOut += "    {0, 0}\n";
+    codeOut += "};\n";
+    codeOut += "\n";
+
+    codeOut += "static const VkbStructInfo g_vkbStructInfo[] = {\n";
+    for (size_t iDense = 0; iDense < denseValues.size(); ++iDense) {
+        size_t iValue;
+        for (iValue = 0; iValue < values.size(); ++iValue) {
+            if (atoll(values[iValue].c_str()) == denseValues[iDense]) {
+                break;
+            }
+        }
+
+        if (iValue == values.size()) {
+            codeOut += "    {VK_STRUCTURE_TYPE_MAX_ENUM, NULL, 0, 0, NULL, 0},\n";    // <-- A hole.
+            continue;
+        }
+
+        std::string emptyEntry = "    {" + valueNames[iValue] + ", NULL, 0, 0, NULL, 0},\n";
+        if (valueStructs[iValue] == "") {
+            codeOut += emptyEntry;
+            continue;
+        }
+
+        const std::string &structName = valueStructs[iValue];
+        std::string entry = "    {" + valueNames[iValue] + ", \"" + structName + "\", sizeof(" + structName + "), VKBIND_ALIGNOF(" + structName + "), ";
+        if (extendsCounts[iValue] > 0) {
+            entry += "g_vkbStructExtends + " + std::to_string(extendsFirsts[iValue]) + ", " + std::to_string(extendsCounts[iValue]) + "},\n";
+        } else {
+            entry += "NULL, 0},\n";
+        }
+
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(structName));
+        if (protect != "") {
+            codeOut += "#ifdef " + protect + "\n";
+            codeOut += entry;
+            codeOut += "#else\n";
+            codeOut += emptyEntry;
+            codeOut += "#endif\n";
+        } else {
+            codeOut += entry;
+        }
+    }
+    codeOut += "    {VK_STRUCTURE_TYPE_MAX_ENUM, NULL, 0, 0, NULL, 0}  /* Terminator. Not counted by vkbGetStructTypeCount(). */\n";
+    codeOut += "};";
+
+    return VKB_SUCCESS;
+}
+
+// Converts a numericFormat attribute from the formats section to a VkbNumericFormat value.
+std::string vkbBuildGetNumericFormatValue(const std::string &numericFormat)
+{
+    const char* numericFormats[] = {
+        "UNORM", "SNORM", "USCALED", "SSCALED", "UINT", "SINT", "UFLOAT", "SFLOAT", "SRGB", "SFIXED5"
+    };
+
+    for (size_t iNumericFormat = 0; iNumericFormat < sizeof(numericFormats) / sizeof(numericFormats[0]); ++iNumericFormat) {
+        if (numericFormat == numericFormats[iNumericFormat]) {
+            return "VKB_NUMERIC_FORMAT_" + numericFormat;
+        }
+    }
+
+    return "VKB_NUMERIC_FORMAT_UNKNOWN";
+}
+
+VkbResult vkbBuildGenerateCode_C_FormatInfo(VkbBuild &context, std::string &codeOut)
+{
+    const size_t maxComponents = 4; // <-- Must match the size of VkbFormatInfo::components.
+    const size_t maxPlanes     = 3; // <-- Must match the size of VkbFormatInfo::planes.
+
+    // Only formats that are actually output get an entry. In modern mode, for example, some of the extensions adding formats are culled.
+    std::vector<std::string> valueNames;
+    std::vector<std::string> values;
+    vkbBuildGetEnumValues(context, "VkFormat", valueNames, values);
+
+    // Split the values into the core range and the extension blocks the same way as the structure types.
+    long long coreCount = 0;
+    std::vector<long long> blockCounts;
+    for (size_t iValue = 0; iValue < values.size(); ++iValue) {
+        long long value = atoll(values[iValue].c_str());
+        if (value < 0) {
+            continue;
+        }
+
+        if (value < 1000000000) {
+            if (value + 1 > coreCount) {
+                coreCount = value + 1;
+            }
+        } else {
+            size_t block = (size_t)((value - 1000000000) / 1000);
+            long long offset = (value - 1000000000) % 1000;
+            if (block >= blockCounts.size()) {
+                blockCounts.resize(block + 1, 0);
+            }
+            if (offset + 1 > blockCounts[block]) {
+                blockCounts[block] = offset + 1;
+            }
+        }
+    }
+
+    std::vector<long long> blockFirsts(blockCounts.size(), 0);
+    std::vector<long long> denseValues;
+    for (long long value = 0; value < coreCount; ++value) {
+        denseValues.push_back(value);
+    }
+    for (size_t iBlock = 0; iBlock < blockCounts.size(); ++iBlock) {
+        blockFirsts[iBlock] = (long long)denseValues.size();
+        for (long long offset = 0; offset < blockCounts[iBlock]; ++offset) {
+            denseValues.push_back(1000000000 + (long long)iBlock * 1000 + offset);
+        }
+    }
+
+    codeOut += "#define VKB_FORMAT_CORE_COUNT  " + std::to_string(coreCount) + "\n";
+    codeOut += "#define VKB_FORMAT_INFO_NONE   {VK_FORMAT_MAX_ENUM, NULL, 0, 0, {0, 0, 0}, 0, NULL, 0, {{0, 0, 0, VKB_NUMERIC_FORMAT_UNKNOWN}}, 0, {{0, 0, VK_FORMAT_UNDEFINED}}}\n";
+    codeOut += "\n";
+
+    codeOut += "static const struct\n";
+    codeOut += "{\n";
+    codeOut += "    uint16_t first;\n";
+    codeOut += "    uint16_t count;\n";
+    codeOut += "} g_vkbFormatBlocks[] = {\n";
+    for (size_t iBlock = 0; iBlock < blockCounts.size(); ++iBlock) {
+        codeOut += "    {" + std::to_string(blockFirsts[iBlock]) + ", " + std::to_string(blockCounts[iBlock]) + "},\n";
+    }
+    codeOut += "    {0, 0}\n";
+    codeOut += "};\n";
+    codeOut += "\n";
+
+    codeOut += "static const VkbFormatInfo g_vkbFormatInfo[] = {\n";
+    for (size_t iDense = 0; iDense < denseValues.size(); ++iDense) {
+        size_t iValue;
+        for (iValue = 0; iValue < values.size(); ++iValue) {
+            if (atoll(values[iValue].c_str()) == denseValues[iDense]) {
+                break;
+            }
+        }
+
+        const vkbBuildFormat* pFormat = NULL;
+        if (iValue < values.size()) {
+            for (size_t iFormat = 0; iFormat < context.formats.size(); ++iFormat) {
+                if (context.formats[iFormat].name == valueNames[iValue]) {
+                    pFormat = &context.formats[iFormat];
+                    break;
+                }
+            }
+        }
+
+        // Holes and values without an entry in the formats section, such as VK_FORMAT_UNDEFINED.
+        if (pFormat == NULL) {
+            codeOut += "    VKB_FORMAT_INFO_NONE,\n";
+            continue;
+        }
+
+        std::string blockExtent = "1, 1, 1";
+        if (pFormat->blockExtent != "") {
+            blockExtent = vkbReplaceAll(pFormat->blockExtent, ",", ", ");
+        }
+
+        std::string components;
+        size_t componentCount = 0;
+        for (size_t iComponent = 0; iComponent < pFormat->components.size() && componentCount < maxComponents; ++iComponent) {
+            const vkbBuildFormatComponent &component = pFormat->components[iComponent];
+            if (component.name == "") {
+                continue;
+            }
+
+            std::string bits = (component.bits == "compressed" || component.bits == "") ? "0" : component.bits;
+            std::string planeIndex = (component.planeIndex != "") ? component.planeIndex : "0";
+            if (componentCount > 0) {
+                components += ", ";
+            }
+            components += "{'" + component.name.substr(0, 1) + "', " + bits + ", " + planeIndex + ", " + vkbBuildGetNumericFormatValue(component.numericFormat) + "}";
+            componentCount += 1;
+        }
+        if (componentCount == 0) {
+            components = "{0, 0, 0, VKB_NUMERIC_FORMAT_UNKNOWN}";
+        }
+
+        std::string planes;
+        size_t planeCount = 0;
+        for (size_t iPlane = 0; iPlane < pFormat->planes.size() && planeCount < maxPlanes; ++iPlane) {
+            const vkbBuildFormatPlane &plane = pFormat->planes[iPlane];
+            std::string compatible = vkbContains(valueNames, plane.compatible) ? plane.compatible : std::string("VK_FORMAT_UNDEFINED");
+            if (planeCount > 0) {
+                planes += ", ";
+            }
+            planes += "{" + plane.widthDivisor + ", " + plane.heightDivisor + ", " + compatible + "}";
+            planeCount += 1;
+        }
+        if (planeCount == 0) {
+            planes = "{0, 0, VK_FORMAT_UNDEFINED}";
+        }
+
+        codeOut += "    {" + pFormat->name + ", \"" + pFormat->formatClass + "\", " + pFormat->blockSize + ", " + pFormat->texelsPerBlock + ", {" + blockExtent + "}, ";
+        codeOut += ((pFormat->packed != "") ? pFormat->packed : std::string("0")) + ", ";
+        codeOut += ((pFormat->compressed != "") ? "\"" + pFormat->compressed + "\"" : std::string("NULL")) + ", ";
+        codeOut += std::to_string(componentCount) + ", {" + components + "}, ";
+        codeOut += std::to_string(planeCount) + ", {" + planes + "}},\n";
+    }
+    codeOut += "    VKB_FORMAT_INFO_NONE  /* Terminator. Also makes sure the array is never empty. */\n";
+    codeOut += "};";
+
+    return VKB_SUCCESS;
+}
+
+// Converts a 64-bit flags value to a constant expression that doesn't need a 64-bit literal suffix.
+std::string vkbBuildFlags64ToString(unsigned long long value)
+{
+    char buffer[128];
+    if (value <= 0xFFFFFFFFULL) {
+        snprintf(buffer, sizeof(buffer), "0x%08x", (unsigned int)value);
+    } else {
+        snprintf(buffer, sizeof(buffer), "(((VkFlags64)0x%08x << 32) | 0x%08x)", (unsigned int)(value >> 32), (unsigned int)(value & 0xFFFFFFFF));
+    }
+
+    return buffer;
+}
+
+// Combines the values of a list of bits of a 64-bit bitmask. Bits that aren't output are ignored.
+unsigned long long vkbBuildGetFlags64Mask(const std::vector<std::string> &names, const std::vector<std::string> &values, const std::vector<std::string> &bits)
+{
+    unsigned long long mask = 0;
+    for (size_t iBit = 0; iBit < bits.size(); ++iBit) {
+        for (size_t iName = 0; iName < names.size(); ++iName) {
+            if (names[iName] == bits[iBit]) {
+                mask |= strtoull(values[iName].c_str(), NULL, 0);
+                break;
+            }
+        }
+    }
+
+    return mask;
+}
+
+// Retrieves the position of a single bit of a 64-bit bitmask, or -1 if it isn't output or isn't a single bit.
+int vkbBuildGetFlags64BitIndex(const std::vector<std::string> &names, const std::vector<std::string> &values, const std::string &name)
+{
+    std::vector<std::string> bits;
+    bits.push_back(name);
+
+    unsigned long long value = vkbBuildGetFlags64Mask(names, values, bits);
+    if (value == 0 || (value & (value - 1)) != 0) {
+        return -1;
+    }
+
+    int bitIndex = 0;
+    while ((value >> bitIndex) != 1) {
+        bitIndex += 1;
+    }
+
+    return bitIndex;
+}
+
+VkbResult vkbBuildGenerateCode_C_SyncInfo(VkbBuild &context, std::string &codeOut)
+{
+    // The queue names used by the sync section and the queue flag each of them stands for.
+    const char* queueNames[][2] = {
+        {"graphics",       "VK_QUEUE_GRAPHICS_BIT"},
+        {"compute",        "VK_QUEUE_COMPUTE_BIT"},
+        {"transfer",       "VK_QUEUE_TRANSFER_BIT"},
+        {"sparse_binding", "VK_QUEUE_SPARSE_BINDING_BIT"},
+        {"decode",         "VK_QUEUE_VIDEO_DECODE_BIT_KHR"},
+        {"encode",         "VK_QUEUE_VIDEO_ENCODE_BIT_KHR"},
+        {"opticalflow",    "VK_QUEUE_OPTICAL_FLOW_BIT_NV"}
+    };
+
+    std::vector<std::string> queueBitNames;
+    std::vector<std::string> queueBitValues;
+    vkbBuildGetEnumValues(context, "VkQueueFlagBits", queueBitNames, queueBitValues);
+
+    std::vector<std::string> stageNames;
+    std::vector<std::string> stageValues;
+    vkbBuildGetEnumValues(context, "VkPipelineStageFlagBits2", stageNames, stageValues);
+
+    std::vector<std::string> accessNames;
+    std::vector<std::string> accessValues;
+    vkbBuildGetEnumValues(context, "VkAccessFlagBits2", accessNames, accessValues);
+
+    // One entry per bit so lookups are a plain index.
+    std::vector<std::string> stageEntries(64, "    {0, 0},\n");
+    for (size_t iStage = 0; iStage < context.syncStages.size(); ++iStage) {
+        const vkbBuildSyncStage &stage = context.syncStages[iStage];
+
+        int bitIndex = vkbBuildGetFlags64BitIndex(stageNames, stageValues, stage.name);
+        if (bitIndex < 0) {
+            continue;
+        }
+
+        std::string queues;
+        for (size_t iQueue = 0; iQueue < stage.queues.size(); ++iQueue) {
+            for (size_t iQueueName = 0; iQueueName < sizeof(queueNames) / sizeof(queueNames[0]); ++iQueueName) {
+                if (stage.queues[iQueue] == queueNames[iQueueName][0] && vkbContains(queueBitNames, std::string(queueNames[iQueueName][1]))) {
+                    queues += (queues != "") ? " | " : "";
+                    queues += queueNames[iQueueName][1];
+                }
+            }
+        }
+
+        stageEntries[bitIndex] = "    {" + ((queues != "") ? queues : std::string("0")) + ", " + vkbBuildFlags64ToString(vkbBuildGetFlags64Mask(stageNames, stageValues, stage.equivalentStages)) + "},  /* " + stage.name + " */\n";
+    }
+
+    std::vector<std::string> accessEntries(64, "    {0, 0},\n");
+    for (size_t iAccess = 0; iAccess < context.syncAccesses.size(); ++iAccess) {
+        const vkbBuildSyncAccess &access = context.syncAccesses[iAccess];
+
+        int bitIndex = vkbBuildGetFlags64BitIndex(accessNames, accessValues, access.name);
+        if (bitIndex < 0) {
+            continue;
+        }
+
+        accessEntries[bitIndex] = "    {" + vkbBuildFlags64ToString(vkbBuildGetFlags64Mask(stageNames, stageValues, access.stages)) + ", " + vkbBuildFlags64ToString(vkbBuildGetFlags64Mask(accessNames, accessValues, access.equivalentAccesses)) + "},  /* " + access.name + " */\n";
+    }
+
+    codeOut += "static const struct\n";
+    codeOut += "{\n";
+    codeOut += "    VkQueueFlags queues;\n";
+    codeOut += "    VkPipelineStageFlags2 equivalentStages;\n";
+    codeOut += "} g_vkbSyncStages[64] = {\n";
+    for (size_t iBit = 0; iBit < stageEntries.size(); ++iBit) {
+        codeOut += stageEntries[iBit];
+    }
+    codeOut += "};\n";
+    codeOut += "\n";
+
+    codeOut += "static const struct\n";
+    codeOut += "{\n";
+    codeOut += "    VkPipelineStageFlags2 stages;\n";
+    codeOut += "    VkAccessFlags2 equivalentAccesses;\n";
+    codeOut += "} g_vkbSyncAccesses[64] = {\n";
+    for (size_t iBit = 0; iBit < accessEntries.size(); ++iBit) {
+        codeOut += accessEntries[iBit];
+    }
+    codeOut += "};";
+
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_BarrierBatch(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    // vkCmdPipelineBarrier2 might only be available through an alias, such as vkCmdPipelineBarrier2KHR with Vulkan SC.
+    std::vector<std::string> commandNames;
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+        if ((command.name == "vkCmdPipelineBarrier2" || command.alias == "vkCmdPipelineBarrier2") && codegenState.HasOutputCommand(command.name)) {
+            commandNames.push_back(command.name);
+        }
+    }
+
+    std::string apiCode;
+    std::string globalCode;
+    std::string currentProtect;
+    for (size_t iCommandName = 0; iCommandName < commandNames.size(); ++iCommandName) {
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(commandNames[iCommandName]));
+        vkbBuildAppendGuardedLine(protect, "    if (pAPI->" + commandNames[iCommandName] + " != NULL) {\n        return pAPI->" + commandNames[iCommandName] + ";\n    }\n", currentProtect, apiCode);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, apiCode);
+
+    for (size_t iCommandName = 0; iCommandName < commandNames.size(); ++iCommandName) {
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(commandNames[iCommandName]));
+        vkbBuildAppendGuardedLine(protect, "        if (" + commandNames[iCommandName] + " != NULL) {\n            return " + commandNames[iCommandName] + ";\n        }\n", currentProtect, globalCode);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, globalCode);
+
+    codeOut += "static VkbCmdPipelineBarrier2Proc vkbBarrierBatchGetCmdPipelineBarrier2(const VkbAPI* pAPI)\n";
+    codeOut += "{\n";
+    codeOut += "    if (pAPI == NULL) {\n";
+    codeOut += "    #if !defined(VKBIND_NO_GLOBAL_API)\n";
+    codeOut += globalCode;
+    codeOut += "    #endif\n";
+    codeOut += "        return NULL;\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += apiCode;
+    codeOut += "\n";
+    codeOut += "    return NULL;\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+struct vkbBuildEnumStringValue
+{
+    std::string name;
+    long long value;
+};
+
+bool vkbBuildCompareEnumStringValuesByValue(const vkbBuildEnumStringValue &a, const vkbBuildEnumStringValue &b)
+{
+    return a.value < b.value;
+}
+
+bool vkbBuildCompareEnumStringValuesByName(const vkbBuildEnumStringValue &a, const vkbBuildEnumStringValue &b)
+{
+    return a.name < b.name;
+}
+
+// Values that don't fit in 32 bits are split in two for the same reason as vkbBuildBitPosToHexStringEx().
+std::string vkbBuildEnumValueToInt64String(long long value)
+{
+    char buffer[128];
+    if (value >= -2147483647LL && value <= 2147483647LL) {
+        snprintf(buffer, sizeof(buffer), "%lld", value);
+    } else {
+        unsigned long long bits = (unsigned long long)value;
+        snprintf(buffer, sizeof(buffer), "(int64_t)(((uint64_t)0x%08x << 32) | 0x%08x)", (unsigned int)(bits >> 32), (unsigned int)(bits & 0xFFFFFFFF));
+    }
+
+    return buffer;
+}
+
+/*
+Outputs the tables used by vkbEnumToString() and friends. Each enum and bitmask that is output gets a list of values sorted by value
+for value to name lookups and a list of names, including aliases, sorted by name for name to value lookups. Both are found with a
+binary search, except for the leading run of consecutive values which is indexed directly. The values are output as literals rather
+than by name so none of this needs to be guarded by platform macros.
+
+When declarationsOnly is true, only the extern declarations of the per-enum info objects are output.
+*/
+VkbResult vkbBuildGenerateCode_C_EnumStrings(VkbBuild &context, vkbBuildCodeGenState &codegenState, bool declarationsOnly, std::string &codeOut)
+{
+    // Only enums that are actually output get a table.
+    std::vector<std::string> enumNames;
+    for (size_t iEnums = 0; iEnums < context.enums.size(); ++iEnums) {
+        vkbBuildEnums &enums = context.enums[iEnums];
+        if ((enums.type == "enum" || enums.type == "bitmask") && codegenState.HasOutputType(enums.name) && !vkbContains(enumNames, enums.name)) {
+            enumNames.push_back(enums.name);
+        }
+    }
+
+    if (declarationsOnly) {
+        for (size_t iEnum = 0; iEnum < enumNames.size(); ++iEnum) {
+            if (iEnum > 0) {
+                codeOut += "\n";
+            }
+            codeOut += "extern const VkbEnumInfo vkbEnumInfo_" + enumNames[iEnum] + ";";
+        }
+
+        return VKB_SUCCESS;
+    }
+
+    // Type names for vkbGetEnumInfo(). Bitmasks can be looked up by both their Flags and FlagBits names.
+    std::vector<vkbBuildEnumStringValue> typeNames;   // <-- value is the index into enumNames.
+
+    for (size_t iEnum = 0; iEnum < enumNames.size(); ++iEnum) {
+        const std::string &enumName = enumNames[iEnum];
+        bool isBitmask = false;
+
+        std::vector<std::string> valueNames;
+        std::vector<std::string> valueStrings;
+        vkbBuildGetEnumValues(context, enumName, valueNames, valueStrings);
+
+        std::vector<vkbBuildEnumStringValue> values;
+        for (size_t iValue = 0; iValue < valueNames.size(); ++iValue) {
+            vkbBuildEnumStringValue value;
+            value.name  = valueNames[iValue];
+            value.value = (long long)strtoull(valueStrings[iValue].c_str(), NULL, 0);
+            values.push_back(value);
+        }
+
+        // Aliases can be used for name to value lookups. They always refer to a value of the same enum.
+        std::vector<vkbBuildEnumStringValue> names = values;
+        std::vector<std::string> aliasNames;
+        std::vector<std::string> aliasTargets;
+
+        size_t iEnums;
+        if (vkbBuildFindEnumByName(context, enumName.c_str(), &iEnums)) {
+            isBitmask = context.enums[iEnums].type == "bitmask";
+            for (size_t iEnumValue = 0; iEnumValue < context.enums[iEnums].enums.size(); ++iEnumValue) {
+                const vkbBuildEnum &enumValue = context.enums[iEnums].enums[iEnumValue];
+                if (enumValue.alias != "" && !vkbContains(aliasNames, enumValue.name)) {
+                    aliasNames.push_back(enumValue.name);
+                    aliasTargets.push_back(enumValue.alias);
+                }
+            }
+        }
+
+        for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+            for (size_t iRequire = 0; iRequire < context.features[iFeature].requires.size(); ++iRequire) {
+                vkbBuildRequire &require = context.features[iFeature].requires[iRequire];
+                for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                    vkbBuildRequireEnum &requireEnum = require.enums[iRequireEnum];
+                    if (requireEnum.extends == enumName && requireEnum.alias != "" && !vkbContains(aliasNames, requireEnum.name)) {
+                        aliasNames.push_back(requireEnum.name);
+                        aliasTargets.push_back(requireEnum.alias);
+                    }
+                }
+            }
+        }
+
+        for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+            for (size_t iRequire = 0; iRequire < context.extensions[iExtension].requires.size(); ++iRequire) {
+                vkbBuildRequire &require = context.extensions[iExtension].requires[iRequire];
+                for (size_t iRequireEnum = 0; iRequireEnum < require.enums.size(); ++iRequireEnum) {
+                    vkbBuildRequireEnum &requireEnum = require.enums[iRequireEnum];
+                    if (requireEnum.extends == enumName && requireEnum.alias != "" && !vkbContains(aliasNames, requireEnum.name)) {
+                        aliasNames.push_back(requireEnum.name);
+                        aliasTargets.push_back(requireEnum.alias);
+                    }
+                }
+            }
+        }
+
+        for (size_t iAlias = 0; iAlias < aliasNames.size(); ++iAlias) {
+            // Aliases of aliases are resolved by following the chain.
+            std::string target = aliasTargets[iAlias];
+            for (size_t iDepth = 0; iDepth < aliasNames.size(); ++iDepth) {
+                std::vector<std::string>::iterator it = std::find(aliasNames.begin(), aliasNames.end(), target);
+                if (it == aliasNames.end()) {
+                    break;
+                }
+                target = aliasTargets[it - aliasNames.begin()];
+            }
+
+            for (size_t iValue = 0; iValue < values.size(); ++iValue) {
+                if (values[iValue].name == target) {
+                    vkbBuildEnumStringValue alias;
+                    alias.name  = aliasNames[iAlias];
+                    alias.value = values[iValue].value;
+                    names.push_back(alias);
+                    break;
+                }
+            }
+        }
+
+        std::stable_sort(values.begin(), values.end(), vkbBuildCompareEnumStringValuesByValue);
+        std::sort(names.begin(), names.end(), vkbBuildCompareEnumStringValuesByName);
+
+        // Values that share a value with an earlier one can only be found by name.
+        std::vector<vkbBuildEnumStringValue> uniqueValues;
+        for (size_t iValue = 0; iValue < values.size(); ++iValue) {
+            if (uniqueValues.size() == 0 || uniqueValues.back().value != values[iValue].value) {
+                uniqueValues.push_back(values[iValue]);
+            }
+        }
+
+        size_t denseCount = 0;
+        while (denseCount < uniqueValues.size() && uniqueValues[denseCount].value == uniqueValues[0].value + (long long)denseCount) {
+            denseCount += 1;
+        }
+
+        std::string valuesArray = "NULL";
+        std::string namesArray  = "NULL";
+
+        if (uniqueValues.size() > 0) {
+            valuesArray = "g_vkbEnumValues_" + enumName;
+            codeOut += "static const VkbEnumValue " + valuesArray + "[] = {\n";
+            for (size_t iValue = 0; iValue < uniqueValues.size(); ++iValue) {
+                codeOut += "    {\"" + uniqueValues[iValue].name + "\", " + vkbBuildEnumValueToInt64String(uniqueValues[iValue].value) + "}";
+                codeOut += (iValue + 1 < uniqueValues.size()) ? ",\n" : "\n";
+            }
+            codeOut += "};\n";
+        }
+
+        if (names.size() > 0) {
+            namesArray = "g_vkbEnumNames_" + enumName;
+            codeOut += "static const VkbEnumValue " + namesArray + "[] = {\n";
+            for (size_t iName = 0; iName < names.size(); ++iName) {
+                codeOut += "    {\"" + names[iName].name + "\", " + vkbBuildEnumValueToInt64String(names[iName].value) + "}";
+                codeOut += (iName + 1 < names.size()) ? ",\n" : "\n";
+            }
+            codeOut += "};\n";
+        }
+
+        codeOut += "const VkbEnumInfo vkbEnumInfo_" + enumName + " = {\"" + enumName + "\", " + (isBitmask ? "VK_TRUE" : "VK_FALSE") + ", ";
+        codeOut += valuesArray + ", " + std::to_string(uniqueValues.size()) + ", " + std::to_string(denseCount) + ", " + namesArray + ", " + std::to_string(names.size()) + "};\n";
+        codeOut += "\n";
+
+        vkbBuildEnumStringValue typeName;
+        typeName.name  = enumName;
+        typeName.value = (long long)iEnum;
+        typeNames.push_back(typeName);
+    }
+
+    for (size_t iType = 0; iType < context.types.size(); ++iType) {
+        vkbBuildType &type = context.types[iType];
+        if (type.category == "bitmask" && type.alias == "" && codegenState.HasOutputType(type.name)) {
+            const std::string &bitsName = (type.requires != "") ? type.requires : type.bitvalues;
+            std::vector<std::string>::iterator it = std::find(enumNames.begin(), enumNames.end(), bitsName);
+            if (it != enumNames.end()) {
+                vkbBuildEnumStringValue typeName;
+                typeName.name  = type.name;
+                typeName.value = (long long)(it - enumNames.begin());
+                typeNames.push_back(typeName);
+            }
+        }
+    }
+
+    std::sort(typeNames.begin(), typeNames.end(), vkbBuildCompareEnumStringValuesByName);
+
+    codeOut += "static const struct\n";
+    codeOut += "{\n";
+    codeOut += "    const char* pName;\n";
+    codeOut += "    const VkbEnumInfo* pInfo;\n";
+    codeOut += "} g_vkbEnumInfos[] = {\n";
+    for (size_t iType = 0; iType < typeNames.size(); ++iType) {
+        codeOut += "    {\"" + typeNames[iType].name + "\", &vkbEnumInfo_" + enumNames[(size_t)typeNames[iType].value] + "},\n";
+    }
+    codeOut += "    {NULL, NULL}    /* Terminator. Not included in the search. */\n";
+    codeOut += "};";
+
+    return VKB_SUCCESS;
+}
+
+enum vkbBuildDeepCopyKind
+{
+    VKB_DEEP_COPY_KIND_NONE,        // Nothing to do after copying the bytes.
+    VKB_DEEP_COPY_KIND_NEXT,        // Only the pNext chain needs to be copied. Done with vkbDeepCopyNext().
+    VKB_DEEP_COPY_KIND_FUNCTION     // Has pointers that need to be copied. Done with vkbDeepCopy_<Struct>().
+};
+
+enum vkbBuildDeepCopyShape
+{
+    VKB_DEEP_COPY_SHAPE_STRING,         // const char* pName (len="null-terminated")
+    VKB_DEEP_COPY_SHAPE_STRING_ARRAY,   // const char* const* ppNames (len="count,null-terminated")
+    VKB_DEEP_COPY_SHAPE_ARRAY,          // const T* pItems (len="count", or a single item when there's no len)
+    VKB_DEEP_COPY_SHAPE_POINTER_ARRAY,  // const T* const* ppItems (len="count,1")
+    VKB_DEEP_COPY_SHAPE_VALUE           // T item, where T is a struct that has pointers of its own.
+};
+
+struct vkbBuildDeepCopyPlan
+{
+    vkbBuildDeepCopyShape shape;
+    std::string count;              // A C expression. Empty for a single item.
+    std::string condition;          // A C expression which needs to be true for the member to be followed. Empty if it always is.
+    vkbBuildType* pElementStruct;   // The struct or union type of the elements, with aliases resolved. NULL for other types.
+    bool isVoid;
+};
+
+struct vkbBuildDeepCopyState
+{
+    VkbBuild* pVK;
+    VkbBuild* pVideo;
+    std::vector<std::string> kindNames;
+    std::vector<vkbBuildDeepCopyKind> kinds;
+    std::vector<std::string> remapKindNames;        // The same as kinds, but for whether or not a struct has handles to remap.
+    std::vector<vkbBuildDeepCopyKind> remapKinds;
+};
+
+// Finds a type in vk.xml or video.xml. Aliases are resolved.
+vkbBuildType* vkbBuildFindDeepCopyType(vkbBuildDeepCopyState &state, const std::string &typeName)
+{
+    VkbBuild* pContexts[2] = {state.pVK, state.pVideo};
+    for (size_t iContext = 0; iContext < 2; ++iContext) {
+        std::string name = typeName;
+        size_t iType;
+        for (size_t iDepth = 0; iDepth < pContexts[iContext]->types.size() && vkbBuildFindTypeByName(*pContexts[iContext], name.c_str(), &iType); ++iDepth) {
+            vkbBuildType &type = pContexts[iContext]->types[iType];
+            if (type.alias == "") {
+                return &type;
+            }
+            name = type.alias;
+        }
+    }
+
+    return NULL;
+}
+
+bool vkbBuildIsDeepCopyScalarType(const vkbBuildType* pType)
+{
+    if (pType == NULL) {
+        return false;
+    }
+
+    // Platform types like HWND and Display are deliberately not included. They're kept as is.
+    return pType->category == "basetype" || pType->category == "bitmask" || pType->category == "enum" || pType->category == "handle" || pType->requires == "vk_platform" || pType->requires == "stdint";
+}
+
+// Converts a len or altlen expression to C by prefixing the names of members with "pSrc->".
+std::string vkbBuildDeepCopyCountExpression(const vkbBuildStruct &structData, const std::string &len)
+{
+    std::string result;
+    for (size_t iChar = 0; iChar < len.size();) {
+        if (isalpha((unsigned char)len[iChar]) || len[iChar] == '_') {
+            size_t iEnd = iChar;
+            while (iEnd < len.size() && (isalnum((unsigned char)len[iEnd]) || len[iEnd] == '_')) {
+                iEnd += 1;
+            }
+
+            std::string identifier = len.substr(iChar, iEnd - iChar);
+            bool isMember = false;
+            if (result.size() < 2 || (result.substr(result.size() - 2) != "->" && result[result.size() - 1] != '.')) {
+                for (size_t iMember = 0; iMember < structData.members.size(); ++iMember) {
+                    if (structData.members[iMember].name == identifier) {
+                        isMember = true;
+                        break;
+                    }
+                }
+            }
+
+            result += (isMember ? "pSrc->" : "") + identifier;
+            iChar = iEnd;
+        } else {
+            result += len[iChar];
+            iChar += 1;
+        }
+    }
+
+    return result;
+}
+
+/*
+Retrieves the condition for following a member which the specification says is ignored in some cases. Applications are allowed to
+leave these pointing at garbage, so they can't be followed unconditionally. The conditions use the same "pSrc->" prefix as counts.
+The cases that depend on things outside of the struct, such as the attachments of a subpass, can't be detected and aren't listed.
+*/
+std::string vkbBuildGetDeepCopyCondition(const std::string &structName, const std::string &memberName)
+{
+    const char* conditions[][3] = {
+        {"VkDescriptorSetLayoutBinding", "pImmutableSamplers", "pSrc->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER || pSrc->descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER"},
+        {"VkWriteDescriptorSet",         "pImageInfo",         "!vkbIsBufferDescriptorType(pSrc->descriptorType) && !vkbIsTexelBufferDescriptorType(pSrc->descriptorType)"},
+        {"VkWriteDescriptorSet",         "pBufferInfo",        "vkbIsBufferDescriptorType(pSrc->descriptorType)"},
+        {"VkWriteDescriptorSet",         "pTexelBufferView",   "vkbIsTexelBufferDescriptorType(pSrc->descriptorType)"},
+        {"VkGraphicsPipelineCreateInfo", "pTessellationState", "vkbHasShaderStage(pSrc->pStages, pSrc->stageCount, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT)"},
+        {"VkGraphicsPipelineCreateInfo", "pViewportState",     "!vkbIsRasterizationDisabled(pSrc->pRasterizationState, pSrc->pDynamicState)"},
+        {"VkGraphicsPipelineCreateInfo", "pMultisampleState",  "!vkbIsRasterizationDisabled(pSrc->pRasterizationState, pSrc->pDynamicState)"},
+        {"VkGraphicsPipelineCreateInfo", "pDepthStencilState", "!vkbIsRasterizationDisabled(pSrc->pRasterizationState, pSrc->pDynamicState)"},
+        {"VkGraphicsPipelineCreateInfo", "pColorBlendState",   "!vkbIsRasterizationDisabled(pSrc->pRasterizationState, pSrc->pDynamicState)"}
+    };
+
+    for (size_t iCondition = 0; iCondition < sizeof(conditions) / sizeof(conditions[0]); ++iCondition) {
+        if (structName == conditions[iCondition][0] && memberName == conditions[iCondition][1]) {
+            return conditions[iCondition][2];
+        }
+    }
+
+    return "";
+}
+
+vkbBuildDeepCopyKind vkbBuildGetDeepCopyKind(vkbBuildDeepCopyState &state, vkbBuildType &type);
+
+/*
+Returns false if the member doesn't need to be copied, or can't be. Members that can't be copied keep pointing to the original data.
+structName is used for looking up the condition for following the member and is empty for the arguments of commands.
+*/
+bool vkbBuildGetDeepCopyPlan(vkbBuildDeepCopyState &state, const std::string &structName, const vkbBuildStruct &structData, const vkbBuildStructMember &member, vkbBuildDeepCopyPlan &planOut)
+{
+    if (member.name == "pNext") {
+        return false;   // The pNext chain is handled separately.
+    }
+
+    size_t pointerCount = std::count(member.typeC.begin(), member.typeC.end(), '*');
+    std::vector<std::string> lens = vkbSplitString(member.len, ",");
+    std::string count;
+    if (lens.size() > 0 && lens[0] != "null-terminated") {
+        if (lens[0].find("latexmath") == 0) {
+            if (member.altlen == "") {
+                return false;
+            }
+            count = vkbBuildDeepCopyCountExpression(structData, member.altlen);
+        } else {
+            count = vkbBuildDeepCopyCountExpression(structData, lens[0]);
+        }
+    }
+
+    vkbBuildType* pElementType = vkbBuildFindDeepCopyType(state, member.type);
+    bool isStruct = pElementType != NULL && (pElementType->category == "struct" || pElementType->category == "union");
+
+    planOut.count = count;
+    planOut.condition = vkbBuildGetDeepCopyCondition(structName, member.name);
+    planOut.pElementStruct = isStruct ? pElementType : NULL;
+    planOut.isVoid = member.type == "void";
+
+    if (pointerCount == 0) {
+        if (isStruct && pElementType->category == "struct" && member.nameC.find('[') == std::string::npos && vkbBuildGetDeepCopyKind(state, *pElementType) != VKB_DEEP_COPY_KIND_NONE) {
+            planOut.shape = VKB_DEEP_COPY_SHAPE_VALUE;
+            return true;
+        }
+        return false;
+    }
+
+    if (pointerCount == 1) {
+        if (member.type == "char" && lens.size() > 0 && lens[0] == "null-terminated") {
+            planOut.shape = VKB_DEEP_COPY_SHAPE_STRING;
+            return true;
+        }
+
+        // Pointers to anything other than a struct need a length. Without one there's no way to know how much to copy.
+        if (isStruct || (count != "" && (planOut.isVoid || vkbBuildIsDeepCopyScalarType(pElementType)))) {
+            planOut.shape = VKB_DEEP_COPY_SHAPE_ARRAY;
+            return true;
+        }
+        return false;
+    }
+
+    if (pointerCount == 2 && lens.size() == 2 && count != "") {
+        if (member.type == "char" && lens[1] == "null-terminated") {
+            planOut.shape = VKB_DEEP_COPY_SHAPE_STRING_ARRAY;
+            return true;
+        }
+        if (lens[1] == "1" && (isStruct || vkbBuildIsDeepCopyScalarType(pElementType))) {
+            planOut.shape = VKB_DEEP_COPY_SHAPE_POINTER_ARRAY;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+vkbBuildDeepCopyKind vkbBuildGetDeepCopyKind(vkbBuildDeepCopyState &state, vkbBuildType &type)
+{
+    if (type.category != "struct") {
+        return VKB_DEEP_COPY_KIND_NONE;   // Unions are copied as is because there's no way to know which member is active.
+    }
+
+    for (size_t iKind = 0; iKind < state.kindNames.size(); ++iKind) {
+        if (state.kindNames[iKind] == type.name) {
+            return state.kinds[iKind];
+        }
+    }
+
+    vkbBuildDeepCopyKind kind = VKB_DEEP_COPY_KIND_NONE;
+    for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+        const vkbBuildStructMember &member = type.structData.members[iMember];
+        vkbBuildDeepCopyPlan plan;
+        if (vkbBuildGetDeepCopyPlan(state, type.name, type.structData, member, plan)) {
+            kind = VKB_DEEP_COPY_KIND_FUNCTION;
+            break;
+        }
+        if (member.name == "pNext") {
+            kind = VKB_DEEP_COPY_KIND_NEXT;
+        }
+    }
+
+    state.kindNames.push_back(type.name);
+    state.kinds.push_back(kind);
+
+    return kind;
+}
+
+// The code for finishing the copy of a single element after its bytes have been copied. Empty if there's nothing to do.
+std::string vkbBuildDeepCopyElementCode(vkbBuildDeepCopyState &state, vkbBuildType* pElementStruct, const std::string &src, const std::string &dst)
+{
+    if (pElementStruct == NULL) {
+        return "";
+    }
+
+    vkbBuildDeepCopyKind kind = vkbBuildGetDeepCopyKind(state, *pElementStruct);
+    if (kind == VKB_DEEP_COPY_KIND_FUNCTION) {
+        return "vkbDeepCopy_" + pElementStruct->name + "(pArena, " + src + ", " + dst + ");";
+    }
+    if (kind == VKB_DEEP_COPY_KIND_NEXT) {
+        return "vkbDeepCopyNext(pArena, " + src + ", " + dst + ");";
+    }
+
+    return "";
+}
+
+std::string vkbBuildGenerateCode_C_DeepCopyMember(vkbBuildDeepCopyState &state, const vkbBuildStructMember &member, const vkbBuildDeepCopyPlan &plan)
+{
+    std::string code;
+    std::string src = "pSrc->" + member.name;
+    std::string elementType = plan.isVoid ? "void" : member.type;
+    std::string condition = src + " != NULL";
+    if (plan.count != "") {
+        condition += " && (" + plan.count + ") > 0";
+    }
+    if (plan.condition != "") {
+        condition += " && (" + plan.condition + ")";
+    }
+
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_VALUE) {
+        return "    " + vkbBuildDeepCopyElementCode(state, plan.pElementStruct, "&" + src, "(pDst != NULL) ? &pDst->" + member.name + " : NULL") + "\n";
+    }
+
+    code += "    if (" + condition + ") {\n";
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_STRING) {
+        code += "        char* pCopy = vkbDeepCopyString(pArena, " + src + ");\n";
+    }
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_STRING_ARRAY) {
+        code += "        char** pCopy = (char**)vkbDeepCopyAlloc(pArena, sizeof(char*) * (size_t)(" + plan.count + "));\n";
+        code += "        size_t i;\n";
+        code += "        for (i = 0; i < (size_t)(" + plan.count + "); ++i) {\n";
+        code += "            char* pString = vkbDeepCopyString(pArena, " + src + "[i]);\n";
+        code += "            if (pCopy != NULL) {\n";
+        code += "                pCopy[i] = pString;\n";
+        code += "            }\n";
+        code += "        }\n";
+    }
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_ARRAY) {
+        std::string elementCode;
+        std::string size = "sizeof(" + elementType + ")";
+        if (plan.count != "") {
+            size = plan.isVoid ? "(size_t)(" + plan.count + ")" : size + " * (size_t)(" + plan.count + ")";
+            elementCode = vkbBuildDeepCopyElementCode(state, plan.pElementStruct, "&" + src + "[i]", "(pCopy != NULL) ? &pCopy[i] : NULL");
+        } else {
+            elementCode = vkbBuildDeepCopyElementCode(state, plan.pElementStruct, src, "pCopy");
+        }
+
+        code += "        " + elementType + "* pCopy = (" + elementType + "*)vkbDeepCopyBytes(pArena, " + src + ", " + size + ");\n";
+        if (elementCode != "") {
+            if (plan.count != "") {
+                code += "        size_t i;\n";
+                code += "        for (i = 0; i < (size_t)(" + plan.count + "); ++i) {\n";
+                code += "            " + elementCode + "\n";
+                code += "        }\n";
+            } else {
+                code += "        " + elementCode + "\n";
+            }
+        }
+    }
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_POINTER_ARRAY) {
+        std::string elementCode = vkbBuildDeepCopyElementCode(state, plan.pElementStruct, src + "[i]", "pElement");
+
+        code += "        " + elementType + "** pCopy = (" + elementType + "**)vkbDeepCopyAlloc(pArena, sizeof(" + elementType + "*) * (size_t)(" + plan.count + "));\n";
+        code += "        size_t i;\n";
+        code += "        for (i = 0; i < (size_t)(" + plan.count + "); ++i) {\n";
+        code += "            " + elementType + "* pElement = NULL;\n";
+        code += "            if (" + src + "[i] != NULL) {\n";
+        code += "                pElement = (" + elementType + "*)vkbDeepCopyBytes(pArena, " + src + "[i], sizeof(" + elementType + "));\n";
+        if (elementCode != "") {
+            code += "                " + elementCode + "\n";
+        }
+        code += "            }\n";
+        code += "            if (pCopy != NULL) {\n";
+        code += "                pCopy[i] = pElement;\n";
+        code += "            }\n";
+        code += "        }\n";
+    }
+    code += "        if (pDst != NULL) {\n";
+    code += "            pDst->" + member.name + " = (" + member.typeC + ")pCopy;\n";
+    code += "        }\n";
+    // Empty arrays and members that are ignored can point anywhere so the copy can't keep pointing to the original data.
+    code += "    } else if (pDst != NULL) {\n";
+    code += "        pDst->" + member.name + " = NULL;\n";
+    code += "    }\n";
+
+    return code;
+}
+
+/*
+Outputs the functions used by vkbDeepCopy(). Each struct with pointers to copy gets a vkbDeepCopy_<Struct>() function which is called
+after the bytes of the struct have been copied. It copies everything the struct points to into the arena and points the copy at it.
+When measuring, pDst is NULL and nothing is written. Structs whose only pointer is pNext use vkbDeepCopyNext() instead, and structs
+without pointers only need their bytes copied. The pNext chain is followed with vkbDeepCopyChain() which dispatches on sType with
+vkbDeepCopyStruct().
+
+The video std structs are included so the std pictures and parameter sets referenced by the video extensions are copied too.
+*/
+VkbResult vkbBuildGenerateCode_C_DeepCopy(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, vkbBuildCodeGenState &videoCodegenState, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<vkbBuildType*> functionTypes;
+    std::vector<std::string> functionProtects;
+    VkbBuild* pContexts[2] = {&vk, &video};
+    for (size_t iContext = 0; iContext < 2; ++iContext) {
+        VkbBuild &context = *pContexts[iContext];
+        for (size_t iType = 0; iType < context.types.size(); ++iType) {
+            vkbBuildType &type = context.types[iType];
+            if (type.category != "struct" || type.alias != "") {
+                continue;
+            }
+
+            if (iContext == 0) {
+                if (!codegenState.HasOutputType(type.name)) {
+                    continue;
+                }
+            } else {
+                if (!videoCodegenState.HasOutputType(type.name)) {
+                    continue;
+                }
+            }
+
+            if (vkbBuildGetDeepCopyKind(state, type) == VKB_DEEP_COPY_KIND_FUNCTION) {
+                functionTypes.push_back(&type);
+                functionProtects.push_back((iContext == 0) ? vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(type.name)) : "VKBIND_ENABLE_VIDEO");
+            }
+        }
+    }
+
+    std::string currentProtect;
+
+    // Prototypes first because structs can point to each other.
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        const std::string &name = functionTypes[iFunction]->name;
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], "static void vkbDeepCopy_" + name + "(VkbDeepCopyArena* pArena, const " + name + "* pSrc, " + name + "* pDst);\n", currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "\n", currentProtect, codeOut);
+
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        vkbBuildType &type = *functionTypes[iFunction];
+        std::string function;
+
+        function += "static void vkbDeepCopy_" + type.name + "(VkbDeepCopyArena* pArena, const " + type.name + "* pSrc, " + type.name + "* pDst)\n";
+        function += "{\n";
+        for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = type.structData.members[iMember];
+            vkbBuildDeepCopyPlan plan;
+            if (member.name == "pNext") {
+                function += "    vkbDeepCopyNext(pArena, pSrc, pDst);\n";
+            } else if (vkbBuildGetDeepCopyPlan(state, type.name, type.structData, member, plan)) {
+                function += vkbBuildGenerateCode_C_DeepCopyMember(state, member, plan);
+            }
+        }
+        function += "}\n";
+        function += "\n";
+
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], function, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // Dispatching for pNext chains. Only structs with an sType can be in a chain.
+    std::vector<std::string> caseValues;
+    codeOut += "static void vkbDeepCopyStruct(VkbDeepCopyArena* pArena, const VkbBaseStructure* pSrc, void* pDst)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (pSrc->sType)\n";
+    codeOut += "    {\n";
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        const std::string &name = functionTypes[iFunction]->name;
+        std::string value = vkbBuildGetStructTypeValue(vk, name, NULL);
+        if (value == "" || vkbContains(caseValues, value)) {
+            continue;
+        }
+        caseValues.push_back(value);
+
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], "        case " + value + ": vkbDeepCopy_" + name + "(pArena, (const " + name + "*)pSrc, (" + name + "*)pDst); break;\n", currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: vkbDeepCopyNext(pArena, pSrc, pDst); break;\n";
+    codeOut += "    }\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+// Collects the structs that get vkbHash_<Struct>() and vkbEqual_<Struct>() along with the macro each one needs to be guarded with.
+VkbResult vkbBuildGetHashStructs(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &vkCodegenState, vkbBuildCodeGenState &videoCodegenState, std::vector<vkbBuildType*> &typesOut, std::vector<std::string> &protectsOut, std::vector<vkbBuildType*> &aliasesOut, std::vector<std::string> &aliasProtectsOut)
+{
+    VkbBuild* pContexts[2] = {&vk, &video};
+    vkbBuildCodeGenState* pCodegenStates[2] = {&vkCodegenState, &videoCodegenState};
+
+    for (size_t iContext = 0; iContext < 2; ++iContext) {
+        VkbBuild &context = *pContexts[iContext];
+        vkbBuildCodeGenState &codegenState = *pCodegenStates[iContext];
+
+        for (size_t iType = 0; iType < context.types.size(); ++iType) {
+            vkbBuildType &type = context.types[iType];
+            if (type.category != "struct" || !codegenState.HasOutputType(type.name)) {
+                continue;
+            }
+
+            std::string protect = (iContext == 0) ? vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(type.name)) : "VKBIND_ENABLE_VIDEO";
+            if (type.alias == "") {
+                typesOut.push_back(&type);
+                protectsOut.push_back(protect);
+            } else {
+                aliasesOut.push_back(&type);
+                aliasProtectsOut.push_back(protect);
+            }
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
+/*
+Outputs the hashing and comparison of a single member. The members with pointers are classified the same way as for deep copying so
+the two always agree on what is followed. Pointers that aren't followed are opaque, such as pUserData, and are ignored.
+*/
+void vkbBuildGenerateCode_C_HashMember(vkbBuildDeepCopyState &state, const std::string &structName, const vkbBuildStruct &structData, const vkbBuildStructMember &member, std::string &hashOut, std::string &equalOut, bool &usesLoopOut)
+{
+    std::string a = "pA->" + member.name;
+    std::string b = "pB->" + member.name;
+    std::string m = "pStruct->" + member.name;
+
+    if (member.name == "pNext") {
+        hashOut  += "    h = vkbHashU64(h, vkbHash(" + m + "));\n";
+        equalOut += "    if (!vkbEqual(" + a + ", " + b + ")) {\n";
+        equalOut += "        return VK_FALSE;\n";
+        equalOut += "    }\n";
+        return;
+    }
+
+    size_t pointerCount = std::count(member.typeC.begin(), member.typeC.end(), '*');
+    vkbBuildType* pElementType = vkbBuildFindDeepCopyType(state, member.type);
+    bool isStruct = pElementType != NULL && pElementType->category == "struct";
+
+    if (pointerCount == 0) {
+        size_t arrayCount = std::count(member.nameC.begin(), member.nameC.end(), '[');
+        if (member.nameC.find(':') != std::string::npos) {
+            // Bit fields don't have an address.
+            hashOut  += "    h = vkbHashU64(h, (uint64_t)" + m + ");\n";
+            equalOut += "    if (" + a + " != " + b + ") {\n";
+            equalOut += "        return VK_FALSE;\n";
+            equalOut += "    }\n";
+        } else if (isStruct && arrayCount == 0) {
+            // Structs are done member by member so padding isn't included.
+            hashOut  += "    h = vkbHashU64(h, vkbHash_" + pElementType->name + "(&" + m + "));\n";
+            equalOut += "    if (!vkbEqual_" + pElementType->name + "(&" + a + ", &" + b + ")) {\n";
+            equalOut += "        return VK_FALSE;\n";
+            equalOut += "    }\n";
+        } else if (isStruct && arrayCount == 1) {
+            usesLoopOut = true;
+            hashOut  += "    for (i = 0; i < sizeof(" + m + ")/sizeof(" + m + "[0]); ++i) {\n";
+            hashOut  += "        h = vkbHashU64(h, vkbHash_" + pElementType->name + "(&" + m + "[i]));\n";
+            hashOut  += "    }\n";
+            equalOut += "    for (i = 0; i < sizeof(" + a + ")/sizeof(" + a + "[0]); ++i) {\n";
+            equalOut += "        if (!vkbEqual_" + pElementType->name + "(&" + a + "[i], &" + b + "[i])) {\n";
+            equalOut += "            return VK_FALSE;\n";
+            equalOut += "        }\n";
+            equalOut += "    }\n";
+        } else {
+            hashOut  += "    h = vkbHashBytes(h, &" + m + ", sizeof(" + m + "));\n";
+            equalOut += "    if (memcmp(&" + a + ", &" + b + ", sizeof(" + a + ")) != 0) {\n";
+            equalOut += "        return VK_FALSE;\n";
+            equalOut += "    }\n";
+        }
+        return;
+    }
+
+    vkbBuildDeepCopyPlan plan;
+    if (!vkbBuildGetDeepCopyPlan(state, structName, structData, member, plan)) {
+        return; // Opaque.
+    }
+
+    std::string countM = vkbReplaceAll(plan.count, "pSrc->", "pStruct->");
+    std::string countA = vkbReplaceAll(plan.count, "pSrc->", "pA->");
+    std::string countB = vkbReplaceAll(plan.count, "pSrc->", "pB->");
+    std::string elementType = plan.isVoid ? "void" : member.type;
+
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_STRING) {
+        hashOut  += "    h = vkbHashString(h, " + m + ");\n";
+        equalOut += "    if (!vkbEqualString(" + a + ", " + b + ")) {\n";
+        equalOut += "        return VK_FALSE;\n";
+        equalOut += "    }\n";
+        return;
+    }
+
+    // Arrays are only looked at when they're present, which is the same condition used for deep copying.
+    std::string presentM = m + " != NULL";
+    std::string presentA = a + " != NULL";
+    std::string presentB = b + " != NULL";
+    if (plan.count != "") {
+        presentM += " && (" + countM + ") > 0";
+        presentA += " && (" + countA + ") > 0";
+        presentB += " && (" + countB + ") > 0";
+    }
+    if (plan.condition != "") {
+        presentM += " && (" + vkbReplaceAll(plan.condition, "pSrc->", "pStruct->") + ")";
+        presentA += " && (" + vkbReplaceAll(plan.condition, "pSrc->", "pA->") + ")";
+        presentB += " && (" + vkbReplaceAll(plan.condition, "pSrc->", "pB->") + ")";
+    }
+
+    std::string hashElements;
+    std::string equalElements;
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_STRING_ARRAY) {
+        usesLoopOut = true;
+        hashElements  += "        for (i = 0; i < (size_t)(" + countM + "); ++i) {\n";
+        hashElements  += "            h = vkbHashString(h, " + m + "[i]);\n";
+        hashElements  += "        }\n";
+        equalElements += "        for (i = 0; i < (size_t)(" + countA + "); ++i) {\n";
+        equalElements += "            if (!vkbEqualString(" + a + "[i], " + b + "[i])) {\n";
+        equalElements += "                return VK_FALSE;\n";
+        equalElements += "            }\n";
+        equalElements += "        }\n";
+    }
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_ARRAY) {
+        bool isElementStruct = plan.pElementStruct != NULL && plan.pElementStruct->category == "struct";
+        if (isElementStruct && plan.count != "") {
+            usesLoopOut = true;
+            hashElements  += "        for (i = 0; i < (size_t)(" + countM + "); ++i) {\n";
+            hashElements  += "            h = vkbHashU64(h, vkbHash_" + plan.pElementStruct->name + "(&" + m + "[i]));\n";
+            hashElements  += "        }\n";
+            equalElements += "        for (i = 0; i < (size_t)(" + countA + "); ++i) {\n";
+            equalElements += "            if (!vkbEqual_" + plan.pElementStruct->name + "(&" + a + "[i], &" + b + "[i])) {\n";
+            equalElements += "                return VK_FALSE;\n";
+            equalElements += "            }\n";
+            equalElements += "        }\n";
+        } else if (isElementStruct) {
+            hashElements  += "        h = vkbHashU64(h, vkbHash_" + plan.pElementStruct->name + "(" + m + "));\n";
+            equalElements += "        if (!vkbEqual_" + plan.pElementStruct->name + "(" + a + ", " + b + ")) {\n";
+            equalElements += "            return VK_FALSE;\n";
+            equalElements += "        }\n";
+        } else {
+            std::string sizeM = "sizeof(" + elementType + ")";
+            std::string sizeA = sizeM;
+            if (plan.count != "") {
+                sizeM = plan.isVoid ? "(size_t)(" + countM + ")" : sizeM + " * (size_t)(" + countM + ")";
+                sizeA = plan.isVoid ? "(size_t)(" + countA + ")" : sizeA + " * (size_t)(" + countA + ")";
+            }
+            hashElements  += "        h = vkbHashBytes(h, " + m + ", " + sizeM + ");\n";
+            equalElements += "        if (memcmp(" + a + ", " + b + ", " + sizeA + ") != 0) {\n";
+            equalElements += "            return VK_FALSE;\n";
+            equalElements += "        }\n";
+        }
+    }
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_POINTER_ARRAY) {
+        bool isElementStruct = plan.pElementStruct != NULL && plan.pElementStruct->category == "struct";
+        std::string hashElement  = isElementStruct ? "vkbHash_" + plan.pElementStruct->name + "(" + m + "[i])" : "vkbHashBytes(VKB_HASH_SEED, " + m + "[i], sizeof(" + elementType + "))";
+        std::string equalElement = isElementStruct ? "vkbEqual_" + plan.pElementStruct->name + "(" + a + "[i], " + b + "[i])" : "memcmp(" + a + "[i], " + b + "[i], sizeof(" + elementType + ")) == 0";
+
+        usesLoopOut = true;
+        hashElements  += "        for (i = 0; i < (size_t)(" + countM + "); ++i) {\n";
+        hashElements  += "            h = vkbHashU64(h, (" + m + "[i] != NULL) ? " + hashElement + " : 0);\n";
+        hashElements  += "        }\n";
+        equalElements += "        for (i = 0; i < (size_t)(" + countA + "); ++i) {\n";
+        equalElements += "            if ((" + a + "[i] != NULL) != (" + b + "[i] != NULL)) {\n";
+        equalElements += "                return VK_FALSE;\n";
+        equalElements += "            }\n";
+        equalElements += "            if (" + a + "[i] != NULL && !(" + equalElement + ")) {\n";
+        equalElements += "                return VK_FALSE;\n";
+        equalElements += "            }\n";
+        equalElements += "        }\n";
+    }
+
+    hashOut += "    if (" + presentM + ") {\n";
+    hashOut += "        h = vkbHashU64(h, 1);\n";
+    hashOut += hashElements;
+    hashOut += "    } else {\n";
+    hashOut += "        h = vkbHashU64(h, 0);\n";
+    hashOut += "    }\n";
+
+    equalOut += "    if ((" + presentA + ") != (" + presentB + ")) {\n";
+    equalOut += "        return VK_FALSE;\n";
+    equalOut += "    }\n";
+    equalOut += "    if (" + presentA + ") {\n";
+    if (plan.count != "") {
+        equalOut += "        if ((" + countA + ") != (" + countB + ")) {\n";
+        equalOut += "            return VK_FALSE;\n";
+        equalOut += "        }\n";
+    }
+    equalOut += equalElements;
+    equalOut += "    }\n";
+}
+
+/*
+Outputs vkbHash_<Struct>() and vkbEqual_<Struct>() for every struct, and vkbHash() and vkbEqual() which dispatch on sType. When
+declarationsOnly is true, only the declarations are output. Aliases of structs are output as #defines of the functions.
+*/
+VkbResult vkbBuildGenerateCode_C_Hash(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, vkbBuildCodeGenState &videoCodegenState, bool declarationsOnly, std::string &codeOut)
+{
+    std::vector<vkbBuildType*> types;
+    std::vector<std::string> protects;
+    std::vector<vkbBuildType*> aliases;
+    std::vector<std::string> aliasProtects;
+    std::string currentProtect;
+
+    VkbResult result = vkbBuildGetHashStructs(vk, video, codegenState, videoCodegenState, types, protects, aliases, aliasProtects);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    if (declarationsOnly) {
+        for (size_t iType = 0; iType < types.size(); ++iType) {
+            const std::string &name = types[iType]->name;
+            std::string declaration;
+            declaration += "uint64_t vkbHash_" + name + "(const " + name + "* pStruct);\n";
+            declaration += "VkBool32 vkbEqual_" + name + "(const " + name + "* pA, const " + name + "* pB);\n";
+            vkbBuildAppendGuardedLine(protects[iType], declaration, currentProtect, codeOut);
+        }
+        for (size_t iAlias = 0; iAlias < aliases.size(); ++iAlias) {
+            const std::string &name   = aliases[iAlias]->name;
+            const std::string &target = aliases[iAlias]->alias;
+            std::string declaration;
+            declaration += "#define vkbHash_" + name + " vkbHash_" + target + "\n";
+            declaration += "#define vkbEqual_" + name + " vkbEqual_" + target + "\n";
+            vkbBuildAppendGuardedLine(aliasProtects[iAlias], declaration, currentProtect, codeOut);
+        }
+        vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+        return VKB_SUCCESS;
+    }
+
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    for (size_t iType = 0; iType < types.size(); ++iType) {
+        vkbBuildType &type = *types[iType];
+        std::string hashCode;
+        std::string equalCode;
+        bool usesLoop = false;
+
+        for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+            vkbBuildGenerateCode_C_HashMember(state, type.name, type.structData, type.structData.members[iMember], hashCode, equalCode, usesLoop);
+        }
+
+        // Structs with only opaque members, such as VkAllocationCallbacks without the function pointers, have nothing to look at.
+        if (hashCode == "") {
+            hashCode  = "    (void)pStruct;\n";
+            equalCode = "    (void)pA;\n    (void)pB;\n";
+        }
+
+        std::string function;
+        function += "uint64_t vkbHash_" + type.name + "(const " + type.name + "* pStruct)\n";
+        function += "{\n";
+        function += "    uint64_t h = VKB_HASH_SEED;\n";
+        if (usesLoop) {
+            function += "    size_t i;\n";
+        }
+        function += hashCode;
+        function += "    return h;\n";
+        function += "}\n";
+        function += "\n";
+        function += "VkBool32 vkbEqual_" + type.name + "(const " + type.name + "* pA, const " + type.name + "* pB)\n";
+        function += "{\n";
+        if (usesLoop) {
+            function += "    size_t i;\n";
+        }
+        function += equalCode;
+        function += "    return VK_TRUE;\n";
+        function += "}\n";
+        function += "\n";
+
+        vkbBuildAppendGuardedLine(protects[iType], function, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // Dispatching on sType. Used for pNext chains.
+    std::vector<std::string> caseValues;
+    std::string hashCases;
+    std::string equalCases;
+    for (size_t iType = 0; iType < types.size(); ++iType) {
+        const std::string &name = types[iType]->name;
+        std::string value = vkbBuildGetStructTypeValue(vk, name, NULL);
+        if (value == "" || vkbContains(caseValues, value)) {
+            continue;
+        }
+        caseValues.push_back(value);
+
+        vkbBuildAppendGuardedLine(protects[iType], "        case " + value + ": return vkbHash_" + name + "((const " + name + "*)pStruct);\n", currentProtect, hashCases);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, hashCases);
+
+    caseValues.clear();
+    for (size_t iType = 0; iType < types.size(); ++iType) {
+        const std::string &name = types[iType]->name;
+        std::string value = vkbBuildGetStructTypeValue(vk, name, NULL);
+        if (value == "" || vkbContains(caseValues, value)) {
+            continue;
+        }
+        caseValues.push_back(value);
+
+        vkbBuildAppendGuardedLine(protects[iType], "        case " + value + ": return vkbEqual_" + name + "((const " + name + "*)pA, (const " + name + "*)pB);\n", currentProtect, equalCases);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, equalCases);
+
+    codeOut += "uint64_t vkbHash(const void* pStruct)\n";
+    codeOut += "{\n";
+    codeOut += "    if (pStruct == NULL) {\n";
+    codeOut += "        return VKB_HASH_SEED;\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    switch (((const VkbBaseStructure*)pStruct)->sType)\n";
+    codeOut += "    {\n";
+    codeOut += hashCases;
+    codeOut += "        default: break;\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    /* The contents of unknown structures can't be hashed. They're only equal to themselves. See vkbEqual(). */\n";
+    codeOut += "    return vkbHashU64(VKB_HASH_SEED, (uint64_t)((const VkbBaseStructure*)pStruct)->sType);\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+    codeOut += "VkBool32 vkbEqual(const void* pA, const void* pB)\n";
+    codeOut += "{\n";
+    codeOut += "    if (pA == pB) {\n";
+    codeOut += "        return VK_TRUE;\n";
+    codeOut += "    }\n";
+    codeOut += "    if (pA == NULL || pB == NULL || ((const VkbBaseStructure*)pA)->sType != ((const VkbBaseStructure*)pB)->sType) {\n";
+    codeOut += "        return VK_FALSE;\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    switch (((const VkbBaseStructure*)pA)->sType)\n";
+    codeOut += "    {\n";
+    codeOut += equalCases;
+    codeOut += "        default: break;\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    return VK_FALSE;\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+/*
+Checks whether or not a command creates one of the immutable object types that can be shared through a VkbObjectCache. These are
+fully described by their create info so two objects created from equal create infos are interchangeable. The command needs to have
+the usual (device, pCreateInfo, pAllocator, pObject) signature and there needs to be a matching vkDestroy* command.
+*/
+bool vkbBuildIsObjectCacheCommand(VkbBuild &context, vkbBuildCodeGenState &codegenState, const vkbBuildCommand &command, size_t* pDestroyIndexOut)
+{
+    const char* handleTypes[] = {
+        "VkSampler",
+        "VkDescriptorSetLayout",
+        "VkPipelineLayout",
+        "VkRenderPass"
+    };
+
+    if (command.alias != "" || command.name.find("vkCreate") != 0 || command.parameters.size() != 4 || !codegenState.HasOutputCommand(command.name)) {
+        return false;
+    }
+
+    const vkbBuildFunctionParameter &handleParam = command.parameters[3];
+    if (command.parameters[0].type != "VkDevice" || command.parameters[1].typeC.find("const") != 0 || command.parameters[2].type != "VkAllocationCallbacks" || handleParam.typeC != handleParam.type + "*") {
+        return false;
+    }
+
+    bool isCacheable = false;
+    for (size_t iHandleType = 0; iHandleType < sizeof(handleTypes) / sizeof(handleTypes[0]); ++iHandleType) {
+        if (handleParam.type == handleTypes[iHandleType]) {
+            isCacheable = true;
+            break;
+        }
+    }
+
+    if (!isCacheable) {
+        return false;
+    }
+
+    std::string destroyName = "vkDestroy" + handleParam.type.substr(2);
+    if (!vkbBuildFindCommandByName(context, destroyName.c_str(), pDestroyIndexOut) || !codegenState.HasOutputCommand(destroyName)) {
+        return false;
+    }
+
+    return context.commands[*pDestroyIndexOut].parameters.size() == 3;
+}
+
+VkbResult vkbBuildGenerateCode_C_ObjectCache(VkbBuild &context, vkbBuildCodeGenState &codegenState, bool declarationsOnly, std::string &codeOut)
+{
+    std::vector<std::string> releasedTypes;
+    std::string currentProtect;
+
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+
+        size_t iDestroyCommand;
+        if (!vkbBuildIsObjectCacheCommand(context, codegenState, command, &iDestroyCommand)) {
+            continue;
+        }
+
+        const vkbBuildCommand &destroyCommand = context.commands[iDestroyCommand];
+        const std::string &createInfoType = command.parameters[1].type;
+        const std::string &handleType     = command.parameters[3].type;
+        const std::string &handleName     = command.parameters[3].name;
+        const std::string &objectName     = destroyCommand.parameters[1].name;
+        std::string createName  = "vkbCreateShared" + command.name.substr(8);
+        std::string releaseName = "vkbReleaseShared" + handleType.substr(2);
+        std::string protect        = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(command.name));
+        std::string destroyProtect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(destroyCommand.name));
+
+        // Every create command of a type is released the same way, such as vkCreateRenderPass and vkCreateRenderPass2.
+        bool isFirstOfType = !vkbContains(releasedTypes, handleType);
+        if (isFirstOfType) {
+            releasedTypes.push_back(handleType);
+        }
+
+        if (declarationsOnly) {
+            vkbBuildAppendGuardedLine(protect, "VkResult " + createName + "(VkbObjectCache* pCache, const " + createInfoType + "* pCreateInfo, " + handleType + "* " + handleName + ");\n", currentProtect, codeOut);
+            if (isFirstOfType) {
+                vkbBuildAppendGuardedLine(destroyProtect, "void " + releaseName + "(VkbObjectCache* pCache, " + handleType + " " + objectName + ");\n", currentProtect, codeOut);
+            }
+            continue;
+        }
+
+        std::string destroyProcName = "vkbObjectCacheDestroy_" + handleType;
+        std::string createProcName  = "vkbObjectCacheCreate_" + command.name;
+
+        if (isFirstOfType) {
+            std::string code;
+            code += "static void " + destroyProcName + "(VkbObjectCache* pCache, uint64_t handle)\n";
+            code += "{\n";
+            code += "    " + handleType + " " + objectName + ";\n";
+            code += "    memcpy(&" + objectName + ", &handle, sizeof(" + objectName + "));\n";
+            code += "    pCache->api." + destroyCommand.name + "(pCache->device, " + objectName + ", pCache->pAllocator);\n";
+            code += "}\n";
+            code += "\n";
+            code += "void " + releaseName + "(VkbObjectCache* pCache, " + handleType + " " + objectName + ")\n";
+            code += "{\n";
+            code += "    uint64_t handle = 0;\n";
+            code += "    memcpy(&handle, &" + objectName + ", sizeof(" + objectName + "));\n";
+            code += "    vkbObjectCacheRelease(pCache, " + destroyProcName + ", handle);\n";
+            code += "}\n";
+            code += "\n";
+            vkbBuildAppendGuardedLine(destroyProtect, code, currentProtect, codeOut);
+        }
+
+        std::string code;
+        code += "static VkResult " + createProcName + "(VkbObjectCache* pCache, const void* pCreateInfo, uint64_t* pHandle)\n";
+        code += "{\n";
+        code += "    " + handleType + " " + objectName + ";\n";
+        code += "    VkResult result = pCache->api." + command.name + "(pCache->device, (const " + createInfoType + "*)pCreateInfo, pCache->pAllocator, &" + objectName + ");\n";
+        code += "    if (result == VK_SUCCESS) {\n";
+        code += "        *pHandle = 0;\n";
+        code += "        memcpy(pHandle, &" + objectName + ", sizeof(" + objectName + "));\n";
+        code += "    }\n";
+        code += "\n";
+        code += "    return result;\n";
+        code += "}\n";
+        code += "\n";
+        code += "VkResult " + createName + "(VkbObjectCache* pCache, const " + createInfoType + "* pCreateInfo, " + handleType + "* " + handleName + ")\n";
+        code += "{\n";
+        code += "    uint64_t handle;\n";
+        code += "    VkResult result = vkbObjectCacheAcquire(pCache, pCreateInfo, " + createProcName + ", " + destroyProcName + ", &handle);\n";
+        code += "    if (result == VK_SUCCESS) {\n";
+        code += "        memcpy(" + handleName + ", &handle, sizeof(*" + handleName + "));\n";
+        code += "    }\n";
+        code += "\n";
+        code += "    return result;\n";
+        code += "}\n";
+        code += "\n";
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // The template has its own line break after the tag.
+    if (!declarationsOnly) {
+        while (codeOut.size() > 0 && codeOut[codeOut.size() - 1] == '\n') {
+            codeOut.erase(codeOut.size() - 1);
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
+/*
+Checks whether or not a command returns an array with the two-call idiom, where the second to last parameter is a pointer to the
+count and the last parameter is the array with a len attribute naming the count.
+*/
+bool vkbBuildIsEnumerateCommand(const vkbBuildCommand &command)
+{
+    if (command.parameters.size() < 2 || (command.returnType != "VkResult" && command.returnType != "void")) {
+        return false;
+    }
+
+    const vkbBuildFunctionParameter &countParam = command.parameters[command.parameters.size() - 2];
+    const vkbBuildFunctionParameter &arrayParam = command.parameters[command.parameters.size() - 1];
+
+    if (arrayParam.len != countParam.name || arrayParam.typeC != arrayParam.type + "*") {
+        return false;
+    }
+
+    return countParam.typeC == "uint32_t*" || countParam.typeC == "size_t*";
+}
+
+VkbResult vkbBuildGenerateCode_C_Enumerate(VkbBuild &context, vkbBuildCodeGenState &codegenState, bool declarationsOnly, std::string &codeOut)
+{
+    std::string currentProtect;
+
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+        if (!codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        // Aliases get their own helper so they go through their own function pointer. It might be the only one that's loaded.
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(context, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &context.commands[iBaseCommand];
+        }
+
+        if (!vkbBuildIsEnumerateCommand(*pBaseCommand)) {
+            continue;
+        }
+
+        const std::vector<vkbBuildFunctionParameter> &params = pBaseCommand->parameters;
+        const vkbBuildFunctionParameter &countParam = params[params.size() - 2];
+        const vkbBuildFunctionParameter &arrayParam = params[params.size() - 1];
+        std::string countType   = countParam.type;
+        std::string elementType = arrayParam.type;
+        std::string elementSize = (elementType == "void") ? "1" : "sizeof(" + elementType + ")";
+        std::string arrayName   = "p" + arrayParam.name;
+        std::string structType  = vkbBuildGetStructTypeValue(context, elementType, NULL);
+        bool returnsResult = pBaseCommand->returnType == "VkResult";
+
+        std::string signature;
+        signature += "VkResult vkbEnumerate_" + command.name + "(const VkbAPI* pAPI, ";
+        for (size_t iParam = 0; iParam + 2 < params.size(); ++iParam) {
+            signature += params[iParam].typeC + " " + params[iParam].nameC + ", ";
+        }
+        signature += countParam.typeC + " " + countParam.nameC + ", " + arrayParam.typeC + "* " + arrayName + ", VkbArena* pArena)";
+
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(command.name));
+        if (declarationsOnly) {
+            vkbBuildAppendGuardedLine(protect, signature + ";\n", currentProtect, codeOut);
+            continue;
+        }
+
+        std::string leadingArgs;
+        for (size_t iParam = 0; iParam + 2 < params.size(); ++iParam) {
+            leadingArgs += params[iParam].name + ", ";
+        }
+
+        std::string code;
+        code += signature + "\n";
+        code += "{\n";
+        code += "    #if defined(VKBIND_NO_GLOBAL_API)\n";
+        code += "    PFN_" + command.name + " pfn = (pAPI != NULL) ? pAPI->" + command.name + " : NULL;\n";
+        code += "    #else\n";
+        code += "    PFN_" + command.name + " pfn = (pAPI != NULL) ? pAPI->" + command.name + " : " + command.name + ";\n";
+        code += "    #endif\n";
+        code += "    size_t cursor;\n";
+        code += "    " + countType + " count;\n";
+        code += "    VkResult result;\n";
+        if (structType != "") {
+            code += "    " + countType + " i;\n";
+        }
+        code += "\n";
+        code += "    if (pfn == NULL || " + countParam.name + " == NULL || " + arrayName + " == NULL || pArena == NULL) {\n";
+        code += "        return VK_ERROR_INITIALIZATION_FAILED;\n";
+        code += "    }\n";
+        code += "\n";
+        code += "    cursor = pArena->cursor;\n";
+        code += "    for (;;) {\n";
+        code += "        count = 0;\n";
+        if (returnsResult) {
+            code += "        result = pfn(" + leadingArgs + "&count, NULL);\n";
+            code += "        if (result != VK_SUCCESS) {\n";
+            code += "            break;\n";
+            code += "        }\n";
+        } else {
+            code += "        pfn(" + leadingArgs + "&count, NULL);\n";
+        }
+        code += "\n";
+        code += "        *" + arrayName + " = (" + arrayParam.typeC + ")vkbArenaAlloc(pArena, " + elementSize + " * count);\n";
+        code += "        if (*" + arrayName + " == NULL && count > 0) {\n";
+        code += "            result = VK_ERROR_OUT_OF_HOST_MEMORY;\n";
+        code += "            break;\n";
+        code += "        }\n";
+        if (structType != "") {
+            code += "\n";
+            code += "        for (i = 0; i < count; i += 1) {\n";
+            code += "            (*" + arrayName + ")[i].sType = " + structType + ";\n";
+            code += "            (*" + arrayName + ")[i].pNext = NULL;\n";
+            code += "        }\n";
+        }
+        code += "\n";
+        if (returnsResult) {
+            code += "        result = pfn(" + leadingArgs + "&count, *" + arrayName + ");\n";
+            code += "        if (result != VK_INCOMPLETE) {\n";
+            code += "            break;\n";
+            code += "        }\n";
+            code += "\n";
+            code += "        /* More items were added between the two calls. Try again, reusing the space from this attempt. */\n";
+            code += "        pArena->cursor = cursor;\n";
+        } else {
+            code += "        pfn(" + leadingArgs + "&count, *" + arrayName + ");\n";
+            code += "        result = VK_SUCCESS;\n";
+            code += "        break;\n";
+        }
+        code += "    }\n";
+        code += "\n";
+        code += "    if (result < 0) {\n";
+        code += "        pArena->cursor = cursor;\n";
+        code += "        *" + arrayName + " = NULL;\n";
+        code += "        count = 0;\n";
+        code += "    }\n";
+        code += "\n";
+        code += "    *" + countParam.name + " = count;\n";
+        code += "    return result;\n";
+        code += "}\n";
+        code += "\n";
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // The template has its own line break after the tag.
+    if (!declarationsOnly) {
+        while (codeOut.size() > 0 && codeOut[codeOut.size() - 1] == '\n') {
+            codeOut.erase(codeOut.size() - 1);
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
+/*
+Builds the arguments of a command as if they were the members of a structure so they can be copied by the deep copy code. The
+command buffer is left out since it's only known when the stream is replayed. Returns false if the command can't be recorded
+into a command stream, which is the case for commands that return something, have output parameters, or have pointers that the
+deep copy code doesn't know the size of.
+*/
+bool vkbBuildGetCommandStreamArgs(vkbBuildDeepCopyState &state, const vkbBuildCommand &command, vkbBuildStruct &argsOut, std::vector<bool> &hasPlanOut)
+{
+    argsOut.members.clear();
+    hasPlanOut.clear();
+
+    if (command.returnType != "void" || command.name.find("vkCmd") != 0 || command.parameters.size() == 0 || command.parameters[0].type != "VkCommandBuffer") {
+        return false;
+    }
+
+    for (size_t iParam = 1; iParam < command.parameters.size(); ++iParam) {
+        const vkbBuildFunctionParameter &param = command.parameters[iParam];
+
+        vkbBuildStructMember member;
+        member.typeC  = param.typeC;
+        member.type   = param.type;
+        member.nameC  = param.nameC;
+        member.name   = param.name;
+        member.len    = param.len;
+        member.altlen = param.altlen;
+        argsOut.members.push_back(member);
+    }
+
+    for (size_t iMember = 0; iMember < argsOut.members.size(); ++iMember) {
+        const vkbBuildStructMember &member = argsOut.members[iMember];
+        bool isPointer = member.typeC.find('*') != std::string::npos;
+
+        vkbBuildDeepCopyPlan plan;
+        bool hasPlan = vkbBuildGetDeepCopyPlan(state, "", argsOut, member, plan);
+        if (isPointer && (!hasPlan || member.typeC.find("const") != 0)) {
+            return false;
+        }
+
+        hasPlanOut.push_back(hasPlan);
+    }
+
+    return true;
+}
+
+// Collects the commands that can be recorded into a VkbCommandStream, in opcode order.
+void vkbBuildGetCommandStreamCommands(VkbBuild &vk, vkbBuildCodeGenState &codegenState, vkbBuildDeepCopyState &state, std::vector<std::string> &namesOut, std::vector<std::string> &protectsOut, std::vector<vkbBuildStruct> &argsOut, std::vector<std::vector<bool> > &plansOut)
+{
+    // Aliases get their own encoder so they're replayed through their own function pointer. It might be the only one that's loaded.
+    for (size_t iCommand = 0; iCommand < vk.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = vk.commands[iCommand];
+        if (!codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(vk, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &vk.commands[iBaseCommand];
+        }
+
+        vkbBuildStruct args;
+        std::vector<bool> plans;
+        if (!vkbBuildGetCommandStreamArgs(state, *pBaseCommand, args, plans)) {
+            continue;
+        }
+
+        namesOut.push_back(command.name);
+        protectsOut.push_back(vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(command.name)));
+        argsOut.push_back(args);
+        plansOut.push_back(plans);
+    }
+}
+
+/*
+Outputs the encoders and the decoder of VkbCommandStream. Each vkCmd* command that can be recorded gets an opcode, a structure
+holding its arguments after a VkbCommandStreamHeader, and vkbEncode_<Command>() which fills in that structure and passes it to
+vkbCommandStreamPush() along with a function for copying what the arguments point to. Copying is done with the deep copy code so
+arrays, strings, nested structures and pNext chains are all included. vkbCommandStreamReplayCommand() is the decoder. It switches
+on the opcode and calls the command through the VkbAPI it's given.
+
+The opcodes are not guarded by platform macros so a given header always uses the same values.
+*/
+VkbResult vkbBuildGenerateCode_C_CommandStream(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, bool declarationsOnly, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+    std::vector<vkbBuildStruct> commandArgs;
+    std::vector<std::vector<bool> > commandPlans;
+    vkbBuildGetCommandStreamCommands(vk, codegenState, state, commandNames, commandProtects, commandArgs, commandPlans);
+
+    std::string currentProtect;
+
+    if (declarationsOnly) {
+        for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+            std::string signature = "VkResult vkbEncode_" + commandNames[iCommand] + "(VkbCommandStream* pStream";
+            for (size_t iMember = 0; iMember < commandArgs[iCommand].members.size(); ++iMember) {
+                const vkbBuildStructMember &member = commandArgs[iCommand].members[iMember];
+                signature += ", " + member.typeC + " " + member.nameC;
+            }
+            signature += ");\n";
+
+            vkbBuildAppendGuardedLine(commandProtects[iCommand], signature, currentProtect, codeOut);
+        }
+        vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+        return VKB_SUCCESS;
+    }
+
+    codeOut += "typedef enum\n";
+    codeOut += "{\n";
+    codeOut += "    VKB_COMMAND_STREAM_OPCODE_NONE = 0,\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        codeOut += "    VKB_COMMAND_STREAM_OPCODE_" + commandNames[iCommand] + ",\n";
+    }
+    codeOut += "    VKB_COMMAND_STREAM_OPCODE_COUNT\n";
+    codeOut += "} VkbCommandStreamOpcode;\n";
+    codeOut += "\n";
+
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildStruct &args = commandArgs[iCommand];
+        const std::vector<bool> &plans = commandPlans[iCommand];
+        bool hasCopy = std::find(plans.begin(), plans.end(), true) != plans.end();
+        std::string code;
+
+        code += "typedef struct\n";
+        code += "{\n";
+        code += "    VkbCommandStreamHeader header;\n";
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = args.members[iMember];
+
+            // Fixed size arrays, like blendConstants[4], are copied into the structure so they can't be const.
+            std::string typeC = member.typeC;
+            if (member.nameC.find('[') != std::string::npos && typeC.find("const ") == 0) {
+                typeC = typeC.substr(6);
+            }
+
+            code += "    " + typeC + " " + member.nameC + ";\n";
+        }
+        code += "} VkbCommand_" + name + ";\n";
+        code += "\n";
+
+        if (hasCopy) {
+            code += "static void vkbCommandStreamCopy_" + name + "(VkbDeepCopyArena* pArena, const VkbCommandStreamHeader* pArgs, VkbCommandStreamHeader* pCommand)\n";
+            code += "{\n";
+            code += "    const VkbCommand_" + name + "* pSrc = (const VkbCommand_" + name + "*)pArgs;\n";
+            code += "    VkbCommand_" + name + "* pDst = (VkbCommand_" + name + "*)pCommand;\n";
+            code += "\n";
+            for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+                vkbBuildDeepCopyPlan plan;
+                if (plans[iMember] && vkbBuildGetDeepCopyPlan(state, "", args, args.members[iMember], plan)) {
+                    code += vkbBuildGenerateCode_C_DeepCopyMember(state, args.members[iMember], plan);
+                }
+            }
+            code += "}\n";
+            code += "\n";
+        }
+
+        code += "VkResult vkbEncode_" + name + "(VkbCommandStream* pStream";
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            code += ", " + args.members[iMember].typeC + " " + args.members[iMember].nameC;
+        }
+        code += ")\n";
+        code += "{\n";
+        code += "    VkbCommand_" + name + " args;\n";
+        code += "\n";
+        code += "    args.header.opcode = VKB_COMMAND_STREAM_OPCODE_" + name + ";\n";
+        code += "    args.header.size   = 0;\n";
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = args.members[iMember];
+            if (member.nameC.find('[') != std::string::npos) {
+                code += "    memcpy(args." + member.name + ", " + member.name + ", sizeof(args." + member.name + "));\n";
+            } else {
+                code += "    args." + member.name + " = " + member.name + ";\n";
+            }
+        }
+        code += "\n";
+        code += "    return vkbCommandStreamPush(pStream, &args.header, sizeof(args), " + (hasCopy ? "vkbCommandStreamCopy_" + name : std::string("NULL")) + ");\n";
+        code += "}\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    codeOut += "static VkResult vkbCommandStreamReplayCommand(const VkbAPI* pAPI, VkCommandBuffer commandBuffer, const VkbCommandStreamHeader* pHeader)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (pHeader->opcode)\n";
+    codeOut += "    {\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildStruct &args = commandArgs[iCommand];
+        std::string code;
+
+        code += "        case VKB_COMMAND_STREAM_OPCODE_" + name + ":\n";
+        code += "        {\n";
+        if (args.members.size() > 0) {
+            code += "            const VkbCommand_" + name + "* pArgs = (const VkbCommand_" + name + "*)pHeader;\n";
+        }
+        code += "            if (pAPI->" + name + " == NULL) {\n";
+        code += "                return VK_ERROR_INITIALIZATION_FAILED;\n";
+        code += "            }\n";
+        code += "            pAPI->" + name + "(commandBuffer";
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            code += ", pArgs->" + args.members[iMember].name;
+        }
+        code += ");\n";
+        code += "        } break;\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: return VK_ERROR_INITIALIZATION_FAILED;    /* Corrupt stream, or recorded with a different build. */\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    return VK_SUCCESS;\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+/*
+Retrieves the state that a command sets, for the purpose of redundant state filtering. Commands that set the same state share a
+group, such as vkCmdSetViewport and vkCmdSetViewportWithCount, or vkCmdBindVertexBuffers and vkCmdBindVertexBuffers2. This is
+worked out from the name with the author suffix, version number and "WithCount" removed. Everything to do with descriptors is put
+in one group since binding sets, pushing descriptors and binding descriptor buffers all disturb each other. vkCmdSetVertexInputEXT is
+in the same group as the vertex buffers since it replaces the strides that vkCmdBindVertexBuffers2 sets, which means binding the same
+buffers again afterwards is not redundant.
+*/
+std::string vkbBuildGetStateFilterGroup(const std::string &commandName)
+{
+    std::string group = commandName.substr(5);  // "vkCmd"
+
+    size_t suffixLength = 0;
+    while (suffixLength < group.size() && isupper((unsigned char)group[group.size() - 1 - suffixLength])) {
+        suffixLength += 1;
+    }
+    if (suffixLength >= 2) {
+        group = group.substr(0, group.size() - suffixLength);
+    }
+
+    while (group.size() > 0 && isdigit((unsigned char)group[group.size() - 1])) {
+        group.erase(group.size() - 1);
+    }
+
+    if (group.size() > 9 && group.substr(group.size() - 9) == "WithCount") {
+        group = group.substr(0, group.size() - 9);
+    }
+
+    if (group.find("Descriptor") != std::string::npos) {
+        group = "Descriptor";
+    }
+
+    if (group == "SetVertexInput") {
+        group = "BindVertexBuffers";
+    }
+
+    return group;
+}
+
+/*
+Outputs the redundant state filter. Each vkCmd* command that the registry says sets state or executes other commands gets an
+entry in g_vkbStateFilterCommands and vkbFilter_<Command>(). The table gives the state group of the command and whether or not it
+invalidates every other group. Binding a pipeline or shaders does, since they replace static state and can disturb everything
+else, and so does executing secondary or generated commands. Commands that can be recorded into a VkbCommandStream also get
+vkbStateFilterEqual_<Command>() which compares the arguments of a call with the copy of the last call in the same group. The
+comparisons are the same as for vkbEqual() so arrays and structures are compared by value.
+
+The table isn't guarded by platform macros so the indices are the same for a given header.
+*/
+VkbResult vkbBuildGenerateCode_C_StateFilter(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, bool declarationsOnly, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<const vkbBuildCommand*> commands;      // The base command, for the parameters.
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+    std::vector<std::string> commandGroups;            // Empty for commands that don't set state.
+    std::vector<bool> commandInvalidatesAll;
+    std::vector<bool> commandIsEncodable;
+    std::vector<vkbBuildStruct> commandArgs;
+    std::vector<std::string> groupNames;
+    for (size_t iCommand = 0; iCommand < vk.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = vk.commands[iCommand];
+        if (command.name.find("vkCmd") != 0 || !codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(vk, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &vk.commands[iBaseCommand];
+        }
+
+        std::vector<std::string> tasks = vkbSplitString(pBaseCommand->tasks, ",");
+        bool isState = vkbContains(tasks, std::string("state"));
+        bool isIndirection = vkbContains(tasks, std::string("indirection"));
+        if ((!isState && !isIndirection) || pBaseCommand->parameters.size() == 0 || pBaseCommand->parameters[0].type != "VkCommandBuffer") {
+            continue;
+        }
+
+        std::string group;
+        if (isState) {
+            group = vkbBuildGetStateFilterGroup(command.name);
+            if (!vkbContains(groupNames, group)) {
+                groupNames.push_back(group);
+            }
+        }
+
+        vkbBuildStruct args;
+        std::vector<bool> plans;
+        bool isEncodable = isState && vkbBuildGetCommandStreamArgs(state, *pBaseCommand, args, plans);
+
+        commands.push_back(pBaseCommand);
+        commandNames.push_back(command.name);
+        commandProtects.push_back(vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(command.name)));
+        commandGroups.push_back(group);
+        commandInvalidatesAll.push_back(isIndirection || group == "BindPipeline" || group == "BindShaders");
+        commandIsEncodable.push_back(isEncodable);
+        commandArgs.push_back(args);
+    }
+
+    std::string currentProtect;
+
+    if (declarationsOnly) {
+        for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+            const std::vector<vkbBuildFunctionParameter> &params = commands[iCommand]->parameters;
+
+            std::string signature = commands[iCommand]->returnTypeC + " vkbFilter_" + commandNames[iCommand] + "(VkbStateFilter* pFilter";
+            for (size_t iParam = 1; iParam < params.size(); ++iParam) {
+                signature += ", " + params[iParam].typeC + " " + params[iParam].nameC;
+            }
+            signature += ");\n";
+
+            vkbBuildAppendGuardedLine(commandProtects[iCommand], signature, currentProtect, codeOut);
+        }
+        vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+        return VKB_SUCCESS;
+    }
+
+    char countStr[64];
+    snprintf(countStr, sizeof(countStr), "%d", (int)groupNames.size());
+    codeOut += "#define VKB_STATE_FILTER_GROUP_COUNT   " + std::string(countStr) + "\n";
+    snprintf(countStr, sizeof(countStr), "%d", (int)commandNames.size());
+    codeOut += "#define VKB_STATE_FILTER_COMMAND_COUNT " + std::string(countStr) + "\n";
+    codeOut += "\n";
+
+    codeOut += "static const VkbStateFilterCommand g_vkbStateFilterCommands[VKB_STATE_FILTER_COMMAND_COUNT + 1] = {\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        std::string group = "VKB_STATE_FILTER_NO_GROUP";
+        for (size_t iGroup = 0; iGroup < groupNames.size(); ++iGroup) {
+            if (groupNames[iGroup] == commandGroups[iCommand]) {
+                snprintf(countStr, sizeof(countStr), "%d", (int)iGroup);
+                group = countStr;
+            }
+        }
+
+        codeOut += "    {\"" + commandNames[iCommand] + "\", " + group + ", " + (commandInvalidatesAll[iCommand] ? "VK_TRUE" : "VK_FALSE") + "},\n";
+    }
+    codeOut += "    {NULL, VKB_STATE_FILTER_NO_GROUP, VK_FALSE}  /* Keeps the table from being empty. */\n";
+    codeOut += "};\n";
+    codeOut += "\n";
+
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildCommand &command = *commands[iCommand];
+        const vkbBuildStruct &args = commandArgs[iCommand];
+        bool returnsValue = command.returnType != "void";
+        char indexStr[64];
+        snprintf(indexStr, sizeof(indexStr), "%d", (int)iCommand);
+        std::string code;
+
+        if (commandIsEncodable[iCommand]) {
+            std::string equal;
+            std::string discardHash;
+            bool usesLoop = false;
+            for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+                vkbBuildGenerateCode_C_HashMember(state, "", args, args.members[iMember], discardHash, equal, usesLoop);
+            }
+
+            code += "static VkBool32 vkbStateFilterEqual_" + name + "(const VkbCommandStreamHeader* pShadow, const VkbCommandStreamHeader* pArgs)\n";
+            code += "{\n";
+            if (args.members.size() > 0) {
+                code += "    const VkbCommand_" + name + "* pA = (const VkbCommand_" + name + "*)pShadow;\n";
+                code += "    const VkbCommand_" + name + "* pB = (const VkbCommand_" + name + "*)pArgs;\n";
+            } else {
+                code += "    (void)pShadow;\n";
+                code += "    (void)pArgs;\n";
+            }
+            if (usesLoop) {
+                code += "    size_t i;\n";
+            }
+            code += "\n";
+            code += equal;
+            code += "\n";
+            code += "    return VK_TRUE;\n";
+            code += "}\n";
+            code += "\n";
+        }
+
+        std::string callArgs = "pFilter->commandBuffer";
+        code += command.returnTypeC + " vkbFilter_" + name + "(VkbStateFilter* pFilter";
+        for (size_t iParam = 1; iParam < command.parameters.size(); ++iParam) {
+            code += ", " + command.parameters[iParam].typeC + " " + command.parameters[iParam].nameC;
+            callArgs += ", " + command.parameters[iParam].name;
+        }
+        code += ")\n";
+        code += "{\n";
+        if (commandIsEncodable[iCommand]) {
+            code += "    VkbCommand_" + name + " args;\n";
+        }
+        if (returnsValue) {
+            code += "    " + command.returnTypeC + " result;\n";
+        }
+        if (commandIsEncodable[iCommand]) {
+            code += "\n";
+            code += "    args.header.opcode = VKB_COMMAND_STREAM_OPCODE_" + name + ";\n";
+            code += "    args.header.size   = 0;\n";
+            for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+                const vkbBuildStructMember &member = args.members[iMember];
+                if (member.nameC.find('[') != std::string::npos) {
+                    code += "    memcpy(args." + member.name + ", " + member.name + ", sizeof(args." + member.name + "));\n";
+                } else {
+                    code += "    args." + member.name + " = " + member.name + ";\n";
+                }
+            }
+            code += "\n";
+            code += "    if (vkbStateFilterIsRedundant(pFilter, " + std::string(indexStr) + ", &args.header, vkbStateFilterEqual_" + name + ")) {\n";
+            code += "        return;\n";   // Only commands that return void can be recorded, so only they can be dropped.
+            code += "    }\n";
+        } else {
+            if (returnsValue) {
+                code += "\n";
+            }
+            code += "    vkbStateFilterIsRedundant(pFilter, " + std::string(indexStr) + ", NULL, NULL);\n";   // Only counts the call.
+        }
+        code += "\n";
+        code += "    " + std::string(returnsValue ? "result = " : "") + "pFilter->api." + name + "(" + callArgs + ");\n";
+        if (commandIsEncodable[iCommand]) {
+            std::string copyProc = "NULL";
+            for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+                vkbBuildDeepCopyPlan plan;
+                if (vkbBuildGetDeepCopyPlan(state, "", args, args.members[iMember], plan)) {
+                    copyProc = "vkbCommandStreamCopy_" + name;
+                }
+            }
+            code += "    vkbStateFilterUpdate(pFilter, " + std::string(indexStr) + ", &args.header, sizeof(args), " + copyProc + ");\n";
+        } else {
+            code += "    vkbStateFilterUpdate(pFilter, " + std::string(indexStr) + ", NULL, 0, NULL);\n";
+        }
+        if (returnsValue) {
+            code += "\n";
+            code += "    return result;\n";
+        }
+        code += "}\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // The template has its own line break after the tag.
+    while (codeOut.size() > 0 && codeOut[codeOut.size() - 1] == '\n') {
+        codeOut.erase(codeOut.size() - 1);
+    }
+
+    return VKB_SUCCESS;
+}
+
+// The registry-derived traits of a handle type. Only the commands that are output are included.
+struct vkbBuildHandleTraits
+{
+    std::string parentObjectType;           // VK_OBJECT_TYPE_UNKNOWN if the handle has no parent.
+    std::vector<std::string> createCommands;
+    std::string destroyCommand;             // Empty if objects of this type are never destroyed explicitly.
+};
+
+void vkbBuildGetHandleTraits(VkbBuild &context, vkbBuildCodeGenState &codegenState, const vkbBuildType &type, vkbBuildHandleTraits &traitsOut)
+{
+    traitsOut.parentObjectType = "VK_OBJECT_TYPE_UNKNOWN";
+    traitsOut.createCommands.clear();
+    traitsOut.destroyCommand = "";
+
+    // Some handles list more than one parent, such as VkSwapchainKHR. The first one is the one it's created from.
+    std::vector<std::string> parents = vkbSplitString(type.parent, ",");
+    if (parents.size() > 0) {
+        size_t iParentType;
+        if (vkbBuildFindTypeByName(context, vkbTrim(parents[0]).c_str(), &iParentType) && context.types[iParentType].objtypeenum != "") {
+            traitsOut.parentObjectType = context.types[iParentType].objtypeenum;
+        }
+    }
+
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+        if (command.alias != "" || command.parameters.size() == 0 || !codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        if (command.name.find("vkCreate") == 0 || command.name.find("vkAllocate") == 0) {
+            const vkbBuildFunctionParameter &lastParam = command.parameters.back();
+            if (lastParam.type == type.name && lastParam.typeC == type.name + "*") {
+                traitsOut.createCommands.push_back(command.name);
+            }
+        }
+    }
+
+    std::string destroyName = "vkDestroy" + type.name.substr(2);
+    if (codegenState.HasOutputCommand(destroyName)) {
+        traitsOut.destroyCommand = destroyName;
+        return;
+    }
+
+    // Objects that are allocated from a pool or from the device are freed instead, such as vkFreeMemory and vkFreeCommandBuffers.
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+        if (command.alias != "" || command.name.find("vkFree") != 0 || !codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        for (size_t iParam = 0; iParam < command.parameters.size(); ++iParam) {
+            if (command.parameters[iParam].type == type.name) {
+                traitsOut.destroyCommand = command.name;
+                return;
+            }
+        }
+    }
+}
+
+VkbResult vkbBuildGenerateCode_C_HandleInfo(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    std::string currentProtect;
+    std::string cases;
+
+    for (size_t iType = 0; iType < context.types.size(); ++iType) {
+        const vkbBuildType &type = context.types[iType];
+        if (type.category != "handle" || type.alias != "" || type.objtypeenum == "" || !codegenState.HasOutputType(type.name)) {
+            continue;
+        }
+
+        vkbBuildHandleTraits traits;
+        vkbBuildGetHandleTraits(context, codegenState, type, traits);
+
+        std::string infoName = "g_vkbHandleInfo_" + type.name;
+        std::string createCommandsName = "NULL";
+
+        std::string code;
+        if (traits.createCommands.size() > 0) {
+            createCommandsName = "g_vkbCreateCommands_" + type.name;
+            code += "static const char* const " + createCommandsName + "[] = {";
+            for (size_t iCreateCommand = 0; iCreateCommand < traits.createCommands.size(); ++iCreateCommand) {
+                if (iCreateCommand > 0) {
+                    code += ", ";
+                }
+                code += "\"" + traits.createCommands[iCreateCommand] + "\"";
+            }
+            code += "};\n";
+        }
+
+        char createCommandCount[32];
+        snprintf(createCommandCount, sizeof(createCommandCount), "%u", (unsigned int)traits.createCommands.size());
+
+        code += "static const VkbHandleInfo " + infoName + " = {\"" + type.name + "\", " + type.objtypeenum + ", " + traits.parentObjectType + ", ";
+        code += std::string((type.type == "VK_DEFINE_HANDLE") ? "VK_TRUE" : "VK_FALSE") + ", " + createCommandsName + ", " + createCommandCount + ", ";
+        code += ((traits.destroyCommand != "") ? "\"" + traits.destroyCommand + "\"" : std::string("NULL")) + "};\n";
+
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(type.name));
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+
+        if (protect != "") {
+            cases += "    #ifdef " + protect + "\n";
+        }
+        cases += "    case " + type.objtypeenum + ": return &" + infoName + ";\n";
+        if (protect != "") {
+            cases += "    #endif\n";
+        }
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    codeOut += "\n";
+    codeOut += "const VkbHandleInfo* vkbGetHandleInfo(VkObjectType objectType)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (objectType)\n";
+    codeOut += "    {\n";
+    codeOut += cases;
+    codeOut += "    default: return NULL;\n";
+    codeOut += "    }\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+// Converts a uint64_t expression to a handle with the conversion macros of the object registry.
+std::string vkbBuildHandleFromU64(VkbBuild &context, const std::string &handleType, const std::string &value)
+{
+    size_t iType;
+    if (vkbBuildFindTypeByName(context, handleType.c_str(), &iType) && context.types[iType].type == "VK_DEFINE_HANDLE") {
+        return "VKB_DISPATCHABLE_FROM_U64(" + handleType + ", " + value + ")";
+    } else {
+        return "VKB_NON_DISPATCHABLE_FROM_U64(" + handleType + ", " + value + ")";
+    }
+}
+
+// Retrieves the VkObjectType value of a handle type, or an empty string if it doesn't have one.
+std::string vkbBuildGetHandleObjectType(VkbBuild &context, const std::string &handleType)
+{
+    size_t iType;
+    if (vkbBuildFindTypeByName(context, handleType.c_str(), &iType)) {
+        return context.types[iType].objtypeenum;
+    }
+
+    return "";
+}
+
+// The number of VkbAPI objects that a feature such as the object registry can be installed into at the same time.
+#define VKB_BUILD_MAX_INSTALLS  4
+
+/*
+Outputs the copies of a wrapper for each install of a feature, such as the object registry. Function pointers can't carry any state
+of their own so each install has its own copy, vkb<Feature><Index>_<Command>(), which calls the wrapper with the install it belongs to
+followed by extraArgs and the parameters of the command. g_vkb<Feature>Thunks_<Command> has the copies in install order.
+*/
+std::string vkbBuildGenerateCode_C_InstallThunks(const std::string &feature, const std::string &maxInstalls, const std::string &commandName, const std::string &returnTypeC, const std::string &declParams, const std::string &callArgs, const std::string &wrapName, const std::string &extraArgs)
+{
+    std::string code;
+    std::string thunks;
+    for (int iInstall = 0; iInstall < VKB_BUILD_MAX_INSTALLS; ++iInstall) {
+        char indexStr[32];
+        snprintf(indexStr, sizeof(indexStr), "%d", iInstall);
+
+        std::string thunkName = "vkb" + feature + indexStr + "_" + commandName;
+
+        code += "static VKAPI_ATTR " + returnTypeC + " VKAPI_CALL " + thunkName + "(" + ((declParams != "") ? declParams : "void") + ")\n";
+        code += "{\n";
+        code += "    " + std::string((returnTypeC != "void") ? "return " : "") + wrapName + "(&g_vkb" + feature + "Installs[" + indexStr + "], " + extraArgs + callArgs + ");\n";
+        code += "}\n";
+        code += "\n";
+
+        if (iInstall > 0) {
+            thunks += ", ";
+        }
+        thunks += thunkName;
+    }
+    code += "static const PFN_" + commandName + " g_vkb" + feature + "Thunks_" + commandName + "[" + maxInstalls + "] = {" + thunks + "};\n";
+    code += "\n";
+
+    return code;
+}
+
+/*
+Outputs vkb<Feature>InstallAPI() and vkb<Feature>UninstallAPI() which swap the function pointers of a VkbAPI with the copies of the
+wrappers for an install and back, saving the originals in the next member of the install, and vkb<Feature>IsInstalledAPI() which
+checks whether or not any of them belong to an install.
+*/
+void vkbBuildGenerateCode_C_InstallFunctions(const std::string &feature, const std::vector<std::string> &commandNames, const std::vector<std::string> &commandProtects, std::string &codeOut)
+{
+    std::string currentProtect;
+
+    codeOut += "static void vkb" + feature + "InstallAPI(VkbAPI* pAPI, uint32_t iInstall)\n";
+    codeOut += "{\n";
+    codeOut += "    Vkb" + feature + "Install* pInstall = &g_vkb" + feature + "Installs[iInstall];\n";
+    codeOut += "\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string thunks = "g_vkb" + feature + "Thunks_" + name;
+        std::string code;
+        code += "    if (pAPI->" + name + " != NULL && pAPI->" + name + " != " + thunks + "[iInstall]) {\n";
+        code += "        pInstall->next." + name + " = pAPI->" + name + ";\n";
+        code += "        pAPI->" + name + " = " + thunks + "[iInstall];\n";
+        code += "    }\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    if (commandNames.size() == 0) {
+        codeOut += "    (void)pAPI;\n";
+        codeOut += "    (void)pInstall;\n";
+    }
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    codeOut += "static void vkb" + feature + "UninstallAPI(VkbAPI* pAPI, uint32_t iInstall)\n";
+    codeOut += "{\n";
+    codeOut += "    Vkb" + feature + "Install* pInstall = &g_vkb" + feature + "Installs[iInstall];\n";
+    codeOut += "\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string code;
+        code += "    if (pAPI->" + name + " == g_vkb" + feature + "Thunks_" + name + "[iInstall]) {\n";
+        code += "        pAPI->" + name + " = pInstall->next." + name + ";\n";
+        code += "    }\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    if (commandNames.size() == 0) {
+        codeOut += "    (void)pAPI;\n";
+        codeOut += "    (void)pInstall;\n";
+    }
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    codeOut += "static VkBool32 vkb" + feature + "IsInstalledAPI(const VkbAPI* pAPI, uint32_t iInstall)\n";
+    codeOut += "{\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string code;
+        code += "    if (pAPI->" + name + " == g_vkb" + feature + "Thunks_" + name + "[iInstall]) {\n";
+        code += "        return VK_TRUE;\n";
+        code += "    }\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    if (commandNames.size() == 0) {
+        codeOut += "    (void)pAPI;\n";
+        codeOut += "    (void)iInstall;\n";
+    }
+    codeOut += "    return VK_FALSE;\n";
+    codeOut += "}";
+}
+
+// Converts a handle expression to a 64-bit integer with the conversion macros of the object registry.
+std::string vkbBuildHandleToU64(VkbBuild &context, const std::string &handleType, const std::string &value)
+{
+    size_t iType;
+    if (vkbBuildFindTypeByName(context, handleType.c_str(), &iType) && context.types[iType].type == "VK_DEFINE_HANDLE") {
+        return "VKB_U64_FROM_DISPATCHABLE(" + value + ")";
+    } else {
+        return "VKB_U64_FROM_NON_DISPATCHABLE(" + value + ")";
+    }
+}
+
+/*
+Works out the C expression for the parent of an object created with the given command. This is the parameter with the type of the
+parent, such as the device, or a member of a create info with that type, such as the command pool of VkCommandBufferAllocateInfo.
+For arrays of create infos the member is read from the create info of each object with "i" as the index. Returns an empty string if
+the parent can't be found.
+*/
+std::string vkbBuildGetObjectRegistryParent(VkbBuild &context, const vkbBuildCommand &command, const std::string &parentType)
+{
+    for (size_t iParam = 0; iParam + 1 < command.parameters.size(); ++iParam) {
+        if (command.parameters[iParam].type == parentType && command.parameters[iParam].typeC == parentType) {
+            return command.parameters[iParam].name;
+        }
+    }
+
+    for (size_t iParam = 0; iParam + 1 < command.parameters.size(); ++iParam) {
+        const vkbBuildFunctionParameter &param = command.parameters[iParam];
+
+        size_t iStructType;
+        if (param.typeC != "const " + param.type + "*" || !vkbBuildFindTypeByName(context, param.type.c_str(), &iStructType) || context.types[iStructType].category != "struct") {
+            continue;
+        }
+
+        const std::vector<vkbBuildStructMember> &members = context.types[iStructType].structData.members;
+        for (size_t iMember = 0; iMember < members.size(); ++iMember) {
+            if (members[iMember].type == parentType && members[iMember].typeC == parentType && members[iMember].nameC.find('[') == std::string::npos) {
+                if (param.len != "") {
+                    return param.name + "[i]." + members[iMember].name;
+                } else {
+                    return param.name + "->" + members[iMember].name;
+                }
+            }
+        }
+    }
+
+    return "";
+}
+
+/*
+Outputs the wrappers that register and unregister objects automatically. Each create, allocate, destroy and free command gets
+vkbObjectRegistryWrap_<Command>() which takes the install it was called through followed by the parameters of the command, and a
+copy of it for each install. See vkbBuildGenerateCode_C_InstallThunks().
+*/
+VkbResult vkbBuildGenerateCode_C_ObjectRegistryInstall(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    // The handle types that objects are allocated from and freed back to in batches, such as command pools. Destroying or resetting one
+    // of these frees those objects along with it. vkFreeMemory frees a single object so it doesn't make the device one of these.
+    std::vector<std::string> poolTypes;
+    for (size_t iType = 0; iType < context.types.size(); ++iType) {
+        const vkbBuildType &type = context.types[iType];
+        if (type.category != "handle" || type.alias != "" || type.objtypeenum == "" || !codegenState.HasOutputType(type.name)) {
+            continue;
+        }
+
+        vkbBuildHandleTraits traits;
+        vkbBuildGetHandleTraits(context, codegenState, type, traits);
+
+        size_t iDestroyCommand;
+        if (traits.destroyCommand.find("vkFree") != 0 || !vkbBuildFindCommandByName(context, traits.destroyCommand.c_str(), &iDestroyCommand)) {
+            continue;
+        }
+
+        const std::vector<vkbBuildFunctionParameter> &params = context.commands[iDestroyCommand].parameters;
+        if (params.back().type != type.name || params.back().len == "") {
+            continue;
+        }
+
+        for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+            if (vkbBuildGetHandleObjectType(context, params[iParam].type) == traits.parentObjectType && !vkbContains(poolTypes, params[iParam].type)) {
+                poolTypes.push_back(params[iParam].type);
+            }
+        }
+    }
+
+    char maxInstallsStr[32];
+    snprintf(maxInstallsStr, sizeof(maxInstallsStr), "%d", VKB_BUILD_MAX_INSTALLS);
+
+    codeOut += "#define VKB_OBJECT_REGISTRY_MAX_INSTALLS " + std::string(maxInstallsStr) + "\n";
+    codeOut += "\n";
+    codeOut += "static VkbObjectRegistryInstall g_vkbObjectRegistryInstalls[VKB_OBJECT_REGISTRY_MAX_INSTALLS];\n";
+    codeOut += "\n";
+
+    std::string currentProtect;
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+
+    for (size_t iCommand = 0; iCommand < context.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = context.commands[iCommand];
+        if (!codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        // Aliases get their own wrapper since they're called through their own function pointer.
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(context, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &context.commands[iBaseCommand];
+        }
+
+        const std::vector<vkbBuildFunctionParameter> &params = pBaseCommand->parameters;
+        if (params.size() == 0) {
+            continue;
+        }
+
+        bool returnsValue = pBaseCommand->returnType != "void";
+
+        // Works out what the command does to which handle type. Creating and destroying are worked out the same way as for the handle
+        // traits so the two are consistent. Objects are unregistered before they're destroyed because another thread can be given the
+        // same handle as soon as the driver has released it.
+        std::string body;
+        bool isBefore = false;
+        for (size_t iType = 0; iType < context.types.size() && body == ""; ++iType) {
+            const vkbBuildType &type = context.types[iType];
+            if (type.category != "handle" || type.alias != "" || type.objtypeenum == "" || !codegenState.HasOutputType(type.name)) {
+                continue;
+            }
+
+            vkbBuildHandleTraits traits;
+            vkbBuildGetHandleTraits(context, codegenState, type, traits);
+
+            if (vkbContains(traits.createCommands, pBaseCommand->name)) {
+                const vkbBuildFunctionParameter &handleParam = params.back();
+                std::vector<std::string> lens = vkbSplitString(handleParam.len, ",");
+                bool isArray = lens.size() > 0 && lens[0] != "" && lens[0] != "null-terminated" && lens[0].find("latexmath") != 0;
+
+                std::string parent = "0";
+                std::string parentObjectType = "VK_OBJECT_TYPE_UNKNOWN";
+                std::vector<std::string> parents = vkbSplitString(type.parent, ",");
+                if (parents.size() > 0 && traits.parentObjectType != "VK_OBJECT_TYPE_UNKNOWN") {
+                    std::string parentExpression = vkbBuildGetObjectRegistryParent(context, *pBaseCommand, vkbTrim(parents[0]));
+                    if (parentExpression != "" && (isArray || parentExpression.find("[i]") == std::string::npos)) {
+                        parent = vkbBuildHandleToU64(context, vkbTrim(parents[0]), parentExpression);
+                        parentObjectType = traits.parentObjectType;
+                    }
+                }
+
+                std::string object = isArray ? handleParam.name + "[i]" : "*" + handleParam.name;
+                std::string call = "vkbRegisterObject(pInstall->pRegistry, " + type.objtypeenum + ", " + vkbBuildHandleToU64(context, type.name, object) + ", " + parentObjectType + ", " + parent + ");\n";
+
+                // Objects that failed to be created, such as some of the pipelines of a batch, are left as null handles.
+                if (returnsValue) {
+                    body += "    if (result >= 0) {\n";
+                } else {
+                    body += "    {\n";
+                }
+                if (isArray) {
+                    body += "        size_t i;\n";
+                    body += "        for (i = 0; i < (size_t)(" + lens[0] + "); ++i) {\n";
+                    body += "            if (" + vkbBuildHandleToU64(context, type.name, object) + " != 0) {\n";
+                    body += "                " + call;
+                    body += "            }\n";
+                    body += "        }\n";
+                } else {
+                    body += "        if (" + vkbBuildHandleToU64(context, type.name, object) + " != 0) {\n";
+                    body += "            " + call;
+                    body += "        }\n";
+                }
+                body += "    }\n";
+            } else if (traits.destroyCommand == pBaseCommand->name) {
+                // The handle is the parameter of the type being destroyed, or an array of them for vkFree* commands with a count.
+                for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+                    const vkbBuildFunctionParameter &param = params[iParam];
+                    if (param.type != type.name) {
+                        continue;
+                    }
+
+                    if (param.typeC == type.name) {
+                        if (vkbContains(poolTypes, type.name)) {
+                            body += "    vkbObjectRegistryRemoveChildren(pInstall->pRegistry, " + type.objtypeenum + ", " + vkbBuildHandleToU64(context, type.name, param.name) + ");\n";
+                        }
+                        body += "    vkbUnregisterObject(pInstall->pRegistry, " + type.objtypeenum + ", " + vkbBuildHandleToU64(context, type.name, param.name) + ");\n";
+                    } else if (param.typeC == "const " + type.name + "*" && param.len != "") {
+                        body += "    if (" + param.name + " != NULL) {\n";
+                        body += "        size_t i;\n";
+                        body += "        for (i = 0; i < (size_t)(" + vkbSplitString(param.len, ",")[0] + "); ++i) {\n";
+                        body += "            vkbUnregisterObject(pInstall->pRegistry, " + type.objtypeenum + ", " + vkbBuildHandleToU64(context, type.name, param.name + "[i]") + ");\n";
+                        body += "        }\n";
+                        body += "    }\n";
+                    }
+                    break;
+                }
+                isBefore = body != "";
+            }
+        }
+
+        // Resetting a descriptor pool frees every descriptor set allocated from it.
+        if (body == "" && pBaseCommand->name == "vkResetDescriptorPool" && params.size() > 1) {
+            std::string objectType = vkbBuildGetHandleObjectType(context, params[1].type);
+            if (objectType != "") {
+                body = "    vkbObjectRegistryRemoveChildren(pInstall->pRegistry, " + objectType + ", " + vkbBuildHandleToU64(context, params[1].type, params[1].name) + ");\n";
+                isBefore = true;
+            }
+        }
+
+        if (body == "") {
+            continue;
+        }
+
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(command.name));
+
+        std::string declParams;
+        std::string callArgs;
+        for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+            declParams += ", " + params[iParam].typeC + " " + params[iParam].nameC;
+            if (iParam > 0) {
+                callArgs += ", ";
+            }
+            callArgs += params[iParam].name;
+        }
+
+        std::string code;
+        code += "static " + pBaseCommand->returnTypeC + " vkbObjectRegistryWrap_" + command.name + "(VkbObjectRegistryInstall* pInstall" + declParams + ")\n";
+        code += "{\n";
+        if (returnsValue) {
+            code += "    " + pBaseCommand->returnTypeC + " result;\n";
+            code += "\n";
+        }
+        if (isBefore) {
+            code += body;
+            code += "\n";
+        }
+        code += "    " + std::string(returnsValue ? "result = " : "") + "pInstall->next." + command.name + "(" + callArgs + ");\n";
+        if (!isBefore) {
+            code += "\n";
+            code += body;
+        }
+        if (returnsValue) {
+            code += "\n";
+            code += "    return result;\n";
+        }
+        code += "}\n";
+        code += "\n";
+
+        code += vkbBuildGenerateCode_C_InstallThunks("ObjectRegistry", "VKB_OBJECT_REGISTRY_MAX_INSTALLS", command.name, pBaseCommand->returnTypeC, declParams.substr(2), callArgs, "vkbObjectRegistryWrap_" + command.name, "");
+
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+
+        commandNames.push_back(command.name);
+        commandProtects.push_back(protect);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    vkbBuildGenerateCode_C_InstallFunctions("ObjectRegistry", commandNames, commandProtects, codeOut);
+
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_ObjectRegistry(VkbBuild &context, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    std::string currentProtect;
+    std::string cases;
+
+    for (size_t iType = 0; iType < context.types.size(); ++iType) {
+        const vkbBuildType &type = context.types[iType];
+        if (type.category != "handle" || type.alias != "" || type.objtypeenum == "" || !codegenState.HasOutputType(type.name)) {
+            continue;
+        }
+
+        vkbBuildHandleTraits traits;
+        vkbBuildGetHandleTraits(context, codegenState, type, traits);
+        if (traits.destroyCommand == "") {
+            continue;
+        }
+
+        size_t iDestroyCommand;
+        if (!vkbBuildFindCommandByName(context, traits.destroyCommand.c_str(), &iDestroyCommand)) {
+            continue;
+        }
+
+        // Handles arrive as 64-bit integers. The owner is the device or instance the destroy command takes first.
+        const std::vector<vkbBuildFunctionParameter> &params = context.commands[iDestroyCommand].parameters;
+        std::string ownerObjectType = "VK_OBJECT_TYPE_UNKNOWN";
+        std::string call;
+        std::vector<std::string> unusedParams;
+        if (params.size() == 2 && params[0].type == type.name && params[1].type == "VkAllocationCallbacks") {
+            call = "pAPI->" + traits.destroyCommand + "(" + vkbBuildHandleFromU64(context, type.name, "handle") + ", pAllocator)";
+            unusedParams.push_back("owner");
+            unusedParams.push_back("parent");
+        } else if (params.size() == 3 && params[1].type == type.name && params[2].type == "VkAllocationCallbacks") {
+            call = "pAPI->" + traits.destroyCommand + "(" + vkbBuildHandleFromU64(context, params[0].type, "owner") + ", " + vkbBuildHandleFromU64(context, type.name, "handle") + ", pAllocator)";
+            ownerObjectType = vkbBuildGetHandleObjectType(context, params[0].type);
+            unusedParams.push_back("parent");
+        } else if (params.size() == 4 && params[2].type == "uint32_t" && params[3].type == type.name && params[3].typeC == "const " + type.name + "*") {
+            // Pool allocations, such as vkFreeCommandBuffers. The parent is the pool.
+            call = "pAPI->" + traits.destroyCommand + "(" + vkbBuildHandleFromU64(context, params[0].type, "owner") + ", " + vkbBuildHandleFromU64(context, params[1].type, "parent") + ", 1, &object)";
+            ownerObjectType = vkbBuildGetHandleObjectType(context, params[0].type);
+            unusedParams.push_back("pAllocator");
+        }
+
+        if (call == "" || ownerObjectType == "") {
+            continue;
+        }
+
+        std::string procName = "vkbObjectRegistryDestroy_" + type.name;
+
+        std::string code;
+        code += "static VkBool32 " + procName + "(const VkbAPI* pAPI, uint64_t owner, uint64_t parent, uint64_t handle, const VkAllocationCallbacks* pAllocator)\n";
+        code += "{\n";
+        if (params.size() == 4) {
+            code += "    " + type.name + " object = " + vkbBuildHandleFromU64(context, type.name, "handle") + ";\n";
+            code += "\n";
+        }
+        for (size_t iUnused = 0; iUnused < unusedParams.size(); ++iUnused) {
+            code += "    (void)" + unusedParams[iUnused] + ";\n";
+        }
+        code += "\n";
+        code += "    if (pAPI->" + traits.destroyCommand + " == NULL) {\n";
+        code += "        return VK_FALSE;\n";
+        code += "    }\n";
+        code += "\n";
+        code += "    " + call + ";\n";
+        code += "    return VK_TRUE;\n";
+        code += "}\n";
+        code += "\n";
+
+        std::string protect = vkbBuildGetUnitProtect(context, codegenState.GetOutputUnit(traits.destroyCommand));
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+
+        if (protect != "") {
+            cases += "    #ifdef " + protect + "\n";
+        }
+        if (ownerObjectType != "VK_OBJECT_TYPE_UNKNOWN") {
+            cases += "    case " + type.objtypeenum + ": *pOwnerType = " + ownerObjectType + "; return " + procName + ";\n";
+        } else {
+            cases += "    case " + type.objtypeenum + ": return " + procName + ";\n";
+        }
+        if (protect != "") {
+            cases += "    #endif\n";
+        }
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    codeOut += "static VkbObjectRegistryDestroyProc vkbObjectRegistryGetDestroyProc(VkObjectType objectType, VkObjectType* pOwnerType)\n";
+    codeOut += "{\n";
+    codeOut += "    *pOwnerType = VK_OBJECT_TYPE_UNKNOWN;\n";
+    codeOut += "\n";
+    codeOut += "    switch (objectType)\n";
+    codeOut += "    {\n";
+    codeOut += cases;
+    codeOut += "    default: return NULL;\n";
+    codeOut += "    }\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    return vkbBuildGenerateCode_C_ObjectRegistryInstall(context, codegenState, codeOut);
+}
+
+// Retrieves a handle type with aliases resolved. Returns NULL if the type isn't a handle with a VkObjectType.
+vkbBuildType* vkbBuildFindObjectHandleType(vkbBuildDeepCopyState &state, const std::string &typeName)
+{
+    vkbBuildType* pType = vkbBuildFindDeepCopyType(state, typeName);
+    if (pType == NULL || pType->category != "handle" || pType->objtypeenum == "") {
+        return NULL;
+    }
+
+    return pType;
+}
+
+// The code for remapping a single handle. The handle is assigned to so it must be an lvalue.
+std::string vkbBuildCaptureRemapHandleCode(const vkbBuildType &handleType, const std::string &handle)
+{
+    std::string macro = (handleType.type == "VK_DEFINE_HANDLE") ? "VKB_CAPTURE_REMAP_DISPATCHABLE" : "VKB_CAPTURE_REMAP_NON_DISPATCHABLE";
+    return macro + "(pRemap, " + handleType.objtypeenum + ", " + handleType.name + ", " + handle + ");";
+}
+
+vkbBuildDeepCopyKind vkbBuildGetCaptureRemapKind(vkbBuildDeepCopyState &state, vkbBuildType &type);
+
+// The code for remapping the handles of a single struct. Empty if it has none.
+std::string vkbBuildCaptureRemapElementCode(vkbBuildDeepCopyState &state, vkbBuildType* pElementStruct, const std::string &element)
+{
+    if (pElementStruct == NULL) {
+        return "";
+    }
+
+    vkbBuildDeepCopyKind kind = vkbBuildGetCaptureRemapKind(state, *pElementStruct);
+    if (kind == VKB_DEEP_COPY_KIND_FUNCTION) {
+        return "vkbCaptureRemap_" + pElementStruct->name + "(pRemap, " + element + ");";
+    }
+    if (kind == VKB_DEEP_COPY_KIND_NEXT) {
+        return "vkbCaptureRemapNext(pRemap, " + element + ");";
+    }
+
+    return "";
+}
+
+/*
+Outputs the remapping of the handles in a single member of a copied struct, or an empty string if there's nothing to remap. Only
+members that are deep copied are followed because everything else still points to memory owned by the application. The pNext
+chain is handled separately.
+*/
+std::string vkbBuildGenerateCode_C_CaptureRemapMember(vkbBuildDeepCopyState &state, const vkbBuildStruct &structData, const vkbBuildStructMember &member)
+{
+    if (member.name == "pNext") {
+        return "";
+    }
+
+    std::string code;
+    std::string m = "pStruct->" + member.name;
+    size_t pointerCount = std::count(member.typeC.begin(), member.typeC.end(), '*');
+    vkbBuildType* pHandleType = vkbBuildFindObjectHandleType(state, member.type);
+
+    if (pointerCount == 0) {
+        if (pHandleType != NULL) {
+            if (member.nameC.find('[') != std::string::npos) {
+                code += "    {\n";
+                code += "        size_t i;\n";
+                code += "        for (i = 0; i < sizeof(" + m + ") / sizeof(" + m + "[0]); ++i) {\n";
+                code += "            " + vkbBuildCaptureRemapHandleCode(*pHandleType, m + "[i]") + "\n";
+                code += "        }\n";
+                code += "    }\n";
+            } else {
+                code += "    " + vkbBuildCaptureRemapHandleCode(*pHandleType, m) + "\n";
+            }
+            return code;
+        }
+    }
+
+    // Members that weren't followed when copying were set to NULL in the copy so their conditions don't need to be checked again.
+    vkbBuildDeepCopyPlan plan;
+    if (!vkbBuildGetDeepCopyPlan(state, "", structData, member, plan)) {
+        return "";
+    }
+
+    std::string count = vkbReplaceAll(plan.count, "pSrc->", "pStruct->");
+
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_VALUE) {
+        std::string elementCode = vkbBuildCaptureRemapElementCode(state, plan.pElementStruct, "&" + m);
+        if (elementCode != "") {
+            code += "    " + elementCode + "\n";
+        }
+        return code;
+    }
+
+    if (plan.shape == VKB_DEEP_COPY_SHAPE_ARRAY || plan.shape == VKB_DEEP_COPY_SHAPE_POINTER_ARRAY) {
+        bool isPointerArray = plan.shape == VKB_DEEP_COPY_SHAPE_POINTER_ARRAY;
+        std::string elements = (isPointerArray || count != "") ? "pElements" : "pElement";
+        std::string element = isPointerArray ? "ppElements[i]" : ((count != "") ? "&pElements[i]" : "pElement");
+        std::string elementCode;
+        if (pHandleType != NULL) {
+            elementCode = vkbBuildCaptureRemapHandleCode(*pHandleType, isPointerArray ? "*ppElements[i]" : "pElements[i]");
+        } else {
+            elementCode = vkbBuildCaptureRemapElementCode(state, plan.pElementStruct, element);
+        }
+        if (elementCode == "") {
+            return "";
+        }
+
+        // The copies are in the stream so it's safe to cast away the const.
+        code += "    if (" + m + " != NULL) {\n";
+        if (isPointerArray) {
+            code += "        " + member.type + "* const* ppElements = (" + member.type + "* const*)" + m + ";\n";
+        } else {
+            code += "        " + member.type + "* " + elements + " = (" + member.type + "*)" + m + ";\n";
+        }
+        if (count != "") {
+            code += "        size_t i;\n";
+            code += "        for (i = 0; i < (size_t)(" + count + "); ++i) {\n";
+            if (isPointerArray) {
+                code += "            if (ppElements[i] != NULL) {\n";
+                code += "                " + elementCode + "\n";
+                code += "            }\n";
+            } else {
+                code += "            " + elementCode + "\n";
+            }
+            code += "        }\n";
+        } else {
+            code += "        " + elementCode + "\n";
+        }
+        code += "    }\n";
+    }
+
+    return code;
+}
+
+vkbBuildDeepCopyKind vkbBuildGetCaptureRemapKind(vkbBuildDeepCopyState &state, vkbBuildType &type)
+{
+    if (type.category != "struct") {
+        return VKB_DEEP_COPY_KIND_NONE;   // Unions are left as is because there's no way to know which member is active.
+    }
+
+    for (size_t iKind = 0; iKind < state.remapKindNames.size(); ++iKind) {
+        if (state.remapKindNames[iKind] == type.name) {
+            return state.remapKinds[iKind];
+        }
+    }
+
+    // Nothing is assumed while working it out so structs that point to each other don't recurse forever.
+    size_t iKind = state.remapKindNames.size();
+    state.remapKindNames.push_back(type.name);
+    state.remapKinds.push_back(VKB_DEEP_COPY_KIND_NONE);
+
+    vkbBuildDeepCopyKind kind = VKB_DEEP_COPY_KIND_NONE;
+    for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+        const vkbBuildStructMember &member = type.structData.members[iMember];
+        if (vkbBuildGenerateCode_C_CaptureRemapMember(state, type.structData, member) != "") {
+            kind = VKB_DEEP_COPY_KIND_FUNCTION;
+            break;
+        }
+        if (member.name == "pNext") {
+            kind = VKB_DEEP_COPY_KIND_NEXT;
+        }
+    }
+
+    state.remapKinds[iKind] = kind;
+    return kind;
+}
+
+/*
+Outputs what VkbCommandStream needs for saving, loading and remapping handles. vkbCaptureGetCommandInfo() gives the size of the
+arguments of each opcode and the function that copies what they point to, which is how vkbCommandStreamSave() records a stream
+again. Each struct with handles gets vkbCaptureRemap_<Struct>() which remaps them in place, including those in nested structs and
+arrays that were deep copied, and vkbCaptureRemapCommand() does the same for the arguments of each command. The pNext chain is
+followed with vkbCaptureRemapStruct() which dispatches on sType.
+*/
+VkbResult vkbBuildGenerateCode_C_Capture(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, vkbBuildCodeGenState &videoCodegenState, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+    std::vector<vkbBuildStruct> commandArgs;
+    std::vector<std::vector<bool> > commandPlans;
+    vkbBuildGetCommandStreamCommands(vk, codegenState, state, commandNames, commandProtects, commandArgs, commandPlans);
+
+    std::string currentProtect;
+
+    codeOut += "static VkResult vkbCaptureGetCommandInfo(uint32_t opcode, size_t* pArgsSize, VkbCommandStreamCopyProc* pOnCopy)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (opcode)\n";
+    codeOut += "    {\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const std::vector<bool> &plans = commandPlans[iCommand];
+        bool hasCopy = std::find(plans.begin(), plans.end(), true) != plans.end();
+
+        std::string code;
+        code += "        case VKB_COMMAND_STREAM_OPCODE_" + name + ": *pArgsSize = sizeof(VkbCommand_" + name + "); *pOnCopy = " + (hasCopy ? "vkbCommandStreamCopy_" + name : std::string("NULL")) + "; break;\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: return VK_ERROR_INITIALIZATION_FAILED;    /* Corrupt stream, or recorded with a different build. */\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    return VK_SUCCESS;\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    std::vector<vkbBuildType*> functionTypes;
+    std::vector<std::string> functionProtects;
+    VkbBuild* pContexts[2] = {&vk, &video};
+    for (size_t iContext = 0; iContext < 2; ++iContext) {
+        VkbBuild &context = *pContexts[iContext];
+        for (size_t iType = 0; iType < context.types.size(); ++iType) {
+            vkbBuildType &type = context.types[iType];
+            if (type.category != "struct" || type.alias != "") {
+                continue;
+            }
+
+            if (iContext == 0) {
+                if (!codegenState.HasOutputType(type.name)) {
+                    continue;
+                }
+            } else {
+                if (!videoCodegenState.HasOutputType(type.name)) {
+                    continue;
+                }
+            }
+
+            if (vkbBuildGetCaptureRemapKind(state, type) == VKB_DEEP_COPY_KIND_FUNCTION) {
+                functionTypes.push_back(&type);
+                functionProtects.push_back((iContext == 0) ? vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(type.name)) : "VKBIND_ENABLE_VIDEO");
+            }
+        }
+    }
+
+    // Prototypes first because structs can point to each other.
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        const std::string &name = functionTypes[iFunction]->name;
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], "static void vkbCaptureRemap_" + name + "(VkbCaptureRemap* pRemap, " + name + "* pStruct);\n", currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "\n", currentProtect, codeOut);
+
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        vkbBuildType &type = *functionTypes[iFunction];
+        std::string function;
+
+        function += "static void vkbCaptureRemap_" + type.name + "(VkbCaptureRemap* pRemap, " + type.name + "* pStruct)\n";
+        function += "{\n";
+        for (size_t iMember = 0; iMember < type.structData.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = type.structData.members[iMember];
+            if (member.name == "pNext") {
+                function += "    vkbCaptureRemapNext(pRemap, pStruct);\n";
+            } else {
+                function += vkbBuildGenerateCode_C_CaptureRemapMember(state, type.structData, member);
+            }
+        }
+        function += "}\n";
+        function += "\n";
+
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], function, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    // Dispatching for pNext chains. Only structs with an sType can be in a chain.
+    std::vector<std::string> caseValues;
+    codeOut += "static void vkbCaptureRemapStruct(VkbCaptureRemap* pRemap, VkbBaseStructure* pStruct)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (pStruct->sType)\n";
+    codeOut += "    {\n";
+    for (size_t iFunction = 0; iFunction < functionTypes.size(); ++iFunction) {
+        const std::string &name = functionTypes[iFunction]->name;
+        std::string value = vkbBuildGetStructTypeValue(vk, name, NULL);
+        if (value == "" || vkbContains(caseValues, value)) {
+            continue;
+        }
+        caseValues.push_back(value);
+
+        vkbBuildAppendGuardedLine(functionProtects[iFunction], "        case " + value + ": vkbCaptureRemap_" + name + "(pRemap, (" + name + "*)pStruct); break;\n", currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: vkbCaptureRemapNext(pRemap, pStruct); break;\n";
+    codeOut += "    }\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    // Commands without handles don't need a case.
+    codeOut += "static void vkbCaptureRemapCommand(VkbCaptureRemap* pRemap, VkbCommandStreamHeader* pHeader)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (pHeader->opcode)\n";
+    codeOut += "    {\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildStruct &args = commandArgs[iCommand];
+
+        std::string members;
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            members += vkbBuildGenerateCode_C_CaptureRemapMember(state, args, args.members[iMember]);
+        }
+        if (members == "") {
+            continue;
+        }
+
+        std::string code;
+        code += "        case VKB_COMMAND_STREAM_OPCODE_" + name + ":\n";
+        code += "        {\n";
+        code += "            VkbCommand_" + name + "* pStruct = (VkbCommand_" + name + "*)pHeader;\n";
+        code += "        " + vkbReplaceAll(members, "\n    ", "\n            ");    // The member code is indented for a function body.
+        code += "        } break;\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: break;\n";
+    codeOut += "    }\n";
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+// Retrieves the name of the pointer parameter that gives the length of a parameter, such as pDataSize for vkGetPipelineCacheData().
+std::string vkbBuildGetCaptureCountPointer(const vkbBuildStruct &args, const vkbBuildStructMember &member)
+{
+    std::vector<std::string> lens = vkbSplitString(member.len, ",");
+    if (lens.size() == 0) {
+        return "";
+    }
+
+    for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+        if (args.members[iMember].name == lens[0] && args.members[iMember].typeC.find('*') != std::string::npos) {
+            return lens[0];
+        }
+    }
+
+    return "";
+}
+
+/*
+Works out how a parameter of a captured call is copied. This is the same as for command streams, except that output parameters are
+included. They're copied after the call so they hold what it returned. Lengths given by a pointer, as with two-call enumeration,
+use the value it points to, and single scalars like the handle returned by vkCreateBuffer() are copied even though they don't have a
+length. Returns false for parameters that are recorded as NULL.
+*/
+bool vkbBuildGetCapturePlan(vkbBuildDeepCopyState &state, const vkbBuildStruct &args, const vkbBuildStructMember &member, vkbBuildDeepCopyPlan &planOut)
+{
+    size_t pointerCount = std::count(member.typeC.begin(), member.typeC.end(), '*');
+    if (pointerCount == 0 || member.type == "VkAllocationCallbacks") {
+        return false;   // Allocation callbacks belong to the process that made the call.
+    }
+
+    if (vkbBuildGetDeepCopyPlan(state, "", args, member, planOut)) {
+        std::string countPointer = vkbBuildGetCaptureCountPointer(args, member);
+        if (countPointer != "") {
+            planOut.count = "((pSrc->" + countPointer + " != NULL) ? *pSrc->" + countPointer + " : 0)";
+        }
+        return true;
+    }
+
+    if (pointerCount == 1 && member.typeC.find("const") != 0 && member.len == "" && vkbBuildIsDeepCopyScalarType(vkbBuildFindDeepCopyType(state, member.type))) {
+        planOut.shape = VKB_DEEP_COPY_SHAPE_ARRAY;
+        planOut.count = "";
+        planOut.condition = "";
+        planOut.pElementStruct = NULL;
+        planOut.isVoid = false;
+        return true;
+    }
+
+    return false;
+}
+
+// Outputs a statement that hooks into a captured or replayed call, with the condition it's run under if it has one.
+std::string vkbBuildCaptureHookCode(const std::string &condition, const std::string &statement, const std::string &indent)
+{
+    if (condition == "") {
+        return indent + statement + "\n";
+    }
+
+    return indent + "if (" + condition + ") {\n" + indent + "    " + statement + "\n" + indent + "}\n";
+}
+
+// A handle, or array of handles, returned by a captured call.
+struct vkbBuildCaptureOutput
+{
+    std::string name;
+    std::string count;          // A C expression for the number of handles, using "pStruct->". "1" for a single handle.
+    const vkbBuildType* pType;
+};
+
+/*
+Outputs everything vkbBeginCapture() and vkbReplayCapture() need for each command. Every command in VkbAPI, other than
+vkGetInstanceProcAddr() and vkGetDeviceProcAddr(), gets an opcode, a structure holding its arguments and result after a
+VkbCaptureCallHeader, and vkbCapture_<Command>() which makes the call and then records it. Copying is done with the deep copy code
+like command streams. The commands that map, unmap and free memory, and those that let the device see what's in mapped memory,
+also call into the tracking of mapped memory.
+
+vkbCaptureReplayCall() makes a recorded call with its handles remapped. The handles a call returns are added to the table used for
+remapping so later calls use the handles returned by the replay. Memory mapped by the replay is tracked so recorded changes to
+mapped memory can be applied to it.
+
+The opcodes are not guarded by platform macros so a given header always uses the same values.
+*/
+VkbResult vkbBuildGenerateCode_C_CaptureCalls(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+    std::vector<const vkbBuildCommand*> commands;      // The base command, for the parameters.
+    for (size_t iCommand = 0; iCommand < vk.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = vk.commands[iCommand];
+        if (!codegenState.HasOutputCommand(command.name) || command.name == "vkGetInstanceProcAddr" || command.name == "vkGetDeviceProcAddr") {
+            continue;
+        }
+
+        // Aliases get their own wrapper since they're called through their own function pointer.
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(vk, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &vk.commands[iBaseCommand];
+        }
+
+        commandNames.push_back(command.name);
+        commandProtects.push_back(vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(command.name)));
+        commands.push_back(pBaseCommand);
+    }
+
+    std::string currentProtect;
+
+    codeOut += "typedef enum\n";
+    codeOut += "{\n";
+    codeOut += "    VKB_CAPTURE_OPCODE_NONE = 0,\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        codeOut += "    VKB_CAPTURE_OPCODE_" + commandNames[iCommand] + ((iCommand == 0) ? " = VKB_CAPTURE_OPCODE_MEMORY + 1" : "") + ",\n";
+    }
+    codeOut += "    VKB_CAPTURE_OPCODE_COUNT" + std::string((commandNames.size() == 0) ? " = VKB_CAPTURE_OPCODE_MEMORY + 1" : "") + "\n";
+    codeOut += "} VkbCaptureOpcode;\n";
+    codeOut += "\n";
+
+    std::vector<bool> commandHasCopy;
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildCommand &command = *commands[iCommand];
+        const std::string &baseName = command.name;
+        bool returnsValue = command.returnType != "void";
+
+        vkbBuildStruct args;
+        for (size_t iParam = 0; iParam < command.parameters.size(); ++iParam) {
+            const vkbBuildFunctionParameter &param = command.parameters[iParam];
+
+            vkbBuildStructMember member;
+            member.typeC  = param.typeC;
+            member.type   = param.type;
+            member.nameC  = param.nameC;
+            member.name   = param.name;
+            member.len    = param.len;
+            member.altlen = param.altlen;
+            args.members.push_back(member);
+        }
+
+        std::vector<bool> plans;
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            vkbBuildDeepCopyPlan plan;
+            plans.push_back(vkbBuildGetCapturePlan(state, args, args.members[iMember], plan));
+        }
+        bool hasCopy = std::find(plans.begin(), plans.end(), true) != plans.end();
+        commandHasCopy.push_back(hasCopy);
+
+        // Calls that release handles are ordered by when they're made rather than when they return. See vkbCaptureReserveSequence().
+        bool isRelease = baseName.find("vkDestroy") == 0 || baseName.find("vkFree") == 0 || baseName.find("vkRelease") == 0 || baseName == "vkResetDescriptorPool";
+
+        // Mapped memory is compared before the device can see it, and when it's unmapped.
+        std::string preHook;
+        std::string postHook;
+        if (baseName == "vkFreeMemory") {
+            preHook = vkbBuildCaptureHookCode("", "vkbCaptureFreed(memory);", "    ");
+        }
+        if (baseName == "vkUnmapMemory") {
+            preHook = vkbBuildCaptureHookCode("", "vkbCaptureUnmapped(memory);", "    ");
+        }
+        if (baseName == "vkUnmapMemory2" || baseName == "vkUnmapMemory2KHR") {
+            preHook = vkbBuildCaptureHookCode("pMemoryUnmapInfo != NULL", "vkbCaptureUnmapped(pMemoryUnmapInfo->memory);", "    ");
+        }
+        if (baseName == "vkQueueSubmit" || baseName == "vkQueueSubmit2" || baseName == "vkQueueSubmit2KHR" || baseName == "vkQueueBindSparse" || baseName == "vkFlushMappedMemoryRanges") {
+            preHook = vkbBuildCaptureHookCode("", "vkbCaptureFlushMapped();", "    ");
+        }
+        if (baseName == "vkAllocateMemory") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS", "vkbCaptureAllocated(*pMemory, pAllocateInfo->allocationSize);", "    ");
+        }
+        if (baseName == "vkMapMemory") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS", "vkbCaptureMapped(memory, offset, size, *ppData);", "    ");
+        }
+        if (baseName == "vkMapMemory2" || baseName == "vkMapMemory2KHR") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS", "vkbCaptureMapped(pMemoryMapInfo->memory, pMemoryMapInfo->offset, pMemoryMapInfo->size, *ppData);", "    ");
+        }
+
+        std::string code;
+        code += "typedef struct\n";
+        code += "{\n";
+        code += "    VkbCaptureCallHeader header;\n";
+        if (returnsValue) {
+            code += "    " + command.returnTypeC + " result;\n";
+        }
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = args.members[iMember];
+
+            // Fixed size arrays, like blendConstants[4], are copied into the structure so they can't be const.
+            std::string typeC = member.typeC;
+            if (member.nameC.find('[') != std::string::npos && typeC.find("const ") == 0) {
+                typeC = typeC.substr(6);
+            }
+
+            code += "    " + typeC + " " + member.nameC + ";\n";
+        }
+        code += "} VkbCaptureArgs_" + name + ";\n";
+        code += "\n";
+
+        if (hasCopy) {
+            code += "static void vkbCaptureCopy_" + name + "(VkbDeepCopyArena* pArena, const VkbCommandStreamHeader* pArgs, VkbCommandStreamHeader* pCommand)\n";
+            code += "{\n";
+            code += "    const VkbCaptureArgs_" + name + "* pSrc = (const VkbCaptureArgs_" + name + "*)pArgs;\n";
+            code += "    VkbCaptureArgs_" + name + "* pDst = (VkbCaptureArgs_" + name + "*)pCommand;\n";
+            code += "\n";
+            for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+                vkbBuildDeepCopyPlan plan;
+                if (plans[iMember] && vkbBuildGetCapturePlan(state, args, args.members[iMember], plan)) {
+                    code += vkbBuildGenerateCode_C_DeepCopyMember(state, args.members[iMember], plan);
+                }
+            }
+            code += "}\n";
+            code += "\n";
+        }
+
+        std::string callArgs;
+        code += "static VKAPI_ATTR " + command.returnTypeC + " VKAPI_CALL vkbCapture_" + name + "(";
+        for (size_t iParam = 0; iParam < command.parameters.size(); ++iParam) {
+            if (iParam > 0) {
+                code += ", ";
+                callArgs += ", ";
+            }
+            code += command.parameters[iParam].typeC + " " + command.parameters[iParam].nameC;
+            callArgs += command.parameters[iParam].name;
+        }
+        if (command.parameters.size() == 0) {
+            code += "void";
+        }
+        code += ")\n";
+        code += "{\n";
+        code += "    VkbCaptureArgs_" + name + " args;\n";
+        if (returnsValue) {
+            code += "    " + command.returnTypeC + " result;\n";
+        }
+        code += "\n";
+        if (isRelease) {
+            code += "    memset(&args, 0, sizeof(args));\n";
+            code += "    args.header.sequence = vkbCaptureReserveSequence();\n";
+            code += "\n";
+        }
+        code += preHook;
+        code += "    " + std::string(returnsValue ? "result = " : "") + "g_vkbCaptureNext." + name + "(" + callArgs + ");\n";
+        code += postHook;
+        code += "\n";
+        if (!isRelease) {
+            code += "    memset(&args, 0, sizeof(args));\n";
+        }
+        code += "    args.header.stream.opcode = VKB_CAPTURE_OPCODE_" + name + ";\n";
+        if (returnsValue) {
+            code += "    args.result = result;\n";
+        }
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = args.members[iMember];
+            if (member.nameC.find('[') != std::string::npos) {
+                code += "    memcpy(args." + member.name + ", " + member.name + ", sizeof(args." + member.name + "));\n";
+            } else if (member.typeC.find('*') == std::string::npos || plans[iMember]) {
+                code += "    args." + member.name + " = " + member.name + ";\n";
+            }
+        }
+        code += "    vkbCaptureRecord(&args.header, sizeof(args), " + (hasCopy ? "vkbCaptureCopy_" + name : std::string("NULL")) + ");\n";
+        if (returnsValue) {
+            code += "\n";
+            code += "    return result;\n";
+        }
+        code += "}\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    codeOut += "static VkResult vkbCaptureCallGetInfo(uint32_t opcode, size_t* pArgsSize, VkbCommandStreamCopyProc* pOnCopy)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (opcode)\n";
+    codeOut += "    {\n";
+    codeOut += "        case VKB_CAPTURE_OPCODE_MEMORY: *pArgsSize = sizeof(VkbCaptureMemoryUpdate); *pOnCopy = vkbCaptureCopyMemoryUpdate; break;\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string code = "        case VKB_CAPTURE_OPCODE_" + name + ": *pArgsSize = sizeof(VkbCaptureArgs_" + name + "); *pOnCopy = " + (commandHasCopy[iCommand] ? "vkbCaptureCopy_" + name : std::string("NULL")) + "; break;\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: return VK_ERROR_INITIALIZATION_FAILED;    /* Corrupt capture, or recorded with a different build. */\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    return VK_SUCCESS;\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    codeOut += "static VkResult vkbCaptureReplayCall(VkbCaptureReplay* pReplay, VkbAPI* pAPI, VkbCaptureCallHeader* pHeader)\n";
+    codeOut += "{\n";
+    codeOut += "    switch (pHeader->stream.opcode)\n";
+    codeOut += "    {\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        const vkbBuildCommand &command = *commands[iCommand];
+        const std::string &baseName = command.name;
+
+        vkbBuildStruct args;
+        for (size_t iParam = 0; iParam < command.parameters.size(); ++iParam) {
+            const vkbBuildFunctionParameter &param = command.parameters[iParam];
+
+            vkbBuildStructMember member;
+            member.typeC  = param.typeC;
+            member.type   = param.type;
+            member.nameC  = param.nameC;
+            member.name   = param.name;
+            member.len    = param.len;
+            member.altlen = param.altlen;
+            args.members.push_back(member);
+        }
+
+        // Inputs are remapped before the call. Outputs are overwritten by the call so they're kept for adding to the table.
+        std::string remap;
+        std::vector<vkbBuildCaptureOutput> outputs;
+        bool hasMappedData = false;
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            const vkbBuildStructMember &member = args.members[iMember];
+            size_t pointerCount = std::count(member.typeC.begin(), member.typeC.end(), '*');
+
+            if (member.typeC == "void**") {
+                hasMappedData = true;
+                continue;
+            }
+
+            vkbBuildDeepCopyPlan plan;
+            if (pointerCount > 0 && !vkbBuildGetCapturePlan(state, args, member, plan)) {
+                continue;
+            }
+
+            if (pointerCount == 0 || member.typeC.find("const") == 0) {
+                if (vkbBuildGetCaptureCountPointer(args, member) == "") {
+                    remap += vkbBuildGenerateCode_C_CaptureRemapMember(state, args, member);
+                }
+                continue;
+            }
+
+            vkbBuildType* pHandleType = vkbBuildFindObjectHandleType(state, member.type);
+            if (pointerCount == 1 && pHandleType != NULL) {
+                vkbBuildCaptureOutput output;
+                output.name = member.name;
+                output.count = (plan.count != "") ? vkbReplaceAll(plan.count, "pSrc->", "pStruct->") : "1";
+                output.pType = pHandleType;
+                outputs.push_back(output);
+            }
+        }
+
+        std::string postHook;
+        if (baseName == "vkFreeMemory" || baseName == "vkUnmapMemory") {
+            postHook = vkbBuildCaptureHookCode("", "vkbCaptureReplayUnmapped(pReplay, pStruct->memory);", "            ");
+        }
+        if (baseName == "vkUnmapMemory2" || baseName == "vkUnmapMemory2KHR") {
+            postHook = vkbBuildCaptureHookCode("pStruct->pMemoryUnmapInfo != NULL", "vkbCaptureReplayUnmapped(pReplay, pStruct->pMemoryUnmapInfo->memory);", "            ");
+        }
+        if (baseName == "vkMapMemory") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS", "vkbCaptureReplayMapped(pReplay, pStruct->memory, pStruct->offset, pMappedData);", "            ");
+        }
+        if (baseName == "vkMapMemory2" || baseName == "vkMapMemory2KHR") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS && pStruct->pMemoryMapInfo != NULL", "vkbCaptureReplayMapped(pReplay, pStruct->pMemoryMapInfo->memory, pStruct->pMemoryMapInfo->offset, pMappedData);", "            ");
+        }
+        // Loading the functions of the new instance or device is what the application would have done next.
+        if (baseName == "vkCreateInstance") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS && pAPI->vkGetInstanceProcAddr != NULL", "vkbInitInstanceAPI(*pStruct->pInstance, pAPI);", "            ");
+        }
+        if (baseName == "vkCreateDevice") {
+            postHook = vkbBuildCaptureHookCode("result == VK_SUCCESS && pAPI->vkGetDeviceProcAddr != NULL", "vkbInitDeviceAPI(*pStruct->pDevice, pAPI);", "            ");
+        }
+
+        bool isResult = command.returnType == "VkResult";
+        bool needsResult = isResult && (outputs.size() > 0 || postHook.find("result") != std::string::npos);
+
+        std::string code;
+        code += "        case VKB_CAPTURE_OPCODE_" + name + ":\n";
+        code += "        {\n";
+        code += "            VkbCaptureArgs_" + name + "* pStruct = (VkbCaptureArgs_" + name + "*)pHeader;\n";
+        if (remap != "") {
+            code += "            VkbCaptureRemap* pRemap = &pReplay->remap;\n";
+        }
+        if (needsResult) {
+            code += "            VkResult result;\n";
+        }
+        if (hasMappedData) {
+            code += "            void* pMappedData = NULL;\n";
+        }
+        for (size_t iOutput = 0; iOutput < outputs.size(); ++iOutput) {
+            char indexString[32];
+            snprintf(indexString, sizeof(indexString), "%d", (int)iOutput);
+            std::string index = indexString;
+            code += "            " + outputs[iOutput].pType->name + "* pCaptured" + index + ";\n";
+            code += "            size_t capturedCount" + index + ";\n";
+        }
+        code += "\n";
+        code += "            if (pAPI->" + name + " == NULL) {\n";
+        code += "                return VK_ERROR_INITIALIZATION_FAILED;\n";
+        code += "            }\n";
+        code += "\n";
+        for (size_t iOutput = 0; iOutput < outputs.size(); ++iOutput) {
+            const vkbBuildCaptureOutput &output = outputs[iOutput];
+            char indexString[32];
+            snprintf(indexString, sizeof(indexString), "%d", (int)iOutput);
+            std::string index = indexString;
+            code += "            capturedCount" + index + " = (pStruct->" + output.name + " != NULL) ? (size_t)(" + output.count + ") : 0;\n";
+            code += "            pCaptured" + index + " = (" + output.pType->name + "*)vkbCaptureReplayCopy(pReplay, pStruct->" + output.name + ", sizeof(" + output.pType->name + ") * capturedCount" + index + ");\n";
+        }
+        if (remap != "") {
+            code += "        " + vkbReplaceAll(remap, "\n    ", "\n            ");    // The member code is indented for a function body.
+        }
+        code += "            " + std::string(needsResult ? "result = " : "") + "pAPI->" + name + "(";
+        for (size_t iMember = 0; iMember < args.members.size(); ++iMember) {
+            if (iMember > 0) {
+                code += ", ";
+            }
+            code += (args.members[iMember].typeC == "void**") ? "&pMappedData" : "pStruct->" + args.members[iMember].name;
+        }
+        code += ");\n";
+        if (outputs.size() > 0) {
+            std::string indent = "            ";
+            if (isResult) {
+                code += "            if (result >= VK_SUCCESS) {\n";
+                indent += "    ";
+            }
+            for (size_t iOutput = 0; iOutput < outputs.size(); ++iOutput) {
+                const vkbBuildCaptureOutput &output = outputs[iOutput];
+                std::string macro = (output.pType->type == "VK_DEFINE_HANDLE") ? "VKB_U64_FROM_DISPATCHABLE" : "VKB_U64_FROM_NON_DISPATCHABLE";
+                char indexString[32];
+                snprintf(indexString, sizeof(indexString), "%d", (int)iOutput);
+                std::string index = indexString;
+                code += indent + "if (pCaptured" + index + " != NULL) {\n";
+                code += indent + "    size_t replayedCount = (size_t)(" + output.count + ");\n";
+                code += indent + "    size_t i;\n";
+                code += indent + "    for (i = 0; i < capturedCount" + index + " && i < replayedCount; ++i) {\n";
+                code += indent + "        vkbCaptureReplayMapHandle(pReplay, " + output.pType->objtypeenum + ", " + macro + "(pCaptured" + index + "[i]), " + macro + "(pStruct->" + output.name + "[i]));\n";
+                code += indent + "    }\n";
+                code += indent + "}\n";
+            }
+            if (isResult) {
+                code += "            }\n";
+            }
+        }
+        code += postHook;
+        code += "        } break;\n";
+        code += "\n";
+
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    codeOut += "        default: return VK_ERROR_INITIALIZATION_FAILED;    /* Corrupt capture, or recorded with a different build. */\n";
+    codeOut += "    }\n";
+    codeOut += "\n";
+    codeOut += "    (void)pReplay;\n";
+    codeOut += "    return VK_SUCCESS;\n";
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    codeOut += "static void vkbCaptureInstallAPI(VkbAPI* pAPI)\n";
+    codeOut += "{\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string code;
+        code += "    if (pAPI->" + name + " != NULL && pAPI->" + name + " != vkbCapture_" + name + ") {\n";
+        code += "        g_vkbCaptureNext." + name + " = pAPI->" + name + ";\n";
+        code += "        pAPI->" + name + " = vkbCapture_" + name + ";\n";
+        code += "    }\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    if (commandNames.size() == 0) {
+        codeOut += "    (void)pAPI;\n";
+    }
+    codeOut += "}\n";
+    codeOut += "\n";
+
+    codeOut += "static void vkbCaptureUninstallAPI(VkbAPI* pAPI)\n";
+    codeOut += "{\n";
+    for (size_t iCommand = 0; iCommand < commandNames.size(); ++iCommand) {
+        const std::string &name = commandNames[iCommand];
+        std::string code;
+        code += "    if (pAPI->" + name + " == vkbCapture_" + name + ") {\n";
+        code += "        pAPI->" + name + " = g_vkbCaptureNext." + name + ";\n";
+        code += "    }\n";
+        vkbBuildAppendGuardedLine(commandProtects[iCommand], code, currentProtect, codeOut);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    if (commandNames.size() == 0) {
+        codeOut += "    (void)pAPI;\n";
+    }
+    codeOut += "}";
+
+    return VKB_SUCCESS;
+}
+
+// A handle that a command requires to be externally synchronized.
+struct vkbBuildExternSyncHandle
+{
+    std::string expression;     // The externsync expression, or the name of the parameter when it's "true". Used in reports.
+    std::string check;          // A C condition that has to be true before the handle can be accessed. Empty if none.
+    std::string count;          // A C expression for the number of handles when it's an array. Empty for a single handle.
+    std::string handle;         // A C expression for the handle. Uses "i" as the index for arrays.
+    const vkbBuildType* pType;
+};
+
+/*
+Works out the handles of a command that are externally synchronized. These are parameters with externsync="true", arrays of them,
+and members of a structure parameter such as "pAllocateInfo->commandPool" or "pSubmits[].fence". Anything deeper than that, such as
+"pBindInfo[].pBufferBinds[].buffer", and handles without a VkObjectType are not checked.
+*/
+void vkbBuildGetExternSyncHandles(vkbBuildDeepCopyState &state, const vkbBuildCommand &command, std::vector<vkbBuildExternSyncHandle> &handlesOut)
+{
+    for (size_t iParam = 0; iParam < command.parameters.size(); ++iParam) {
+        const vkbBuildFunctionParameter &param = command.parameters[iParam];
+        if (param.externsync == "") {
+            continue;
+        }
+
+        size_t pointerCount = std::count(param.typeC.begin(), param.typeC.end(), '*');
+        std::vector<std::string> lens = vkbSplitString(param.len, ",");
+        bool hasCount = lens.size() > 0 && lens[0] != "null-terminated" && lens[0].find("latexmath") != 0;
+
+        if (param.externsync == "true") {
+            vkbBuildType* pType = vkbBuildFindObjectHandleType(state, param.type);
+            if (pType == NULL) {
+                continue;
+            }
+
+            vkbBuildExternSyncHandle handle;
+            handle.expression = param.name;
+            handle.pType = pType;
+            if (pointerCount == 0) {
+                handle.handle = param.name;
+            } else if (pointerCount == 1 && hasCount) {
+                handle.check = param.name + " != NULL";
+                handle.count = lens[0];
+                handle.handle = param.name + "[i]";
+            } else {
+                continue;
+            }
+
+            handlesOut.push_back(handle);
+            continue;
+        }
+
+        // Expressions referring to members of a structure parameter. There can be several separated by commas.
+        vkbBuildType* pStructType = vkbBuildFindDeepCopyType(state, param.type);
+        if (pStructType == NULL || pStructType->category != "struct" || pointerCount != 1) {
+            continue;
+        }
+
+        std::vector<std::string> expressions = vkbSplitString(param.externsync, ",");
+        for (size_t iExpression = 0; iExpression < expressions.size(); ++iExpression) {
+            std::string expression = vkbTrim(expressions[iExpression]);
+            std::string arrow = param.name + "->";
+            std::string brackets = param.name + "[].";
+
+            std::string memberName;
+            bool isArray = false;
+            if (expression.find(arrow) == 0) {
+                memberName = expression.substr(arrow.size());
+            } else if (expression.find(brackets) == 0 && hasCount) {
+                memberName = expression.substr(brackets.size());
+                isArray = true;
+            } else {
+                continue;
+            }
+
+            const vkbBuildStructMember* pMember = NULL;
+            for (size_t iMember = 0; iMember < pStructType->structData.members.size(); ++iMember) {
+                if (pStructType->structData.members[iMember].name == memberName && pStructType->structData.members[iMember].typeC.find('*') == std::string::npos && pStructType->structData.members[iMember].nameC.find('[') == std::string::npos) {
+                    pMember = &pStructType->structData.members[iMember];
+                    break;
+                }
+            }
+            if (pMember == NULL) {
+                continue;
+            }
+
+            vkbBuildType* pType = vkbBuildFindObjectHandleType(state, pMember->type);
+            if (pType == NULL) {
+                continue;
+            }
+
+            vkbBuildExternSyncHandle handle;
+            handle.expression = expression;
+            handle.check = param.name + " != NULL";
+            handle.pType = pType;
+            if (isArray) {
+                handle.count = lens[0];
+                handle.handle = param.name + "[i]." + memberName;
+            } else {
+                handle.handle = param.name + "->" + memberName;
+            }
+
+            handlesOut.push_back(handle);
+        }
+    }
+}
+
+// Outputs the code for claiming or releasing each of the handles of a command.
+std::string vkbBuildGenerateCode_C_ExternSyncHandles(const std::vector<vkbBuildExternSyncHandle> &handles, bool claim)
+{
+    std::string code;
+    for (size_t iHandle = 0; iHandle < handles.size(); ++iHandle) {
+        const vkbBuildExternSyncHandle &handle = handles[iHandle];
+
+        char indexStr[32];
+        snprintf(indexStr, sizeof(indexStr), "%d", (int)iHandle);
+
+        std::string value = ((handle.pType->type == "VK_DEFINE_HANDLE") ? "VKB_U64_FROM_DISPATCHABLE(" : "VKB_U64_FROM_NON_DISPATCHABLE(") + handle.handle + ")";
+        std::string call;
+        if (claim) {
+            call = "vkbExternSyncClaim(&call, &sites[" + std::string(indexStr) + "], " + handle.pType->objtypeenum + ", " + value + ");\n";
+        } else {
+            call = "vkbExternSyncRelease(&call, " + handle.pType->objtypeenum + ", " + value + ");\n";
+        }
+
+        std::string indentation = "    ";
+        if (handle.check != "") {
+            code += "    if (" + handle.check + ") {\n";
+            indentation += "    ";
+        }
+        if (handle.count != "") {
+            code += indentation + "size_t i;\n";
+            code += indentation + "for (i = 0; i < (size_t)(" + handle.count + "); ++i) {\n";
+            code += indentation + "    " + call;
+            code += indentation + "}\n";
+        } else {
+            code += indentation + call;
+        }
+        if (handle.check != "") {
+            code += "    }\n";
+        }
+    }
+
+    return code;
+}
+
+/*
+Outputs the checks for externally synchronized handles. Each command with handles that need external synchronization gets
+vkbExternSyncCheck_<Command>() which takes the install it was called through and the call site followed by the parameters of the
+command. It claims each handle, calls the command through the next functions of the install and then releases them. Each install
+gets its own copy of the check. See vkbBuildGenerateCode_C_InstallThunks().
+*/
+VkbResult vkbBuildGenerateCode_C_ExternSyncCheck(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    char maxInstallsStr[32];
+    snprintf(maxInstallsStr, sizeof(maxInstallsStr), "%d", VKB_BUILD_MAX_INSTALLS);
+
+    codeOut += "#define VKB_EXTERNSYNC_MAX_INSTALLS " + std::string(maxInstallsStr) + "\n";
+    codeOut += "\n";
+    codeOut += "static VkbExternSyncInstall g_vkbExternSyncInstalls[VKB_EXTERNSYNC_MAX_INSTALLS];\n";
+    codeOut += "\n";
+
+    std::string currentProtect;
+    std::vector<std::string> commandNames;
+    std::vector<std::string> commandProtects;
+
+    for (size_t iCommand = 0; iCommand < vk.commands.size(); ++iCommand) {
+        const vkbBuildCommand &command = vk.commands[iCommand];
+        if (!codegenState.HasOutputCommand(command.name)) {
+            continue;
+        }
+
+        // Aliases get their own check since they're called through their own function pointer.
+        const vkbBuildCommand* pBaseCommand = &command;
+        if (command.alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(vk, command.alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &vk.commands[iBaseCommand];
+        }
+
+        std::vector<vkbBuildExternSyncHandle> handles;
+        vkbBuildGetExternSyncHandles(state, *pBaseCommand, handles);
+        if (handles.size() == 0) {
+            continue;
+        }
+
+        const std::vector<vkbBuildFunctionParameter> &params = pBaseCommand->parameters;
+        bool returnsValue = pBaseCommand->returnType != "void";
+        std::string protect = vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(command.name));
+
+        char siteCount[32];
+        snprintf(siteCount, sizeof(siteCount), "%d", (int)handles.size());
+
+        std::string code;
+        std::string declParams;
+        std::string callArgs;
+        for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+            if (iParam > 0) {
+                declParams += ", ";
+                callArgs += ", ";
+            }
+            declParams += params[iParam].typeC + " " + params[iParam].nameC;
+            callArgs += params[iParam].name;
+        }
+
+        code += "static " + pBaseCommand->returnTypeC + " vkbExternSyncCheck_" + command.name + "(VkbExternSyncInstall* pInstall, const void* pCallSite" + ((declParams != "") ? ", " + declParams : "") + ")\n";
+        code += "{\n";
+        code += "    static const VkbExternSyncSite sites[" + std::string(siteCount) + "] = {";
+        for (size_t iHandle = 0; iHandle < handles.size(); ++iHandle) {
+            if (iHandle > 0) {
+                code += ", ";
+            }
+            code += "{\"" + command.name + "\", \"" + handles[iHandle].expression + "\"}";
+        }
+        code += "};\n";
+        code += "    VkbExternSyncCallState call;\n";
+        if (returnsValue) {
+            code += "    " + pBaseCommand->returnTypeC + " result;\n";
+        }
+        code += "\n";
+        code += "    vkbExternSyncBeginCall(&call, pInstall, pCallSite);\n";
+        code += vkbBuildGenerateCode_C_ExternSyncHandles(handles, true);
+        code += "\n";
+        code += "    " + std::string(returnsValue ? "result = " : "") + "pInstall->next." + command.name + "(" + callArgs + ");\n";
+        code += "\n";
+        code += vkbBuildGenerateCode_C_ExternSyncHandles(handles, false);
+        if (returnsValue) {
+            code += "\n";
+            code += "    return result;\n";
+        }
+        code += "}\n";
+        code += "\n";
+
+        // The call site is taken in the copies since they're what the application calls.
+        code += vkbBuildGenerateCode_C_InstallThunks("ExternSync", "VKB_EXTERNSYNC_MAX_INSTALLS", command.name, pBaseCommand->returnTypeC, declParams, callArgs, "vkbExternSyncCheck_" + command.name, "VKB_EXTERNSYNC_CALL_SITE(), ");
+
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+
+        commandNames.push_back(command.name);
+        commandProtects.push_back(protect);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+
+    vkbBuildGenerateCode_C_InstallFunctions("ExternSync", commandNames, commandProtects, codeOut);
+
+    return VKB_SUCCESS;
+}
+
+// Works out the VkbParamKind of a parameter type.
+std::string vkbBuildGetCommandParamKind(vkbBuildDeepCopyState &state, const std::string &typeName)
+{
+    if (typeName == "void") {
+        return "VKB_PARAM_KIND_VOID";
+    }
+
+    vkbBuildType* pType = vkbBuildFindDeepCopyType(state, typeName);
+    if (pType == NULL) {
+        return "VKB_PARAM_KIND_SCALAR";
+    }
+
+    if (pType->category == "handle") {
+        return "VKB_PARAM_KIND_HANDLE";
+    }
+    if (pType->category == "struct") {
+        return "VKB_PARAM_KIND_STRUCT";
+    }
+    if (pType->category == "union") {
+        return "VKB_PARAM_KIND_UNION";
+    }
+    if (pType->category == "enum") {
+        return "VKB_PARAM_KIND_ENUM";
+    }
+    if (pType->category == "bitmask") {
+        return "VKB_PARAM_KIND_BITMASK";
+    }
+    if (pType->category == "funcpointer") {
+        return "VKB_PARAM_KIND_FUNCPOINTER";
+    }
+
+    // Base types without an underlying type are opaque platform types such as ANativeWindow.
+    if ((pType->category == "basetype" && pType->type != "") || pType->requires == "vk_platform" || pType->requires == "stdint") {
+        return "VKB_PARAM_KIND_SCALAR";
+    }
+
+    return "VKB_PARAM_KIND_PLATFORM";
+}
+
+// Converts the result codes of a command to a list of VkResult literals. Codes that aren't values of VkResult are dropped.
+std::vector<std::string> vkbBuildGetCommandResultCodes(VkbBuild &context, const std::vector<std::string> &resultNames, const std::vector<std::string> &resultValues, const std::string &codes)
+{
+    std::vector<std::string> literals;
+
+    std::vector<std::string> codeNames = vkbSplitString(codes, ",");
+    for (size_t iCode = 0; iCode < codeNames.size(); ++iCode) {
+        vkbBuildEnum value;
+        if (!vkbBuildFindEnumValue(context, vkbTrim(codeNames[iCode]), value)) {
+            continue;
+        }
+
+        for (size_t iResult = 0; iResult < resultNames.size(); ++iResult) {
+            if (resultNames[iResult] == value.name) {
+                literals.push_back("(VkResult)(" + resultValues[iResult] + ")");
+                break;
+            }
+        }
+    }
+
+    return literals;
+}
+
+/*
+Outputs the reflection table behind vkbGetCommandInfo(). Every command that is output gets an array of VkbParamInfo and arrays of
+its success and error codes, followed by one VkbCommandInfo per command sorted by name so they can be found with a binary search.
+Each entry is guarded by the platform macro of its command.
+*/
+VkbResult vkbBuildGenerateCode_C_CommandInfo(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenState &codegenState, std::string &codeOut)
+{
+    vkbBuildDeepCopyState state;
+    state.pVK = &vk;
+    state.pVideo = &video;
+
+    std::vector<std::string> resultNames;
+    std::vector<std::string> resultValues;
+    vkbBuildGetEnumValues(vk, "VkResult", resultNames, resultValues);
+
+    std::vector<std::string> commandNames;
+    for (size_t iCommand = 0; iCommand < vk.commands.size(); ++iCommand) {
+        if (codegenState.HasOutputCommand(vk.commands[iCommand].name) && !vkbContains(commandNames, vk.commands[iCommand].name)) {
+            commandNames.push_back(vk.commands[iCommand].name);
+        }
+    }
+    std::sort(commandNames.begin(), commandNames.end());
+
+    std::string currentProtect;
+    std::string entries;
+    std::string entriesProtect;
+
+    for (size_t iCommandName = 0; iCommandName < commandNames.size(); ++iCommandName) {
+        const std::string &name = commandNames[iCommandName];
+
+        size_t iCommand;
+        if (!vkbBuildFindCommandByName(vk, name.c_str(), &iCommand)) {
+            continue;
+        }
+
+        // Aliases are described by the command they alias.
+        vkbBuildCommand* pBaseCommand = &vk.commands[iCommand];
+        if (pBaseCommand->alias != "") {
+            size_t iBaseCommand;
+            if (!vkbBuildFindCommandByName(vk, pBaseCommand->alias.c_str(), &iBaseCommand)) {
+                continue;
+            }
+            pBaseCommand = &vk.commands[iBaseCommand];
+        }
+
+        const std::vector<vkbBuildFunctionParameter> &params = pBaseCommand->parameters;
+        std::string protect = vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(name));
+
+        // Pointers that another parameter gets its length from are both read and written, such as pPropertyCount.
+        std::vector<std::string> lenParamNames;
+        for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+            std::vector<std::string> lens = vkbSplitString(params[iParam].len, ",");
+            if (lens.size() > 0) {
+                lenParamNames.push_back(vkbTrim(lens[0]));
+            }
+        }
+
+        std::string code;
+        std::string paramsName = "NULL";
+        if (params.size() > 0) {
+            paramsName = "g_vkbCommandParams_" + name;
+            code += "static const VkbParamInfo " + paramsName + "[] = {\n";
+            for (size_t iParam = 0; iParam < params.size(); ++iParam) {
+                const vkbBuildFunctionParameter &param = params[iParam];
+
+                std::string kind = vkbBuildGetCommandParamKind(state, param.type);
+                size_t pointerDepth = std::count(param.typeC.begin(), param.typeC.end(), '*');
+
+                // Fixed size arrays such as blendConstants[4] are passed as pointers.
+                std::string fixedLen = "0";
+                size_t bracket = param.nameC.find('[');
+                if (bracket != std::string::npos) {
+                    pointerDepth += 1;
+                    if (param.arrayEnum != "") {
+                        fixedLen = param.arrayEnum;
+                    } else {
+                        fixedLen = param.nameC.substr(bracket + 1, param.nameC.find(']') - bracket - 1);
+                    }
+                }
+
+                std::vector<std::string> flags;
+                if (pointerDepth == 0 || param.typeC.find("const") == 0) {
+                    flags.push_back("VKB_PARAM_IN");
+                } else {
+                    if (vkbContains(lenParamNames, param.name)) {
+                        flags.push_back("VKB_PARAM_IN");
+                    }
+                    flags.push_back("VKB_PARAM_OUT");
+                }
+
+                std::vector<std::string> optionals = vkbSplitString(param.optional, ",");
+                if (optionals.size() > 0 && vkbTrim(optionals[0]) == "true") {
+                    flags.push_back("VKB_PARAM_OPTIONAL");
+                }
+                if (optionals.size() > 1 && vkbTrim(optionals[1]) == "true") {
+                    flags.push_back("VKB_PARAM_OPTIONAL_POINTEE");
+                }
+
+                if (param.externsync == "true") {
+                    flags.push_back("VKB_PARAM_EXTERNSYNC");
+                } else if (param.externsync != "") {
+                    flags.push_back("VKB_PARAM_EXTERNSYNC_MEMBERS");
+                }
+
+                // The length is either another parameter or a member of a structure another parameter points to. Anything else,
+                // such as latexmath, is left out.
+                std::string lenIndex = "VKB_PARAM_INDEX_NONE";
+                std::string lenOffset = "0";
+                std::vector<std::string> lens = vkbSplitString(param.len, ",");
+                for (size_t iLen = 0; iLen < lens.size(); ++iLen) {
+                    if (vkbTrim(lens[iLen]) == "null-terminated") {
+                        flags.push_back("VKB_PARAM_NULL_TERMINATED");
+                        break;
+                    }
+                }
+                if (lens.size() > 0) {
+                    std::string len = vkbTrim(lens[0]);
+                    std::string lenMember;
+                    size_t arrow = len.find("->");
+                    if (arrow != std::string::npos) {
+                        lenMember = len.substr(arrow + 2);
+                        len = len.substr(0, arrow);
+                    }
+
+                    for (size_t iLenParam = 0; iLenParam < params.size(); ++iLenParam) {
+                        if (params[iLenParam].name != len) {
+                            continue;
+                        }
+
+                        if (lenMember == "") {
+                            char indexStr[32];
+                            snprintf(indexStr, sizeof(indexStr), "%d", (int)iLenParam);
+                            lenIndex = indexStr;
+                        } else {
+                            vkbBuildType* pLenType = vkbBuildFindDeepCopyType(state, params[iLenParam].type);
+                            if (pLenType != NULL && pLenType->category == "struct" && lenMember.find_first_of("-.[") == std::string::npos) {
+                                char indexStr[32];
+                                snprintf(indexStr, sizeof(indexStr), "%d", (int)iLenParam);
+                                lenIndex = indexStr;
+                                lenOffset = "offsetof(" + pLenType->name + ", " + lenMember + ")";
+                            }
+                        }
+                        break;
+                    }
+                }
+
+                std::string objectType = "VK_OBJECT_TYPE_UNKNOWN";
+                if (kind == "VKB_PARAM_KIND_HANDLE") {
+                    vkbBuildType* pHandleType = vkbBuildFindObjectHandleType(state, param.type);
+                    if (pHandleType != NULL) {
+                        objectType = pHandleType->objtypeenum;
+                    }
+                }
+
+                // Structures with a fixed sType. Those that can be any of several types, like VkBaseOutStructure, have none.
+                std::string sType = "(VkStructureType)0";
+                if (kind == "VKB_PARAM_KIND_STRUCT") {
+                    vkbBuildType* pStructType = vkbBuildFindDeepCopyType(state, param.type);
+                    if (pStructType != NULL && pStructType->structData.members.size() > 0 && pStructType->structData.members[0].name == "sType" && pStructType->structData.members[0].values != "") {
+                        sType = pStructType->structData.members[0].values;
+                    }
+                }
+
+                std::string flagsStr;
+                for (size_t iFlag = 0; iFlag < flags.size(); ++iFlag) {
+                    if (iFlag > 0) {
+                        flagsStr += " | ";
+                    }
+                    flagsStr += flags[iFlag];
+                }
+                if (flagsStr == "") {
+                    flagsStr = "0";
+                }
+
+                char pointerDepthStr[32];
+                snprintf(pointerDepthStr, sizeof(pointerDepthStr), "%d", (int)pointerDepth);
+
+                code += "    {\"" + param.name + "\", \"" + param.type + "\", " + kind + ", " + pointerDepthStr + ", " + lenIndex + ", " + flagsStr + ", " + lenOffset + ", " + fixedLen + ", " + objectType + ", " + sType + "}";
+                code += (iParam + 1 < params.size()) ? ",\n" : "\n";
+            }
+            code += "};\n";
+        }
+
+        std::vector<std::string> successCodes = vkbBuildGetCommandResultCodes(vk, resultNames, resultValues, pBaseCommand->successcodes);
+        std::vector<std::string> errorCodes = vkbBuildGetCommandResultCodes(vk, resultNames, resultValues, pBaseCommand->errorcodes);
+
+        std::string successCodesName = "NULL";
+        if (successCodes.size() > 0) {
+            successCodesName = "g_vkbCommandSuccessCodes_" + name;
+            code += "static const VkResult " + successCodesName + "[] = {";
+            for (size_t iCode = 0; iCode < successCodes.size(); ++iCode) {
+                code += ((iCode > 0) ? ", " : "") + successCodes[iCode];
+            }
+            code += "};\n";
+        }
+
+        std::string errorCodesName = "NULL";
+        if (errorCodes.size() > 0) {
+            errorCodesName = "g_vkbCommandErrorCodes_" + name;
+            code += "static const VkResult " + errorCodesName + "[] = {";
+            for (size_t iCode = 0; iCode < errorCodes.size(); ++iCode) {
+                code += ((iCode > 0) ? ", " : "") + errorCodes[iCode];
+            }
+            code += "};\n";
+        }
+
+        vkbBuildAppendGuardedLine(protect, code, currentProtect, codeOut);
+
+        std::string level = "VKB_COMMAND_LEVEL_GLOBAL";
+        if (vkbBuildIsDeviceLevelCommand(vk, *pBaseCommand)) {
+            level = "VKB_COMMAND_LEVEL_DEVICE";
+        } else if (vkbBuildIsInstanceLevelCommand(vk, *pBaseCommand)) {
+            level = "VKB_COMMAND_LEVEL_INSTANCE";
+        }
+
+        char paramCount[32];
+        char successCodeCount[32];
+        char errorCodeCount[32];
+        snprintf(paramCount, sizeof(paramCount), "%u", (unsigned int)params.size());
+        snprintf(successCodeCount, sizeof(successCodeCount), "%u", (unsigned int)successCodes.size());
+        snprintf(errorCodeCount, sizeof(errorCodeCount), "%u", (unsigned int)errorCodes.size());
+
+        std::string entry;
+        entry += "    {\"" + name + "\", \"" + pBaseCommand->returnTypeC + "\", offsetof(VkbAPI, " + name + "), " + level + ", ";
+        entry += paramsName + ", " + paramCount + ", " + successCodesName + ", " + successCodeCount + ", " + errorCodesName + ", " + errorCodeCount + "},\n";
+        vkbBuildAppendGuardedLine(protect, entry, entriesProtect, entries);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, codeOut);
+    vkbBuildAppendGuardedLine("", "", entriesProtect, entries);
+
+    // C89 doesn't allow empty initializers so there's always a terminator. It's not counted.
+    codeOut += "\n";
+    codeOut += "static const VkbCommandInfo g_vkbCommandInfos[] = {\n";
+    codeOut += entries;
+    codeOut += "    {NULL, NULL, 0, VKB_COMMAND_LEVEL_GLOBAL, NULL, 0, NULL, 0, NULL, 0}\n";
+    codeOut += "};";
+
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C_VulkanVersion(VkbBuild &context, std::string &codeOut)
+{
+    std::string version;
+    VkbResult result = vkbBuildGetVulkanVersion(context, version);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    codeOut += version;
+
+    return VKB_SUCCESS;
+}
 
 VkbResult vkbBuildGenerateCode_C_Revision(VkbBuild &context, std::string &codeOut)
 {
@@ -3358,87 +8725,790 @@ VkbResult vkbBuildGenerateCode_C_Revision(VkbBuild &context, std::string &codeOu
             // Couldn't find the previous version.
             revision = "0";
         }
-    } else {
-        // vkbind.h was not found.
-        revision = "0";
+    } else {
+        // vkbind.h was not found.
+        revision = "0";
+    }
+
+    codeOut += revision;
+    return VKB_SUCCESS;
+}
+
+#include <time.h>
+VkbResult vkbBuildGenerateCode_C_Date(VkbBuild &context, std::string &codeOut)
+{
+    (void)context;
+
+    time_t t = time(NULL);
+
+    char dateStr[32];
+#if defined(_MSC_VER)
+    struct tm local;
+    localtime_s(&local, &t);
+    strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", &local);
+#else
+    struct tm *local = localtime(&t);
+    strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", local);
+#endif
+
+    codeOut += dateStr;
+    return VKB_SUCCESS;
+}
+
+VkbResult vkbBuildGenerateCode_C(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenOutput &output, const char* tag, std::string &codeOut)
+{
+    if (tag == NULL) {
+        return VKB_INVALID_ARGS;
+    }
+
+    VkbResult result = VKB_INVALID_ARGS;
+    if (strcmp(tag, "/*<<vk_video>>*/") == 0) {
+        codeOut += "#ifdef VKBIND_ENABLE_VIDEO\n";
+        codeOut += output.videoCode;
+        codeOut += "#endif /*VKBIND_ENABLE_VIDEO*/\n";
+        result = VKB_SUCCESS;
+    }
+    if (strcmp(tag, "/*<<vulkan_main>>*/") == 0) {
+        codeOut += output.vkCode;
+        result = VKB_SUCCESS;
+    }
+    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global:extern>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 0, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global:4>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 4, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 0, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<load_global_api_funcpointers>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_LoadVulkanFuncPointers(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<set_struct_api_from_global>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_SetStructAPIFromGlobal(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<set_global_api_from_struct>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_SetGlobalAPIFromStruct(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<load_instance_api>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_LoadInstanceAPI(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<load_device_api>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_LoadDeviceAPI(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<load_safe_global_api>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_LoadSafeVulkanAPI(vk, codeOut);
+    }
+    if (strcmp(tag, "<<safe_global_api_docs>>") == 0) {
+        result = vkbBuildGenerateCode_C_SafeGlobalAPIDocs(vk, codeOut);
+    }
+    if (strcmp(tag, "<<vulkan_version>>") == 0) {
+        result = vkbBuildGenerateCode_C_VulkanVersion(vk, codeOut);
+    }
+    if (strcmp(tag, "<<revision>>") == 0) {
+        result = vkbBuildGenerateCode_C_Revision(vk, codeOut);
+    }
+    if (strcmp(tag, "<<date>>") == 0) {
+        result = vkbBuildGenerateCode_C_Date(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<struct_info>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_StructInfo(vk, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<enum_strings_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_EnumStrings(vk, output.vkState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<enum_strings>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_EnumStrings(vk, output.vkState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<deep_copy>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_DeepCopy(vk, video, output.vkState, output.videoState, codeOut);
+    }
+    if (strcmp(tag, "/*<<hash_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_Hash(vk, video, output.vkState, output.videoState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<hash>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_Hash(vk, video, output.vkState, output.videoState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<object_cache_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_ObjectCache(vk, output.vkState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<object_cache>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_ObjectCache(vk, output.vkState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<enumerate_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_Enumerate(vk, output.vkState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<enumerate>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_Enumerate(vk, output.vkState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<command_stream_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_CommandStream(vk, video, output.vkState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<command_stream>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_CommandStream(vk, video, output.vkState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<state_filter_decl>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_StateFilter(vk, video, output.vkState, true, codeOut);
+    }
+    if (strcmp(tag, "/*<<state_filter>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_StateFilter(vk, video, output.vkState, false, codeOut);
+    }
+    if (strcmp(tag, "/*<<capture>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_Capture(vk, video, output.vkState, output.videoState, codeOut);
+    }
+    if (strcmp(tag, "/*<<capture_calls>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_CaptureCalls(vk, video, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<externsync_check>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_ExternSyncCheck(vk, video, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<format_info>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_FormatInfo(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<sync_info>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_SyncInfo(vk, codeOut);
+    }
+    if (strcmp(tag, "/*<<barrier_batch>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_BarrierBatch(vk, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<handle_info>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_HandleInfo(vk, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<command_info>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_CommandInfo(vk, video, output.vkState, codeOut);
+    }
+    if (strcmp(tag, "/*<<object_registry>>*/") == 0) {
+        result = vkbBuildGenerateCode_C_ObjectRegistry(vk, output.vkState, codeOut);
+    }
+
+    return result;
+}
+
+std::string vkbBuildGenerateSplitHeaderBanner(VkbBuild &vk, const std::string &description)
+{
+    std::string banner;
+
+    banner += "/*\n";
+    banner += "vkbind - v"; vkbBuildGenerateCode_C_VulkanVersion(vk, banner);
+    banner += ".";          vkbBuildGenerateCode_C_Revision(vk, banner);
+    banner += " - ";        vkbBuildGenerateCode_C_Date(vk, banner);
+    banner += "\n\n";
+    banner += description + " Generated by vkbuild in split-header mode. See vkbind.h for usage and license information.\n";
+    banner += "*/\n";
+
+    return banner;
+}
+
+/*
+Writes the headers for split-header mode and converts the template into the loader header. The platform section of the template is
+moved into vkbind_platform.h, video.xml is output to vkbind_video.h and each feature and extension gets it's own header. The loader
+includes all of them so that existing code can continue to include just the one file.
+*/
+VkbResult vkbBuildGenerateSplitHeaders_C(VkbBuild &vk, vkbBuildCodeGenOutput &output, const std::string &outputDirectory, std::string &loaderStr)
+{
+    VkbResult result;
+
+    result = vkbMakeDirectory(outputDirectory.c_str());
+    if (result != VKB_SUCCESS) {
+        printf("Failed to create output directory: %s\n", outputDirectory.c_str());
+        return result;
+    }
+
+    // Platform.
+    {
+        const std::string platformBeg = "/*<<platform_begin>>*/\n";
+        const std::string platformEnd = "/*<<platform_end>>*/\n";
+
+        std::string::size_type begPos = loaderStr.find(platformBeg);
+        std::string::size_type endPos = loaderStr.find(platformEnd);
+        if (begPos == std::string::npos || endPos == std::string::npos || endPos < begPos) {
+            printf("Template is missing platform tags.\n");
+            return VKB_ERROR;
+        }
+
+        std::string code;
+        code += vkbBuildGenerateSplitHeaderBanner(vk, "Platform definitions.");
+        code += "#ifndef VKBIND_PLATFORM_H\n";
+        code += "#define VKBIND_PLATFORM_H\n\n";
+        code += loaderStr.substr(begPos + platformBeg.length(), endPos - (begPos + platformBeg.length()));
+        code += "\n#endif  /* VKBIND_PLATFORM_H */\n";
+
+        result = vkbOpenAndWriteTextFileIfChanged((outputDirectory + "vkbind_platform.h").c_str(), code.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        loaderStr.replace(begPos, (endPos + platformEnd.length()) - begPos, "#include \"vkbind_platform.h\"\n");
+    }
+
+    // Video.
+    {
+        std::string code;
+        code += vkbBuildGenerateSplitHeaderBanner(vk, "Video std definitions from video.xml.");
+        code += "#ifndef VKBIND_VIDEO_H\n";
+        code += "#define VKBIND_VIDEO_H\n\n";
+        code += "#include \"vkbind_platform.h\"\n";
+        code += output.videoCode;
+        code += "#endif  /* VKBIND_VIDEO_H */\n";
+
+        result = vkbOpenAndWriteTextFileIfChanged((outputDirectory + "vkbind_video.h").c_str(), code.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        vkbReplaceAllInline(loaderStr, "/*<<vk_video>>*/", "#ifdef VKBIND_ENABLE_VIDEO\n#include \"vkbind_video.h\"\n#endif");
+    }
+
+    // Features and extensions.
+    {
+        std::vector<vkbBuildCodeGenUnit> units;
+        result = vkbBuildGenerateCode_C_Units(vk, units);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+
+        std::string loaderIncludes;
+        for (size_t iUnit = 0; iUnit < units.size(); ++iUnit) {
+            vkbBuildCodeGenUnit &unit = units[iUnit];
+            std::string guard = vkbToUpper(unit.name) + "_H_";
+            std::string code;
+
+            code += vkbBuildGenerateSplitHeaderBanner(vk, unit.name + ".");
+            code += "#ifndef " + guard + "\n";
+            code += "#define " + guard + "\n\n";
+            code += "#include \"vkbind_platform.h\"\n";
+            if (unit.requiresVideo) {
+                code += "#include \"vkbind_video.h\"\n";
+            }
+            for (size_t iInclude = 0; iInclude < unit.includes.size(); ++iInclude) {
+                code += "#include \"" + vkbBuildGetUnitFileName(unit.includes[iInclude]) + "\"\n";
+            }
+            code += "\n";
+            code += "#ifdef __cplusplus\n";
+            code += "extern \"C\" {\n";
+            code += "#endif\n";
+
+            if (unit.protect != "") {
+                code += "\n#ifdef " + unit.protect + "\n";
+            }
+
+            code += unit.code;
+
+            if (unit.commands.size() > 0) {
+                code += "#ifndef VKBIND_NO_GLOBAL_API\n";
+                for (size_t iCommand = 0; iCommand < unit.commands.size(); ++iCommand) {
+                    code += "extern PFN_" + unit.commands[iCommand] + " " + unit.commands[iCommand] + ";\n";
+                }
+                code += "#endif /*VKBIND_NO_GLOBAL_API*/\n";
+            }
+
+            if (unit.protect != "") {
+                code += "#endif /*" + unit.protect + "*/\n";
+            }
+
+            code += "\n";
+            code += "#ifdef __cplusplus\n";
+            code += "}\n";
+            code += "#endif\n";
+            code += "#endif  /* " + guard + " */\n";
+
+            result = vkbOpenAndWriteTextFileIfChanged((outputDirectory + vkbBuildGetUnitFileName(unit.name)).c_str(), code.c_str());
+            if (result != VKB_SUCCESS) {
+                return result;
+            }
+
+            loaderIncludes += "#include \"" + vkbBuildGetUnitFileName(unit.name) + "\"\n";
+        }
+
+        vkbReplaceAllInline(loaderStr, "/*<<vulkan_main>>*/", loaderIncludes);
+    }
+
+    return VKB_SUCCESS;
+}
+
+/*
+Macros can't be exported from a module. Object-like macros are re-declared as constants by first capturing the value under a
+different name, then #undef-ing the macro and declaring the real name. Function-like macros that produce a value (VK_MAKE_API_VERSION,
+etc.) are re-declared as constexpr function templates. Macros which expand to declarations (VK_DEFINE_HANDLE, etc.) are skipped.
+*/
+void vkbBuildGenerateModuleDefine(VkbBuild &context, const std::string &name, std::string &codeOut)
+{
+    std::string params;
+    std::string body;
+    bool isFunctionLike = false;
+
+    size_t iType;
+    if (vkbBuildFindTypeByName(context, name.c_str(), &iType) && context.types[iType].category == "define") {
+        std::string defineValue = vkbBuildCleanDefineValue(context.types[iType].verbatimValue);
+        std::string defineToken = "#define " + name;
+
+        std::string::size_type defineStart = defineValue.find(defineToken);
+        if (defineStart == std::string::npos) {
+            return;
+        }
+
+        std::string::size_type defineEnd = defineValue.find('\n', defineStart);
+        std::string define = defineValue.substr(defineStart + defineToken.size(), (defineEnd == std::string::npos) ? std::string::npos : defineEnd - (defineStart + defineToken.size()));
+
+        if (define.size() > 0 && define[0] == '(') {
+            std::string::size_type paramsEnd = define.find(')');
+            if (paramsEnd == std::string::npos) {
+                return;
+            }
+
+            isFunctionLike = true;
+            params = define.substr(1, paramsEnd - 1);
+            body   = vkbTrim(define.substr(paramsEnd + 1));
+        } else {
+            body   = vkbTrim(define);
+        }
+
+        if (body == "" || body.find('#') != std::string::npos || body.find("typedef") != std::string::npos) {
+            return;
+        }
+    }
+
+    codeOut += "#if defined(" + name + ")\n";
+    if (isFunctionLike) {
+        std::vector<std::string> paramNames = vkbSplitString(params, ",");
+        std::string templateParams;
+        std::string functionParams;
+        for (size_t iParam = 0; iParam < paramNames.size(); ++iParam) {
+            if (iParam > 0) {
+                templateParams += ", ";
+                functionParams += ", ";
+            }
+
+            templateParams += "typename T" + std::to_string(iParam);
+            functionParams += "T" + std::to_string(iParam) + " " + vkbTrim(paramNames[iParam]);
+        }
+
+        codeOut += "#undef " + name + "\n";
+        codeOut += "export template <" + templateParams + "> constexpr auto " + name + "(" + functionParams + ") { return " + body + "; }\n";
+    } else {
+        codeOut += "inline constexpr auto vkbModule_" + name + " = " + name + ";\n";
+        codeOut += "#undef " + name + "\n";
+        codeOut += "export inline constexpr auto " + name + " = vkbModule_" + name + ";\n";
+    }
+    codeOut += "#endif\n";
+}
+
+/*
+Writes vkbind.cppm and vkbind_impl.cpp which are a C++20 module interface and implementation unit for vkbind. The interface includes
+vkbind.h inside an export block. Everything in vkbind.h is within an extern "C" block so it's attached to the global module which
+means the module and the header refer to the same entities. The system headers vkbind.h depends on need to be included in the global
+module fragment so they don't end up attached to the module.
+*/
+VkbResult vkbBuildGenerateModule_Cpp(VkbBuild &vk, VkbBuild &video, vkbBuildCodeGenOutput &output, const std::string &outputDirectory)
+{
+    VkbResult result;
+    vkbBuildCodeGenState &videoState = output.videoState;
+    vkbBuildCodeGenState &vkState = output.vkState;
+
+    std::string banner;
+    banner += "/*\n";
+    banner += "vkbind - v"; vkbBuildGenerateCode_C_VulkanVersion(vk, banner);
+    banner += ".";          vkbBuildGenerateCode_C_Revision(vk, banner);
+    banner += " - ";        vkbBuildGenerateCode_C_Date(vk, banner);
+    banner += "\n\n";
+
+    // Interface unit.
+    {
+        std::string code = banner;
+        code += "C++20 module interface for vkbind. Generated by vkbuild. See vkbind.h for usage and license information.\n";
+        code += "\n";
+        code += "    import vkbind;\n";
+        code += "\n";
+        code += "Compile this together with vkbind_impl.cpp. Any VK_USE_PLATFORM_* and VKBIND_* options need to be defined when compiling the\n";
+        code += "module rather than in the importing code. Macros cannot be exported so object-like macros (VK_TRUE, VK_API_VERSION_1_0,\n";
+        code += "extension names, etc.) are exported as constants and function-like macros (VK_MAKE_API_VERSION, etc.) as constexpr\n";
+        code += "functions. Feature macros like VK_KHR_surface are not available to importers.\n";
+        code += "*/\n";
+        code += "module;\n";
+        code += "\n";
+        code += "/* These need to mirror the includes in vkbind.h. */\n";
+        code += "#ifndef VK_NO_STDINT_H\n";
+        code += "#include <stdint.h>\n";
+        code += "#endif\n";
+        code += "#ifndef VK_NO_STDDEF_H\n";
+        code += "#include <stddef.h>\n";
+        code += "#endif\n";
+        code += "#if defined(VK_USE_PLATFORM_WIN32_KHR) && !defined(VKBIND_NO_WIN32_HEADERS)\n";
+        code += "#include <windows.h>\n";
+        code += "#endif\n";
+        code += "#if defined(VK_USE_PLATFORM_XLIB_KHR) && !defined(VKBIND_NO_XLIB_HEADERS)\n";
+        code += "#include <X11/Xlib.h>\n";
+        code += "#endif\n";
+        code += "#if defined(VK_USE_PLATFORM_XLIB_XRANDR_EXT) && !defined(VKBIND_NO_XLIB_HEADERS)\n";
+        code += "#include <X11/extensions/Xrandr.h>\n";
+        code += "#endif\n";
+        {
+            std::string currentProtect;
+            for (size_t iType = 0; iType < vkState.outputTypes.size(); ++iType) {
+                size_t iContextType;
+                if (vkbBuildFindTypeByName(vk, vkState.outputTypes[iType].c_str(), &iContextType) && vk.types[iContextType].category == "include") {
+                    vkbBuildAppendGuardedLine(vkbBuildGetUnitProtect(vk, vkState.outputTypeUnits[iType]), "#include <" + vkState.outputTypes[iType] + ">\n", currentProtect, code);
+                }
+            }
+            vkbBuildAppendGuardedLine("", "", currentProtect, code);
+        }
+        code += "\n";
+        code += "export module vkbind;\n";
+        code += "\n";
+        code += "/* 64-bit flags need external linkage to be exported. */\n";
+        code += "#define VKBIND_FLAGS64_CONST inline constexpr\n";
+        code += "export {\n";
+        code += "#include \"vkbind.h\"\n";
+        code += "}\n";
+        code += "\n";
+
+        for (size_t iDefine = 0; iDefine < videoState.outputDefines.size(); ++iDefine) {
+            vkbBuildGenerateModuleDefine(video, videoState.outputDefines[iDefine], code);
+        }
+        for (size_t iDefine = 0; iDefine < vkState.outputDefines.size(); ++iDefine) {
+            vkbBuildGenerateModuleDefine(vk, vkState.outputDefines[iDefine], code);
+        }
+
+        result = vkbOpenAndWriteTextFileIfChanged((outputDirectory + "vkbind.cppm").c_str(), code.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
+    // Implementation unit.
+    {
+        std::string code = banner;
+        code += "C++20 module implementation unit for vkbind. Generated by vkbuild. See vkbind.cppm.\n";
+        code += "*/\n";
+        code += "module;\n";
+        code += "\n";
+        code += "#define VKBIND_IMPLEMENTATION\n";
+        code += "#include \"vkbind.h\"\n";
+        code += "\n";
+        code += "module vkbind;\n";
+
+        result = vkbOpenAndWriteTextFileIfChanged((outputDirectory + "vkbind_impl.cpp").c_str(), code.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
+    return VKB_SUCCESS;
+}
+
+/*
+Writes vkbind.hpp. This has a tag type for each command carrying the PFN type and the location of the command in VkbAPI, which lets
+vkb::call() compile down to a single indirect call with the arguments checked against the PFN. vkb::Dispatch is a table with only a
+chosen set of commands. vkb::StructChain lays out a pNext chain in a single object and is validated at compile time against the
+structextends attribute from the registry.
+*/
+VkbResult vkbBuildGenerateHeader_Cpp(VkbBuild &vk, vkbBuildCodeGenState &codegenState, const char* headerFilePath)
+{
+    std::string headerFilePathStr = headerFilePath;
+    std::string headerFileName = headerFilePathStr.substr(headerFilePathStr.find_last_of("/\\") + 1);    // <-- Safe if there's no slash because npos + 1 is 0.
+
+    std::string code;
+    code += "/*\n";
+    code += "vkbind - v"; vkbBuildGenerateCode_C_VulkanVersion(vk, code);
+    code += ".";          vkbBuildGenerateCode_C_Revision(vk, code);
+    code += " - ";        vkbBuildGenerateCode_C_Date(vk, code);
+    code += "\n\n";
+    code += "C++ dispatch helpers for vkbind. Generated by vkbuild. See " + headerFileName + " for usage and license information. Requires C++11.\n";
+    code += "\n";
+    code += "Each command has a tag type in vkb::cmd named after the command without the \"vk\" prefix. The tag carries the PFN type and\n";
+    code += "the offset of the command in VkbAPI. Calls are type checked against the PFN and compile to a single indirect call:\n";
+    code += "\n";
+    code += "    vkb::call<vkb::cmd::CmdDraw>(api, commandBuffer, 3, 1, 0, 0);\n";
+    code += "\n";
+    code += "vkb::Dispatch is a table with only the given commands. Using a command that isn't in the table is a compile error:\n";
+    code += "\n";
+    code += "    typedef vkb::Dispatch<vkb::cmd::CmdBindPipeline, vkb::cmd::CmdDraw> DrawDispatch;\n";
+    code += "    DrawDispatch dispatch(api);\n";
+    code += "    vkb::call<vkb::cmd::CmdDraw>(dispatch, commandBuffer, 3, 1, 0, 0);\n";
+    code += "\n";
+    code += "vkb::StructChain holds a structure and the structures chained to it in a single object with no allocations. The sType\n";
+    code += "and pNext members are set by the constructor. Each structure must be allowed to extend one of the structures before it:\n";
+    code += "\n";
+    code += "    vkb::StructChain<VkPhysicalDeviceFeatures2, VkPhysicalDeviceVulkan11Features> features;\n";
+    code += "    vkGetPhysicalDeviceFeatures2(physicalDevice, &features.get<VkPhysicalDeviceFeatures2>());\n";
+    code += "    if (features.get<VkPhysicalDeviceVulkan11Features>().multiview) { ... }\n";
+    code += "*/\n";
+    code += "#ifndef VKBIND_HPP\n";
+    code += "#define VKBIND_HPP\n";
+    code += "\n";
+    code += "#include \"" + headerFileName + "\"\n";
+    code += "#include <cstddef>\n";
+    code += "#include <type_traits>\n";
+    code += "#include <utility>\n";
+    code += "\n";
+    code += "namespace vkb\n";
+    code += "{\n";
+    code += "namespace cmd\n";
+    code += "{\n";
+
+    std::string currentProtect;
+    for (size_t iCommand = 0; iCommand < codegenState.outputCommands.size(); ++iCommand) {
+        const std::string &name = codegenState.outputCommands[iCommand];
+        std::string tagName = name.substr(2);   // <-- Drop the "vk" prefix.
+
+        std::string tag;
+        tag += "    struct " + tagName + "\n";
+        tag += "    {\n";
+        tag += "        typedef PFN_" + name + " pfn;\n";
+        tag += "        static constexpr std::size_t offset = offsetof(VkbAPI, " + name + ");\n";
+        tag += "        static constexpr pfn VkbAPI::* member() { return &VkbAPI::" + name + "; }\n";
+        tag += "        static constexpr const char* name() { return \"" + name + "\"; }\n";
+        tag += "    };\n";
+
+        vkbBuildAppendGuardedLine(vkbBuildGetUnitProtect(vk, codegenState.outputCommandUnits[iCommand]), tag, currentProtect, code);
+    }
+    vkbBuildAppendGuardedLine("", "", currentProtect, code);
+
+    code += "}\n";
+    code += "\n";
+    code += "template<typename Cmd>\n";
+    code += "struct DispatchSlot\n";
+    code += "{\n";
+    code += "    typename Cmd::pfn pfn;\n";
+    code += "};\n";
+    code += "\n";
+    code += "template<typename... Cmds>\n";
+    code += "struct Dispatch : DispatchSlot<Cmds>...\n";
+    code += "{\n";
+    code += "    Dispatch() : DispatchSlot<Cmds>()... {}\n";
+    code += "    explicit Dispatch(const VkbAPI &api) : DispatchSlot<Cmds>{api.*Cmds::member()}... {}\n";
+    code += "};\n";
+    code += "\n";
+    code += "template<typename Cmd>\n";
+    code += "inline typename Cmd::pfn get(const VkbAPI &api)\n";
+    code += "{\n";
+    code += "    return api.*Cmd::member();\n";
+    code += "}\n";
+    code += "\n";
+    code += "template<typename Cmd, typename... Cmds>\n";
+    code += "inline typename Cmd::pfn get(const Dispatch<Cmds...> &dispatch)\n";
+    code += "{\n";
+    code += "    return static_cast<const DispatchSlot<Cmd>&>(dispatch).pfn;\n";
+    code += "}\n";
+    code += "\n";
+    code += "template<typename Cmd, typename Table, typename... Args>\n";
+    code += "inline auto call(const Table &table, Args&&... args) -> decltype(get<Cmd>(table)(std::forward<Args>(args)...))\n";
+    code += "{\n";
+    code += "    return get<Cmd>(table)(std::forward<Args>(args)...);\n";
+    code += "}\n";
+    code += "\n";
+
+    // StructType and StructExtends traits.
+    std::string structTypeCode;
+    std::string structExtendsCode;
+    std::string structTypeProtect;
+    std::string structExtendsProtect;
+    for (size_t iType = 0; iType < vk.types.size(); ++iType) {
+        vkbBuildType &type = vk.types[iType];
+        if (type.category != "struct" || type.alias != "" || !codegenState.HasOutputType(type.name)) {
+            continue;
+        }
+
+        std::string sType = vkbBuildGetStructTypeValue(vk, type.name, NULL);
+        if (sType == "") {
+            continue;
+        }
+
+        std::string protect = vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(type.name));
+        vkbBuildAppendGuardedLine(protect, "template<> struct StructType<" + type.name + "> { static constexpr VkStructureType value = " + sType + "; };\n", structTypeProtect, structTypeCode);
+
+        std::vector<std::string> bases = vkbSplitString(type.structextends, ",");
+        for (size_t iBase = 0; iBase < bases.size(); ++iBase) {
+            std::string baseName;
+            if (vkbBuildGetStructTypeValue(vk, vkbTrim(bases[iBase]), &baseName) == "" || !codegenState.HasOutputType(baseName)) {
+                continue;
+            }
+
+            std::string line = "template<> struct StructExtends<" + type.name + ", " + baseName + "> : std::true_type {};\n";
+
+            // The base can be behind a different platform macro to the struct itself. Rare, but it needs to be handled.
+            std::string baseProtect = vkbBuildGetUnitProtect(vk, codegenState.GetOutputUnit(baseName));
+            if (baseProtect != "" && baseProtect != protect) {
+                line = "#ifdef " + baseProtect + "\n" + line + "#endif\n";
+            }
+
+            vkbBuildAppendGuardedLine(protect, line, structExtendsProtect, structExtendsCode);
+        }
     }
+    vkbBuildAppendGuardedLine("", "", structTypeProtect, structTypeCode);
+    vkbBuildAppendGuardedLine("", "", structExtendsProtect, structExtendsCode);
+
+    code += "/* The sType of each structure. */\n";
+    code += "template<typename T> struct StructType;\n";
+    code += structTypeCode;
+    code += "\n";
+    code += "/* Whether or not Ext can be chained to Base with pNext. From the structextends attribute in the registry. */\n";
+    code += "template<typename Ext, typename Base> struct StructExtends : std::false_type {};\n";
+    code += structExtendsCode;
+    code += "\n";
+    code += "namespace detail\n";
+    code += "{\n";
+    code += "    template<typename... Ts> struct TypeList {};\n";
+    code += "\n";
+    code += "    template<typename T, typename... Prev> struct StructExtendsAny : std::false_type {};\n";
+    code += "    template<typename T, typename P, typename... Prev> struct StructExtendsAny<T, P, Prev...> : std::integral_constant<bool, StructExtends<T, P>::value || StructExtendsAny<T, Prev...>::value> {};\n";
+    code += "\n";
+    code += "    template<typename Prev, typename... Rest> struct StructChainIsValid : std::true_type {};\n";
+    code += "    template<typename... Prev, typename T, typename... Rest> struct StructChainIsValid<TypeList<Prev...>, T, Rest...> : std::integral_constant<bool, StructExtendsAny<T, Prev...>::value && StructChainIsValid<TypeList<Prev..., T>, Rest...>::value> {};\n";
+    code += "\n";
+    code += "    template<typename T, typename... Ts> struct StructChainStorage\n";
+    code += "    {\n";
+    code += "        T value;\n";
+    code += "        StructChainStorage<Ts...> rest;\n";
+    code += "    };\n";
+    code += "    template<typename T> struct StructChainStorage<T>\n";
+    code += "    {\n";
+    code += "        T value;\n";
+    code += "    };\n";
+    code += "\n";
+    code += "    template<typename T>\n";
+    code += "    inline void StructChainLink(StructChainStorage<T> &storage)\n";
+    code += "    {\n";
+    code += "        storage.value.sType = StructType<T>::value;\n";
+    code += "        storage.value.pNext = nullptr;\n";
+    code += "    }\n";
+    code += "\n";
+    code += "    template<typename T, typename U, typename... Ts>\n";
+    code += "    inline void StructChainLink(StructChainStorage<T, U, Ts...> &storage)\n";
+    code += "    {\n";
+    code += "        storage.value.sType = StructType<T>::value;\n";
+    code += "        storage.value.pNext = &storage.rest.value;\n";
+    code += "        StructChainLink(storage.rest);\n";
+    code += "    }\n";
+    code += "\n";
+    code += "    template<typename U, typename... Ts> struct StructChainGet;\n";
+    code += "    template<typename U, typename... Ts> struct StructChainGet<U, U, Ts...>\n";
+    code += "    {\n";
+    code += "        static U& get(StructChainStorage<U, Ts...> &storage) { return storage.value; }\n";
+    code += "    };\n";
+    code += "    template<typename U, typename T, typename... Ts> struct StructChainGet<U, T, Ts...>\n";
+    code += "    {\n";
+    code += "        static U& get(StructChainStorage<T, Ts...> &storage) { return StructChainGet<U, Ts...>::get(storage.rest); }\n";
+    code += "    };\n";
+    code += "}\n";
+    code += "\n";
+    code += "template<typename Base, typename... Exts>\n";
+    code += "class StructChain\n";
+    code += "{\n";
+    code += "    static_assert(detail::StructChainIsValid<detail::TypeList<Base>, Exts...>::value, \"Each structure in a StructChain must be allowed to extend one of the structures before it.\");\n";
+    code += "\n";
+    code += "public:\n";
+    code += "    StructChain() : m_storage() { detail::StructChainLink(m_storage); }\n";
+    code += "    StructChain(const StructChain &other) : m_storage(other.m_storage) { detail::StructChainLink(m_storage); }\n";
+    code += "    StructChain& operator=(const StructChain &other) { m_storage = other.m_storage; detail::StructChainLink(m_storage); return *this; }\n";
+    code += "\n";
+    code += "    template<typename T> T& get() { return detail::StructChainGet<T, Base, Exts...>::get(m_storage); }\n";
+    code += "    template<typename T> const T& get() const { return detail::StructChainGet<T, Base, Exts...>::get(const_cast<detail::StructChainStorage<Base, Exts...>&>(m_storage)); }\n";
+    code += "\n";
+    code += "private:\n";
+    code += "    detail::StructChainStorage<Base, Exts...> m_storage;\n";
+    code += "};\n";
+    code += "}\n";
+    code += "\n";
+    code += "#endif  /* VKBIND_HPP */\n";
+
+    std::string outputFilePath = headerFilePathStr.substr(0, headerFilePathStr.find_last_of('.')) + ".hpp";
+    return vkbOpenAndWriteTextFileIfChanged(outputFilePath.c_str(), code.c_str());
+}
 
-    codeOut += revision;
-    return VKB_SUCCESS;
+void vkbBuildAppendReportRow(const vkbBuildCodeGenUnitStats &stats, std::string &reportOut)
+{
+    char row[512];
+    snprintf(row, sizeof(row), "%-56s %-28s %8u %10u %7u %7u %7u %7u %8u\n", stats.name.c_str(), stats.section.c_str(),
+        (unsigned int)stats.lines, (unsigned int)stats.bytes, (unsigned int)stats.types, (unsigned int)stats.structs, (unsigned int)stats.enums, (unsigned int)stats.defines, (unsigned int)stats.commands);
+    reportOut += row;
 }
 
-#include <time.h>
-VkbResult vkbBuildGenerateCode_C_Date(VkbBuild &context, std::string &codeOut)
+/*
+Writes a report of how much each feature, extension and section contributes to the generated header. This is for deciding what's
+worth trimming and for tracking the growth of the header between registry versions. The numbers are for the single-header output;
+the code around each feature and extension (includes, guards, the VkbAPI structure and loaders) isn't attributed to anything. Each
+command is one function pointer in VkbAPI and one in the global API.
+*/
+VkbResult vkbBuildGenerateReport(VkbBuild &vk, vkbBuildCodeGenOutput &output, const char* outputFilePath)
 {
-    (void)context;
+    std::vector<vkbBuildCodeGenUnitStats> unitStats;
 
-    time_t t = time(NULL);
+    // Video std headers.
+    for (size_t iStats = 0; iStats < output.videoState.unitStats.size(); ++iStats) {
+        unitStats.push_back(output.videoState.unitStats[iStats]);
+        unitStats.back().section = "video std";
+    }
 
-    char dateStr[32];
-#if defined(_MSC_VER)
-    struct tm local;
-    localtime_s(&local, &t);
-    strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", &local);
-#else
-    struct tm *local = localtime(&t);
-    strftime(dateStr, sizeof(dateStr), "%Y-%m-%d", local);
-#endif
+    // Main registry.
+    unitStats.insert(unitStats.end(), output.vkState.unitStats.begin(), output.vkState.unitStats.end());
 
-    codeOut += dateStr;
-    return VKB_SUCCESS;
-}
+    // Per-section totals, in the order the sections first appear.
+    std::vector<vkbBuildCodeGenUnitStats> sectionStats;
+    vkbBuildCodeGenUnitStats totalStats;
+    totalStats.name = "Total";
+    for (size_t iStats = 0; iStats < unitStats.size(); ++iStats) {
+        const vkbBuildCodeGenUnitStats &stats = unitStats[iStats];
 
-VkbResult vkbBuildGenerateCode_C(VkbBuild &vk, VkbBuild &video, const char* tag, std::string &codeOut)
-{
-    if (tag == NULL) {
-        return VKB_INVALID_ARGS;
-    }
+        size_t iSection;
+        for (iSection = 0; iSection < sectionStats.size(); ++iSection) {
+            if (sectionStats[iSection].name == stats.section) {
+                break;
+            }
+        }
+        if (iSection == sectionStats.size()) {
+            vkbBuildCodeGenUnitStats section;
+            section.name = stats.section;
+            sectionStats.push_back(section);
+        }
 
-    VkbResult result = VKB_INVALID_ARGS;
-    if (strcmp(tag, "/*<<vk_video>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_Main(video, codeOut);
-    }
-    if (strcmp(tag, "/*<<vulkan_main>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_Main(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global:extern>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 0, true, codeOut);
-    }
-    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global:4>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 4, false, codeOut);
-    }
-    if (strcmp(tag, "/*<<vulkan_funcpointers_decl_global>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_FuncPointersDeclGlobal(vk, 0, false, codeOut);
-    }
-    if (strcmp(tag, "/*<<load_global_api_funcpointers>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_LoadVulkanFuncPointers(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<set_struct_api_from_global>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_SetStructAPIFromGlobal(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<set_global_api_from_struct>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_SetGlobalAPIFromStruct(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<load_instance_api>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_LoadInstanceAPI(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<load_device_api>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_LoadDeviceAPI(vk, codeOut);
-    }
-    if (strcmp(tag, "/*<<load_safe_global_api>>*/") == 0) {
-        result = vkbBuildGenerateCode_C_LoadSafeVulkanAPI(vk, codeOut);
-    }
-    if (strcmp(tag, "<<safe_global_api_docs>>") == 0) {
-        result = vkbBuildGenerateCode_C_SafeGlobalAPIDocs(vk, codeOut);
+        vkbBuildCodeGenUnitStats* pTotals[2] = {&sectionStats[iSection], &totalStats};
+        for (size_t iTotal = 0; iTotal < 2; ++iTotal) {
+            pTotals[iTotal]->lines    += stats.lines;
+            pTotals[iTotal]->bytes    += stats.bytes;
+            pTotals[iTotal]->types    += stats.types;
+            pTotals[iTotal]->structs  += stats.structs;
+            pTotals[iTotal]->enums    += stats.enums;
+            pTotals[iTotal]->defines  += stats.defines;
+            pTotals[iTotal]->commands += stats.commands;
+        }
     }
-    if (strcmp(tag, "<<vulkan_version>>") == 0) {
-        result = vkbBuildGenerateCode_C_VulkanVersion(vk, codeOut);
+
+    char header[512];
+    snprintf(header, sizeof(header), "%-56s %-28s %8s %10s %7s %7s %7s %7s %8s\n", "Name", "Section", "Lines", "Bytes", "Types", "Structs", "Enums", "Defines", "Commands");
+
+    std::string report;
+    report += "vkbind - v"; vkbBuildGenerateCode_C_VulkanVersion(vk, report);
+    report += ".";          vkbBuildGenerateCode_C_Revision(vk, report);
+    report += " - ";        vkbBuildGenerateCode_C_Date(vk, report);
+    report += "\n\n";
+    report += "Generated code per feature and extension. Each command is one function pointer in VkbAPI.\n\n";
+    report += header;
+    for (size_t iStats = 0; iStats < unitStats.size(); ++iStats) {
+        vkbBuildAppendReportRow(unitStats[iStats], report);
     }
-    if (strcmp(tag, "<<revision>>") == 0) {
-        result = vkbBuildGenerateCode_C_Revision(vk, codeOut);
+
+    report += "\n";
+    report += header;
+    for (size_t iSection = 0; iSection < sectionStats.size(); ++iSection) {
+        vkbBuildAppendReportRow(sectionStats[iSection], report);
     }
-    if (strcmp(tag, "<<date>>") == 0) {
-        result = vkbBuildGenerateCode_C_Date(vk, codeOut);
+    vkbBuildAppendReportRow(totalStats, report);
+
+    return vkbOpenAndWriteTextFileIfChanged(outputFilePath, report.c_str());
+}
+
+// Escapes the characters that have a special meaning in a Make depfile. Ninja understands the same escapes.
+std::string vkbBuildEscapeDepfilePath(const std::string &path)
+{
+    std::string result;
+    for (size_t iChar = 0; iChar < path.size(); ++iChar) {
+        if (path[iChar] == ' ' || path[iChar] == '#') {
+            result += '\\';
+        } else if (path[iChar] == '$') {
+            result += '$';
+        }
+        result += path[iChar];
     }
 
     return result;
@@ -3461,6 +9531,31 @@ VkbResult vkbBuildGenerateLib_C(VkbBuild &vk, VkbBuild &video, const char* outpu
     std::string outputStr = pTemplateFileData;
     free(pTemplateFileData);
 
+    // The main code is generated once up front. Most tags need to know what was output so they're all given the same state.
+    vkbBuildCodeGenOutput output;
+    result = vkbBuildGenerateCode_C_Output(vk, video, output);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    if (vk.codegenConfig.treatExtensionsAsSeparateHeaders) {
+        // The output file path is the loader header. Everything else goes into the same directory.
+        std::string outputFilePathStr = outputFilePath;
+        std::string outputDirectory;
+        std::string::size_type lastSlash = outputFilePathStr.find_last_of("/\\");
+        if (lastSlash != std::string::npos) {
+            outputDirectory = outputFilePathStr.substr(0, lastSlash + 1);
+        }
+
+        result = vkbBuildGenerateSplitHeaders_C(vk, output, outputDirectory, outputStr);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    } else {
+        vkbReplaceAllInline(outputStr, "/*<<platform_begin>>*/\n", "");
+        vkbReplaceAllInline(outputStr, "/*<<platform_end>>*/\n", "");
+    }
+
     // There will be a series of tags that we need to replace with generated code.
     const char* tags[] = {
         "/*<<vk_video>>*/",
@@ -3474,6 +9569,29 @@ VkbResult vkbBuildGenerateLib_C(VkbBuild &vk, VkbBuild &video, const char* outpu
         "/*<<load_instance_api>>*/",
         "/*<<load_device_api>>*/",
         "/*<<load_safe_global_api>>*/",
+        "/*<<struct_info>>*/",
+        "/*<<enum_strings_decl>>*/",
+        "/*<<enum_strings>>*/",
+        "/*<<deep_copy>>*/",
+        "/*<<hash_decl>>*/",
+        "/*<<hash>>*/",
+        "/*<<object_cache_decl>>*/",
+        "/*<<object_cache>>*/",
+        "/*<<enumerate_decl>>*/",
+        "/*<<enumerate>>*/",
+        "/*<<command_stream_decl>>*/",
+        "/*<<command_stream>>*/",
+        "/*<<state_filter_decl>>*/",
+        "/*<<state_filter>>*/",
+        "/*<<capture>>*/",
+        "/*<<capture_calls>>*/",
+        "/*<<externsync_check>>*/",
+        "/*<<format_info>>*/",
+        "/*<<sync_info>>*/",
+        "/*<<barrier_batch>>*/",
+        "/*<<handle_info>>*/",
+        "/*<<command_info>>*/",
+        "/*<<object_registry>>*/",
         "<<safe_global_api_docs>>",
         "<<vulkan_version>>",
         "<<revision>>",
@@ -3482,7 +9600,7 @@ VkbResult vkbBuildGenerateLib_C(VkbBuild &vk, VkbBuild &video, const char* outpu
 
     for (size_t iTag = 0; iTag < sizeof(tags)/sizeof(tags[0]); ++iTag) {
         std::string generatedCode;
-        result = vkbBuildGenerateCode_C(vk, video, tags[iTag], generatedCode);
+        result = vkbBuildGenerateCode_C(vk, video, output, tags[iTag], generatedCode);
         if (result != VKB_SUCCESS) {
             return result;
         }
@@ -3490,11 +9608,248 @@ VkbResult vkbBuildGenerateLib_C(VkbBuild &vk, VkbBuild &video, const char* outpu
         vkbReplaceAllInline(outputStr, tags[iTag], generatedCode);
     }
 
-    vkbOpenAndWriteTextFile(outputFilePath, outputStr.c_str());
+    // The module needs to be generated before vkbind.h is written because the revision is derived from the existing vkbind.h.
+    if (vk.codegenConfig.generateCppModule) {
+        std::string outputFilePathStr = outputFilePath;
+        std::string outputDirectory;
+        std::string::size_type lastSlash = outputFilePathStr.find_last_of("/\\");
+        if (lastSlash != std::string::npos) {
+            outputDirectory = outputFilePathStr.substr(0, lastSlash + 1);
+        }
+
+        result = vkbBuildGenerateModule_Cpp(vk, video, output, outputDirectory);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
+    // Same for the C++ header.
+    if (vk.codegenConfig.generateCppHeader) {
+        result = vkbBuildGenerateHeader_Cpp(vk, output.vkState, outputFilePath);
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
+    // Same for the report. This goes next to the header with a matching name (vkbind_report.txt, vkbind_sc_report.txt).
+    if (vk.codegenConfig.generateReport) {
+        std::string reportFilePath = outputFilePath;
+        std::string::size_type lastDot = reportFilePath.find_last_of('.');
+        reportFilePath = reportFilePath.substr(0, lastDot) + "_report.txt";
+
+        result = vkbBuildGenerateReport(vk, output, reportFilePath.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
+    result = vkbOpenAndWriteTextFileIfChanged(outputFilePath, outputStr.c_str());
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    // The depfile lets Make and Ninja re-run the generator only when one of the inputs has changed. The paths are absolute because
+    // they're resolved relative to the build directory rather than the bin directory the generator is run from.
+    if (vk.codegenConfig.depfilePath != "") {
+        std::string depfile = vkbBuildEscapeDepfilePath(vkbGetAbsolutePath(outputFilePath)) + ":";
+        depfile += " " + vkbBuildEscapeDepfilePath(vkbGetAbsolutePath(VKB_BUILD_XML_PATH_VK));
+        depfile += " " + vkbBuildEscapeDepfilePath(vkbGetAbsolutePath(VKB_BUILD_XML_PATH_VIDEO));
+        depfile += " " + vkbBuildEscapeDepfilePath(vkbGetAbsolutePath(VKB_BUILD_TEMPLATE_PATH));
+        if (vk.codegenConfig.profilePath != "") {
+            depfile += " " + vkbBuildEscapeDepfilePath(vkbGetAbsolutePath(vk.codegenConfig.profilePath.c_str()));
+        }
+        depfile += "\n";
+        result = vkbOpenAndWriteTextFileIfChanged(vk.codegenConfig.depfilePath.c_str(), depfile.c_str());
+        if (result != VKB_SUCCESS) {
+            return result;
+        }
+    }
+
     return VKB_SUCCESS;
 }
 
 
+/*
+Returns the core version an extension has been promoted to, following promotions to other extensions (EXT to KHR, for example). Returns
+an empty string if the extension has not been promoted to one of the features being generated.
+*/
+std::string vkbBuildGetPromotedCoreVersion(VkbBuild &context, const vkbBuildExtension &extension)
+{
+    std::string promotedto = extension.promotedto;
+    for (size_t iDepth = 0; iDepth < context.extensions.size() && promotedto != ""; ++iDepth) {
+        for (size_t iFeature = 0; iFeature < context.features.size(); ++iFeature) {
+            if (context.features[iFeature].name == promotedto) {
+                return promotedto;
+            }
+        }
+
+        size_t iExtension;
+        if (!vkbBuildFindExtensionByName(context, promotedto.c_str(), &iExtension)) {
+            break;
+        }
+
+        promotedto = context.extensions[iExtension].promotedto;
+    }
+
+    return "";
+}
+
+/*
+Modern mode. Extensions that have been fully promoted into a core version that's being generated, and extensions that have been
+deprecated, are removed. Code using the core names doesn't need them and they make up a big chunk of the header and VkbAPI. The
+removed extensions are kept in culledExtensions so their aliases of core names can be output as #defines.
+*/
+void vkbBuildCullExtensions(VkbBuild &context)
+{
+    std::vector<vkbBuildExtension> keptExtensions;
+
+    for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+        const vkbBuildExtension &extension = context.extensions[iExtension];
+        if (extension.isDeprecated || vkbBuildGetPromotedCoreVersion(context, extension) != "") {
+            context.culledExtensions.push_back(extension);
+        } else {
+            keptExtensions.push_back(extension);
+        }
+    }
+
+    context.extensions = keptExtensions;
+}
+
+/*
+Most programs never use the video std types from video.xml, but they make up a large part of the header. Extensions that depend on
+them are moved to a pseudo-platform protected by VKBIND_ENABLE_VIDEO so they're compiled out along with the video std section unless
+the application opts in. Treating it as a platform means the function pointers, loaders and split headers are all guarded the same
+way as any other platform-specific extension.
+*/
+void vkbBuildGuardVideoExtensions(VkbBuild &context)
+{
+    bool hasVideoExtensions = false;
+
+    for (size_t iExtension = 0; iExtension < context.extensions.size(); ++iExtension) {
+        vkbBuildExtension &extension = context.extensions[iExtension];
+        if (extension.platform != "") {
+            continue;   // <-- Already guarded by a platform macro.
+        }
+
+        vkbBuildCodeGenDependencies dependencies;
+        if (dependencies.ParseExtensionDependencies(context, extension) != VKB_SUCCESS) {
+            continue;
+        }
+
+        for (size_t iType = 0; iType < dependencies.typeIndexes.size(); ++iType) {
+            const vkbBuildType &type = context.types[dependencies.typeIndexes[iType]];
+            if (type.category == "include" && type.name.find("vk_video/") != std::string::npos) {
+                extension.platform = VKB_BUILD_VIDEO_PLATFORM_NAME;
+                hasVideoExtensions = true;
+                break;
+            }
+        }
+    }
+
+    if (hasVideoExtensions) {
+        vkbBuildPlatform platform;
+        platform.name    = VKB_BUILD_VIDEO_PLATFORM_NAME;
+        platform.protect = "VKBIND_ENABLE_VIDEO";
+        context.platforms.push_back(platform);
+    }
+}
+
+struct vkbBuildProfileEntry
+{
+    std::string name;
+    unsigned long long count;
+};
+
+bool vkbBuildCompareProfileEntries(const vkbBuildProfileEntry &a, const vkbBuildProfileEntry &b)
+{
+    return a.count > b.count;
+}
+
+/*
+Loads a call-frequency profile. This is a list of command names each followed by the number of times it was called. The format is
+deliberately loose so both a plain text file ("vkCmdDraw 1234" per line, with # comments) and a JSON object ({"vkCmdDraw": 1234})
+work. Anything else in the file is ignored. Names that aren't being output but are an alias of a command that is (vkCmdDrawIndirectCountKHR,
+for example, when the KHR extension has been culled) are mapped to that command.
+*/
+VkbResult vkbBuildLoadProfile(VkbBuild &context, const char* pFilePath)
+{
+    size_t fileSize;
+    char* pFileData;
+    VkbResult result = vkbOpenAndReadTextFile(pFilePath, &fileSize, &pFileData);
+    if (result != VKB_SUCCESS) {
+        return result;
+    }
+
+    // Split into identifiers and numbers, skipping comments.
+    std::vector<std::string> tokens;
+    for (size_t iChar = 0; iChar < fileSize; ) {
+        if (pFileData[iChar] == '#') {
+            while (iChar < fileSize && pFileData[iChar] != '\n') {
+                iChar += 1;
+            }
+            continue;
+        }
+
+        if (!isalnum((unsigned char)pFileData[iChar]) && pFileData[iChar] != '_') {
+            iChar += 1;
+            continue;
+        }
+
+        size_t tokenBeg = iChar;
+        while (iChar < fileSize && (isalnum((unsigned char)pFileData[iChar]) || pFileData[iChar] == '_')) {
+            iChar += 1;
+        }
+
+        tokens.push_back(std::string(pFileData + tokenBeg, iChar - tokenBeg));
+    }
+
+    free(pFileData);
+
+    std::vector<vkbBuildProfileEntry> entries;
+    for (size_t iToken = 0; iToken + 1 < tokens.size(); ++iToken) {
+        if (tokens[iToken].compare(0, 2, "vk") != 0 || !isdigit((unsigned char)tokens[iToken + 1][0])) {
+            continue;
+        }
+
+        vkbBuildProfileEntry entry;
+        entry.name  = tokens[iToken];
+        entry.count = strtoull(tokens[iToken + 1].c_str(), NULL, 10);
+
+        // Map aliases to the command that's actually being output.
+        std::string unit;
+        size_t iCommand;
+        for (size_t iDepth = 0; iDepth < context.commands.size() && !vkbBuildFindRequireCommandUnit(context, entry.name, unit); ++iDepth) {
+            if (!vkbBuildFindCommandByName(context, entry.name.c_str(), &iCommand) || context.commands[iCommand].alias == "") {
+                break;
+            }
+            entry.name = context.commands[iCommand].alias;
+        }
+
+        // The same command can appear more than once if aliases were recorded separately.
+        size_t iEntry;
+        for (iEntry = 0; iEntry < entries.size(); ++iEntry) {
+            if (entries[iEntry].name == entry.name) {
+                entries[iEntry].count += entry.count;
+                break;
+            }
+        }
+        if (iEntry == entries.size() && entry.count > 0) {
+            entries.push_back(entry);
+        }
+
+        iToken += 1;
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), vkbBuildCompareProfileEntries);
+
+    context.codegenConfig.hotCommands.clear();
+    for (size_t iEntry = 0; iEntry < entries.size(); ++iEntry) {
+        context.codegenConfig.hotCommands.push_back(entries[iEntry].name);
+    }
+
+    return VKB_SUCCESS;
+}
+
 static VkbResult vkbBuildStateInit(const char* pXMLFilePath, VkbBuild &context)
 {
     tinyxml2::XMLError xmlError;
@@ -3546,6 +9901,16 @@ static VkbResult vkbBuildStateInit(const char* pXMLFilePath, VkbBuild &context)
         if (strcmp(pChildElement->Name(), "extensions") == 0) {
             vkbBuildParseExtensions(context, pChildElement);
         }
+        if (strcmp(pChildElement->Name(), "formats") == 0) {
+            vkbBuildParseFormats(context, pChildElement);
+        }
+        if (strcmp(pChildElement->Name(), "sync") == 0) {
+            vkbBuildParseSync(context, pChildElement);
+        }
+    }
+
+    if (context.codegenConfig.modern) {
+        vkbBuildCullExtensions(context);
     }
 
     return VKB_SUCCESS;
@@ -3581,11 +9946,77 @@ int main(int argc, char** argv)
     VkbResult result;
     VkbBuild video;
     VkbBuild vk;
+    bool forceDownload = true;  // <-- Set to false with --no-download. The registry is still downloaded if it's missing.
+    const char* profileFilePath = NULL;
+
+    for (int iArg = 1; iArg < argc; iArg += 1) {
+        if (strcmp(argv[iArg], "--split-headers") == 0) {
+            vk.codegenConfig.treatExtensionsAsSeparateHeaders = true;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--api") == 0 && iArg + 1 < argc) {
+            iArg += 1;
+            if (strcmp(argv[iArg], "vulkan") != 0 && strcmp(argv[iArg], "vulkansc") != 0) {
+                printf("Unknown API: %s. Expecting \"vulkan\" or \"vulkansc\".\n", argv[iArg]);
+                return -1;
+            }
+
+            vk.codegenConfig.api    = argv[iArg];
+            video.codegenConfig.api = argv[iArg];
+            continue;
+        }
 
-    (void)argc;
-    (void)argv;
+        if (strcmp(argv[iArg], "--cpp-module") == 0) {
+            vk.codegenConfig.generateCppModule = true;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--modern") == 0) {
+            vk.codegenConfig.modern = true;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--cpp-header") == 0) {
+            vk.codegenConfig.generateCppHeader = true;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--report") == 0) {
+            vk.codegenConfig.generateReport = true;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--depfile") == 0 && iArg + 1 < argc) {
+            iArg += 1;
+            vk.codegenConfig.depfilePath = argv[iArg];
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--profile") == 0 && iArg + 1 < argc) {
+            iArg += 1;
+            profileFilePath = argv[iArg];
+            vk.codegenConfig.profilePath = profileFilePath;
+            continue;
+        }
+
+        if (strcmp(argv[iArg], "--no-download") == 0) {
+            forceDownload = false;
+            continue;
+        }
+
+        printf("Unknown argument: %s\n", argv[iArg]);
+        return -1;
+    }
+
+    // The Vulkan SC header is output separately so it doesn't overwrite the main one.
+    std::string outputFilePath = (vk.codegenConfig.api == "vulkansc") ? "../../vkbind_sc" : "../../vkbind";
+    if (vk.codegenConfig.treatExtensionsAsSeparateHeaders) {
+        outputFilePath += "/vkbind.h";
+    } else {
+        outputFilePath += ".h";
+    }
 
-    bool forceDownload = true;
     if (forceDownload || _access_s(VKB_BUILD_XML_PATH_VK, 04) != 0) {   // 04 = Read access.
         printf("vk.xml not found. Attempting to download...\n");
         std::string cmd = "curl -o " VKB_BUILD_XML_PATH_VK " https://raw.githubusercontent.com/KhronosGroup/Vulkan-Docs/main/xml/vk.xml";
@@ -3617,8 +10048,20 @@ int main(int argc, char** argv)
         return -1;
     }
 
+    // Only the main registry is guarded. The video std headers themselves are guarded as a whole where they're output.
+    vkbBuildGuardVideoExtensions(vk);
+
+    // The profile needs to be loaded after the registry so aliases can be resolved.
+    if (profileFilePath != NULL) {
+        result = vkbBuildLoadProfile(vk, profileFilePath);
+        if (result != VKB_SUCCESS) {
+            printf("Failed to load profile: %s\n", profileFilePath);
+            return -1;
+        }
+    }
+
 
-    result = vkbBuildGenerateLib_C(vk, video, "../../vkbind.h");
+    result = vkbBuildGenerateLib_C(vk, video, outputFilePath.c_str());
     if (result != VKB_SUCCESS) {
         printf("Failed to generate C code.\n");
         return result;
@@ -83,6 +83,59 @@ Example:
         vkbUninit();
         return 0;
     }
+
+
+The video std types (H.264, H.265, AV1, etc.) and the extensions that depend on them are large and rarely needed so they
+are compiled out by default. Define VKBIND_ENABLE_VIDEO before including vkbind.h to enable them. This needs to be
+defined consistently in every translation unit, including the one with VKBIND_IMPLEMENTATION.
+
+Define VKBIND_ENUM_STRINGS to enable conversions between enum values and their names, such as vkbEnumToString() and
+vkbFlagsToString(). The tables are generated from the registry so they always cover every value. They're large so they're
+compiled out by default.
+
+Define VKBIND_DEEP_COPY to enable vkbDeepCopySize() and vkbDeepCopy() which copy a structure, its pNext chain and everything they
+point to into a single buffer. This is useful for keeping create infos around after the call that received them has returned,
+such as when handing them off to another thread.
+
+Define VKBIND_HASH to enable vkbHash() and vkbEqual(), and typed versions for every structure such as vkbHash_VkSamplerCreateInfo(),
+for using structures as keys in hash tables.
+
+Define VKBIND_OBJECT_CACHE to enable VkbObjectCache which shares samplers, descriptor set layouts, pipeline layouts and render passes
+between everything that creates them with equal create infos, such as vkbCreateSharedSampler(). This enables VKBIND_DEEP_COPY and
+VKBIND_HASH. The cache is thread safe and uses pthreads on platforms other than Windows, so you may need to link with -lpthread.
+
+Define VKBIND_ENUMERATE to enable helpers for commands that return arrays, such as vkbEnumerate_vkEnumeratePhysicalDevices(). They
+do both calls of the count-then-fill idiom, handle VK_INCOMPLETE and take the array from a VkbArena instead of the heap.
+
+Define VKBIND_OBJECT_REGISTRY to enable VkbObjectRegistry which keeps track of live objects and their parents. Use it to report
+leaked objects and to destroy an object along with everything created from it. Objects are tracked automatically once the registry
+is installed into a VkbAPI object with vkbInstallObjectRegistry(). Like the object cache it's thread safe and uses pthreads on
+platforms other than Windows.
+
+Define VKBIND_BARRIER_BATCH to enable VkbBarrierBatch which collects the barriers needed at a sync point from any number of places,
+merges the ones that can be merged and records them with a single vkCmdPipelineBarrier2().
+
+Define VKBIND_COMMAND_STREAM to enable VkbCommandStream which records vkCmd* commands into memory instead of a command buffer, such
+as with vkbEncode_vkCmdDraw(). Streams can be recorded on any thread and replayed into a real command buffer later with
+vkbCommandStreamReplay(). This enables VKBIND_DEEP_COPY.
+
+Define VKBIND_STATE_FILTER to enable VkbStateFilter which drops vkCmd* calls that set state to what it already is, such as binding
+the pipeline that's already bound, with vkbFilter_vkCmdBindPipeline() and friends. This enables VKBIND_COMMAND_STREAM and
+VKBIND_HASH.
+
+Define VKBIND_CAPTURE to enable vkbBeginCapture() and vkbEndCapture() which record every call made through a VkbAPI object, along
+with the handles they return and the changes made to mapped memory, and vkbReplayCapture() which makes the calls again, such as in a
+separate program that reproduces a problem. It also enables vkbCommandStreamSave() and vkbCommandStreamLoad() which turn a
+VkbCommandStream into a buffer that can be written to a file, and vkbCommandStreamRemapHandles() for swapping the handles it refers
+to for the ones in the process that loads it. Capturing uses a thread for writing and uses pthreads on platforms other than Windows.
+This enables VKBIND_COMMAND_STREAM.
+
+Define VKBIND_EXTERNSYNC_CHECK to enable vkbInstallExternSyncCheck() which reports when two threads use an object that must be
+externally synchronized at the same time, such as recording into the same command buffer. This is for debugging and uses pthreads
+on platforms other than Windows.
+
+Define VKBIND_COMMAND_INFO to enable vkbGetCommandInfo() which describes the parameters and result codes of every command, for
+tools such as tracers and validators that handle every command the same way.
 */
 
 #ifndef VKBIND_H
@@ -92,6 +145,7 @@ Example:
 extern "C" {
 #endif
 
+/*<<platform_begin>>*/
 /*
 vkbind's vk_platform.h implementation. See: https://www.khronos.org/registry/vulkan/specs/1.0/html/vkspec.html#boilerplate-platform-specific-calling-conventions
 
@@ -129,6 +183,14 @@ will be added later. Let me know what isn't supported properly and I'll look int
     #include <stddef.h>
 #endif  /* VK_NO_STDDEF_H */
 
+/*
+64-bit flags can't be declared as enums so they're declared as constants instead. The C++ module (vkbind.cppm) overrides this
+with `inline constexpr` so the constants have external linkage and can be exported.
+*/
+#ifndef VKBIND_FLAGS64_CONST
+#define VKBIND_FLAGS64_CONST static const
+#endif
+
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
     #if !defined(VKBIND_NO_WIN32_HEADERS)
         #include <windows.h>
@@ -159,6 +221,7 @@ will be added later. Let me know what isn't supported properly and I'll look int
         typedef unsigned long vkbind_VisualID;
     #endif
 #endif
+/*<<platform_end>>*/
 
 /*<<vk_video>>*/
 /*<<vulkan_main>>*/
@@ -224,282 +287,5709 @@ Binds the function pointers in pAPI to global scope.
 */
 VkResult vkbBindAPI(const VkbAPI* pAPI);
 
-#ifdef __cplusplus
-}
-#endif
-#endif  /* VKBIND_H */
 
+/*
+Structure type metadata. There is one of these for every VkStructureType value. Values whose structure is not available in
+this build, such as platform-specific structures when the platform macro is not defined, have a NULL pName and a size of 0.
+*/
+typedef struct
+{
+    VkStructureType sType;
+    const char* pName;
+    size_t size;
+    size_t alignment;
+    const VkStructureType* pExtends;    /* The structure types this structure can be chained to with pNext. */
+    uint32_t extendsCount;
+} VkbStructInfo;
 
+#define VKB_INVALID_STRUCT_TYPE_INDEX   0xFFFFFFFF
 
-/******************************************************************************
- ******************************************************************************
+/*
+Retrieves a compact index for the given structure type in constant time. The indices are dense and start at 0 so they can be
+used for indexing into your own tables. Returns VKB_INVALID_STRUCT_TYPE_INDEX if the structure type is unknown.
+*/
+uint32_t vkbGetStructTypeIndex(VkStructureType sType);
 
- IMPLEMENTATION
+/*
+Retrieves the number of structure type indices. All indices returned by vkbGetStructTypeIndex() are less than this.
+*/
+uint32_t vkbGetStructTypeCount(void);
 
- ******************************************************************************
- ******************************************************************************/
-#ifdef VKBIND_IMPLEMENTATION
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <unistd.h>
-#include <dlfcn.h>
-#endif
+/*
+Retrieves the metadata of the given structure type in constant time. Returns NULL if the structure type is unknown.
+*/
+const VkbStructInfo* vkbGetStructInfo(VkStructureType sType);
 
-#ifndef VKBIND_NO_GLOBAL_API
-/*<<vulkan_funcpointers_decl_global>>*/
-#endif /*VKBIND_NO_GLOBAL_API*/
+/*
+Finds the structure with the given type in a pNext chain. pHead itself is included in the search. Returns NULL if the
+structure is not in the chain.
+*/
+void* vkbFindInChain(const void* pHead, VkStructureType sType);
 
-typedef void* VkbHandle;
-typedef void (* VkbProc)(void);
+/*
+Retrieves the combined size in bytes of every structure in a pNext chain, including pHead. Structures with an unknown type,
+or whose type is not available in this build, count as 0.
+*/
+size_t vkbChainSize(const void* pHead);
 
-static VkbHandle vkb_dlopen(const char* filename)
+
+/*
+The numeric format of a format component.
+*/
+typedef enum
 {
-#ifdef _WIN32
-    return (VkbHandle)LoadLibraryA(filename);
-#else
-    return (VkbHandle)dlopen(filename, RTLD_NOW);
-#endif
-}
+    VKB_NUMERIC_FORMAT_UNKNOWN = 0,
+    VKB_NUMERIC_FORMAT_UNORM,
+    VKB_NUMERIC_FORMAT_SNORM,
+    VKB_NUMERIC_FORMAT_USCALED,
+    VKB_NUMERIC_FORMAT_SSCALED,
+    VKB_NUMERIC_FORMAT_UINT,
+    VKB_NUMERIC_FORMAT_SINT,
+    VKB_NUMERIC_FORMAT_UFLOAT,
+    VKB_NUMERIC_FORMAT_SFLOAT,
+    VKB_NUMERIC_FORMAT_SRGB,
+    VKB_NUMERIC_FORMAT_SFIXED5
+} VkbNumericFormat;
 
-static void vkb_dlclose(VkbHandle handle)
+typedef struct
 {
-#ifdef _WIN32
-    FreeLibrary((HMODULE)handle);
-#else
-    dlclose((void*)handle);
-#endif
-}
+    char name;                          /* 'R', 'G', 'B', 'A', 'D' or 'S'. */
+    uint8_t bits;                       /* 0 for block-compressed formats. */
+    uint8_t planeIndex;                 /* The plane the component is in. Always 0 for formats with a single plane. */
+    VkbNumericFormat numericFormat;
+} VkbFormatComponent;
 
-static VkbProc vkb_dlsym(VkbHandle handle, const char* symbol)
+typedef struct
 {
-#ifdef _WIN32
-    return (VkbProc)GetProcAddress((HMODULE)handle, symbol);
-#else
-#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wpedantic"
-#endif
-    return (VkbProc)dlsym((void*)handle, symbol);
-#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
-    #pragma GCC diagnostic pop
-#endif
-#endif
-}
+    uint8_t widthDivisor;
+    uint8_t heightDivisor;
+    VkFormat compatibleFormat;          /* The single-plane format the plane can be accessed as, such as VK_FORMAT_R8_UNORM. */
+} VkbFormatPlane;
 
+/*
+Format metadata from the formats section of the registry. blockSize is the size in bytes of a texel block, which is a single
+texel for uncompressed formats. For multi-planar formats, the size of each plane comes from the block size of its compatible
+format.
+*/
+typedef struct
+{
+    VkFormat format;
+    const char* pClass;                 /* The compatibility class, such as "32-bit" or "BC1_RGB". */
+    uint32_t blockSize;
+    uint32_t texelsPerBlock;
+    uint8_t blockExtent[3];             /* {1, 1, 1} for uncompressed formats. */
+    uint8_t packed;                     /* The number of bits the components are packed into, or 0 if they aren't packed. */
+    const char* pCompression;           /* The compression scheme, such as "BC" or "ASTC LDR", or NULL if the format is not compressed. */
+    uint32_t componentCount;
+    VkbFormatComponent components[4];
+    uint32_t planeCount;                /* 0 for formats that aren't multi-planar. */
+    VkbFormatPlane planes[3];
+} VkbFormatInfo;
 
-static unsigned int g_vkbInitCount = 0;
-static VkbHandle g_vkbVulkanSO = NULL;
+/*
+Retrieves the metadata of a format in constant time. Returns NULL if the format is unknown or has no metadata, such as
+VK_FORMAT_UNDEFINED.
+*/
+const VkbFormatInfo* vkbGetFormatInfo(VkFormat format);
 
-static VkResult vkbLoadVulkanSO()
-{
-    size_t i;
+/*
+Retrieves the size in bytes of a texel block of a format. Returns 0 if the format is unknown.
+*/
+uint32_t vkbFormatBlockSize(VkFormat format);
 
-    const char* vulkanSONames[] = {
-    #if defined(VKBIND_VULKAN_SO)
-        VKBIND_VULKAN_SO,
-    #endif
-    #if defined(_WIN32)
-        "vulkan-1.dll"
-    #elif defined(__APPLE__)
-        /*
-        The idea here is that since MoltenVK seems to be the de facto standard for Vulkan on Apple platforms at the moment we'll try
-        that first. If Apple ever decides to officially support Vulkan we can perhaps consider dropping it to the bottom of the priority
-        list. Not sure if this reasoning is sound, but it makes sense in my head!
-        */
-        "libMoltenVK.dylib",
-        "libvulkan.dylib.1",
-        "libvulkan.dylib"
-    #else
-        "libvulkan.so.1",
-        "libvulkan.so"
-    #endif
-    };
+/*
+Retrieves the size in texels of a texel block of a format. This is {1, 1, 1} for uncompressed formats and {0, 0, 0} if the format
+is unknown.
+*/
+VkExtent3D vkbFormatBlockExtent(VkFormat format);
 
-    for (i = 0; i < sizeof(vulkanSONames)/sizeof(vulkanSONames[0]); ++i) {
-        VkbHandle handle = vkb_dlopen(vulkanSONames[i]);
-        if (handle != NULL) {
-            g_vkbVulkanSO = handle;
-            return VK_SUCCESS;
-        }
+/*
+Checks whether or not a format has the given component. The component is one of 'R', 'G', 'B', 'A', 'D' or 'S'.
+
+    if (vkbFormatHasComponent(format, 'S')) {
+        aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
     }
+*/
+VkBool32 vkbFormatHasComponent(VkFormat format, char component);
 
-    return VK_ERROR_INCOMPATIBLE_DRIVER;
-}
+/*
+Retrieves the number of bits of a component of a format. Returns 0 if the format doesn't have the component, or if it's
+block-compressed.
+*/
+uint32_t vkbFormatComponentBits(VkFormat format, char component);
 
-static VkResult vkbLoadVulkanSymbols(VkbAPI* pAPI)
-{
-    /*<<load_global_api_funcpointers>>*/
+/*
+Calculates the size in bytes of a tightly packed image of a format, such as the staging data of a single mip level. Partial blocks
+are rounded up and each plane of a multi-planar format is included. Returns 0 if the format is unknown.
+*/
+VkDeviceSize vkbFormatImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth);
 
-    /*
-    We can only safely guarantee that vkGetInstanceProcAddr was successfully returned from dlsym(). The Vulkan specification lists some APIs
-    that should always work with vkGetInstanceProcAddr(), so I'm going ahead and doing that here just for robustness.
-    */
-    if (pAPI->vkGetInstanceProcAddr == NULL) {
-        return VK_ERROR_INITIALIZATION_FAILED;
-    }
 
-    /*<<load_safe_global_api>>*/
+/*
+Adds the stages that meta stages stand for according to the sync section of the registry. VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, for
+example, adds VK_PIPELINE_STAGE_2_COPY_BIT and the other transfer stages. This is done recursively. The stages that were passed in
+are kept.
+*/
+VkPipelineStageFlags2 vkbExpandPipelineStages(VkPipelineStageFlags2 stages);
 
-    return VK_SUCCESS;
-}
+/*
+Adds the accesses that meta accesses stand for, such as VK_ACCESS_2_SHADER_SAMPLED_READ_BIT for VK_ACCESS_2_SHADER_READ_BIT. The
+accesses that were passed in are kept.
+*/
+VkAccessFlags2 vkbExpandAccesses(VkAccessFlags2 accesses);
 
-#ifndef VKBIND_NO_GLOBAL_API
-static void vkbInitFromGlobalAPI(VkbAPI* pAPI)
-{
-    /*<<set_struct_api_from_global>>*/
-}
-#endif /*VKBIND_NO_GLOBAL_API*/
+/*
+Checks whether or not every stage can be used on a queue with the given capabilities. Stages that the registry doesn't restrict
+to particular queues are supported by every queue.
+*/
+VkBool32 vkbArePipelineStagesSupportedByQueue(VkPipelineStageFlags2 stages, VkQueueFlags queueFlags);
 
-VkResult vkbInit(VkbAPI* pAPI)
+/*
+Checks whether or not every access in a barrier is supported by at least one of its stages, taking meta stages into account.
+VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT supports every access, as do accesses the registry has no information about, such as
+VK_ACCESS_2_MEMORY_READ_BIT.
+*/
+VkBool32 vkbAreAccessesSupportedByStages(VkAccessFlags2 accesses, VkPipelineStageFlags2 stages);
+
+
+/*
+Information about a handle type from the registry.
+*/
+typedef struct
 {
-    VkResult result;
+    const char* pName;                      /* The name of the handle type, such as "VkSampler". */
+    VkObjectType objectType;
+    VkObjectType parentObjectType;          /* VK_OBJECT_TYPE_UNKNOWN if the handle has no parent, such as VkInstance. */
+    VkBool32 isDispatchable;
+    const char* const* ppCreateCommands;    /* The commands that create or allocate objects of this type. */
+    uint32_t createCommandCount;
+    const char* pDestroyCommand;            /* NULL if objects of this type are never destroyed explicitly, such as VkPhysicalDevice. */
+} VkbHandleInfo;
 
-    /* If the Vulkan SO has not been loaded, do that first thing. */
-    if (g_vkbInitCount == 0) {
-        result = vkbLoadVulkanSO();
-        if (result != VK_SUCCESS) {
-            return result;
-        }
-    }
+/*
+Retrieves information about a handle type. Returns NULL if the object type is unknown or not available in this build.
+*/
+const VkbHandleInfo* vkbGetHandleInfo(VkObjectType objectType);
 
-    #if defined(VKBIND_NO_GLOBAL_API)
-    {
-        /* Getting here means the global API has been disabled. Therefore the caller *must* provide a VkbAPI object. */
-        if (pAPI == NULL) {
-            return VK_ERROR_INITIALIZATION_FAILED;
-        } else {
-            /* Since we don't have global function pointers we'll have to use dlsym() every time we initialize. */
-            result = vkbLoadVulkanSymbols(pAPI);
-            if (result != VK_SUCCESS) {
-                return result;
-            }
-        }
-    }
-    #else
-    {
-        if (pAPI == NULL) {
-            if (g_vkbInitCount == 0) {
-                VkbAPI api;
-                result = vkbInit(&api);
-                if (result != VK_SUCCESS) {
-                    return result;
-                }
 
-                /* The call to vkbInit() will have incremented the reference counter. Bring it back down since we're just going to increment it again later. */
-            } else {
-                /* The global API has already been bound. No need to do anything here. */
-            }
-        } else {
-            if (g_vkbInitCount == 0) {
-                result = vkbLoadVulkanSymbols(pAPI);
-                if (result != VK_SUCCESS) {
-                    return result;
-                }
+#ifdef VKBIND_COMMAND_INFO
+/*
+The kind of type a parameter is, or points to.
+*/
+typedef enum
+{
+    VKB_PARAM_KIND_SCALAR = 0,  /* Integers, floats, chars and base types such as VkBool32 and VkDeviceSize. */
+    VKB_PARAM_KIND_VOID,        /* Only ever pointed to, such as the pData of vkMapMemory(). */
+    VKB_PARAM_KIND_ENUM,
+    VKB_PARAM_KIND_BITMASK,
+    VKB_PARAM_KIND_HANDLE,
+    VKB_PARAM_KIND_STRUCT,
+    VKB_PARAM_KIND_UNION,
+    VKB_PARAM_KIND_FUNCPOINTER,
+    VKB_PARAM_KIND_PLATFORM     /* Window system types such as HWND and Display. */
+} VkbParamKind;
 
-                result = vkbBindAPI(pAPI);
-                if (result != VK_SUCCESS) {
-                    return result;
-                }
-            } else {
-                /* The global API has already been bound. We need only retrieve the pointers from the globals. Using dlsym() would be too inefficient. */
-                vkbInitFromGlobalAPI(pAPI);
-            }
-        }
-    }
-    #endif
+#define VKB_PARAM_IN                    0x0001  /* Read by the command. Values and pointers to const, as well as counts like pPropertyCount. */
+#define VKB_PARAM_OUT                   0x0002  /* Written by the command. Pointers to non-const. */
+#define VKB_PARAM_OPTIONAL              0x0004  /* Can be 0, VK_NULL_HANDLE or NULL. */
+#define VKB_PARAM_OPTIONAL_POINTEE      0x0008  /* What the parameter points to can be 0, such as *pPropertyCount. */
+#define VKB_PARAM_EXTERNSYNC            0x0010  /* The parameter, or each handle in the array, must be externally synchronized. */
+#define VKB_PARAM_EXTERNSYNC_MEMBERS    0x0020  /* Some of the handles the parameter points to must be externally synchronized. */
+#define VKB_PARAM_NULL_TERMINATED       0x0040  /* A string, or an array of strings. */
 
-    g_vkbInitCount += 1;    /* <-- Only increment the init counter on success. */
-    return VK_SUCCESS;
-}
+#define VKB_PARAM_INDEX_NONE            0xFF
 
-void vkbUninit()
+/*
+Describes a parameter of a command. The length of an array comes from the parameter at lenIndex. When that parameter is a pointer to
+a structure, the length is the uint32_t at lenOffset in the structure, such as pAllocateInfo->commandBufferCount. Otherwise it's the
+value of the parameter, or what it points to. Lengths that are expressions, such as the pSampleMask of vkCmdSetSampleMaskEXT(), have
+no lenIndex.
+*/
+typedef struct
 {
-    if (g_vkbInitCount == 0) {
-        return;
-    }
+    const char* pName;
+    const char* pTypeName;      /* The type without const or pointers, such as "VkBufferCreateInfo" or "uint32_t". */
+    uint8_t kind;               /* A VkbParamKind. */
+    uint8_t pointerDepth;       /* 1 for pointers and fixed size arrays, 2 for pointers to pointers such as ppData. */
+    uint8_t lenIndex;           /* VKB_PARAM_INDEX_NONE if the parameter isn't an array with its length in another parameter. */
+    uint16_t flags;             /* VKB_PARAM_* */
+    uint16_t lenOffset;
+    uint16_t fixedLen;          /* The number of elements of a fixed size array such as blendConstants[4]. Otherwise 0. */
+    VkObjectType objectType;    /* For handles. VK_OBJECT_TYPE_UNKNOWN otherwise. */
+    VkStructureType sType;      /* For structures with a fixed sType. 0 otherwise. */
+} VkbParamInfo;
 
-    g_vkbInitCount -= 1;
-    if (g_vkbInitCount == 0) {
-        vkb_dlclose(g_vkbVulkanSO);
-        g_vkbVulkanSO = NULL;
-    }
-}
+typedef enum
+{
+    VKB_COMMAND_LEVEL_GLOBAL = 0,   /* Loaded with vkGetInstanceProcAddr() and a NULL instance, such as vkCreateInstance(). */
+    VKB_COMMAND_LEVEL_INSTANCE,
+    VKB_COMMAND_LEVEL_DEVICE        /* Can be loaded with vkGetDeviceProcAddr(). */
+} VkbCommandLevel;
 
-VkResult vkbInitInstanceAPI(VkInstance instance, VkbAPI* pAPI)
+/*
+Describes a command. Aliases, such as vkGetPhysicalDeviceFeatures2KHR, have their own entry with the same parameters as the command
+they alias. The function pointer of the command is at apiOffset in VkbAPI:
+
+    PFN_vkVoidFunction proc = *(PFN_vkVoidFunction*)((char*)&api + pInfo->apiOffset);
+*/
+typedef struct
 {
-    if (g_vkbInitCount == 0) {
-        return VK_ERROR_INITIALIZATION_FAILED;  /* vkbind not initialized. */
-    }
+    const char* pName;
+    const char* pReturnTypeName;    /* Such as "VkResult" or "void". */
+    size_t apiOffset;
+    VkbCommandLevel level;
+    const VkbParamInfo* pParams;
+    uint32_t paramCount;
+    const VkResult* pSuccessCodes;
+    uint32_t successCodeCount;
+    const VkResult* pErrorCodes;
+    uint32_t errorCodeCount;
+} VkbCommandInfo;
 
-    if (pAPI == NULL) {
-        return VK_ERROR_INITIALIZATION_FAILED;
-    }
+/*
+Retrieves information about a command with a binary search. Returns NULL if the command is unknown or not available in this build.
+*/
+const VkbCommandInfo* vkbGetCommandInfo(const char* pName);
 
-    /*
+/*
+Retrieves the number of commands available in this build. Use with vkbGetCommandInfoByIndex() to go over every command.
+*/
+uint32_t vkbGetCommandCount(void);
+
+/*
+Retrieves information about a command by its index. Commands are sorted by name. Returns NULL if index is out of range.
+*/
+const VkbCommandInfo* vkbGetCommandInfoByIndex(uint32_t index);
+#endif  /* VKBIND_COMMAND_INFO */
+
+
+/*
+A linear allocator over a buffer owned by the caller. Allocations are aligned to 8 bytes relative to pData so pData should be aligned
+to at least 8 bytes. Nothing is freed individually. Set cursor back to 0, or to an earlier value of cursor, to reuse the memory.
+*/
+typedef struct
+{
+    void* pData;
+    size_t capacity;
+    size_t cursor;
+} VkbArena;
+
+/*
+Initializes an arena over a buffer of capacity bytes.
+*/
+void vkbArenaInit(VkbArena* pArena, void* pData, size_t capacity);
+
+/*
+Allocates size bytes from an arena. Returns NULL if there isn't enough space left, in which case the arena is left unchanged.
+*/
+void* vkbArenaAlloc(VkbArena* pArena, size_t size);
+
+
+/* The object cache is built on top of deep copying and hashing. */
+#ifdef VKBIND_OBJECT_CACHE
+    #ifndef VKBIND_DEEP_COPY
+    #define VKBIND_DEEP_COPY
+    #endif
+    #ifndef VKBIND_HASH
+    #define VKBIND_HASH
+    #endif
+#endif
+
+/* The state filter keeps a copy of the last call that set each piece of state and compares new calls against it. */
+#ifdef VKBIND_STATE_FILTER
+    #ifndef VKBIND_COMMAND_STREAM
+    #define VKBIND_COMMAND_STREAM
+    #endif
+    #ifndef VKBIND_HASH
+    #define VKBIND_HASH
+    #endif
+#endif
+
+/* Captures record calls into command streams. */
+#ifdef VKBIND_CAPTURE
+    #ifndef VKBIND_COMMAND_STREAM
+    #define VKBIND_COMMAND_STREAM
+    #endif
+#endif
+
+/* Command streams use deep copying for the data that commands point to. */
+#ifdef VKBIND_COMMAND_STREAM
+    #ifndef VKBIND_DEEP_COPY
+    #define VKBIND_DEEP_COPY
+    #endif
+#endif
+
+
+#ifdef VKBIND_DEEP_COPY
+/*
+Retrieves the number of bytes needed to deep copy a structure with vkbDeepCopy(). This includes the structure itself, its pNext
+chain, and everything they point to, such as arrays, strings and nested structures. pSrc must start with an sType. Returns 0 if
+the structure type is unknown.
+*/
+size_t vkbDeepCopySize(const void* pSrc);
+
+/*
+Deep copies a structure into a single buffer, typically one allocated with the size returned by vkbDeepCopySize(). The copy is at
+the start of the buffer and every pointer in it points to somewhere else in the buffer, so the source can be freed as soon as this
+returns and the copy is freed by freeing the buffer. pDst must be aligned to at least 8 bytes. Returns pDst, or NULL if the
+buffer is too small or the structure type is unknown.
+
+    size_t size = vkbDeepCopySize(&createInfo);
+    VkGraphicsPipelineCreateInfo* pCopy = (VkGraphicsPipelineCreateInfo*)vkbDeepCopy(&createInfo, malloc(size), size);
+
+Structures in the pNext chain with an unknown sType are left out of the copy. Pointers whose length can't be determined from the
+registry, such as pUserData and platform handles, are copied as is and still point to the original data. Arrays with a count of 0
+are NULL in the copy.
+
+Members which the specification says are ignored in some cases are NULL in the copy in those cases, and are not hashed by
+vkbHash(). This covers pImmutableSamplers for descriptor types other than samplers, the arrays of VkWriteDescriptorSet that don't
+match its descriptor type, pTessellationState without a tessellation control stage, and the viewport, multisample, depth/stencil and
+color blend states of graphics pipelines with rasterization disabled. Cases that depend on something outside of the structure, such
+as pDepthStencilState for a subpass without a depth/stencil attachment or states that are made dynamic, are not detected, so those
+members need to be NULL or valid.
+*/
+void* vkbDeepCopy(const void* pSrc, void* pDst, size_t dstSize);
+#endif  /* VKBIND_DEEP_COPY */
+
+
+#ifdef VKBIND_HASH
+/*
+Hashes a structure for use as the key of a hash table, such as a cache of pipelines or samplers. The structure must start with an
+sType. Arrays, strings and nested structures are followed and so is the pNext chain. Pointers to opaque data, such as pUserData,
+are ignored, and so are members in the cases where the specification says they're ignored, as described for vkbDeepCopy(). This
+is not a cryptographic hash. Returns the same value for NULL every time.
+*/
+uint64_t vkbHash(const void* pStruct);
+
+/*
+Compares two structures the same way they're hashed by vkbHash(). Structures that are equal have the same hash. The pNext chains
+need to be in the same order to be equal. Structures with an sType that is unknown to this build are only equal to themselves.
+*/
+VkBool32 vkbEqual(const void* pA, const void* pB);
+
+/*
+Typed versions of the above for every structure, including structures without an sType.
+
+    uint64_t vkbHash_VkSamplerCreateInfo(const VkSamplerCreateInfo* pStruct);
+    VkBool32 vkbEqual_VkSamplerCreateInfo(const VkSamplerCreateInfo* pA, const VkSamplerCreateInfo* pB);
+*/
+/*<<hash_decl>>*/
+#endif  /* VKBIND_HASH */
+
+
+#ifdef VKBIND_ENUM_STRINGS
+typedef struct
+{
+    const char* pName;
+    int64_t value;
+} VkbEnumValue;
+
+/*
+Name and value tables of an enum or bitmask. None of the functions below allocate memory.
+*/
+typedef struct
+{
+    const char* pName;              /* The enum name, or the FlagBits name of a bitmask. */
+    VkBool32 isBitmask;
+    const VkbEnumValue* pValues;    /* Sorted by value. Aliases and duplicate values are not included. */
+    uint32_t valueCount;
+    uint32_t denseCount;            /* The number of values at the start of pValues that are consecutive. These are indexed directly. */
+    const VkbEnumValue* pNames;     /* Sorted by name with strcmp(). Aliases are included. */
+    uint32_t nameCount;
+} VkbEnumInfo;
+
+/*
+There is one of these for every enum and bitmask, named after the enum or the FlagBits type, such as vkbEnumInfo_VkResult and
+vkbEnumInfo_VkBufferUsageFlagBits.
+*/
+/*<<enum_strings_decl>>*/
+
+/*
+Retrieves the tables of an enum or bitmask by name. Bitmasks can be looked up by their Flags or FlagBits name. Returns NULL if
+the name is unknown. This does a binary search so prefer using the vkbEnumInfo_* objects directly.
+*/
+const VkbEnumInfo* vkbGetEnumInfo(const char* pTypeName);
+
+/*
+Retrieves the name of the given value. Returns NULL if the value is unknown.
+
+    vkbEnumToString(&vkbEnumInfo_VkResult, result);
+*/
+const char* vkbEnumToString(const VkbEnumInfo* pInfo, int64_t value);
+
+/*
+Retrieves the value of the given name. Aliases are accepted. Returns VK_FALSE if the name is unknown.
+*/
+VkBool32 vkbEnumFromString(const VkbEnumInfo* pInfo, const char* pName, int64_t* pValue);
+
+/*
+Converts a set of flags to a string such as "VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT". Bits without
+a name are output as a single hex number at the end. A value of 0 is output as the name of the 0 value if there is one, or "0"
+otherwise. The string is always null terminated and truncated if it doesn't fit. Returns the length of the full string, not
+including the null terminator, the same as snprintf(). pBuffer can be NULL if bufferSize is 0.
+*/
+size_t vkbFlagsToString(const VkbEnumInfo* pInfo, uint64_t flags, char* pBuffer, size_t bufferSize);
+
+/*
+Converts a string of flag names and numbers separated by "|" to a set of flags. Whitespace is ignored. Returns VK_FALSE if any
+part is unknown.
+*/
+VkBool32 vkbFlagsFromString(const VkbEnumInfo* pInfo, const char* pString, uint64_t* pFlags);
+#endif  /* VKBIND_ENUM_STRINGS */
+
+
+#ifdef VKBIND_OBJECT_CACHE
+/*
+A cache of immutable objects that are fully described by their create info. Creating an object through the cache with a create info
+that is equal to one that's already in the cache, according to vkbEqual(), returns the existing object and increments its reference
+count instead of creating a new one. The pNext chain is part of the create info. Objects are destroyed when they're released as many
+times as they were created.
+
+    VkSampler sampler;
+    vkbCreateSharedSampler(pCache, &samplerInfo, &sampler);
+    ...
+    vkbReleaseSharedSampler(pCache, sampler);
+
+The cache can be used from multiple threads at the same time. It's split into shards that are locked independently so threads
+creating different objects rarely wait on each other. Structures in the pNext chain with an sType that is unknown to this build
+can't be compared so objects created with them are never shared.
+
+Create infos are compared by the values of the handles in them, such as the immutable samplers of a descriptor set layout or the
+set layouts of a pipeline layout. A handle can be given to a new object once the object it referred to has been destroyed, so
+objects whose create infos refer to a destroyed handle must not be shared anymore. The cache does this itself when it destroys one
+of its own objects. When a handle that wasn't created through the cache is destroyed, such as a sampler that was created with
+vkCreateSampler() and used as an immutable sampler, call vkbEvictObjectCacheReferences() with it before destroying it.
+*/
+typedef struct VkbObjectCache VkbObjectCache;
+
+/*
+Creates an object cache for a device. Objects are created with the device-level functions in pAPI, which is copied, and with
+pAllocator, which must outlive the cache. When pAPI is NULL the global API is used. Returns VK_ERROR_OUT_OF_HOST_MEMORY if the
+cache could not be allocated.
+*/
+VkResult vkbCreateObjectCache(VkDevice device, const VkbAPI* pAPI, const VkAllocationCallbacks* pAllocator, VkbObjectCache** ppCache);
+
+/*
+Destroys an object cache and every object that's still in it.
+*/
+void vkbDestroyObjectCache(VkbObjectCache* pCache);
+
+/*
+Stops sharing every object whose create info refers to the given non-dispatchable handle so later creates with an equal create info
+get a new object. Objects that have already been handed out are still released as normal. The handle is cast with (uint64_t)handle.
+This visits every object in the cache.
+*/
+void vkbEvictObjectCacheReferences(VkbObjectCache* pCache, uint64_t handle);
+
+/*
+Creates or retrieves a shared object, and releases it. These are generated for each object type in the cache.
+
+    VkResult vkbCreateSharedSampler(VkbObjectCache* pCache, const VkSamplerCreateInfo* pCreateInfo, VkSampler* pSampler);
+    void vkbReleaseSharedSampler(VkbObjectCache* pCache, VkSampler sampler);
+
+Releasing an object that didn't come from the cache, or releasing it more times than it was created, does nothing.
+*/
+/*<<object_cache_decl>>*/
+#endif  /* VKBIND_OBJECT_CACHE */
+
+
+#ifdef VKBIND_ENUMERATE
+/*
+Retrieves the whole array returned by a command that uses the count-then-fill idiom, such as vkEnumeratePhysicalDevices() or
+vkGetPhysicalDeviceQueueFamilyProperties(). These are generated for every such command. The array is allocated from pArena and
+the number of items is written to the count parameter. Structures in the array have their sType set and pNext set to NULL before
+they're filled in. When pAPI is NULL the global API is used.
+
+    uint32_t physicalDeviceCount;
+    VkPhysicalDevice* pPhysicalDevices;
+    result = vkbEnumerate_vkEnumeratePhysicalDevices(&api, instance, &physicalDeviceCount, &pPhysicalDevices, &arena);
+
+VK_INCOMPLETE from the second call means the count changed in between, in which case both calls are done again. Commands that
+return void return VK_SUCCESS. Returns VK_ERROR_OUT_OF_HOST_MEMORY if the arena is too small. The arena is left as it was when an
+error is returned.
+*/
+/*<<enumerate_decl>>*/
+#endif  /* VKBIND_ENUMERATE */
+
+
+#ifdef VKBIND_OBJECT_REGISTRY
+/*
+A registry of live objects. Objects are identified by their object type and their handle as a 64-bit integer, the same as
+VkDebugUtilsObjectNameInfoEXT, so non-dispatchable handles are cast with (uint64_t)handle and dispatchable handles with
+(uint64_t)(uintptr_t)handle. Install the registry into a VkbAPI object with vkbInstallObjectRegistry() to have objects registered
+when they're created through it and unregistered when they're destroyed. Objects the installed functions don't see, such as those
+created before installing, through another VkbAPI object or by another library, can be registered by hand. Register them after
+creating them and unregister them before destroying them.
+
+The parent of an object is the object it was created from. For most objects that's the device. For command buffers and descriptor
+sets it's the pool they were allocated from. Registering the same object more than once, which can happen because non-dispatchable
+handles aren't necessarily unique, counts it that many times.
+
+The registry is split into shards that are locked independently, each an open addressing hash table, so registering and
+unregistering from multiple threads at the same time is cheap.
+*/
+typedef struct VkbObjectRegistry VkbObjectRegistry;
+
+typedef struct
+{
+    uint64_t handle;
+    uint64_t parent;
+    VkObjectType objectType;
+    VkObjectType parentType;    /* VK_OBJECT_TYPE_UNKNOWN if the object was registered without a parent. */
+    uint32_t count;             /* The number of times the object has been registered. */
+} VkbRegisteredObject;
+
+/*
+Creates an object registry. The functions in pAPI, which is copied, are used by vkbDestroyRegisteredObject(). When pAPI is NULL the
+global API is used.
+*/
+VkResult vkbCreateObjectRegistry(const VkbAPI* pAPI, VkbObjectRegistry** ppRegistry);
+
+/*
+Destroys an object registry. The objects in it are not destroyed. Use vkbGetRegisteredObjects() beforehand to report leaks.
+*/
+void vkbDestroyObjectRegistry(VkbObjectRegistry* pRegistry);
+
+/*
+Registers an object. Returns VK_ERROR_OUT_OF_HOST_MEMORY if the registry could not grow.
+*/
+VkResult vkbRegisterObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, VkObjectType parentType, uint64_t parent);
+
+/*
+Unregisters an object. Objects that have been registered more than once stay registered until they've been unregistered as many
+times. Unregistering an object that isn't registered does nothing.
+*/
+void vkbUnregisterObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle);
+
+/*
+Replaces the functions in pAPI that create, allocate, destroy and free objects with versions that register and unregister them with
+pRegistry. When pAPI is NULL the global API is used instead. Installing into a VkbAPI object that the registry has already been
+installed into does nothing.
+
+Each install has its own set of functions so a registry can be installed into more than one VkbAPI object, such as one per device,
+and more than one registry can be installed. Up to VKB_OBJECT_REGISTRY_MAX_INSTALLS installs can exist at the same time, after which
+VK_ERROR_TOO_MANY_OBJECTS is returned. Copies of pAPI made after installing call into the same install.
+
+The parent of each object is worked out from the parameters of the command that created it. Destroying or resetting a pool also
+unregisters the objects allocated from it. Physical devices and queues aren't created so they're never registered automatically.
+This means the devices that are registered automatically have a physical device as their parent that isn't registered, so
+vkbDestroyRegisteredObject() can't get from an instance to its devices unless the physical devices are registered by hand.
+*/
+VkResult vkbInstallObjectRegistry(VkbObjectRegistry* pRegistry, VkbAPI* pAPI);
+
+/*
+Restores the functions replaced by vkbInstallObjectRegistry(). This must be done before destroying the registry. Copies of pAPI that
+were made after installing must not be used afterwards.
+*/
+void vkbUninstallObjectRegistry(VkbObjectRegistry* pRegistry, VkbAPI* pAPI);
+
+/*
+Looks up a registered object. Returns VK_FALSE if the object is not registered.
+*/
+VkBool32 vkbGetRegisteredObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, VkbRegisteredObject* pObject);
+
+/*
+Retrieves the number of registered objects of a type, or of every type when objectType is VK_OBJECT_TYPE_UNKNOWN. Counting every
+type is a constant time operation. Counting a single type visits every object.
+*/
+size_t vkbGetRegisteredObjectCount(VkbObjectRegistry* pRegistry, VkObjectType objectType);
+
+/*
+Copies up to capacity registered objects into pObjects, in no particular order, and returns the number that were copied. Pass NULL
+for pObjects to retrieve the number of objects instead. This is meant for leak reports.
+
+    size_t count = vkbGetRegisteredObjects(pRegistry, NULL, 0);
+    ...
+    count = vkbGetRegisteredObjects(pRegistry, pObjects, count);
+    for (i = 0; i < count; i += 1) {
+        printf("Leaked %s 0x%llx\n", vkbGetHandleInfo(pObjects[i].objectType)->pName, (unsigned long long)pObjects[i].handle);
+    }
+*/
+size_t vkbGetRegisteredObjects(VkbObjectRegistry* pRegistry, VkbRegisteredObject* pObjects, size_t capacity);
+
+/*
+Destroys an object and everything that was registered with it as its parent, recursively, and unregisters them. Children are
+destroyed before their parents. Objects that are destroyed implicitly along with their parent, such as VkQueue, are only
+unregistered. Each object is destroyed with pAllocator using the destroy command from vkbGetHandleInfo(), which takes the device or
+instance found by following the parents of the object.
+
+Returns VK_INCOMPLETE if some objects could not be destroyed, in which case they stay registered. This happens when an object's
+device or instance isn't registered as one of its ancestors, or when its destroy command isn't loaded. This must not be called
+while other threads register objects under the same parent.
+
+    vkbDestroyRegisteredObject(pRegistry, VK_OBJECT_TYPE_DEVICE, (uint64_t)(uintptr_t)device, NULL);
+*/
+VkResult vkbDestroyRegisteredObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, const VkAllocationCallbacks* pAllocator);
+#endif  /* VKBIND_OBJECT_REGISTRY */
+
+
+#ifdef VKBIND_BARRIER_BATCH
+/*
+Collects the barriers of a sync point and records them with a single vkCmdPipelineBarrier2(). Barriers are validated as they're
+added and merged with pending barriers where possible:
+
+  - Memory barriers are combined into one.
+  - Buffer barriers on the same buffer with the same queue families are merged when their ranges overlap, or when they're
+    adjacent and have the same stages and accesses.
+  - Image barriers on the same image with the same layouts, queue families and aspects are merged when their subresource ranges
+    are the same, or when they differ in only their mip levels or only their array layers and those overlap or are adjacent.
+    Adjacent ranges are only merged when the stages and accesses are the same.
+
+Queue family ownership transfers are only merged when their ranges are the same and barriers with a pNext chain are never merged.
+Nothing may be recorded between adding barriers and flushing them since every pending barrier is recorded at the point of the
+flush. A batch is not thread safe. Use one per command buffer or thread.
+
+    vkbBarrierBatchAddImageBarrier(pBatch, &toTransferDst);
+    vkbBarrierBatchAddBufferBarrier(pBatch, &uploadToVertex);
+    ...
+    vkbBarrierBatchFlush(pBatch, commandBuffer, 0);
+*/
+typedef struct VkbBarrierBatch VkbBarrierBatch;
+
+/*
+Creates a barrier batch. When pAPI is NULL the global API is used. Returns VK_ERROR_INITIALIZATION_FAILED if neither
+vkCmdPipelineBarrier2() nor an alias of it is loaded.
+*/
+VkResult vkbCreateBarrierBatch(const VkbAPI* pAPI, VkbBarrierBatch** ppBatch);
+
+/*
+Destroys a barrier batch. Pending barriers are discarded.
+*/
+void vkbDestroyBarrierBatch(VkbBarrierBatch* pBatch);
+
+/*
+Adds a barrier. Returns VK_ERROR_INITIALIZATION_FAILED without adding it if an access is not supported by the stages it's used
+with, if the range is empty, or, for images, if a pending barrier transitions some of the same subresources between different
+layouts. Returns VK_ERROR_OUT_OF_HOST_MEMORY if the batch could not grow.
+*/
+VkResult vkbBarrierBatchAddMemoryBarrier(VkbBarrierBatch* pBatch, const VkMemoryBarrier2* pBarrier);
+VkResult vkbBarrierBatchAddBufferBarrier(VkbBarrierBatch* pBatch, const VkBufferMemoryBarrier2* pBarrier);
+VkResult vkbBarrierBatchAddImageBarrier(VkbBarrierBatch* pBatch, const VkImageMemoryBarrier2* pBarrier);
+
+/*
+Retrieves the number of barriers that would be recorded by the next flush.
+*/
+uint32_t vkbBarrierBatchGetPendingCount(const VkbBarrierBatch* pBatch);
+
+/*
+Records the pending barriers with a single vkCmdPipelineBarrier2() and clears them. Nothing is recorded when there are no pending
+barriers.
+*/
+void vkbBarrierBatchFlush(VkbBarrierBatch* pBatch, VkCommandBuffer commandBuffer, VkDependencyFlags dependencyFlags);
+
+/*
+Discards the pending barriers without recording them.
+*/
+void vkbBarrierBatchReset(VkbBarrierBatch* pBatch);
+#endif  /* VKBIND_BARRIER_BATCH */
+
+
+#ifdef VKBIND_COMMAND_STREAM
+/*
+A list of commands recorded into memory rather than into a command buffer. Commands are encoded with the vkbEncode_<Command>()
+functions, which are generated for every vkCmd* command that returns void, such as vkbEncode_vkCmdDraw(). They take the same
+arguments as the command minus the command buffer. Each command is written as an opcode followed by its arguments and a copy of
+everything they point to, including pNext chains, so the arguments don't need to outlive the call.
+
+    VkbCommandStream stream;
+    vkbCommandStreamInit(&stream, pMemory, memorySize);
+    vkbEncode_vkCmdBindPipeline(&stream, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkbEncode_vkCmdDraw(&stream, 3, 1, 0, 0);
+    ...
+    vkbCommandStreamReplay(&stream, &api, commandBuffer);
+
+Recording doesn't touch Vulkan so any thread can record into a stream, but a stream must not be recorded into by more than one
+thread at a time. Replaying makes the calls on the calling thread, which needs to have access to the command buffer as usual.
+
+The stream stores pointers to its own memory, so the memory must not be moved or copied between recording and replaying. It can
+be replayed any number of times. The arena is owned by the stream. Don't allocate anything else from it.
+
+Commands with a pointer that the registry doesn't give a length for, such as vkCmdSetCheckpointNV(), don't get an encoder. Like
+vkbDeepCopy(), pointers inside structures that can't be copied, such as pUserData, still point to the original data.
+*/
+typedef struct
+{
+    VkbArena arena;
+    uint32_t commandCount;
+} VkbCommandStream;
+
+/*
+Initializes a stream over a buffer of capacity bytes, which should be aligned to at least 8 bytes. The buffer is owned by the
+caller.
+*/
+void vkbCommandStreamInit(VkbCommandStream* pStream, void* pData, size_t capacity);
+
+/*
+Removes every command from a stream so the memory can be reused.
+*/
+void vkbCommandStreamReset(VkbCommandStream* pStream);
+
+/*
+Records every command in a stream into a command buffer, in order. When pAPI is NULL the global API is used. Returns
+VK_ERROR_INITIALIZATION_FAILED if a command isn't loaded, in which case the commands before it have already been recorded.
+*/
+VkResult vkbCommandStreamReplay(const VkbCommandStream* pStream, const VkbAPI* pAPI, VkCommandBuffer commandBuffer);
+
+/*
+The encoders. These return VK_ERROR_OUT_OF_HOST_MEMORY, leaving the stream as it was, if the command doesn't fit.
+*/
+/*<<command_stream_decl>>*/
+#endif  /* VKBIND_COMMAND_STREAM */
+
+
+#ifdef VKBIND_STATE_FILTER
+/*
+Drops calls that wouldn't change anything because the state they set is already set to the same values. Use one filter per command
+buffer and make every call that sets state through it with the vkbFilter_<Command>() functions. These are generated for the
+commands that the registry says set state, such as vkCmdBindPipeline(), vkCmdBindDescriptorSets() and vkCmdSetViewport(), and for
+the commands that execute other commands, such as vkCmdExecuteCommands(), since those leave the state unknown. Other commands don't
+affect the filter and can be called directly.
+
+    vkbStateFilterReset(pFilter, commandBuffer);   // After vkBeginCommandBuffer().
+    vkbFilter_vkCmdBindPipeline(pFilter, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkbFilter_vkCmdBindDescriptorSets(pFilter, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &set, 0, NULL);
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    vkbFilter_vkCmdBindDescriptorSets(pFilter, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &set, 0, NULL);   // Dropped.
+
+A call is only dropped when it's equal to the last call that set the same state, with arrays and structures compared by value.
+Commands that set the same state share a copy, so vkCmdSetViewport() and vkCmdSetViewportWithCount() are compared with each other
+and all of the descriptor commands are compared with each other. Binding a pipeline or shaders and executing secondary command
+buffers forget everything. This is conservative. Calls that set the same values in a different way are not dropped.
+
+A filter is not thread safe, which is fine since neither is the command buffer it's used with.
+*/
+typedef struct VkbStateFilter VkbStateFilter;
+
+typedef struct
+{
+    uint64_t callCount;     /* The number of calls made through the filter, including the ones that were dropped. */
+    uint64_t elidedCount;   /* The number of calls that were dropped. */
+} VkbStateFilterStats;
+
+/*
+Creates a filter for a command buffer. When pAPI is NULL the global API is used.
+*/
+VkResult vkbCreateStateFilter(const VkbAPI* pAPI, VkCommandBuffer commandBuffer, VkbStateFilter** ppFilter);
+
+/*
+Destroys a filter.
+*/
+void vkbDestroyStateFilter(VkbStateFilter* pFilter);
+
+/*
+Forgets all state and sets the command buffer calls are made on. Call this whenever recording begins, including when the same
+command buffer is recorded again. The stats are kept.
+*/
+void vkbStateFilterReset(VkbStateFilter* pFilter, VkCommandBuffer commandBuffer);
+
+/*
+Retrieves the number of calls made through the filter and the number of them that were dropped since the filter was created.
+*/
+void vkbStateFilterGetStats(const VkbStateFilter* pFilter, VkbStateFilterStats* pStats);
+
+/*
+Retrieves the number of calls to a command that were dropped, such as "vkCmdBindDescriptorSets". Returns 0 for commands that are
+not filtered.
+*/
+uint64_t vkbStateFilterGetElidedCount(const VkbStateFilter* pFilter, const char* pCommandName);
+
+/*<<state_filter_decl>>*/
+#endif  /* VKBIND_STATE_FILTER */
+
+
+#ifdef VKBIND_CAPTURE
+/*
+Saves the commands in a stream so they can be replayed somewhere else, such as in a separate program that reproduces a problem
+without running the application, or against stub functions to measure the cost on the CPU. Record each command buffer of interest
+into its own stream, save it and write the buffer to a file:
+
+    size_t size;
+    vkbCommandStreamSave(&stream, NULL, &size);
+    pData = malloc(size);
+    vkbCommandStreamSave(&stream, pData, &size);
+    fwrite(pData, 1, size, pFile);
+
+Then read the file back into memory aligned to 8 bytes, load it, swap the handles for those in the new process and replay:
+
+    vkbCommandStreamLoad(&stream, pData, size);
+    vkbCommandStreamRemapHandles(&stream, onRemap, pMyHandleMap);
+    vkbCommandStreamReplay(&stream, &api, commandBuffer);
+
+The file holds the commands as they are in memory, with the pointers a stream has to itself replaced by offsets, and isn't portable.
+It can only be loaded by a build with the same header, pointer size and byte order, which is checked. Like the stream itself,
+pointers that weren't copied, such as pUserData, still refer to the memory of the process that recorded them. Nothing else about
+the application, such as the objects the commands use or the contents of memory, is saved. The contents of a file are trusted, so
+don't load files from untrusted sources.
+*/
+typedef uint64_t (* VkbRemapHandleProc)(void* pUserData, VkObjectType objectType, uint64_t handle);
+
+/*
+Saves a stream to a buffer. When pData is NULL, pDataSize is set to the size of the buffer. Otherwise pDataSize is the size of the
+buffer pointed to by pData, which must be aligned to at least 8 bytes. Returns VK_INCOMPLETE without writing anything if the buffer
+is too small.
+*/
+VkResult vkbCommandStreamSave(const VkbCommandStream* pStream, void* pData, size_t* pDataSize);
+
+/*
+Initializes a stream from a buffer filled with vkbCommandStreamSave(). The buffer is used in place and becomes the memory of the
+stream, so it must remain valid for as long as the stream is used. It can't be loaded a second time. The stream can be replayed
+but has no room for recording more commands. Returns VK_ERROR_INITIALIZATION_FAILED if the buffer is not aligned to 8 bytes, isn't
+a saved stream, or was saved by an incompatible build.
+*/
+VkResult vkbCommandStreamLoad(VkbCommandStream* pStream, void* pData, size_t dataSize);
+
+/*
+Calls onRemap for every handle in a stream and replaces it with the returned value. Handles are passed as 64-bit integers. Convert
+dispatchable handles with (uint64_t)(uintptr_t)handle. VK_NULL_HANDLE is left as is. Handles are found in the arguments of each
+command and everything that was copied along with them, including pNext chains.
+*/
+VkResult vkbCommandStreamRemapHandles(VkbCommandStream* pStream, VkbRemapHandleProc onRemap, void* pUserData);
+
+/*
+Captures every call made through a VkbAPI object so it can be replayed later with vkbReplayCapture(). Install the capture into the
+object the application makes its calls through and give it a function for writing the data, typically to a file:
+
+    static VkResult onWrite(void* pUserData, const void* pData, size_t dataSize)
+    {
+        return (fwrite(pData, 1, dataSize, (FILE*)pUserData) == dataSize) ? VK_SUCCESS : VK_ERROR_UNKNOWN;
+    }
+
+    vkbBeginCapture(&api, onWrite, pFile);
+    ...
+    vkbEndCapture(&api);
+
+Each call is recorded after it returns, with its arguments, its result and everything its arguments point to, including pNext
+chains and what it wrote to its output parameters. The returned handles are part of that, which is how the replay knows which of
+its own objects to use in place of the captured ones. Calls are recorded into a chunk of memory that belongs to the calling thread
+so recording only takes a lock when a chunk is full. Full chunks of VKB_CAPTURE_CHUNK_SIZE bytes are handed to a thread which writes them with onWrite.
+When VKB_CAPTURE_MAX_PENDING_CHUNKS chunks are waiting to be written, recording waits for the writer to catch up. Both can be
+defined before the implementation. The data isn't compressed. Do that in onWrite if it's needed.
+
+Mapped memory is tracked between vkMapMemory() and vkUnmapMemory(). A copy of the mapped range is kept and compared with the memory
+before every vkQueueSubmit(), vkQueueSubmit2(), vkQueueBindSparse(), vkFlushMappedMemoryRanges() and vkUnmapMemory(). The blocks of
+VKB_CAPTURE_MEMORY_BLOCK_SIZE bytes that changed are recorded. This doubles the host memory used by mapped ranges and makes each
+submit compare all of them, which is slow for applications that keep a lot of memory mapped. Memory that was allocated before the
+capture began is only tracked if it's mapped with an explicit size, and its contents before it was mapped aren't recorded.
+
+Only calls made through the function pointers replaced by vkbBeginCapture() are seen, so functions the application loads itself
+with vkGetInstanceProcAddr() or vkGetDeviceProcAddr() are not captured. Reload the VkbAPI object with vkbInitInstanceAPI() or
+vkbInitDeviceAPI() before beginning the capture rather than after. Pointers that can't be copied because the registry doesn't give
+their size, such as pUserData, platform types and pAllocator, are recorded as NULL when they're arguments and are kept as they are
+when they're in a structure. The values returned through void** parameters, such as the pointer returned by vkMapMemory(), aren't
+recorded.
+*/
+typedef VkResult (* VkbCaptureWriteProc)(void* pUserData, const void* pData, size_t dataSize);
+
+typedef struct
+{
+    uint64_t callCount;         /* The number of calls that have been recorded. */
+    uint64_t memoryUpdateCount; /* The number of changes to mapped memory that have been recorded. */
+    uint64_t droppedCount;      /* The number of calls and memory changes that were lost because of a failed allocation or write. */
+    uint64_t chunkCount;        /* The number of chunks that have been written. */
+    uint64_t byteCount;         /* The number of bytes that have been written. */
+} VkbCaptureStats;
+
+/*
+Replaces every function pointer in pAPI other than vkGetInstanceProcAddr() and vkGetDeviceProcAddr() with one that records the call
+and starts the thread that writes the chunks. When pAPI is NULL the global API is captured instead. Only one capture can run at a
+time. Returns VK_ERROR_INITIALIZATION_FAILED if one is already running.
+*/
+VkResult vkbBeginCapture(VkbAPI* pAPI, VkbCaptureWriteProc onWrite, void* pUserData);
+
+/*
+Restores the function pointers replaced by vkbBeginCapture(), writes what's left of every chunk and waits for the writer to finish.
+This must not be called while calls are being made through pAPI on other threads. Returns the first error returned by onWrite, in
+which case nothing after it was written.
+*/
+VkResult vkbEndCapture(VkbAPI* pAPI);
+
+/*
+Retrieves the stats of the current capture, or of the last one when none is running.
+*/
+void vkbGetCaptureStats(VkbCaptureStats* pStats);
+
+/*
+Replays a capture on the calling thread. pData is everything that was passed to onWrite, in the order it was written, and must be
+aligned to at least 8 bytes. It's used in place, so it can only be replayed once. Calls are made through pAPI, or the global API
+when it's NULL, in the order they returned in, except that calls which destroy or free objects are ordered by when they were made.
+After vkCreateInstance() and vkCreateDevice() are replayed, pAPI is reloaded with vkbInitInstanceAPI() and vkbInitDeviceAPI() if it
+has a vkGetInstanceProcAddr() and vkGetDeviceProcAddr() respectively. To replay against stub functions instead of a real driver,
+such as to measure the cost of the calls on the CPU, fill in a VkbAPI object with them and leave both NULL.
+
+Handles that the replayed calls return take the place of the captured ones in the calls that follow. Handles returned inside of
+structures, such as the physical devices of VkPhysicalDeviceGroupProperties, aren't. onRemap is called for captured handles that
+weren't returned by a replayed call, such as the objects that were created before the capture began. It can be NULL, in which case
+they're left as they are. Device addresses aren't remapped, so anything that relies on them only replays correctly if the
+addresses happen to be the same. Changes to memory that isn't mapped by the replay, such as memory that was mapped before the
+capture began, are skipped.
+
+Returns VK_ERROR_INITIALIZATION_FAILED if the data isn't a capture, was captured by an incompatible build or calls a function that
+pAPI doesn't have. The results of the replayed calls are ignored. The contents of a capture are trusted, so don't replay captures
+from untrusted sources.
+*/
+VkResult vkbReplayCapture(void* pData, size_t dataSize, VkbAPI* pAPI, VkbRemapHandleProc onRemap, void* pUserData);
+#endif  /* VKBIND_CAPTURE */
+
+#ifdef VKBIND_EXTERNSYNC_CHECK
+/*
+Checks that objects the specification requires to be externally synchronized aren't used by more than one thread at a time. These
+are the parameters marked with externsync in the registry, such as the command buffer of every vkCmd* command, the command pool of
+vkAllocateCommandBuffers() and the queue and fence of vkQueueSubmit(). Install the check into a VkbAPI object and use it as normal:
+
+    vkbInstallExternSyncCheck(&api, onConflict, pMyLog);
+
+Each checked function claims its objects before calling the real function and releases them afterwards. When a thread tries to
+claim an object that another thread has claimed, onConflict is called on the thread that found the conflict and the call goes
+ahead anyway. Claims of objects that hash to the same entry of the table take turns, but nothing is held while the real function is
+called, so the check doesn't serialize the calls and doesn't hide the race it reports. A conflict is only reported when the calls
+overlap, so the check can only find races that happen while it's installed.
+
+Each install has its own set of functions and its own onConflict, so the check can be installed into more than one VkbAPI object at
+the same time, such as one per device. Up to VKB_EXTERNSYNC_MAX_INSTALLS installs can exist at the same time. Conflicts are found
+between calls through any of them. Claimed objects are tracked in a fixed size table of VKB_EXTERNSYNC_SLOT_COUNT entries and each
+object can go in one of the VKB_EXTERNSYNC_PROBE_COUNT entries after the one it hashes to. Both can be defined before the
+implementation. Entries are freed when the object is released so the table only needs to be big enough for the calls that are in
+flight. Objects that don't fit aren't checked and are counted in uncheckedCount. Parameters whose externsync is described in prose
+rather than as an expression aren't checked.
+*/
+typedef struct
+{
+    const char* pCommandName;   /* Such as "vkCmdDraw". */
+    const char* pParameterName; /* The externsync expression from the registry, such as "commandBuffer" or "pSubmits[].fence". */
+    uint64_t threadId;
+    const void* pCallSite;      /* The return address of the call into the checked function. */
+} VkbExternSyncCall;
+
+typedef struct
+{
+    VkObjectType objectType;
+    uint64_t handle;            /* Dispatchable handles are converted with (uint64_t)(uintptr_t)handle. */
+    VkbExternSyncCall current;  /* The call that found the conflict. */
+    VkbExternSyncCall other;    /* The call that was using the object. pCommandName is NULL if it couldn't be determined. */
+} VkbExternSyncConflict;
+
+typedef void (* VkbExternSyncConflictProc)(void* pUserData, const VkbExternSyncConflict* pConflict);
+
+typedef struct
+{
+    uint64_t conflictCount;
+    uint64_t uncheckedCount;
+} VkbExternSyncCheckStats;
+
+/*
+Replaces the function pointers in pAPI that have externally synchronized parameters with checked versions. When pAPI is NULL the
+global API is checked instead. onConflict is called for each conflict found by calls through pAPI and can be NULL if only the stats
+are wanted. Installing into a VkbAPI object that the check has already been installed into updates onConflict and pUserData. Returns
+VK_ERROR_TOO_MANY_OBJECTS if there are already VKB_EXTERNSYNC_MAX_INSTALLS installs. Copies of pAPI made after installing call into
+the same install.
+*/
+VkResult vkbInstallExternSyncCheck(VkbAPI* pAPI, VkbExternSyncConflictProc onConflict, void* pUserData);
+
+/*
+Restores the function pointers replaced by vkbInstallExternSyncCheck(). Copies of pAPI that were made after installing must not be
+used afterwards.
+*/
+void vkbUninstallExternSyncCheck(VkbAPI* pAPI);
+
+void vkbGetExternSyncCheckStats(VkbExternSyncCheckStats* pStats);
+#endif  /* VKBIND_EXTERNSYNC_CHECK */
+
+#ifdef __cplusplus
+}
+#endif
+#endif  /* VKBIND_H */
+
+
+
+/******************************************************************************
+ ******************************************************************************
+
+ IMPLEMENTATION
+
+ ******************************************************************************
+ ******************************************************************************/
+#ifdef VKBIND_IMPLEMENTATION
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <dlfcn.h>
+#endif
+
+#ifndef VKBIND_NO_GLOBAL_API
+/*<<vulkan_funcpointers_decl_global>>*/
+#endif /*VKBIND_NO_GLOBAL_API*/
+
+typedef void* VkbHandle;
+typedef void (* VkbProc)(void);
+
+static VkbHandle vkb_dlopen(const char* filename)
+{
+#ifdef _WIN32
+    return (VkbHandle)LoadLibraryA(filename);
+#else
+    return (VkbHandle)dlopen(filename, RTLD_NOW);
+#endif
+}
+
+static void vkb_dlclose(VkbHandle handle)
+{
+#ifdef _WIN32
+    FreeLibrary((HMODULE)handle);
+#else
+    dlclose((void*)handle);
+#endif
+}
+
+static VkbProc vkb_dlsym(VkbHandle handle, const char* symbol)
+{
+#ifdef _WIN32
+    return (VkbProc)GetProcAddress((HMODULE)handle, symbol);
+#else
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+    return (VkbProc)dlsym((void*)handle, symbol);
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))
+    #pragma GCC diagnostic pop
+#endif
+#endif
+}
+
+
+static unsigned int g_vkbInitCount = 0;
+static VkbHandle g_vkbVulkanSO = NULL;
+
+static VkResult vkbLoadVulkanSO()
+{
+    size_t i;
+
+    const char* vulkanSONames[] = {
+    #if defined(VKBIND_VULKAN_SO)
+        VKBIND_VULKAN_SO,
+    #endif
+    #if defined(_WIN32)
+        "vulkan-1.dll"
+    #elif defined(__APPLE__)
+        /*
+        The idea here is that since MoltenVK seems to be the de facto standard for Vulkan on Apple platforms at the moment we'll try
+        that first. If Apple ever decides to officially support Vulkan we can perhaps consider dropping it to the bottom of the priority
+        list. Not sure if this reasoning is sound, but it makes sense in my head!
+        */
+        "libMoltenVK.dylib",
+        "libvulkan.dylib.1",
+        "libvulkan.dylib"
+    #else
+        "libvulkan.so.1",
+        "libvulkan.so"
+    #endif
+    };
+
+    for (i = 0; i < sizeof(vulkanSONames)/sizeof(vulkanSONames[0]); ++i) {
+        VkbHandle handle = vkb_dlopen(vulkanSONames[i]);
+        if (handle != NULL) {
+            g_vkbVulkanSO = handle;
+            return VK_SUCCESS;
+        }
+    }
+
+    return VK_ERROR_INCOMPATIBLE_DRIVER;
+}
+
+static VkResult vkbLoadVulkanSymbols(VkbAPI* pAPI)
+{
+    /*<<load_global_api_funcpointers>>*/
+
+    /*
+    We can only safely guarantee that vkGetInstanceProcAddr was successfully returned from dlsym(). The Vulkan specification lists some APIs
+    that should always work with vkGetInstanceProcAddr(), so I'm going ahead and doing that here just for robustness.
+    */
+    if (pAPI->vkGetInstanceProcAddr == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /*<<load_safe_global_api>>*/
+
+    return VK_SUCCESS;
+}
+
+#ifndef VKBIND_NO_GLOBAL_API
+static void vkbInitFromGlobalAPI(VkbAPI* pAPI)
+{
+    /*<<set_struct_api_from_global>>*/
+}
+#endif /*VKBIND_NO_GLOBAL_API*/
+
+VkResult vkbInit(VkbAPI* pAPI)
+{
+    VkResult result;
+
+    /* If the Vulkan SO has not been loaded, do that first thing. */
+    if (g_vkbInitCount == 0) {
+        result = vkbLoadVulkanSO();
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+    }
+
+    #if defined(VKBIND_NO_GLOBAL_API)
+    {
+        /* Getting here means the global API has been disabled. Therefore the caller *must* provide a VkbAPI object. */
+        if (pAPI == NULL) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        } else {
+            /* Since we don't have global function pointers we'll have to use dlsym() every time we initialize. */
+            result = vkbLoadVulkanSymbols(pAPI);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+    }
+    #else
+    {
+        if (pAPI == NULL) {
+            if (g_vkbInitCount == 0) {
+                VkbAPI api;
+                result = vkbInit(&api);
+                if (result != VK_SUCCESS) {
+                    return result;
+                }
+
+                /* The call to vkbInit() will have incremented the reference counter. Bring it back down since we're just going to increment it again later. */
+            } else {
+                /* The global API has already been bound. No need to do anything here. */
+            }
+        } else {
+            if (g_vkbInitCount == 0) {
+                result = vkbLoadVulkanSymbols(pAPI);
+                if (result != VK_SUCCESS) {
+                    return result;
+                }
+
+                result = vkbBindAPI(pAPI);
+                if (result != VK_SUCCESS) {
+                    return result;
+                }
+            } else {
+                /* The global API has already been bound. We need only retrieve the pointers from the globals. Using dlsym() would be too inefficient. */
+                vkbInitFromGlobalAPI(pAPI);
+            }
+        }
+    }
+    #endif
+
+    g_vkbInitCount += 1;    /* <-- Only increment the init counter on success. */
+    return VK_SUCCESS;
+}
+
+void vkbUninit()
+{
+    if (g_vkbInitCount == 0) {
+        return;
+    }
+
+    g_vkbInitCount -= 1;
+    if (g_vkbInitCount == 0) {
+        vkb_dlclose(g_vkbVulkanSO);
+        g_vkbVulkanSO = NULL;
+    }
+}
+
+VkResult vkbInitInstanceAPI(VkInstance instance, VkbAPI* pAPI)
+{
+    if (g_vkbInitCount == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;  /* vkbind not initialized. */
+    }
+
+    if (pAPI == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /*
     We need an instance of vkGetInstanceProcAddr(). If it's not available in pAPI we'll try pulling it
     from global scope.
     */
-    if (pAPI->vkGetInstanceProcAddr == NULL) {
-        #if !defined(VKBIND_NO_GLOBAL_API)
+    if (pAPI->vkGetInstanceProcAddr == NULL) {
+        #if !defined(VKBIND_NO_GLOBAL_API)
+        {
+            pAPI->vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+        }
+        #endif
+    }
+
+    if (pAPI->vkGetInstanceProcAddr == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;  /* We don't have a vkGetInstanceProcAddr(). We need to abort. */
+    }
+
+    /*<<load_instance_api>>*/
+
+    return VK_SUCCESS;
+}
+
+VkResult vkbInitDeviceAPI(VkDevice device, VkbAPI* pAPI)
+{
+    if (g_vkbInitCount == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;  /* vkbind not initialized. */
+    }
+
+    if (pAPI == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /* We need to handle vkGetDeviceProcAddr() in a special way to ensure it's using the device-specific version instead of the per-instance version. */
+    if (pAPI->vkGetDeviceProcAddr == NULL) {
+        #if !defined(VKBIND_NO_GLOBAL_API)
+        {
+            pAPI->vkGetDeviceProcAddr = vkGetDeviceProcAddr;
+        }
+        #endif
+    }
+
+    if (pAPI->vkGetDeviceProcAddr == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;  /* Don't have access to vkGetDeviceProcAddr(). Make sure vkbInitInstanceAPI() is called first on pAPI. */
+    }
+
+    pAPI->vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr)pAPI->vkGetDeviceProcAddr(device, "vkGetDeviceProcAddr");
+    /*<<load_device_api>>*/
+
+    return VK_SUCCESS;
+}
+
+VkResult vkbBindAPI(const VkbAPI* pAPI)
+{
+    if (pAPI == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+#if defined(VKBIND_NO_GLOBAL_API)
+    return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled. */
+#else
+    /*<<set_global_api_from_struct>>*/
+
+    return VK_SUCCESS;
+#endif
+}
+
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+    #define VKBIND_ALIGNOF(type) alignof(type)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    #define VKBIND_ALIGNOF(type) _Alignof(type)
+#elif defined(_MSC_VER)
+    #define VKBIND_ALIGNOF(type) __alignof(type)
+#elif defined(__GNUC__)
+    #define VKBIND_ALIGNOF(type) __alignof__(type)
+#else
+    #define VKBIND_ALIGNOF(type) offsetof(struct { char c; type x; }, x)
+#endif
+
+/* Every structure with an sType starts with these two members. */
+typedef struct VkbBaseStructure
+{
+    VkStructureType sType;
+    const struct VkbBaseStructure* pNext;
+} VkbBaseStructure;
+
+/*<<struct_info>>*/
+
+uint32_t vkbGetStructTypeIndex(VkStructureType sType)
+{
+    uint32_t value = (uint32_t)sType;
+    uint32_t index = VKB_INVALID_STRUCT_TYPE_INDEX;
+
+    if (value < VKB_STRUCT_TYPE_CORE_COUNT) {
+        index = value;
+    } else if (value >= 1000000000) {
+        uint32_t block  = (value - 1000000000) / 1000;
+        uint32_t offset = (value - 1000000000) % 1000;
+        if (block < sizeof(g_vkbStructTypeBlocks)/sizeof(g_vkbStructTypeBlocks[0]) && offset < g_vkbStructTypeBlocks[block].count) {
+            index = g_vkbStructTypeBlocks[block].first + offset;
+        }
+    }
+
+    /* Gaps in the values are in the table as holes so they need to be checked for. */
+    if (index != VKB_INVALID_STRUCT_TYPE_INDEX && g_vkbStructInfo[index].sType != sType) {
+        index = VKB_INVALID_STRUCT_TYPE_INDEX;
+    }
+
+    return index;
+}
+
+uint32_t vkbGetStructTypeCount(void)
+{
+    return (uint32_t)(sizeof(g_vkbStructInfo)/sizeof(g_vkbStructInfo[0])) - 1;  /* -1 for the terminator. */
+}
+
+const VkbStructInfo* vkbGetStructInfo(VkStructureType sType)
+{
+    uint32_t index = vkbGetStructTypeIndex(sType);
+    if (index == VKB_INVALID_STRUCT_TYPE_INDEX) {
+        return NULL;
+    }
+
+    return &g_vkbStructInfo[index];
+}
+
+void* vkbFindInChain(const void* pHead, VkStructureType sType)
+{
+    const VkbBaseStructure* pStruct;
+
+    for (pStruct = (const VkbBaseStructure*)pHead; pStruct != NULL; pStruct = pStruct->pNext) {
+        if (pStruct->sType == sType) {
+            return (void*)pStruct;
+        }
+    }
+
+    return NULL;
+}
+
+size_t vkbChainSize(const void* pHead)
+{
+    const VkbBaseStructure* pStruct;
+    size_t size = 0;
+
+    for (pStruct = (const VkbBaseStructure*)pHead; pStruct != NULL; pStruct = pStruct->pNext) {
+        const VkbStructInfo* pInfo = vkbGetStructInfo(pStruct->sType);
+        if (pInfo != NULL) {
+            size += pInfo->size;
+        }
+    }
+
+    return size;
+}
+
+
+/*<<format_info>>*/
+
+const VkbFormatInfo* vkbGetFormatInfo(VkFormat format)
+{
+    uint32_t value = (uint32_t)format;
+    const VkbFormatInfo* pInfo = NULL;
+
+    if (value < VKB_FORMAT_CORE_COUNT) {
+        pInfo = &g_vkbFormatInfo[value];
+    } else if (value >= 1000000000) {
+        uint32_t block  = (value - 1000000000) / 1000;
+        uint32_t offset = (value - 1000000000) % 1000;
+        if (block < sizeof(g_vkbFormatBlocks)/sizeof(g_vkbFormatBlocks[0]) && offset < g_vkbFormatBlocks[block].count) {
+            pInfo = &g_vkbFormatInfo[g_vkbFormatBlocks[block].first + offset];
+        }
+    }
+
+    /* Holes in the values and formats without metadata are in the table with a format of VK_FORMAT_MAX_ENUM. */
+    if (pInfo != NULL && pInfo->format != format) {
+        pInfo = NULL;
+    }
+
+    return pInfo;
+}
+
+uint32_t vkbFormatBlockSize(VkFormat format)
+{
+    const VkbFormatInfo* pInfo = vkbGetFormatInfo(format);
+    if (pInfo == NULL) {
+        return 0;
+    }
+
+    return pInfo->blockSize;
+}
+
+VkExtent3D vkbFormatBlockExtent(VkFormat format)
+{
+    VkExtent3D extent;
+    const VkbFormatInfo* pInfo = vkbGetFormatInfo(format);
+
+    if (pInfo == NULL) {
+        extent.width  = 0;
+        extent.height = 0;
+        extent.depth  = 0;
+    } else {
+        extent.width  = pInfo->blockExtent[0];
+        extent.height = pInfo->blockExtent[1];
+        extent.depth  = pInfo->blockExtent[2];
+    }
+
+    return extent;
+}
+
+static const VkbFormatComponent* vkbFindFormatComponent(VkFormat format, char component)
+{
+    const VkbFormatInfo* pInfo = vkbGetFormatInfo(format);
+    uint32_t iComponent;
+
+    if (pInfo == NULL) {
+        return NULL;
+    }
+
+    for (iComponent = 0; iComponent < pInfo->componentCount; iComponent += 1) {
+        if (pInfo->components[iComponent].name == component) {
+            return &pInfo->components[iComponent];
+        }
+    }
+
+    return NULL;
+}
+
+VkBool32 vkbFormatHasComponent(VkFormat format, char component)
+{
+    return (vkbFindFormatComponent(format, component) != NULL) ? VK_TRUE : VK_FALSE;
+}
+
+uint32_t vkbFormatComponentBits(VkFormat format, char component)
+{
+    const VkbFormatComponent* pComponent = vkbFindFormatComponent(format, component);
+    if (pComponent == NULL) {
+        return 0;
+    }
+
+    return pComponent->bits;
+}
+
+static VkDeviceSize vkbFormatPlaneSize(const VkbFormatInfo* pInfo, uint32_t width, uint32_t height, uint32_t depth)
+{
+    VkDeviceSize blocksX = (width  + pInfo->blockExtent[0] - 1) / pInfo->blockExtent[0];
+    VkDeviceSize blocksY = (height + pInfo->blockExtent[1] - 1) / pInfo->blockExtent[1];
+    VkDeviceSize blocksZ = (depth  + pInfo->blockExtent[2] - 1) / pInfo->blockExtent[2];
+
+    return blocksX * blocksY * blocksZ * pInfo->blockSize;
+}
+
+VkDeviceSize vkbFormatImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth)
+{
+    const VkbFormatInfo* pInfo = vkbGetFormatInfo(format);
+    VkDeviceSize size = 0;
+    uint32_t iPlane;
+
+    if (pInfo == NULL) {
+        return 0;
+    }
+
+    if (pInfo->planeCount == 0) {
+        return vkbFormatPlaneSize(pInfo, width, height, depth);
+    }
+
+    for (iPlane = 0; iPlane < pInfo->planeCount; iPlane += 1) {
+        const VkbFormatPlane* pPlane = &pInfo->planes[iPlane];
+        const VkbFormatInfo* pPlaneInfo = vkbGetFormatInfo(pPlane->compatibleFormat);
+        if (pPlaneInfo == NULL) {
+            return 0;
+        }
+
+        size += vkbFormatPlaneSize(pPlaneInfo, (width + pPlane->widthDivisor - 1) / pPlane->widthDivisor, (height + pPlane->heightDivisor - 1) / pPlane->heightDivisor, depth);
+    }
+
+    return size;
+}
+
+
+/*<<sync_info>>*/
+
+VkPipelineStageFlags2 vkbExpandPipelineStages(VkPipelineStageFlags2 stages)
+{
+    VkPipelineStageFlags2 expanded = stages;
+    VkPipelineStageFlags2 pending  = stages;
+
+    /* Meta stages can stand for other meta stages so keep going until nothing new is added. */
+    while (pending != 0) {
+        VkPipelineStageFlags2 added = 0;
+        uint32_t iBit;
+
+        for (iBit = 0; iBit < 64; iBit += 1) {
+            if ((pending & ((VkPipelineStageFlags2)1 << iBit)) != 0) {
+                added |= g_vkbSyncStages[iBit].equivalentStages;
+            }
+        }
+
+        pending   = added & ~expanded;
+        expanded |= added;
+    }
+
+    return expanded;
+}
+
+VkAccessFlags2 vkbExpandAccesses(VkAccessFlags2 accesses)
+{
+    VkAccessFlags2 expanded = accesses;
+    VkAccessFlags2 pending  = accesses;
+
+    while (pending != 0) {
+        VkAccessFlags2 added = 0;
+        uint32_t iBit;
+
+        for (iBit = 0; iBit < 64; iBit += 1) {
+            if ((pending & ((VkAccessFlags2)1 << iBit)) != 0) {
+                added |= g_vkbSyncAccesses[iBit].equivalentAccesses;
+            }
+        }
+
+        pending   = added & ~expanded;
+        expanded |= added;
+    }
+
+    return expanded;
+}
+
+VkBool32 vkbArePipelineStagesSupportedByQueue(VkPipelineStageFlags2 stages, VkQueueFlags queueFlags)
+{
+    uint32_t iBit;
+
+    for (iBit = 0; iBit < 64; iBit += 1) {
+        if ((stages & ((VkPipelineStageFlags2)1 << iBit)) != 0) {
+            VkQueueFlags queues = g_vkbSyncStages[iBit].queues;
+            if (queues != 0 && (queues & queueFlags) == 0) {
+                return VK_FALSE;
+            }
+        }
+    }
+
+    return VK_TRUE;
+}
+
+VkBool32 vkbAreAccessesSupportedByStages(VkAccessFlags2 accesses, VkPipelineStageFlags2 stages)
+{
+    VkPipelineStageFlags2 expandedStages;
+    uint32_t iBit;
+
+    if ((stages & VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) != 0) {
+        return VK_TRUE;
+    }
+
+    expandedStages = vkbExpandPipelineStages(stages);
+
+    for (iBit = 0; iBit < 64; iBit += 1) {
+        if ((accesses & ((VkAccessFlags2)1 << iBit)) != 0) {
+            VkPipelineStageFlags2 supportedStages = g_vkbSyncAccesses[iBit].stages;
+            if (supportedStages != 0 && (vkbExpandPipelineStages(supportedStages) & expandedStages) == 0) {
+                return VK_FALSE;
+            }
+        }
+    }
+
+    return VK_TRUE;
+}
+
+
+/*<<handle_info>>*/
+
+
+#ifdef VKBIND_COMMAND_INFO
+#include <string.h>
+
+/*<<command_info>>*/
+
+uint32_t vkbGetCommandCount(void)
+{
+    return (uint32_t)(sizeof(g_vkbCommandInfos)/sizeof(g_vkbCommandInfos[0])) - 1;  /* -1 for the terminator. */
+}
+
+const VkbCommandInfo* vkbGetCommandInfo(const char* pName)
+{
+    uint32_t lo = 0;
+    uint32_t hi = vkbGetCommandCount();
+
+    if (pName == NULL) {
+        return NULL;
+    }
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(g_vkbCommandInfos[mid].pName, pName);
+        if (cmp == 0) {
+            return &g_vkbCommandInfos[mid];
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+const VkbCommandInfo* vkbGetCommandInfoByIndex(uint32_t index)
+{
+    if (index >= vkbGetCommandCount()) {
+        return NULL;
+    }
+
+    return &g_vkbCommandInfos[index];
+}
+#endif  /* VKBIND_COMMAND_INFO */
+
+
+#define VKB_ARENA_ALIGNMENT 8
+
+void vkbArenaInit(VkbArena* pArena, void* pData, size_t capacity)
+{
+    if (pArena == NULL) {
+        return;
+    }
+
+    pArena->pData    = pData;
+    pArena->capacity = (pData != NULL) ? capacity : 0;
+    pArena->cursor   = 0;
+}
+
+void* vkbArenaAlloc(VkbArena* pArena, size_t size)
+{
+    size_t offset;
+
+    if (pArena == NULL || pArena->pData == NULL) {
+        return NULL;
+    }
+
+    offset = (pArena->cursor + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+    if (offset > pArena->capacity || size > pArena->capacity - offset) {
+        return NULL;
+    }
+
+    pArena->cursor = offset + size;
+    return (unsigned char*)pArena->pData + offset;
+}
+
+
+#if defined(VKBIND_DEEP_COPY) || defined(VKBIND_HASH)
+/*
+These are for the members which the specification says are ignored in some cases. They're neither copied nor hashed in those cases
+because the application is allowed to leave them pointing at anything.
+*/
+static VkBool32 vkbIsBufferDescriptorType(VkDescriptorType descriptorType)
+{
+    return descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+static VkBool32 vkbIsTexelBufferDescriptorType(VkDescriptorType descriptorType)
+{
+    return descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+}
+
+static VkBool32 vkbHasShaderStage(const VkPipelineShaderStageCreateInfo* pStages, uint32_t stageCount, VkShaderStageFlagBits stage)
+{
+    uint32_t iStage;
+
+    if (pStages == NULL) {
+        return VK_FALSE;
+    }
+
+    for (iStage = 0; iStage < stageCount; ++iStage) {
+        if (pStages[iStage].stage == stage) {
+            return VK_TRUE;
+        }
+    }
+
+    return VK_FALSE;
+}
+
+static VkBool32 vkbIsRasterizationDisabled(const VkPipelineRasterizationStateCreateInfo* pRasterizationState, const VkPipelineDynamicStateCreateInfo* pDynamicState)
+{
+    uint32_t iDynamicState;
+
+    if (pRasterizationState == NULL || pRasterizationState->rasterizerDiscardEnable == VK_FALSE) {
+        return VK_FALSE;
+    }
+
+    /*
+    It's not disabled when rasterizerDiscardEnable is dynamic. 1000377001 is VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE which isn't
+    defined by every version of the API.
+    */
+    if (pDynamicState != NULL && pDynamicState->pDynamicStates != NULL) {
+        for (iDynamicState = 0; iDynamicState < pDynamicState->dynamicStateCount; ++iDynamicState) {
+            if (pDynamicState->pDynamicStates[iDynamicState] == (VkDynamicState)1000377001) {
+                return VK_FALSE;
+            }
+        }
+    }
+
+    return VK_TRUE;
+}
+#endif  /* VKBIND_DEEP_COPY || VKBIND_HASH */
+
+
+#ifdef VKBIND_DEEP_COPY
+#include <string.h>
+
+#define VKB_DEEP_COPY_ALIGNMENT 8
+
+typedef struct
+{
+    unsigned char* pData;   /* NULL when measuring. */
+    size_t capacity;
+    size_t cursor;
+    VkBool32 overflowed;
+} VkbDeepCopyArena;
+
+/* Returns NULL when measuring, or when the buffer is too small. */
+static void* vkbDeepCopyAlloc(VkbDeepCopyArena* pArena, size_t size)
+{
+    size_t offset = (pArena->cursor + (VKB_DEEP_COPY_ALIGNMENT - 1)) & ~(size_t)(VKB_DEEP_COPY_ALIGNMENT - 1);
+
+    pArena->cursor = offset + size;
+    if (pArena->pData == NULL) {
+        return NULL;
+    }
+
+    if (pArena->cursor > pArena->capacity) {
+        pArena->overflowed = VK_TRUE;
+        return NULL;
+    }
+
+    return pArena->pData + offset;
+}
+
+static void* vkbDeepCopyBytes(VkbDeepCopyArena* pArena, const void* pSrc, size_t size)
+{
+    void* pCopy = vkbDeepCopyAlloc(pArena, size);
+    if (pCopy != NULL) {
+        memcpy(pCopy, pSrc, size);
+    }
+
+    return pCopy;
+}
+
+static char* vkbDeepCopyString(VkbDeepCopyArena* pArena, const char* pSrc)
+{
+    if (pSrc == NULL) {
+        return NULL;
+    }
+
+    return (char*)vkbDeepCopyBytes(pArena, pSrc, strlen(pSrc) + 1);
+}
+
+static void* vkbDeepCopyChain(VkbDeepCopyArena* pArena, const void* pSrc);
+
+static void vkbDeepCopyNext(VkbDeepCopyArena* pArena, const void* pSrc, void* pDst)
+{
+    void* pNext = vkbDeepCopyChain(pArena, ((const VkbBaseStructure*)pSrc)->pNext);
+    if (pDst != NULL) {
+        ((VkbBaseStructure*)pDst)->pNext = (const VkbBaseStructure*)pNext;
+    }
+}
+
+/*<<deep_copy>>*/
+
+static void* vkbDeepCopyChain(VkbDeepCopyArena* pArena, const void* pSrc)
+{
+    const VkbBaseStructure* pStruct;
+
+    /* Structures we don't know the size of can't be copied so they're skipped. */
+    for (pStruct = (const VkbBaseStructure*)pSrc; pStruct != NULL; pStruct = pStruct->pNext) {
+        const VkbStructInfo* pInfo = vkbGetStructInfo(pStruct->sType);
+        if (pInfo != NULL && pInfo->size > 0) {
+            void* pCopy = vkbDeepCopyBytes(pArena, pStruct, pInfo->size);
+            vkbDeepCopyStruct(pArena, pStruct, pCopy);
+            return pCopy;
+        }
+    }
+
+    return NULL;
+}
+
+size_t vkbDeepCopySize(const void* pSrc)
+{
+    VkbDeepCopyArena arena;
+    const VkbStructInfo* pInfo;
+
+    if (pSrc == NULL) {
+        return 0;
+    }
+
+    pInfo = vkbGetStructInfo(((const VkbBaseStructure*)pSrc)->sType);
+    if (pInfo == NULL || pInfo->size == 0) {
+        return 0;
+    }
+
+    arena.pData = NULL;
+    arena.capacity = 0;
+    arena.cursor = 0;
+    arena.overflowed = VK_FALSE;
+    vkbDeepCopyChain(&arena, pSrc);
+
+    return arena.cursor;
+}
+
+void* vkbDeepCopy(const void* pSrc, void* pDst, size_t dstSize)
+{
+    VkbDeepCopyArena arena;
+    const VkbStructInfo* pInfo;
+
+    if (pSrc == NULL || pDst == NULL) {
+        return NULL;
+    }
+
+    /* Only the head needs checking. Unknown structures further down the chain are skipped. */
+    pInfo = vkbGetStructInfo(((const VkbBaseStructure*)pSrc)->sType);
+    if (pInfo == NULL || pInfo->size == 0) {
+        return NULL;
+    }
+
+    arena.pData = (unsigned char*)pDst;
+    arena.capacity = dstSize;
+    arena.cursor = 0;
+    arena.overflowed = VK_FALSE;
+    vkbDeepCopyChain(&arena, pSrc);
+
+    if (arena.overflowed) {
+        return NULL;
+    }
+
+    return pDst;
+}
+#endif  /* VKBIND_DEEP_COPY */
+
+
+#ifdef VKBIND_HASH
+#include <string.h>
+
+#define VKB_HASH_SEED   (((uint64_t)0xCBF29CE4 << 32) | 0x84222325)
+#define VKB_HASH_PRIME1 (((uint64_t)0x9E3779B9 << 32) | 0x7F4A7C15)
+#define VKB_HASH_PRIME2 (((uint64_t)0xBF58476D << 32) | 0x1CE4E5B9)
+
+static uint64_t vkbHashU64(uint64_t h, uint64_t value)
+{
+    value *= VKB_HASH_PRIME1;
+    value ^= value >> 32;
+    h ^= value;
+    h *= VKB_HASH_PRIME2;
+    h ^= h >> 29;
+    return h;
+}
+
+/* Consumes 8 bytes at a time. The result depends on the endianness of the machine. */
+static uint64_t vkbHashBytes(uint64_t h, const void* pData, size_t size)
+{
+    const unsigned char* pBytes = (const unsigned char*)pData;
+
+    while (size >= 8) {
+        uint64_t value;
+        memcpy(&value, pBytes, 8);
+        h = vkbHashU64(h, value);
+        pBytes += 8;
+        size   -= 8;
+    }
+
+    if (size > 0) {
+        uint64_t value = 0;
+        memcpy(&value, pBytes, size);
+        h = vkbHashU64(h, value ^ ((uint64_t)size << 56));
+    }
+
+    return h;
+}
+
+static uint64_t vkbHashString(uint64_t h, const char* pString)
+{
+    if (pString == NULL) {
+        return vkbHashU64(h, 0);
+    }
+
+    return vkbHashBytes(vkbHashU64(h, 1), pString, strlen(pString));
+}
+
+static VkBool32 vkbEqualString(const char* pA, const char* pB)
+{
+    if (pA == NULL || pB == NULL) {
+        return pA == pB;
+    }
+
+    return strcmp(pA, pB) == 0;
+}
+
+/*<<hash>>*/
+#endif  /* VKBIND_HASH */
+
+
+#ifdef VKBIND_ENUM_STRINGS
+#include <string.h>
+
+/*<<enum_strings>>*/
+
+static const VkbEnumValue* vkbFindEnumValueByName(const VkbEnumValue* pNames, uint32_t nameCount, const char* pName, size_t nameLength)
+{
+    uint32_t lo = 0;
+    uint32_t hi = nameCount;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = strncmp(pNames[mid].pName, pName, nameLength);
+        if (cmp == 0 && pNames[mid].pName[nameLength] != '\0') {
+            cmp = 1;
+        }
+
+        if (cmp == 0) {
+            return &pNames[mid];
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+const VkbEnumInfo* vkbGetEnumInfo(const char* pTypeName)
+{
+    uint32_t lo = 0;
+    uint32_t hi = (uint32_t)(sizeof(g_vkbEnumInfos)/sizeof(g_vkbEnumInfos[0])) - 1;  /* -1 for the terminator. */
+
+    if (pTypeName == NULL) {
+        return NULL;
+    }
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(g_vkbEnumInfos[mid].pName, pTypeName);
+        if (cmp == 0) {
+            return g_vkbEnumInfos[mid].pInfo;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+const char* vkbEnumToString(const VkbEnumInfo* pInfo, int64_t value)
+{
+    uint64_t offset;
+    uint32_t lo;
+    uint32_t hi;
+
+    if (pInfo == NULL || pInfo->valueCount == 0) {
+        return NULL;
+    }
+
+    /* Unsigned so values below the first one wrap around and fail the check. */
+    offset = (uint64_t)value - (uint64_t)pInfo->pValues[0].value;
+    if (offset < pInfo->denseCount) {
+        return pInfo->pValues[offset].pName;
+    }
+
+    lo = pInfo->denseCount;
+    hi = pInfo->valueCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pInfo->pValues[mid].value == value) {
+            return pInfo->pValues[mid].pName;
+        } else if (pInfo->pValues[mid].value < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+VkBool32 vkbEnumFromString(const VkbEnumInfo* pInfo, const char* pName, int64_t* pValue)
+{
+    const VkbEnumValue* pEnumValue;
+
+    if (pInfo == NULL || pName == NULL) {
+        return VK_FALSE;
+    }
+
+    pEnumValue = vkbFindEnumValueByName(pInfo->pNames, pInfo->nameCount, pName, strlen(pName));
+    if (pEnumValue == NULL) {
+        return VK_FALSE;
+    }
+
+    if (pValue != NULL) {
+        *pValue = pEnumValue->value;
+    }
+
+    return VK_TRUE;
+}
+
+static size_t vkbAppendString(char* pBuffer, size_t bufferSize, size_t length, const char* pString)
+{
+    for (; *pString != '\0'; ++pString, ++length) {
+        if (length + 1 < bufferSize) {
+            pBuffer[length] = *pString;
+            pBuffer[length + 1] = '\0';
+        }
+    }
+
+    return length;
+}
+
+size_t vkbFlagsToString(const VkbEnumInfo* pInfo, uint64_t flags, char* pBuffer, size_t bufferSize)
+{
+    size_t length = 0;
+    uint64_t remaining = flags;
+    uint32_t iValue;
+
+    if (pBuffer != NULL && bufferSize > 0) {
+        pBuffer[0] = '\0';
+    } else {
+        bufferSize = 0;
+    }
+
+    if (pInfo == NULL) {
+        return 0;
+    }
+
+    if (flags == 0) {
+        const char* pZeroName = vkbEnumToString(pInfo, 0);
+        return vkbAppendString(pBuffer, bufferSize, 0, (pZeroName != NULL) ? pZeroName : "0");
+    }
+
+    /* Only single bits are used. Names for combinations of bits, such as VK_SHADER_STAGE_ALL_GRAPHICS, are skipped. */
+    for (iValue = 0; iValue < pInfo->valueCount; ++iValue) {
+        uint64_t bit = (uint64_t)pInfo->pValues[iValue].value;
+        if (bit != 0 && (bit & (bit - 1)) == 0 && (flags & bit) != 0) {
+            if (length > 0) {
+                length = vkbAppendString(pBuffer, bufferSize, length, " | ");
+            }
+            length = vkbAppendString(pBuffer, bufferSize, length, pInfo->pValues[iValue].pName);
+            remaining &= ~bit;
+        }
+    }
+
+    if (remaining != 0) {
+        char hex[19];   /* "0x" + 16 digits + null terminator. */
+        int iDigit = 18;
+
+        hex[iDigit] = '\0';
+        do {
+            hex[--iDigit] = "0123456789ABCDEF"[remaining & 0xF];
+            remaining >>= 4;
+        } while (remaining != 0);
+        hex[--iDigit] = 'x';
+        hex[--iDigit] = '0';
+
+        if (length > 0) {
+            length = vkbAppendString(pBuffer, bufferSize, length, " | ");
+        }
+        length = vkbAppendString(pBuffer, bufferSize, length, hex + iDigit);
+    }
+
+    return length;
+}
+
+VkBool32 vkbFlagsFromString(const VkbEnumInfo* pInfo, const char* pString, uint64_t* pFlags)
+{
+    uint64_t flags = 0;
+
+    if (pInfo == NULL || pString == NULL) {
+        return VK_FALSE;
+    }
+
+    for (;;) {
+        const char* pBeg;
+        size_t length;
+
+        while (*pString == ' ' || *pString == '\t' || *pString == '\n' || *pString == '\r') {
+            pString += 1;
+        }
+
+        pBeg = pString;
+        while (*pString != '\0' && *pString != '|' && *pString != ' ' && *pString != '\t' && *pString != '\n' && *pString != '\r') {
+            pString += 1;
+        }
+        length = (size_t)(pString - pBeg);
+
+        if (length == 0) {
+            return VK_FALSE;    /* Empty string, or an empty part between two "|". */
+        }
+
+        if (pBeg[0] >= '0' && pBeg[0] <= '9') {
+            uint64_t value = 0;
+            size_t iChar = 0;
+            uint32_t base = 10;
+
+            if (length > 2 && pBeg[0] == '0' && (pBeg[1] == 'x' || pBeg[1] == 'X')) {
+                base = 16;
+                iChar = 2;
+            }
+
+            for (; iChar < length; ++iChar) {
+                char c = pBeg[iChar];
+                uint32_t digit;
+                if (c >= '0' && c <= '9') {
+                    digit = (uint32_t)(c - '0');
+                } else if (base == 16 && c >= 'a' && c <= 'f') {
+                    digit = (uint32_t)(c - 'a' + 10);
+                } else if (base == 16 && c >= 'A' && c <= 'F') {
+                    digit = (uint32_t)(c - 'A' + 10);
+                } else {
+                    return VK_FALSE;
+                }
+                value = value*base + digit;
+            }
+
+            flags |= value;
+        } else {
+            const VkbEnumValue* pEnumValue = vkbFindEnumValueByName(pInfo->pNames, pInfo->nameCount, pBeg, length);
+            if (pEnumValue == NULL) {
+                return VK_FALSE;
+            }
+
+            flags |= (uint64_t)pEnumValue->value;
+        }
+
+        while (*pString == ' ' || *pString == '\t' || *pString == '\n' || *pString == '\r') {
+            pString += 1;
+        }
+
+        if (*pString == '\0') {
+            break;
+        }
+
+        if (*pString != '|') {
+            return VK_FALSE;
+        }
+        pString += 1;
+    }
+
+    if (pFlags != NULL) {
+        *pFlags = flags;
+    }
+
+    return VK_TRUE;
+}
+#endif  /* VKBIND_ENUM_STRINGS */
+
+#if defined(VKBIND_OBJECT_CACHE) || defined(VKBIND_OBJECT_REGISTRY) || defined(VKBIND_BARRIER_BATCH) || defined(VKBIND_STATE_FILTER) || defined(VKBIND_CAPTURE)
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef VKBIND_MALLOC
+#define VKBIND_MALLOC(sz) malloc((sz))
+#endif
+#ifndef VKBIND_FREE
+#define VKBIND_FREE(p) free((p))
+#endif
+#endif
+
+#if defined(VKBIND_OBJECT_CACHE) || defined(VKBIND_OBJECT_REGISTRY) || defined(VKBIND_CAPTURE)
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION VkbMutex;
+#define vkbMutexInit(pMutex)        InitializeCriticalSection(pMutex)
+#define vkbMutexUninit(pMutex)      DeleteCriticalSection(pMutex)
+#define vkbMutexLock(pMutex)        EnterCriticalSection(pMutex)
+#define vkbMutexUnlock(pMutex)      LeaveCriticalSection(pMutex)
+#else
+typedef pthread_mutex_t VkbMutex;
+#define vkbMutexInit(pMutex)        pthread_mutex_init(pMutex, NULL)
+#define vkbMutexUninit(pMutex)      pthread_mutex_destroy(pMutex)
+#define vkbMutexLock(pMutex)        pthread_mutex_lock(pMutex)
+#define vkbMutexUnlock(pMutex)      pthread_mutex_unlock(pMutex)
+#endif
+#endif  /* VKBIND_OBJECT_CACHE || VKBIND_OBJECT_REGISTRY || VKBIND_CAPTURE */
+
+#if defined(VKBIND_OBJECT_REGISTRY) || defined(VKBIND_CAPTURE) || defined(VKBIND_EXTERNSYNC_CHECK)
+/* Handles are passed around as 64-bit integers. Non-dispatchable handles are 64-bit integers themselves on 32-bit platforms. */
+#define VKB_DISPATCHABLE_FROM_U64(type, value)      ((type)(uintptr_t)(value))
+#define VKB_U64_FROM_DISPATCHABLE(handle)           ((uint64_t)(uintptr_t)(handle))
+#if (VK_USE_64_BIT_PTR_DEFINES==1)
+#define VKB_NON_DISPATCHABLE_FROM_U64(type, value)  ((type)(uintptr_t)(value))
+#define VKB_U64_FROM_NON_DISPATCHABLE(handle)       ((uint64_t)(uintptr_t)(handle))
+#else
+#define VKB_NON_DISPATCHABLE_FROM_U64(type, value)  ((type)(value))
+#define VKB_U64_FROM_NON_DISPATCHABLE(handle)       ((uint64_t)(handle))
+#endif
+#endif  /* VKBIND_OBJECT_REGISTRY || VKBIND_CAPTURE || VKBIND_EXTERNSYNC_CHECK */
+
+#if defined(VKBIND_CAPTURE) || defined(VKBIND_EXTERNSYNC_CHECK)
+/* 64-bit atomics. These are all sequentially consistent. */
+#if defined(_WIN32)
+static uint64_t vkbAtomicLoad64(volatile uint64_t* p)
+{
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+}
+
+static void vkbAtomicStore64(volatile uint64_t* p, uint64_t value)
+{
+    InterlockedExchange64((volatile LONG64*)p, (LONG64)value);
+}
+
+static uint64_t vkbAtomicIncrement64(volatile uint64_t* p)
+{
+    return (uint64_t)InterlockedIncrement64((volatile LONG64*)p);
+}
+
+#ifdef VKBIND_CAPTURE
+static uint64_t vkbAtomicAdd64(volatile uint64_t* p, uint64_t value)
+{
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)p, (LONG64)value) + value;
+}
+#endif
+
+#ifdef VKBIND_EXTERNSYNC_CHECK
+static VkBool32 vkbAtomicCompareExchange64(volatile uint64_t* p, uint64_t expected, uint64_t desired)
+{
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, (LONG64)desired, (LONG64)expected) == expected;
+}
+#endif
+#elif defined(__GNUC__)
+static uint64_t vkbAtomicLoad64(volatile uint64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+static void vkbAtomicStore64(volatile uint64_t* p, uint64_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+static uint64_t vkbAtomicIncrement64(volatile uint64_t* p)
+{
+    return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+#ifdef VKBIND_CAPTURE
+static uint64_t vkbAtomicAdd64(volatile uint64_t* p, uint64_t value)
+{
+    return __atomic_add_fetch(p, value, __ATOMIC_SEQ_CST);
+}
+#endif
+
+#ifdef VKBIND_EXTERNSYNC_CHECK
+static VkBool32 vkbAtomicCompareExchange64(volatile uint64_t* p, uint64_t expected, uint64_t desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? VK_TRUE : VK_FALSE;
+}
+#endif
+#else
+#error "VKBIND_CAPTURE and VKBIND_EXTERNSYNC_CHECK need atomics which are not implemented for this compiler."
+#endif
+#endif  /* VKBIND_CAPTURE || VKBIND_EXTERNSYNC_CHECK */
+
+
+#ifdef VKBIND_OBJECT_CACHE
+/* The number of independently locked shards. Must be a power of two. */
+#ifndef VKB_OBJECT_CACHE_SHARD_COUNT
+#define VKB_OBJECT_CACHE_SHARD_COUNT    16
+#endif
+#define VKB_OBJECT_CACHE_BUCKET_COUNT   16 /* The initial number of buckets per shard. Must be a power of two. */
+
+typedef VkResult (* VkbObjectCacheCreateProc)(VkbObjectCache* pCache, const void* pCreateInfo, uint64_t* pHandle);
+typedef void (* VkbObjectCacheDestroyProc)(VkbObjectCache* pCache, uint64_t handle);
+
+/*
+Each entry is in two hash tables. One is keyed by the create info and is used for finding existing objects when creating. The other
+is keyed by the handle and is used for finding the entry when releasing. The deep copy of the create info follows the entry in the
+same allocation.
+*/
+typedef struct VkbObjectCacheEntry
+{
+    struct VkbObjectCacheEntry* pNextByKey;
+    struct VkbObjectCacheEntry* pNextByHandle;
+    VkbObjectCacheDestroyProc onDestroy;    /* Also identifies the object type. */
+    uint64_t keyHash;
+    uint64_t handle;                        /* Handles are stored as 64-bit integers regardless of the platform. */
+    uint32_t refCount;                      /* Protected by the lock of the key shard. */
+    VkBool32 isEvicted;                     /* Evicted entries are only in the handle table. Protected by the lock of the key shard. */
+    const void* pCreateInfo;                /* NULL if the create info couldn't be copied, in which case the object is never shared. */
+    size_t createInfoSize;
+} VkbObjectCacheEntry;
+
+typedef struct
+{
+    VkbMutex lock;
+    VkbObjectCacheEntry** ppBuckets;
+    uint32_t bucketCount;
+    uint32_t count;
+} VkbObjectCacheShard;
+
+/*
+The two tables are sharded separately and have their own locks. When both are needed a key shard is always locked before a handle
+shard, and a handle shard is never held while waiting on a key shard, so they can't deadlock.
+*/
+struct VkbObjectCache
+{
+    VkbAPI api;
+    VkDevice device;
+    const VkAllocationCallbacks* pAllocator;
+    VkbObjectCacheShard keyShards[VKB_OBJECT_CACHE_SHARD_COUNT];
+    VkbObjectCacheShard handleShards[VKB_OBJECT_CACHE_SHARD_COUNT];
+};
+
+static uint64_t vkbObjectCacheHashHandle(uint64_t handle)
+{
+    return vkbHashU64(VKB_HASH_SEED, handle);
+}
+
+/* The top bits select the shard and the bottom bits select the bucket so the two are independent. */
+static uint32_t vkbObjectCacheShardIndex(uint64_t hash)
+{
+    return (uint32_t)(hash >> 48) & (VKB_OBJECT_CACHE_SHARD_COUNT - 1);
+}
+
+static VkbObjectCacheEntry** vkbObjectCacheGetLink(VkbObjectCacheEntry* pEntry, VkBool32 byHandle)
+{
+    return (byHandle) ? &pEntry->pNextByHandle : &pEntry->pNextByKey;
+}
+
+static uint64_t vkbObjectCacheGetEntryHash(const VkbObjectCacheEntry* pEntry, VkBool32 byHandle)
+{
+    return (byHandle) ? vkbObjectCacheHashHandle(pEntry->handle) : pEntry->keyHash;
+}
+
+static VkResult vkbObjectCacheInitShard(VkbObjectCacheShard* pShard)
+{
+    uint32_t iBucket;
+
+    pShard->bucketCount = VKB_OBJECT_CACHE_BUCKET_COUNT;
+    pShard->count       = 0;
+    pShard->ppBuckets   = (VkbObjectCacheEntry**)VKBIND_MALLOC(sizeof(*pShard->ppBuckets) * pShard->bucketCount);
+    if (pShard->ppBuckets == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (iBucket = 0; iBucket < pShard->bucketCount; iBucket += 1) {
+        pShard->ppBuckets[iBucket] = NULL;
+    }
+
+    vkbMutexInit(&pShard->lock);
+    return VK_SUCCESS;
+}
+
+static void vkbObjectCacheUninitShard(VkbObjectCacheShard* pShard)
+{
+    VKBIND_FREE(pShard->ppBuckets);
+    vkbMutexUninit(&pShard->lock);
+}
+
+/* The shard must be locked. If the new buckets can't be allocated the shard is left as is, which is still valid but slower. */
+static void vkbObjectCacheInsert(VkbObjectCacheShard* pShard, VkbObjectCacheEntry* pEntry, VkBool32 byHandle)
+{
+    if (pShard->count >= pShard->bucketCount) {
+        uint32_t newBucketCount = pShard->bucketCount * 2;
+        VkbObjectCacheEntry** ppNewBuckets = (VkbObjectCacheEntry**)VKBIND_MALLOC(sizeof(*ppNewBuckets) * newBucketCount);
+        if (ppNewBuckets != NULL) {
+            uint32_t iBucket;
+            for (iBucket = 0; iBucket < newBucketCount; iBucket += 1) {
+                ppNewBuckets[iBucket] = NULL;
+            }
+
+            for (iBucket = 0; iBucket < pShard->bucketCount; iBucket += 1) {
+                VkbObjectCacheEntry* pOther = pShard->ppBuckets[iBucket];
+                while (pOther != NULL) {
+                    VkbObjectCacheEntry** ppBucket = &ppNewBuckets[vkbObjectCacheGetEntryHash(pOther, byHandle) & (newBucketCount - 1)];
+                    VkbObjectCacheEntry* pNext = *vkbObjectCacheGetLink(pOther, byHandle);
+                    *vkbObjectCacheGetLink(pOther, byHandle) = *ppBucket;
+                    *ppBucket = pOther;
+                    pOther = pNext;
+                }
+            }
+
+            VKBIND_FREE(pShard->ppBuckets);
+            pShard->ppBuckets   = ppNewBuckets;
+            pShard->bucketCount = newBucketCount;
+        }
+    }
+
+    {
+        VkbObjectCacheEntry** ppBucket = &pShard->ppBuckets[vkbObjectCacheGetEntryHash(pEntry, byHandle) & (pShard->bucketCount - 1)];
+        *vkbObjectCacheGetLink(pEntry, byHandle) = *ppBucket;
+        *ppBucket = pEntry;
+        pShard->count += 1;
+    }
+}
+
+/* The shard must be locked and the entry must be in it. */
+static void vkbObjectCacheRemove(VkbObjectCacheShard* pShard, VkbObjectCacheEntry* pEntry, VkBool32 byHandle)
+{
+    VkbObjectCacheEntry** ppLink = &pShard->ppBuckets[vkbObjectCacheGetEntryHash(pEntry, byHandle) & (pShard->bucketCount - 1)];
+    while (*ppLink != pEntry) {
+        ppLink = vkbObjectCacheGetLink(*ppLink, byHandle);
+    }
+
+    *ppLink = *vkbObjectCacheGetLink(pEntry, byHandle);
+    pShard->count -= 1;
+}
+
+/*
+Finds the object for a create info, or creates it if it isn't in the cache yet. The key shard stays locked while the object is
+created so threads creating the same object at the same time end up with the same one.
+*/
+static VkResult vkbObjectCacheAcquire(VkbObjectCache* pCache, const void* pCreateInfo, VkbObjectCacheCreateProc onCreate, VkbObjectCacheDestroyProc onDestroy, uint64_t* pHandle)
+{
+    uint64_t keyHash;
+    VkbObjectCacheShard* pKeyShard;
+    VkbObjectCacheShard* pHandleShard;
+    VkbObjectCacheEntry* pEntry;
+    size_t copySize;
+    VkResult result;
+
+    if (pCache == NULL || pCreateInfo == NULL || pHandle == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    keyHash   = vkbHash(pCreateInfo);
+    pKeyShard = &pCache->keyShards[vkbObjectCacheShardIndex(keyHash)];
+
+    vkbMutexLock(&pKeyShard->lock);
+    {
+        for (pEntry = pKeyShard->ppBuckets[keyHash & (pKeyShard->bucketCount - 1)]; pEntry != NULL; pEntry = pEntry->pNextByKey) {
+            if (pEntry->keyHash == keyHash && pEntry->onDestroy == onDestroy && vkbEqual(pEntry->pCreateInfo, pCreateInfo)) {
+                pEntry->refCount += 1;
+                *pHandle = pEntry->handle;
+                vkbMutexUnlock(&pKeyShard->lock);
+                return VK_SUCCESS;
+            }
+        }
+
+        /* vkbDeepCopy() needs 8 byte alignment, which the entry already has because of its 64-bit members. */
+        copySize = vkbDeepCopySize(pCreateInfo);
+        pEntry = (VkbObjectCacheEntry*)VKBIND_MALLOC(sizeof(*pEntry) + copySize);
+        if (pEntry == NULL) {
+            vkbMutexUnlock(&pKeyShard->lock);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+
+        result = onCreate(pCache, pCreateInfo, &pEntry->handle);
+        if (result != VK_SUCCESS) {
+            VKBIND_FREE(pEntry);
+            vkbMutexUnlock(&pKeyShard->lock);
+            return result;
+        }
+
+        pEntry->onDestroy   = onDestroy;
+        pEntry->keyHash     = keyHash;
+        pEntry->refCount    = 1;
+        pEntry->isEvicted   = VK_FALSE;
+        pEntry->pCreateInfo = vkbDeepCopy(pCreateInfo, pEntry + 1, copySize);
+        pEntry->createInfoSize = copySize;
+
+        /* The entry needs to be findable by its handle before anything else can find it by its key and release it. */
+        pHandleShard = &pCache->handleShards[vkbObjectCacheShardIndex(vkbObjectCacheHashHandle(pEntry->handle))];
+        vkbMutexLock(&pHandleShard->lock);
+        {
+            vkbObjectCacheInsert(pHandleShard, pEntry, VK_TRUE);
+        }
+        vkbMutexUnlock(&pHandleShard->lock);
+
+        vkbObjectCacheInsert(pKeyShard, pEntry, VK_FALSE);
+        *pHandle = pEntry->handle;
+    }
+    vkbMutexUnlock(&pKeyShard->lock);
+
+    return VK_SUCCESS;
+}
+
+/*
+Checks whether a handle appears in the copy of a create info. Everything the create info points to is in the copy, and handles are
+at least 4 byte aligned in it, so looking at every 4 byte offset finds every handle. Other values that happen to be equal to the
+handle are found as well, but all that does is stop an object from being shared.
+*/
+static VkBool32 vkbObjectCacheRefersTo(const VkbObjectCacheEntry* pEntry, uint64_t handle)
+{
+    const unsigned char* pBytes = (const unsigned char*)pEntry->pCreateInfo;
+    size_t offset;
+
+    if (pBytes == NULL) {
+        return VK_FALSE;
+    }
+
+    for (offset = 0; offset + sizeof(handle) <= pEntry->createInfoSize; offset += 4) {
+        uint64_t value;
+        memcpy(&value, pBytes + offset, sizeof(value));
+        if (value == handle) {
+            return VK_TRUE;
+        }
+    }
+
+    return VK_FALSE;
+}
+
+/* Removes the entries that refer to a handle from the key tables. They stay in the handle tables until they're released. */
+static void vkbObjectCacheEvict(VkbObjectCache* pCache, uint64_t handle)
+{
+    uint32_t iShard;
+    uint32_t iBucket;
+
+    for (iShard = 0; iShard < VKB_OBJECT_CACHE_SHARD_COUNT; iShard += 1) {
+        VkbObjectCacheShard* pShard = &pCache->keyShards[iShard];
+
+        vkbMutexLock(&pShard->lock);
+        {
+            for (iBucket = 0; iBucket < pShard->bucketCount; iBucket += 1) {
+                VkbObjectCacheEntry** ppLink = &pShard->ppBuckets[iBucket];
+                while (*ppLink != NULL) {
+                    VkbObjectCacheEntry* pEntry = *ppLink;
+                    if (vkbObjectCacheRefersTo(pEntry, handle)) {
+                        *ppLink = pEntry->pNextByKey;
+                        pShard->count -= 1;
+                        pEntry->isEvicted = VK_TRUE;
+                    } else {
+                        ppLink = &pEntry->pNextByKey;
+                    }
+                }
+            }
+        }
+        vkbMutexUnlock(&pShard->lock);
+    }
+}
+
+static void vkbObjectCacheRelease(VkbObjectCache* pCache, VkbObjectCacheDestroyProc onDestroy, uint64_t handle)
+{
+    uint64_t handleHash;
+    VkbObjectCacheShard* pKeyShard;
+    VkbObjectCacheShard* pHandleShard;
+    VkbObjectCacheEntry* pEntry;
+
+    if (pCache == NULL) {
+        return;
+    }
+
+    handleHash   = vkbObjectCacheHashHandle(handle);
+    pHandleShard = &pCache->handleShards[vkbObjectCacheShardIndex(handleHash)];
+
+    /* The caller holds a reference so the entry can't go away between here and locking the key shard. */
+    vkbMutexLock(&pHandleShard->lock);
+    {
+        for (pEntry = pHandleShard->ppBuckets[handleHash & (pHandleShard->bucketCount - 1)]; pEntry != NULL; pEntry = pEntry->pNextByHandle) {
+            if (pEntry->handle == handle && pEntry->onDestroy == onDestroy) {
+                break;
+            }
+        }
+    }
+    vkbMutexUnlock(&pHandleShard->lock);
+
+    if (pEntry == NULL) {
+        return;
+    }
+
+    pKeyShard = &pCache->keyShards[vkbObjectCacheShardIndex(pEntry->keyHash)];
+    vkbMutexLock(&pKeyShard->lock);
+    {
+        pEntry->refCount -= 1;
+        if (pEntry->refCount > 0) {
+            vkbMutexUnlock(&pKeyShard->lock);
+            return;
+        }
+
+        if (!pEntry->isEvicted) {
+            vkbObjectCacheRemove(pKeyShard, pEntry, VK_FALSE);
+        }
+
+        vkbMutexLock(&pHandleShard->lock);
+        {
+            vkbObjectCacheRemove(pHandleShard, pEntry, VK_TRUE);
+        }
+        vkbMutexUnlock(&pHandleShard->lock);
+    }
+    vkbMutexUnlock(&pKeyShard->lock);
+
+    /*
+    Nothing else can reach the entry now so the object can be destroyed without holding any locks. Objects that refer to it are
+    evicted first so nothing can be created with its handle and match them in between.
+    */
+    vkbObjectCacheEvict(pCache, handle);
+    onDestroy(pCache, handle);
+    VKBIND_FREE(pEntry);
+}
+
+VkResult vkbCreateObjectCache(VkDevice device, const VkbAPI* pAPI, const VkAllocationCallbacks* pAllocator, VkbObjectCache** ppCache)
+{
+    VkbObjectCache* pCache;
+    uint32_t iShard;
+
+    if (ppCache == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *ppCache = NULL;
+
+    #if defined(VKBIND_NO_GLOBAL_API)
+    {
+        if (pAPI == NULL) {
+            return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+        }
+    }
+    #endif
+
+    pCache = (VkbObjectCache*)VKBIND_MALLOC(sizeof(*pCache));
+    if (pCache == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    if (pAPI != NULL) {
+        pCache->api = *pAPI;
+    } else {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        vkbInitFromGlobalAPI(&pCache->api);
+    #endif
+    }
+
+    pCache->device     = device;
+    pCache->pAllocator = pAllocator;
+
+    for (iShard = 0; iShard < VKB_OBJECT_CACHE_SHARD_COUNT; iShard += 1) {
+        if (vkbObjectCacheInitShard(&pCache->keyShards[iShard]) != VK_SUCCESS) {
+            break;
+        }
+
+        if (vkbObjectCacheInitShard(&pCache->handleShards[iShard]) != VK_SUCCESS) {
+            vkbObjectCacheUninitShard(&pCache->keyShards[iShard]);
+            break;
+        }
+    }
+
+    if (iShard < VKB_OBJECT_CACHE_SHARD_COUNT) {
+        while (iShard > 0) {
+            iShard -= 1;
+            vkbObjectCacheUninitShard(&pCache->keyShards[iShard]);
+            vkbObjectCacheUninitShard(&pCache->handleShards[iShard]);
+        }
+
+        VKBIND_FREE(pCache);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    *ppCache = pCache;
+    return VK_SUCCESS;
+}
+
+void vkbDestroyObjectCache(VkbObjectCache* pCache)
+{
+    uint32_t iShard;
+    uint32_t iBucket;
+
+    if (pCache == NULL) {
+        return;
+    }
+
+    /* Every entry is in exactly one handle bucket, including evicted ones, so that's where they're destroyed from. */
+    for (iShard = 0; iShard < VKB_OBJECT_CACHE_SHARD_COUNT; iShard += 1) {
+        VkbObjectCacheShard* pShard = &pCache->handleShards[iShard];
+
+        for (iBucket = 0; iBucket < pShard->bucketCount; iBucket += 1) {
+            VkbObjectCacheEntry* pEntry = pShard->ppBuckets[iBucket];
+            while (pEntry != NULL) {
+                VkbObjectCacheEntry* pNext = pEntry->pNextByHandle;
+                pEntry->onDestroy(pCache, pEntry->handle);
+                VKBIND_FREE(pEntry);
+                pEntry = pNext;
+            }
+        }
+
+        vkbObjectCacheUninitShard(&pCache->keyShards[iShard]);
+        vkbObjectCacheUninitShard(&pCache->handleShards[iShard]);
+    }
+
+    VKBIND_FREE(pCache);
+}
+
+void vkbEvictObjectCacheReferences(VkbObjectCache* pCache, uint64_t handle)
+{
+    if (pCache == NULL) {
+        return;
+    }
+
+    vkbObjectCacheEvict(pCache, handle);
+}
+
+/*<<object_cache>>*/
+#endif  /* VKBIND_OBJECT_CACHE */
+
+
+#ifdef VKBIND_ENUMERATE
+/*<<enumerate>>*/
+#endif  /* VKBIND_ENUMERATE */
+
+
+#ifdef VKBIND_OBJECT_REGISTRY
+/* The number of independently locked shards. Must be a power of two. */
+#ifndef VKB_OBJECT_REGISTRY_SHARD_COUNT
+#define VKB_OBJECT_REGISTRY_SHARD_COUNT 16
+#endif
+#define VKB_OBJECT_REGISTRY_SLOT_COUNT  64 /* The initial number of slots per shard. Must be a power of two. */
+#define VKB_OBJECT_REGISTRY_MAX_DEPTH   16 /* Guards against cycles in the parents. */
+
+#define VKB_OBJECT_REGISTRY_MIX1 (((uint64_t)0xBF58476D << 32) | 0x1CE4E5B9)
+#define VKB_OBJECT_REGISTRY_MIX2 (((uint64_t)0x94D049BB << 32) | 0x133111EB)
+
+/* Returns VK_FALSE if the destroy command isn't loaded. */
+typedef VkBool32 (* VkbObjectRegistryDestroyProc)(const VkbAPI* pAPI, uint64_t owner, uint64_t parent, uint64_t handle, const VkAllocationCallbacks* pAllocator);
+
+/* Slots with an object type of VK_OBJECT_TYPE_UNKNOWN are empty. */
+typedef struct
+{
+    VkbMutex lock;
+    VkbRegisteredObject* pSlots;
+    uint32_t slotCount;
+    uint32_t objectCount;
+} VkbObjectRegistryShard;
+
+struct VkbObjectRegistry
+{
+    VkbAPI api;
+    VkbObjectRegistryShard shards[VKB_OBJECT_REGISTRY_SHARD_COUNT];
+};
+
+static uint64_t vkbObjectRegistryHash(VkObjectType objectType, uint64_t handle)
+{
+    uint64_t h = handle + (uint64_t)(uint32_t)objectType * VKB_OBJECT_REGISTRY_MIX2;
+    h ^= h >> 30;
+    h *= VKB_OBJECT_REGISTRY_MIX1;
+    h ^= h >> 27;
+    h *= VKB_OBJECT_REGISTRY_MIX2;
+    h ^= h >> 31;
+    return h;
+}
+
+/* The top bits select the shard and the bottom bits select the slot so the two are independent. */
+static VkbObjectRegistryShard* vkbObjectRegistryGetShard(VkbObjectRegistry* pRegistry, uint64_t hash)
+{
+    return &pRegistry->shards[(uint32_t)(hash >> 48) & (VKB_OBJECT_REGISTRY_SHARD_COUNT - 1)];
+}
+
+/* The shard must be locked. Returns the slot holding the object, or the empty slot where it would go. */
+static uint32_t vkbObjectRegistryFindSlot(const VkbObjectRegistryShard* pShard, VkObjectType objectType, uint64_t handle, uint64_t hash)
+{
+    uint32_t mask = pShard->slotCount - 1;
+    uint32_t iSlot = (uint32_t)hash & mask;
+
+    for (;;) {
+        const VkbRegisteredObject* pSlot = &pShard->pSlots[iSlot];
+        if (pSlot->objectType == VK_OBJECT_TYPE_UNKNOWN || (pSlot->objectType == objectType && pSlot->handle == handle)) {
+            return iSlot;
+        }
+
+        iSlot = (iSlot + 1) & mask;
+    }
+}
+
+static VkbRegisteredObject* vkbObjectRegistryAllocSlots(uint32_t slotCount)
+{
+    VkbRegisteredObject* pSlots = (VkbRegisteredObject*)VKBIND_MALLOC(sizeof(*pSlots) * slotCount);
+    if (pSlots != NULL) {
+        uint32_t iSlot;
+        for (iSlot = 0; iSlot < slotCount; iSlot += 1) {
+            pSlots[iSlot].objectType = VK_OBJECT_TYPE_UNKNOWN;
+        }
+    }
+
+    return pSlots;
+}
+
+/* The shard must be locked. */
+static VkResult vkbObjectRegistryGrowShard(VkbObjectRegistryShard* pShard)
+{
+    VkbObjectRegistryShard newShard;
+    uint32_t iSlot;
+
+    newShard.slotCount = pShard->slotCount * 2;
+    newShard.pSlots = vkbObjectRegistryAllocSlots(newShard.slotCount);
+    if (newShard.pSlots == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (iSlot = 0; iSlot < pShard->slotCount; iSlot += 1) {
+        const VkbRegisteredObject* pSlot = &pShard->pSlots[iSlot];
+        if (pSlot->objectType != VK_OBJECT_TYPE_UNKNOWN) {
+            newShard.pSlots[vkbObjectRegistryFindSlot(&newShard, pSlot->objectType, pSlot->handle, vkbObjectRegistryHash(pSlot->objectType, pSlot->handle))] = *pSlot;
+        }
+    }
+
+    VKBIND_FREE(pShard->pSlots);
+    pShard->pSlots    = newShard.pSlots;
+    pShard->slotCount = newShard.slotCount;
+
+    return VK_SUCCESS;
+}
+
+/* The shard must be locked. Removes the object in a slot by shifting back the objects that follow it so no tombstones are needed. */
+static void vkbObjectRegistryClearSlot(VkbObjectRegistryShard* pShard, uint32_t iSlot)
+{
+    uint32_t mask = pShard->slotCount - 1;
+    uint32_t iNext = iSlot;
+
+    for (;;) {
+        uint32_t iHome;
+
+        iNext = (iNext + 1) & mask;
+        if (pShard->pSlots[iNext].objectType == VK_OBJECT_TYPE_UNKNOWN) {
+            break;
+        }
+
+        /* Objects whose home slot is between the hole and their current slot have to stay where they are. */
+        iHome = (uint32_t)vkbObjectRegistryHash(pShard->pSlots[iNext].objectType, pShard->pSlots[iNext].handle) & mask;
+        if ((iSlot <= iNext) ? (iSlot < iHome && iHome <= iNext) : (iSlot < iHome || iHome <= iNext)) {
+            continue;
+        }
+
+        pShard->pSlots[iSlot] = pShard->pSlots[iNext];
+        iSlot = iNext;
+    }
+
+    pShard->pSlots[iSlot].objectType = VK_OBJECT_TYPE_UNKNOWN;
+    pShard->objectCount -= 1;
+}
+
+/* Removes every registration of an object. */
+static void vkbObjectRegistryRemove(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle)
+{
+    uint64_t hash = vkbObjectRegistryHash(objectType, handle);
+    VkbObjectRegistryShard* pShard = vkbObjectRegistryGetShard(pRegistry, hash);
+
+    vkbMutexLock(&pShard->lock);
+    {
+        uint32_t iSlot = vkbObjectRegistryFindSlot(pShard, objectType, handle, hash);
+        if (pShard->pSlots[iSlot].objectType != VK_OBJECT_TYPE_UNKNOWN) {
+            vkbObjectRegistryClearSlot(pShard, iSlot);
+        }
+    }
+    vkbMutexUnlock(&pShard->lock);
+}
+
+/* Removes every object registered with the given parent, such as the command buffers of a pool that's being destroyed. This visits every object. */
+static void vkbObjectRegistryRemoveChildren(VkbObjectRegistry* pRegistry, VkObjectType parentType, uint64_t parent)
+{
+    uint32_t iShard;
+
+    for (iShard = 0; iShard < VKB_OBJECT_REGISTRY_SHARD_COUNT; iShard += 1) {
+        VkbObjectRegistryShard* pShard = &pRegistry->shards[iShard];
+
+        vkbMutexLock(&pShard->lock);
+        {
+            uint32_t iSlot = 0;
+            while (iSlot < pShard->slotCount) {
+                const VkbRegisteredObject* pSlot = &pShard->pSlots[iSlot];
+                if (pSlot->objectType != VK_OBJECT_TYPE_UNKNOWN && pSlot->parentType == parentType && pSlot->parent == parent) {
+                    vkbObjectRegistryClearSlot(pShard, iSlot);    /* An object that hasn't been looked at yet can be moved into this slot. */
+                } else {
+                    iSlot += 1;
+                }
+            }
+        }
+        vkbMutexUnlock(&pShard->lock);
+    }
+}
+
+/* The registry and the functions that the installed functions of a VkbAPI object call into. */
+typedef struct
+{
+    VkbObjectRegistry* pRegistry;   /* NULL if the install isn't being used. */
+    VkbAPI next;
+} VkbObjectRegistryInstall;
+
+static VkbObjectRegistryDestroyProc vkbObjectRegistryGetDestroyProc(VkObjectType objectType, VkObjectType* pOwnerType);
+
+/*<<object_registry>>*/
+
+VkResult vkbCreateObjectRegistry(const VkbAPI* pAPI, VkbObjectRegistry** ppRegistry)
+{
+    VkbObjectRegistry* pRegistry;
+    uint32_t iShard;
+
+    if (ppRegistry == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *ppRegistry = NULL;
+
+    #if defined(VKBIND_NO_GLOBAL_API)
+    {
+        if (pAPI == NULL) {
+            return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+        }
+    }
+    #endif
+
+    pRegistry = (VkbObjectRegistry*)VKBIND_MALLOC(sizeof(*pRegistry));
+    if (pRegistry == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    if (pAPI != NULL) {
+        pRegistry->api = *pAPI;
+    } else {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        vkbInitFromGlobalAPI(&pRegistry->api);
+    #endif
+    }
+
+    for (iShard = 0; iShard < VKB_OBJECT_REGISTRY_SHARD_COUNT; iShard += 1) {
+        VkbObjectRegistryShard* pShard = &pRegistry->shards[iShard];
+
+        pShard->slotCount   = VKB_OBJECT_REGISTRY_SLOT_COUNT;
+        pShard->objectCount = 0;
+        pShard->pSlots      = vkbObjectRegistryAllocSlots(pShard->slotCount);
+        if (pShard->pSlots == NULL) {
+            while (iShard > 0) {
+                iShard -= 1;
+                VKBIND_FREE(pRegistry->shards[iShard].pSlots);
+                vkbMutexUninit(&pRegistry->shards[iShard].lock);
+            }
+
+            VKBIND_FREE(pRegistry);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+
+        vkbMutexInit(&pShard->lock);
+    }
+
+    *ppRegistry = pRegistry;
+    return VK_SUCCESS;
+}
+
+void vkbDestroyObjectRegistry(VkbObjectRegistry* pRegistry)
+{
+    uint32_t iShard;
+
+    if (pRegistry == NULL) {
+        return;
+    }
+
+    for (iShard = 0; iShard < VKB_OBJECT_REGISTRY_SHARD_COUNT; iShard += 1) {
+        VKBIND_FREE(pRegistry->shards[iShard].pSlots);
+        vkbMutexUninit(&pRegistry->shards[iShard].lock);
+    }
+
+    VKBIND_FREE(pRegistry);
+}
+
+VkResult vkbInstallObjectRegistry(VkbObjectRegistry* pRegistry, VkbAPI* pAPI)
+{
+    uint32_t iInstall;
+
+    if (pRegistry == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        VkbAPI globalAPI;
+        VkResult result;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        result = vkbInstallObjectRegistry(pRegistry, &globalAPI);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        return vkbBindAPI(&globalAPI);
+    #else
+        return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+    #endif
+    }
+
+    for (iInstall = 0; iInstall < VKB_OBJECT_REGISTRY_MAX_INSTALLS; iInstall += 1) {
+        if (g_vkbObjectRegistryInstalls[iInstall].pRegistry == pRegistry && vkbObjectRegistryIsInstalledAPI(pAPI, iInstall)) {
+            return VK_SUCCESS;
+        }
+    }
+
+    for (iInstall = 0; iInstall < VKB_OBJECT_REGISTRY_MAX_INSTALLS; iInstall += 1) {
+        if (g_vkbObjectRegistryInstalls[iInstall].pRegistry == NULL) {
+            break;
+        }
+    }
+
+    if (iInstall == VKB_OBJECT_REGISTRY_MAX_INSTALLS) {
+        return VK_ERROR_TOO_MANY_OBJECTS;
+    }
+
+    memset(&g_vkbObjectRegistryInstalls[iInstall].next, 0, sizeof(g_vkbObjectRegistryInstalls[iInstall].next));
+    g_vkbObjectRegistryInstalls[iInstall].pRegistry = pRegistry;
+    vkbObjectRegistryInstallAPI(pAPI, iInstall);
+
+    return VK_SUCCESS;
+}
+
+void vkbUninstallObjectRegistry(VkbObjectRegistry* pRegistry, VkbAPI* pAPI)
+{
+    uint32_t iInstall;
+
+    if (pRegistry == NULL) {
+        return;
+    }
+
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        VkbAPI globalAPI;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        vkbUninstallObjectRegistry(pRegistry, &globalAPI);
+        vkbBindAPI(&globalAPI);
+    #endif
+        return;
+    }
+
+    for (iInstall = 0; iInstall < VKB_OBJECT_REGISTRY_MAX_INSTALLS; iInstall += 1) {
+        if (g_vkbObjectRegistryInstalls[iInstall].pRegistry == pRegistry && vkbObjectRegistryIsInstalledAPI(pAPI, iInstall)) {
+            vkbObjectRegistryUninstallAPI(pAPI, iInstall);
+            g_vkbObjectRegistryInstalls[iInstall].pRegistry = NULL;
+        }
+    }
+}
+
+VkResult vkbRegisterObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, VkObjectType parentType, uint64_t parent)
+{
+    uint64_t hash;
+    VkbObjectRegistryShard* pShard;
+    VkResult result = VK_SUCCESS;
+
+    if (pRegistry == NULL || objectType == VK_OBJECT_TYPE_UNKNOWN) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    hash   = vkbObjectRegistryHash(objectType, handle);
+    pShard = vkbObjectRegistryGetShard(pRegistry, hash);
+
+    vkbMutexLock(&pShard->lock);
+    {
+        VkbRegisteredObject* pSlot = &pShard->pSlots[vkbObjectRegistryFindSlot(pShard, objectType, handle, hash)];
+        if (pSlot->objectType != VK_OBJECT_TYPE_UNKNOWN) {
+            pSlot->count += 1;
+        } else {
+            /* Kept at most 3/4 full. */
+            if ((pShard->objectCount + 1) * 4 > pShard->slotCount * 3) {
+                result = vkbObjectRegistryGrowShard(pShard);
+                pSlot  = &pShard->pSlots[vkbObjectRegistryFindSlot(pShard, objectType, handle, hash)];
+            }
+
+            if (result == VK_SUCCESS) {
+                pSlot->handle     = handle;
+                pSlot->parent     = parent;
+                pSlot->objectType = objectType;
+                pSlot->parentType = parentType;
+                pSlot->count      = 1;
+                pShard->objectCount += 1;
+            }
+        }
+    }
+    vkbMutexUnlock(&pShard->lock);
+
+    return result;
+}
+
+void vkbUnregisterObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle)
+{
+    uint64_t hash;
+    VkbObjectRegistryShard* pShard;
+
+    if (pRegistry == NULL) {
+        return;
+    }
+
+    hash   = vkbObjectRegistryHash(objectType, handle);
+    pShard = vkbObjectRegistryGetShard(pRegistry, hash);
+
+    vkbMutexLock(&pShard->lock);
+    {
+        uint32_t iSlot = vkbObjectRegistryFindSlot(pShard, objectType, handle, hash);
+        if (pShard->pSlots[iSlot].objectType != VK_OBJECT_TYPE_UNKNOWN) {
+            pShard->pSlots[iSlot].count -= 1;
+            if (pShard->pSlots[iSlot].count == 0) {
+                vkbObjectRegistryClearSlot(pShard, iSlot);
+            }
+        }
+    }
+    vkbMutexUnlock(&pShard->lock);
+}
+
+VkBool32 vkbGetRegisteredObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, VkbRegisteredObject* pObject)
+{
+    uint64_t hash;
+    VkbObjectRegistryShard* pShard;
+    VkBool32 found;
+
+    if (pRegistry == NULL) {
+        return VK_FALSE;
+    }
+
+    hash   = vkbObjectRegistryHash(objectType, handle);
+    pShard = vkbObjectRegistryGetShard(pRegistry, hash);
+
+    vkbMutexLock(&pShard->lock);
+    {
+        const VkbRegisteredObject* pSlot = &pShard->pSlots[vkbObjectRegistryFindSlot(pShard, objectType, handle, hash)];
+        found = pSlot->objectType != VK_OBJECT_TYPE_UNKNOWN;
+        if (found && pObject != NULL) {
+            *pObject = *pSlot;
+        }
+    }
+    vkbMutexUnlock(&pShard->lock);
+
+    return found;
+}
+
+size_t vkbGetRegisteredObjectCount(VkbObjectRegistry* pRegistry, VkObjectType objectType)
+{
+    size_t count = 0;
+    uint32_t iShard;
+
+    if (pRegistry == NULL) {
+        return 0;
+    }
+
+    for (iShard = 0; iShard < VKB_OBJECT_REGISTRY_SHARD_COUNT; iShard += 1) {
+        VkbObjectRegistryShard* pShard = &pRegistry->shards[iShard];
+
+        vkbMutexLock(&pShard->lock);
+        {
+            if (objectType == VK_OBJECT_TYPE_UNKNOWN) {
+                count += pShard->objectCount;
+            } else {
+                uint32_t iSlot;
+                for (iSlot = 0; iSlot < pShard->slotCount; iSlot += 1) {
+                    if (pShard->pSlots[iSlot].objectType == objectType) {
+                        count += 1;
+                    }
+                }
+            }
+        }
+        vkbMutexUnlock(&pShard->lock);
+    }
+
+    return count;
+}
+
+size_t vkbGetRegisteredObjects(VkbObjectRegistry* pRegistry, VkbRegisteredObject* pObjects, size_t capacity)
+{
+    size_t count = 0;
+    uint32_t iShard;
+
+    if (pObjects == NULL) {
+        return vkbGetRegisteredObjectCount(pRegistry, VK_OBJECT_TYPE_UNKNOWN);
+    }
+
+    if (pRegistry == NULL) {
+        return 0;
+    }
+
+    for (iShard = 0; iShard < VKB_OBJECT_REGISTRY_SHARD_COUNT; iShard += 1) {
+        VkbObjectRegistryShard* pShard = &pRegistry->shards[iShard];
+
+        vkbMutexLock(&pShard->lock);
+        {
+            uint32_t iSlot;
+            for (iSlot = 0; iSlot < pShard->slotCount && count < capacity; iSlot += 1) {
+                if (pShard->pSlots[iSlot].objectType != VK_OBJECT_TYPE_UNKNOWN) {
+                    pObjects[count] = pShard->pSlots[iSlot];
+                    count += 1;
+                }
+            }
+        }
+        vkbMutexUnlock(&pShard->lock);
+    }
+
+    return count;
+}
+
+/* Orders objects by their parent so the children of an object are next to each other. */
+static int vkbObjectRegistryCompareParents(const void* pA, const void* pB)
+{
+    const VkbRegisteredObject* pObjectA = (const VkbRegisteredObject*)pA;
+    const VkbRegisteredObject* pObjectB = (const VkbRegisteredObject*)pB;
+
+    if (pObjectA->parentType != pObjectB->parentType) {
+        return ((uint32_t)pObjectA->parentType < (uint32_t)pObjectB->parentType) ? -1 : 1;
+    }
+    if (pObjectA->parent != pObjectB->parent) {
+        return (pObjectA->parent < pObjectB->parent) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/* pObjects is sorted with vkbObjectRegistryCompareParents(). */
+static VkResult vkbObjectRegistryDestroyTree(VkbObjectRegistry* pRegistry, const VkbRegisteredObject* pObjects, size_t objectCount, VkObjectType objectType, uint64_t handle, const VkAllocationCallbacks* pAllocator, uint32_t depth)
+{
+    VkbRegisteredObject key;
+    VkbRegisteredObject object;
+    VkbRegisteredObject owner;
+    VkbObjectRegistryDestroyProc onDestroy;
+    VkObjectType ownerType;
+    VkResult result = VK_SUCCESS;
+    size_t lo = 0;
+    size_t hi = objectCount;
+    uint32_t iStep;
+
+    if (depth > VKB_OBJECT_REGISTRY_MAX_DEPTH) {
+        return VK_INCOMPLETE;
+    }
+
+    /* Children first. Finds the first child with a binary search. */
+    key.parentType = objectType;
+    key.parent     = handle;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (vkbObjectRegistryCompareParents(&pObjects[mid], &key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (; lo < objectCount && vkbObjectRegistryCompareParents(&pObjects[lo], &key) == 0; lo += 1) {
+        if (vkbObjectRegistryDestroyTree(pRegistry, pObjects, objectCount, pObjects[lo].objectType, pObjects[lo].handle, pAllocator, depth + 1) != VK_SUCCESS) {
+            result = VK_INCOMPLETE;
+        }
+    }
+
+    if (!vkbGetRegisteredObject(pRegistry, objectType, handle, &object)) {
+        return result;
+    }
+
+    onDestroy = vkbObjectRegistryGetDestroyProc(objectType, &ownerType);
+    if (onDestroy == NULL) {
+        vkbObjectRegistryRemove(pRegistry, objectType, handle);   /* Destroyed implicitly along with its parent. */
+        return result;
+    }
+
+    /* The destroy command takes the device or instance, which might be further up than the parent. */
+    owner = object;
+    if (ownerType != VK_OBJECT_TYPE_UNKNOWN) {
+        for (iStep = 0; owner.objectType != ownerType; iStep += 1) {
+            if (iStep == VKB_OBJECT_REGISTRY_MAX_DEPTH || !vkbGetRegisteredObject(pRegistry, owner.parentType, owner.parent, &owner)) {
+                return VK_INCOMPLETE;
+            }
+        }
+    }
+
+    /* Objects that have been registered more than once are separate objects with the same handle. */
+    for (; object.count > 0; object.count -= 1) {
+        if (!onDestroy(&pRegistry->api, owner.handle, object.parent, handle, pAllocator)) {
+            return VK_INCOMPLETE;
+        }
+    }
+
+    vkbObjectRegistryRemove(pRegistry, objectType, handle);
+    return result;
+}
+
+VkResult vkbDestroyRegisteredObject(VkbObjectRegistry* pRegistry, VkObjectType objectType, uint64_t handle, const VkAllocationCallbacks* pAllocator)
+{
+    VkbRegisteredObject* pObjects;
+    size_t objectCount;
+    VkResult result;
+
+    if (pRegistry == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /* Only the children are needed from the snapshot. Everything else is looked up as it's needed so it's always up to date. */
+    objectCount = vkbGetRegisteredObjects(pRegistry, NULL, 0);
+    pObjects = (VkbRegisteredObject*)VKBIND_MALLOC(sizeof(*pObjects) * (objectCount + 1));
+    if (pObjects == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    objectCount = vkbGetRegisteredObjects(pRegistry, pObjects, objectCount);
+    qsort(pObjects, objectCount, sizeof(*pObjects), vkbObjectRegistryCompareParents);
+
+    result = vkbObjectRegistryDestroyTree(pRegistry, pObjects, objectCount, objectType, handle, pAllocator, 0);
+
+    VKBIND_FREE(pObjects);
+    return result;
+}
+#endif  /* VKBIND_OBJECT_REGISTRY */
+
+#ifdef VKBIND_BARRIER_BATCH
+typedef void (VKAPI_PTR* VkbCmdPipelineBarrier2Proc)(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo);
+
+/*<<barrier_batch>>*/
+
+struct VkbBarrierBatch
+{
+    VkbCmdPipelineBarrier2Proc cmdPipelineBarrier2;
+    VkMemoryBarrier2* pMemoryBarriers;
+    uint32_t memoryBarrierCount;
+    uint32_t memoryBarrierCapacity;
+    VkBufferMemoryBarrier2* pBufferBarriers;
+    uint32_t bufferBarrierCount;
+    uint32_t bufferBarrierCapacity;
+    VkImageMemoryBarrier2* pImageBarriers;
+    uint32_t imageBarrierCount;
+    uint32_t imageBarrierCapacity;
+};
+
+/* Makes room for one more element in one of the pending arrays. */
+static VkResult vkbBarrierBatchReserve(void** ppData, uint32_t count, uint32_t* pCapacity, size_t stride)
+{
+    void* pNewData;
+    uint32_t newCapacity;
+
+    if (count < *pCapacity) {
+        return VK_SUCCESS;
+    }
+
+    newCapacity = (*pCapacity == 0) ? 16 : *pCapacity * 2;
+    pNewData = VKBIND_MALLOC(stride * newCapacity);
+    if (pNewData == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    if (*ppData != NULL) {
+        memcpy(pNewData, *ppData, stride * count);
+        VKBIND_FREE(*ppData);
+    }
+
+    *ppData    = pNewData;
+    *pCapacity = newCapacity;
+    return VK_SUCCESS;
+}
+
+static VkBool32 vkbBarrierBatchIsValidDependency(VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+    return vkbAreAccessesSupportedByStages(srcAccessMask, srcStageMask) && vkbAreAccessesSupportedByStages(dstAccessMask, dstStageMask);
+}
+
+/* Stages and accesses are the same for every type of barrier so these work on any of them. */
+#define VKB_BARRIER_BATCH_SAME_MASKS(a, b) ((a).srcStageMask == (b).srcStageMask && (a).srcAccessMask == (b).srcAccessMask && (a).dstStageMask == (b).dstStageMask && (a).dstAccessMask == (b).dstAccessMask)
+#define VKB_BARRIER_BATCH_MERGE_MASKS(a, b) { (a).srcStageMask |= (b).srcStageMask; (a).srcAccessMask |= (b).srcAccessMask; (a).dstStageMask |= (b).dstStageMask; (a).dstAccessMask |= (b).dstAccessMask; }
+
+/*
+Merges the range [*pFirst, *pEnd) with [first, end) if they overlap, or if they're adjacent and allowed to be merged. Ranges that
+run to the end of the resource have an end of the maximum value of the type.
+*/
+static VkBool32 vkbBarrierBatchMergeRange64(VkDeviceSize* pFirst, VkDeviceSize* pEnd, VkDeviceSize first, VkDeviceSize end, VkBool32 allowAdjacent)
+{
+    VkBool32 overlaps = (*pFirst < end && first < *pEnd);
+    VkBool32 adjacent = (*pEnd == first || end == *pFirst);
+
+    if (!overlaps && !(adjacent && allowAdjacent)) {
+        return VK_FALSE;
+    }
+
+    *pFirst = (first < *pFirst) ? first : *pFirst;
+    *pEnd   = (end   > *pEnd)   ? end   : *pEnd;
+    return VK_TRUE;
+}
+
+static VkBool32 vkbBarrierBatchMergeRange32(uint32_t* pFirst, uint32_t* pEnd, uint32_t first, uint32_t end, VkBool32 allowAdjacent)
+{
+    VkDeviceSize first64 = *pFirst;
+    VkDeviceSize end64   = *pEnd;
+
+    if (!vkbBarrierBatchMergeRange64(&first64, &end64, first, end, allowAdjacent)) {
+        return VK_FALSE;
+    }
+
+    *pFirst = (uint32_t)first64;
+    *pEnd   = (uint32_t)end64;
+    return VK_TRUE;
+}
+
+static VkDeviceSize vkbBarrierBatchBufferEnd(const VkBufferMemoryBarrier2* pBarrier)
+{
+    return (pBarrier->size == VK_WHOLE_SIZE) ? ~(VkDeviceSize)0 : pBarrier->offset + pBarrier->size;
+}
+
+static uint32_t vkbBarrierBatchMipEnd(const VkImageSubresourceRange* pRange)
+{
+    return (pRange->levelCount == VK_REMAINING_MIP_LEVELS) ? ~(uint32_t)0 : pRange->baseMipLevel + pRange->levelCount;
+}
+
+static uint32_t vkbBarrierBatchLayerEnd(const VkImageSubresourceRange* pRange)
+{
+    return (pRange->layerCount == VK_REMAINING_ARRAY_LAYERS) ? ~(uint32_t)0 : pRange->baseArrayLayer + pRange->layerCount;
+}
+
+static VkBool32 vkbBarrierBatchImageRangesOverlap(const VkImageSubresourceRange* pA, const VkImageSubresourceRange* pB)
+{
+    return (pA->aspectMask & pB->aspectMask) != 0 &&
+        pA->baseMipLevel   < vkbBarrierBatchMipEnd(pB)   && pB->baseMipLevel   < vkbBarrierBatchMipEnd(pA) &&
+        pA->baseArrayLayer < vkbBarrierBatchLayerEnd(pB) && pB->baseArrayLayer < vkbBarrierBatchLayerEnd(pA);
+}
+
+/*
+Merges the new barrier into an existing one where possible. Queue family ownership transfers are only merged when their ranges are
+the same since anything else would transfer more than was asked for.
+*/
+static VkBool32 vkbBarrierBatchTryMergeBuffer(VkBufferMemoryBarrier2* pPending, const VkBufferMemoryBarrier2* pBarrier)
+{
+    VkDeviceSize first = pPending->offset;
+    VkDeviceSize end   = vkbBarrierBatchBufferEnd(pPending);
+    VkBool32 isSameRange;
+
+    if (pPending->pNext != NULL || pBarrier->pNext != NULL || pPending->buffer != pBarrier->buffer || pPending->srcQueueFamilyIndex != pBarrier->srcQueueFamilyIndex || pPending->dstQueueFamilyIndex != pBarrier->dstQueueFamilyIndex) {
+        return VK_FALSE;
+    }
+
+    isSameRange = (pPending->offset == pBarrier->offset && end == vkbBarrierBatchBufferEnd(pBarrier));
+    if (pBarrier->srcQueueFamilyIndex != pBarrier->dstQueueFamilyIndex && !isSameRange) {
+        return VK_FALSE;
+    }
+
+    if (!vkbBarrierBatchMergeRange64(&first, &end, pBarrier->offset, vkbBarrierBatchBufferEnd(pBarrier), VKB_BARRIER_BATCH_SAME_MASKS(*pPending, *pBarrier))) {
+        return VK_FALSE;
+    }
+
+    pPending->offset = first;
+    pPending->size   = (end == ~(VkDeviceSize)0) ? VK_WHOLE_SIZE : end - first;
+    VKB_BARRIER_BATCH_MERGE_MASKS(*pPending, *pBarrier);
+    return VK_TRUE;
+}
+
+static VkBool32 vkbBarrierBatchTryMergeImage(VkImageMemoryBarrier2* pPending, const VkImageMemoryBarrier2* pBarrier)
+{
+    const VkImageSubresourceRange* pA = &pPending->subresourceRange;
+    const VkImageSubresourceRange* pB = &pBarrier->subresourceRange;
+    VkBool32 isSameMips;
+    VkBool32 isSameLayers;
+    VkBool32 allowAdjacent;
+    uint32_t first;
+    uint32_t end;
+
+    if (pPending->pNext != NULL || pBarrier->pNext != NULL || pPending->image != pBarrier->image || pPending->oldLayout != pBarrier->oldLayout || pPending->newLayout != pBarrier->newLayout ||
+        pPending->srcQueueFamilyIndex != pBarrier->srcQueueFamilyIndex || pPending->dstQueueFamilyIndex != pBarrier->dstQueueFamilyIndex || pA->aspectMask != pB->aspectMask) {
+        return VK_FALSE;
+    }
+
+    isSameMips    = (pA->baseMipLevel   == pB->baseMipLevel   && vkbBarrierBatchMipEnd(pA)   == vkbBarrierBatchMipEnd(pB));
+    isSameLayers  = (pA->baseArrayLayer == pB->baseArrayLayer && vkbBarrierBatchLayerEnd(pA) == vkbBarrierBatchLayerEnd(pB));
+    allowAdjacent = VKB_BARRIER_BATCH_SAME_MASKS(*pPending, *pBarrier);
+
+    if (isSameMips && isSameLayers) {
+        VKB_BARRIER_BATCH_MERGE_MASKS(*pPending, *pBarrier);
+        return VK_TRUE;
+    }
+
+    /* The union of two ranges that differ in both their mips and their layers can't be expressed as a single range. */
+    if (pBarrier->srcQueueFamilyIndex != pBarrier->dstQueueFamilyIndex || (!isSameMips && !isSameLayers)) {
+        return VK_FALSE;
+    }
+
+    if (isSameMips) {
+        first = pA->baseArrayLayer;
+        end   = vkbBarrierBatchLayerEnd(pA);
+        if (!vkbBarrierBatchMergeRange32(&first, &end, pB->baseArrayLayer, vkbBarrierBatchLayerEnd(pB), allowAdjacent)) {
+            return VK_FALSE;
+        }
+
+        pPending->subresourceRange.baseArrayLayer = first;
+        pPending->subresourceRange.layerCount     = (end == ~(uint32_t)0) ? VK_REMAINING_ARRAY_LAYERS : end - first;
+    } else {
+        first = pA->baseMipLevel;
+        end   = vkbBarrierBatchMipEnd(pA);
+        if (!vkbBarrierBatchMergeRange32(&first, &end, pB->baseMipLevel, vkbBarrierBatchMipEnd(pB), allowAdjacent)) {
+            return VK_FALSE;
+        }
+
+        pPending->subresourceRange.baseMipLevel = first;
+        pPending->subresourceRange.levelCount   = (end == ~(uint32_t)0) ? VK_REMAINING_MIP_LEVELS : end - first;
+    }
+
+    VKB_BARRIER_BATCH_MERGE_MASKS(*pPending, *pBarrier);
+    return VK_TRUE;
+}
+
+VkResult vkbCreateBarrierBatch(const VkbAPI* pAPI, VkbBarrierBatch** ppBatch)
+{
+    VkbBarrierBatch* pBatch;
+    VkbCmdPipelineBarrier2Proc cmdPipelineBarrier2;
+
+    if (ppBatch == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *ppBatch = NULL;
+
+    cmdPipelineBarrier2 = vkbBarrierBatchGetCmdPipelineBarrier2(pAPI);
+    if (cmdPipelineBarrier2 == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    pBatch = (VkbBarrierBatch*)VKBIND_MALLOC(sizeof(*pBatch));
+    if (pBatch == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    memset(pBatch, 0, sizeof(*pBatch));
+    pBatch->cmdPipelineBarrier2 = cmdPipelineBarrier2;
+
+    *ppBatch = pBatch;
+    return VK_SUCCESS;
+}
+
+void vkbDestroyBarrierBatch(VkbBarrierBatch* pBatch)
+{
+    if (pBatch == NULL) {
+        return;
+    }
+
+    VKBIND_FREE(pBatch->pMemoryBarriers);
+    VKBIND_FREE(pBatch->pBufferBarriers);
+    VKBIND_FREE(pBatch->pImageBarriers);
+    VKBIND_FREE(pBatch);
+}
+
+VkResult vkbBarrierBatchAddMemoryBarrier(VkbBarrierBatch* pBatch, const VkMemoryBarrier2* pBarrier)
+{
+    VkResult result;
+    uint32_t iPending;
+
+    if (pBatch == NULL || pBarrier == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (!vkbBarrierBatchIsValidDependency(pBarrier->srcStageMask, pBarrier->srcAccessMask, pBarrier->dstStageMask, pBarrier->dstAccessMask)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /* Memory barriers apply to everything so any two of them can be combined. */
+    if (pBarrier->pNext == NULL) {
+        for (iPending = 0; iPending < pBatch->memoryBarrierCount; iPending += 1) {
+            if (pBatch->pMemoryBarriers[iPending].pNext == NULL) {
+                VKB_BARRIER_BATCH_MERGE_MASKS(pBatch->pMemoryBarriers[iPending], *pBarrier);
+                return VK_SUCCESS;
+            }
+        }
+    }
+
+    result = vkbBarrierBatchReserve((void**)&pBatch->pMemoryBarriers, pBatch->memoryBarrierCount, &pBatch->memoryBarrierCapacity, sizeof(*pBarrier));
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    pBatch->pMemoryBarriers[pBatch->memoryBarrierCount] = *pBarrier;
+    pBatch->memoryBarrierCount += 1;
+
+    return VK_SUCCESS;
+}
+
+VkResult vkbBarrierBatchAddBufferBarrier(VkbBarrierBatch* pBatch, const VkBufferMemoryBarrier2* pBarrier)
+{
+    VkBufferMemoryBarrier2 barrier;
+    VkResult result;
+    uint32_t iPending;
+
+    if (pBatch == NULL || pBarrier == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (pBarrier->size == 0 || !vkbBarrierBatchIsValidDependency(pBarrier->srcStageMask, pBarrier->srcAccessMask, pBarrier->dstStageMask, pBarrier->dstAccessMask)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    result = vkbBarrierBatchReserve((void**)&pBatch->pBufferBarriers, pBatch->bufferBarrierCount, &pBatch->bufferBarrierCapacity, sizeof(*pBarrier));
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    /*
+    A merged barrier can have grown to the point where it can be merged with another one so it's taken out and merged again until
+    nothing else can be merged with it.
+    */
+    barrier = *pBarrier;
+    iPending = 0;
+    while (iPending < pBatch->bufferBarrierCount) {
+        VkBufferMemoryBarrier2 merged = pBatch->pBufferBarriers[iPending];
+        if (vkbBarrierBatchTryMergeBuffer(&merged, &barrier)) {
+            barrier = merged;
+            pBatch->bufferBarrierCount -= 1;
+            memmove(&pBatch->pBufferBarriers[iPending], &pBatch->pBufferBarriers[iPending + 1], sizeof(barrier) * (pBatch->bufferBarrierCount - iPending));
+            iPending = 0;
+        } else {
+            iPending += 1;
+        }
+    }
+
+    pBatch->pBufferBarriers[pBatch->bufferBarrierCount] = barrier;
+    pBatch->bufferBarrierCount += 1;
+
+    return VK_SUCCESS;
+}
+
+VkResult vkbBarrierBatchAddImageBarrier(VkbBarrierBatch* pBatch, const VkImageMemoryBarrier2* pBarrier)
+{
+    VkImageMemoryBarrier2 barrier;
+    VkResult result;
+    uint32_t iPending;
+
+    if (pBatch == NULL || pBarrier == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (pBarrier->subresourceRange.levelCount == 0 || pBarrier->subresourceRange.layerCount == 0 || !vkbBarrierBatchIsValidDependency(pBarrier->srcStageMask, pBarrier->srcAccessMask, pBarrier->dstStageMask, pBarrier->dstAccessMask)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /* A subresource can only be transitioned once per batch. Doing it twice with different layouts is always a mistake. */
+    for (iPending = 0; iPending < pBatch->imageBarrierCount; iPending += 1) {
+        const VkImageMemoryBarrier2* pPending = &pBatch->pImageBarriers[iPending];
+        if (pPending->image == pBarrier->image && (pPending->oldLayout != pBarrier->oldLayout || pPending->newLayout != pBarrier->newLayout) && vkbBarrierBatchImageRangesOverlap(&pPending->subresourceRange, &pBarrier->subresourceRange)) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
+    result = vkbBarrierBatchReserve((void**)&pBatch->pImageBarriers, pBatch->imageBarrierCount, &pBatch->imageBarrierCapacity, sizeof(*pBarrier));
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    barrier = *pBarrier;
+    iPending = 0;
+    while (iPending < pBatch->imageBarrierCount) {
+        VkImageMemoryBarrier2 merged = pBatch->pImageBarriers[iPending];
+        if (vkbBarrierBatchTryMergeImage(&merged, &barrier)) {
+            barrier = merged;
+            pBatch->imageBarrierCount -= 1;
+            memmove(&pBatch->pImageBarriers[iPending], &pBatch->pImageBarriers[iPending + 1], sizeof(barrier) * (pBatch->imageBarrierCount - iPending));
+            iPending = 0;
+        } else {
+            iPending += 1;
+        }
+    }
+
+    pBatch->pImageBarriers[pBatch->imageBarrierCount] = barrier;
+    pBatch->imageBarrierCount += 1;
+
+    return VK_SUCCESS;
+}
+
+uint32_t vkbBarrierBatchGetPendingCount(const VkbBarrierBatch* pBatch)
+{
+    if (pBatch == NULL) {
+        return 0;
+    }
+
+    return pBatch->memoryBarrierCount + pBatch->bufferBarrierCount + pBatch->imageBarrierCount;
+}
+
+void vkbBarrierBatchFlush(VkbBarrierBatch* pBatch, VkCommandBuffer commandBuffer, VkDependencyFlags dependencyFlags)
+{
+    VkDependencyInfo dependencyInfo;
+
+    if (vkbBarrierBatchGetPendingCount(pBatch) == 0) {
+        return;
+    }
+
+    memset(&dependencyInfo, 0, sizeof(dependencyInfo));
+    dependencyInfo.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.dependencyFlags          = dependencyFlags;
+    dependencyInfo.memoryBarrierCount       = pBatch->memoryBarrierCount;
+    dependencyInfo.pMemoryBarriers          = pBatch->pMemoryBarriers;
+    dependencyInfo.bufferMemoryBarrierCount = pBatch->bufferBarrierCount;
+    dependencyInfo.pBufferMemoryBarriers    = pBatch->pBufferBarriers;
+    dependencyInfo.imageMemoryBarrierCount  = pBatch->imageBarrierCount;
+    dependencyInfo.pImageMemoryBarriers     = pBatch->pImageBarriers;
+    pBatch->cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+    vkbBarrierBatchReset(pBatch);
+}
+
+void vkbBarrierBatchReset(VkbBarrierBatch* pBatch)
+{
+    if (pBatch == NULL) {
+        return;
+    }
+
+    pBatch->memoryBarrierCount = 0;
+    pBatch->bufferBarrierCount = 0;
+    pBatch->imageBarrierCount  = 0;
+}
+#endif  /* VKBIND_BARRIER_BATCH */
+
+
+#ifdef VKBIND_COMMAND_STREAM
+typedef struct
+{
+    uint32_t opcode;
+    uint32_t size;      /* The size of the command including everything copied along with it. */
+} VkbCommandStreamHeader;
+
+typedef void (* VkbCommandStreamCopyProc)(VkbDeepCopyArena* pArena, const VkbCommandStreamHeader* pArgs, VkbCommandStreamHeader* pCommand);
+
+/*
+Retrieves the number of bytes a command takes up in a stream. pArgs is the structure holding the arguments of the command and onCopy
+copies what they point to.
+*/
+static size_t vkbCommandStreamMeasure(const VkbCommandStreamHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy)
+{
+    VkbDeepCopyArena arena;
+
+    arena.pData = NULL;
+    arena.capacity = 0;
+    arena.cursor = 0;
+    arena.overflowed = VK_FALSE;
+    vkbDeepCopyAlloc(&arena, argsSize);
+    if (onCopy != NULL) {
+        onCopy(&arena, pArgs, NULL);
+    }
+
+    return arena.cursor;
+}
+
+/* Appends a command that has already been measured with vkbCommandStreamMeasure(). */
+static VkResult vkbCommandStreamPushMeasured(VkbCommandStream* pStream, const VkbCommandStreamHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy, size_t commandSize)
+{
+    VkbDeepCopyArena arena;
+    VkbCommandStreamHeader* pCommand;
+
+    /* Both arenas align to 8 bytes so the layout is the same as when measuring. */
+    pCommand = (VkbCommandStreamHeader*)vkbArenaAlloc(&pStream->arena, commandSize);
+    if (pCommand == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    arena.pData = (unsigned char*)pCommand;
+    arena.capacity = commandSize;
+    arena.cursor = 0;
+    arena.overflowed = VK_FALSE;
+    vkbDeepCopyBytes(&arena, pArgs, argsSize);
+    if (onCopy != NULL) {
+        onCopy(&arena, pArgs, pCommand);
+    }
+
+    pCommand->size = (uint32_t)commandSize;
+    pStream->commandCount += 1;
+
+    return VK_SUCCESS;
+}
+
+/*
+Appends a command to a stream. It's measured first so the whole command can be allocated at once.
+*/
+static VkResult vkbCommandStreamPush(VkbCommandStream* pStream, const VkbCommandStreamHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy)
+{
+    if (pStream == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    return vkbCommandStreamPushMeasured(pStream, pArgs, argsSize, onCopy, vkbCommandStreamMeasure(pArgs, argsSize, onCopy));
+}
+
+/*<<command_stream>>*/
+
+void vkbCommandStreamInit(VkbCommandStream* pStream, void* pData, size_t capacity)
+{
+    if (pStream == NULL) {
+        return;
+    }
+
+    vkbArenaInit(&pStream->arena, pData, capacity);
+    pStream->commandCount = 0;
+}
+
+void vkbCommandStreamReset(VkbCommandStream* pStream)
+{
+    if (pStream == NULL) {
+        return;
+    }
+
+    pStream->arena.cursor = 0;
+    pStream->commandCount = 0;
+}
+
+VkResult vkbCommandStreamReplay(const VkbCommandStream* pStream, const VkbAPI* pAPI, VkCommandBuffer commandBuffer)
+{
+#if !defined(VKBIND_NO_GLOBAL_API)
+    VkbAPI globalAPI;
+#endif
+    size_t cursor;
+    VkResult result;
+
+    if (pStream == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        vkbInitFromGlobalAPI(&globalAPI);
+        pAPI = &globalAPI;
+    #else
+        return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+    #endif
+    }
+
+    cursor = 0;
+    while (cursor < pStream->arena.cursor) {
+        const VkbCommandStreamHeader* pHeader = (const VkbCommandStreamHeader*)((const unsigned char*)pStream->arena.pData + cursor);
+
+        result = vkbCommandStreamReplayCommand(pAPI, commandBuffer, pHeader);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        /* Commands are allocated back to back from the arena so the next one is at the next aligned offset. */
+        cursor = (cursor + pHeader->size + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+    }
+
+    return VK_SUCCESS;
+}
+#endif  /* VKBIND_COMMAND_STREAM */
+
+
+#ifdef VKBIND_STATE_FILTER
+#define VKB_STATE_FILTER_NO_GROUP           0xFFFFFFFF
+#define VKB_STATE_FILTER_MIN_SHADOW_SIZE    256
+
+typedef struct
+{
+    const char* pName;
+    uint32_t group;             /* VKB_STATE_FILTER_NO_GROUP for commands that don't set state. */
+    VkBool32 invalidatesAll;    /* Whether or not the command leaves every other piece of state unknown. */
+} VkbStateFilterCommand;
+
+/* A copy of the last call that set a piece of state. It's only valid when its epoch matches the filter's. */
+typedef struct
+{
+    VkbCommandStream stream;
+    uint32_t epoch;
+} VkbStateFilterShadow;
+
+typedef VkBool32 (* VkbStateFilterEqualProc)(const VkbCommandStreamHeader* pShadow, const VkbCommandStreamHeader* pArgs);
+
+/* The number of commands and groups is generated so the arrays are allocated along with the filter. */
+struct VkbStateFilter
+{
+    VkbAPI api;
+    VkCommandBuffer commandBuffer;
+    uint32_t epoch;
+    VkbStateFilterStats stats;
+    uint64_t* pElidedCounts;            /* One per command. */
+    VkbStateFilterShadow* pShadows;     /* One per group. */
+};
+
+/* The generated wrappers call these around each call. They're defined after the generated command table. */
+static VkBool32 vkbStateFilterIsRedundant(VkbStateFilter* pFilter, uint32_t iCommand, const VkbCommandStreamHeader* pArgs, VkbStateFilterEqualProc onEqual);
+static void vkbStateFilterUpdate(VkbStateFilter* pFilter, uint32_t iCommand, const VkbCommandStreamHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy);
+
+/*<<state_filter>>*/
+
+/* Forgets every piece of state. Bumping the epoch does this without touching the shadows. */
+static void vkbStateFilterInvalidateAll(VkbStateFilter* pFilter)
+{
+    uint32_t iGroup;
+
+    pFilter->epoch += 1;
+    if (pFilter->epoch == 0) {
+        /* Wrapped around so old shadows could look valid again. 0 is never valid. */
+        for (iGroup = 0; iGroup < VKB_STATE_FILTER_GROUP_COUNT; iGroup += 1) {
+            pFilter->pShadows[iGroup].epoch = 0;
+        }
+        pFilter->epoch = 1;
+    }
+}
+
+static VkBool32 vkbStateFilterIsRedundant(VkbStateFilter* pFilter, uint32_t iCommand, const VkbCommandStreamHeader* pArgs, VkbStateFilterEqualProc onEqual)
+{
+    const VkbStateFilterCommand* pCommand = &g_vkbStateFilterCommands[iCommand];
+    const VkbStateFilterShadow* pShadow;
+    const VkbCommandStreamHeader* pShadowArgs;
+
+    pFilter->stats.callCount += 1;
+
+    if (pArgs == NULL || pCommand->group == VKB_STATE_FILTER_NO_GROUP) {
+        return VK_FALSE;
+    }
+
+    pShadow = &pFilter->pShadows[pCommand->group];
+    if (pShadow->epoch != pFilter->epoch || pShadow->stream.commandCount == 0) {
+        return VK_FALSE;
+    }
+
+    pShadowArgs = (const VkbCommandStreamHeader*)pShadow->stream.arena.pData;
+    if (pShadowArgs->opcode != pArgs->opcode || !onEqual(pShadowArgs, pArgs)) {
+        return VK_FALSE;
+    }
+
+    pFilter->stats.elidedCount    += 1;
+    pFilter->pElidedCounts[iCommand] += 1;
+    return VK_TRUE;
+}
+
+/* Called after a call has been made. pArgs is NULL for commands that can't be compared, which leaves their state unknown. */
+static void vkbStateFilterUpdate(VkbStateFilter* pFilter, uint32_t iCommand, const VkbCommandStreamHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy)
+{
+    const VkbStateFilterCommand* pCommand = &g_vkbStateFilterCommands[iCommand];
+    VkbStateFilterShadow* pShadow;
+    VkResult result;
+
+    if (pCommand->invalidatesAll) {
+        vkbStateFilterInvalidateAll(pFilter);
+    }
+
+    if (pCommand->group == VKB_STATE_FILTER_NO_GROUP) {
+        return;
+    }
+
+    pShadow = &pFilter->pShadows[pCommand->group];
+    pShadow->epoch = 0;
+
+    if (pArgs == NULL) {
+        return;
+    }
+
+    vkbCommandStreamReset(&pShadow->stream);
+    for (;;) {
+        void* pNewData;
+        size_t newCapacity;
+
+        result = vkbCommandStreamPush(&pShadow->stream, pArgs, argsSize, onCopy);
+        if (result != VK_ERROR_OUT_OF_HOST_MEMORY) {
+            break;
+        }
+
+        /* Most calls are small. The ones with large arrays grow the shadow to fit. */
+        newCapacity = (pShadow->stream.arena.capacity < VKB_STATE_FILTER_MIN_SHADOW_SIZE) ? VKB_STATE_FILTER_MIN_SHADOW_SIZE : pShadow->stream.arena.capacity * 2;
+        pNewData = VKBIND_MALLOC(newCapacity);
+        if (pNewData == NULL) {
+            return;
+        }
+
+        VKBIND_FREE(pShadow->stream.arena.pData);
+        vkbCommandStreamInit(&pShadow->stream, pNewData, newCapacity);
+    }
+
+    if (result == VK_SUCCESS) {
+        pShadow->epoch = pFilter->epoch;
+    }
+}
+
+VkResult vkbCreateStateFilter(const VkbAPI* pAPI, VkCommandBuffer commandBuffer, VkbStateFilter** ppFilter)
+{
+    VkbStateFilter* pFilter;
+    size_t allocationSize;
+
+    if (ppFilter == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *ppFilter = NULL;
+
+    #if defined(VKBIND_NO_GLOBAL_API)
+    {
+        if (pAPI == NULL) {
+            return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+        }
+    }
+    #endif
+
+    /* The counts go straight after the filter since they're 64-bit, followed by the shadows. */
+    allocationSize = sizeof(*pFilter) + (sizeof(uint64_t) * VKB_STATE_FILTER_COMMAND_COUNT) + (sizeof(VkbStateFilterShadow) * VKB_STATE_FILTER_GROUP_COUNT);
+
+    pFilter = (VkbStateFilter*)VKBIND_MALLOC(allocationSize);
+    if (pFilter == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    memset(pFilter, 0, allocationSize);
+    pFilter->pElidedCounts = (uint64_t*)(pFilter + 1);
+    pFilter->pShadows      = (VkbStateFilterShadow*)(pFilter->pElidedCounts + VKB_STATE_FILTER_COMMAND_COUNT);
+
+    if (pAPI != NULL) {
+        pFilter->api = *pAPI;
+    } else {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        vkbInitFromGlobalAPI(&pFilter->api);
+    #endif
+    }
+
+    pFilter->commandBuffer = commandBuffer;
+    pFilter->epoch = 1;
+
+    *ppFilter = pFilter;
+    return VK_SUCCESS;
+}
+
+void vkbDestroyStateFilter(VkbStateFilter* pFilter)
+{
+    uint32_t iGroup;
+
+    if (pFilter == NULL) {
+        return;
+    }
+
+    for (iGroup = 0; iGroup < VKB_STATE_FILTER_GROUP_COUNT; iGroup += 1) {
+        VKBIND_FREE(pFilter->pShadows[iGroup].stream.arena.pData);
+    }
+
+    VKBIND_FREE(pFilter);
+}
+
+void vkbStateFilterReset(VkbStateFilter* pFilter, VkCommandBuffer commandBuffer)
+{
+    if (pFilter == NULL) {
+        return;
+    }
+
+    pFilter->commandBuffer = commandBuffer;
+    vkbStateFilterInvalidateAll(pFilter);
+}
+
+void vkbStateFilterGetStats(const VkbStateFilter* pFilter, VkbStateFilterStats* pStats)
+{
+    if (pStats == NULL) {
+        return;
+    }
+
+    if (pFilter == NULL) {
+        memset(pStats, 0, sizeof(*pStats));
+        return;
+    }
+
+    *pStats = pFilter->stats;
+}
+
+uint64_t vkbStateFilterGetElidedCount(const VkbStateFilter* pFilter, const char* pCommandName)
+{
+    uint32_t iCommand;
+
+    if (pFilter == NULL || pCommandName == NULL) {
+        return 0;
+    }
+
+    for (iCommand = 0; iCommand < VKB_STATE_FILTER_COMMAND_COUNT; iCommand += 1) {
+        if (strcmp(g_vkbStateFilterCommands[iCommand].pName, pCommandName) == 0) {
+            return pFilter->pElidedCounts[iCommand];
+        }
+    }
+
+    return 0;
+}
+#endif  /* VKBIND_STATE_FILTER */
+
+
+#ifdef VKBIND_CAPTURE
+#define VKB_CAPTURE_MAGIC       0x43424B56  /* "VKBC". Reads back as something else with the other byte order. */
+#define VKB_CAPTURE_CHUNK_MAGIC 0x54424B56  /* "VKBT". A chunk of calls written by vkbBeginCapture(). */
+#define VKB_CAPTURE_VERSION     1
+
+/* The commands follow the header, followed by a bitmap with a bit for each pointer-sized word saying whether it's a pointer. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerVersion;     /* VK_HEADER_VERSION of the header that saved it. */
+    uint32_t opcodeCount;       /* VKB_COMMAND_STREAM_OPCODE_COUNT or VKB_CAPTURE_OPCODE_COUNT, which change whenever commands are added. */
+    uint32_t pointerSize;
+    uint32_t commandCount;
+    uint64_t dataSize;          /* The size of the commands, rounded up to VKB_ARENA_ALIGNMENT. */
+} VkbCaptureHeader;
+
+typedef struct
+{
+    VkbRemapHandleProc onRemap;
+    void* pUserData;
+} VkbCaptureRemap;
+
+static uint64_t vkbCaptureRemapHandle(VkbCaptureRemap* pRemap, VkObjectType objectType, uint64_t handle)
+{
+    if (handle == 0) {
+        return 0;
+    }
+
+    return pRemap->onRemap(pRemap->pUserData, objectType, handle);
+}
+
+#define VKB_CAPTURE_REMAP_DISPATCHABLE(pRemap, objectType, type, handle)        (handle) = VKB_DISPATCHABLE_FROM_U64(type, vkbCaptureRemapHandle((pRemap), (objectType), VKB_U64_FROM_DISPATCHABLE(handle)))
+#define VKB_CAPTURE_REMAP_NON_DISPATCHABLE(pRemap, objectType, type, handle)    (handle) = VKB_NON_DISPATCHABLE_FROM_U64(type, vkbCaptureRemapHandle((pRemap), (objectType), VKB_U64_FROM_NON_DISPATCHABLE(handle)))
+
+static void vkbCaptureRemapStruct(VkbCaptureRemap* pRemap, VkbBaseStructure* pStruct);
+
+static void vkbCaptureRemapNext(VkbCaptureRemap* pRemap, void* pStruct)
+{
+    /* The chain was copied into the stream so it's safe to cast away the const. */
+    VkbBaseStructure* pNext = (VkbBaseStructure*)((VkbBaseStructure*)pStruct)->pNext;
+    if (pNext != NULL) {
+        vkbCaptureRemapStruct(pRemap, pNext);
+    }
+}
+
+/*<<capture>>*/
+
+static size_t vkbCaptureGetBitmapSize(size_t dataSize)
+{
+    return ((dataSize / sizeof(uintptr_t)) + 7) / 8;
+}
+
+static size_t vkbCaptureGetNextCommand(size_t cursor, const VkbCommandStreamHeader* pHeader)
+{
+    return (cursor + pHeader->size + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+}
+
+/* The size of a saved stream. It's rounded up so saved streams can be written back to back. */
+static size_t vkbCaptureGetSavedSize(size_t dataSize)
+{
+    return (sizeof(VkbCaptureHeader) + dataSize + vkbCaptureGetBitmapSize(dataSize) + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+}
+
+typedef VkResult (* VkbCaptureGetCommandInfoProc)(uint32_t opcode, size_t* pArgsSize, VkbCommandStreamCopyProc* pOnCopy);
+
+/* Saves both command streams and the chunks of a capture. They only differ in their magic number and opcodes. */
+static VkResult vkbCaptureSaveStream(const VkbCommandStream* pStream, VkbCaptureGetCommandInfoProc onGetCommandInfo, uint32_t magic, uint32_t opcodeCount, void* pData, size_t* pDataSize)
+{
+    VkbCaptureHeader* pHeader;
+    VkbCommandStream copy;
+    const uintptr_t* pSrcWords;
+    uintptr_t* pDstWords;
+    unsigned char* pBitmap;
+    size_t dataSize;
+    size_t requiredSize;
+    size_t cursor;
+    size_t iWord;
+    VkResult result;
+
+    if (pStream == NULL || pDataSize == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    dataSize = (pStream->arena.cursor + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+    requiredSize = vkbCaptureGetSavedSize(dataSize);
+
+    if (pData == NULL) {
+        *pDataSize = requiredSize;
+        return VK_SUCCESS;
+    }
+
+    if (*pDataSize < requiredSize) {
+        return VK_INCOMPLETE;
+    }
+
+    if (((uintptr_t)pData & (VKB_ARENA_ALIGNMENT - 1)) != 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    /*
+    Recording every command again lays them out exactly as they are in the stream, just at a different address. The only words that
+    are different by exactly the distance between the two are the pointers the stream has to itself. Everything else, including the
+    pointers that weren't copied, is the same. The padding is zeroed so it doesn't leak whatever was in memory before.
+    */
+    memset(pData, 0, requiredSize);
+    vkbCommandStreamInit(&copy, (unsigned char*)pData + sizeof(VkbCaptureHeader), dataSize);
+
+    cursor = 0;
+    while (cursor < pStream->arena.cursor) {
+        const VkbCommandStreamHeader* pCommand = (const VkbCommandStreamHeader*)((const unsigned char*)pStream->arena.pData + cursor);
+        VkbCommandStreamCopyProc onCopy;
+        size_t argsSize;
+
+        result = onGetCommandInfo(pCommand->opcode, &argsSize, &onCopy);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        result = vkbCommandStreamPush(&copy, pCommand, argsSize, onCopy);
+        if (result != VK_SUCCESS) {
+            return VK_ERROR_INITIALIZATION_FAILED;  /* Should never happen since the copy is the same size. */
+        }
+
+        cursor = vkbCaptureGetNextCommand(cursor, pCommand);
+    }
+
+    if (copy.arena.cursor != pStream->arena.cursor) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    pSrcWords = (const uintptr_t*)pStream->arena.pData;
+    pDstWords = (uintptr_t*)copy.arena.pData;
+    pBitmap   = (unsigned char*)copy.arena.pData + dataSize;
+
+    for (iWord = 0; iWord < pStream->arena.cursor / sizeof(uintptr_t); iWord += 1) {
+        uintptr_t offset = pSrcWords[iWord] - (uintptr_t)pStream->arena.pData;
+        if (pSrcWords[iWord] != pDstWords[iWord] && offset < pStream->arena.cursor && pDstWords[iWord] - (uintptr_t)copy.arena.pData == offset) {
+            pDstWords[iWord] = offset;
+            pBitmap[iWord / 8] |= (unsigned char)(1 << (iWord % 8));
+        }
+    }
+
+    pHeader = (VkbCaptureHeader*)pData;
+    pHeader->magic         = magic;
+    pHeader->version       = VKB_CAPTURE_VERSION;
+    pHeader->headerVersion = VK_HEADER_VERSION;
+    pHeader->opcodeCount   = opcodeCount;
+    pHeader->pointerSize   = (uint32_t)sizeof(uintptr_t);
+    pHeader->commandCount  = copy.commandCount;
+    pHeader->dataSize      = dataSize;
+
+    *pDataSize = requiredSize;
+    return VK_SUCCESS;
+}
+
+static VkResult vkbCaptureLoadStream(VkbCommandStream* pStream, VkbCaptureGetCommandInfoProc onGetCommandInfo, uint32_t magic, uint32_t opcodeCount, void* pData, size_t dataSize)
+{
+    VkbCaptureHeader* pHeader;
+    unsigned char* pCommands;
+    uintptr_t* pWords;
+    const unsigned char* pBitmap;
+    size_t commandsSize;
+    size_t cursor;
+    size_t iWord;
+    uint32_t commandCount;
+
+    if (pStream == NULL || pData == NULL || dataSize < sizeof(VkbCaptureHeader) || ((uintptr_t)pData & (VKB_ARENA_ALIGNMENT - 1)) != 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    pHeader = (VkbCaptureHeader*)pData;
+    if (pHeader->magic != magic || pHeader->version != VKB_CAPTURE_VERSION || pHeader->headerVersion != VK_HEADER_VERSION || pHeader->opcodeCount != opcodeCount || pHeader->pointerSize != sizeof(uintptr_t)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (pHeader->dataSize > dataSize - sizeof(VkbCaptureHeader) || (pHeader->dataSize & (VKB_ARENA_ALIGNMENT - 1)) != 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    commandsSize = (size_t)pHeader->dataSize;
+    if (vkbCaptureGetBitmapSize(commandsSize) > dataSize - sizeof(VkbCaptureHeader) - commandsSize) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    pCommands = (unsigned char*)pData + sizeof(VkbCaptureHeader);
+    pWords    = (uintptr_t*)pCommands;
+    pBitmap   = pCommands + commandsSize;
+
+    /* Everything is checked before anything is changed so a bad buffer is left as it was. */
+    commandCount = 0;
+    cursor = 0;
+    while (cursor < commandsSize) {
+        const VkbCommandStreamHeader* pCommand = (const VkbCommandStreamHeader*)(pCommands + cursor);
+        VkbCommandStreamCopyProc onCopy;
+        size_t argsSize;
+
+        if (commandsSize - cursor < sizeof(VkbCommandStreamHeader) || onGetCommandInfo(pCommand->opcode, &argsSize, &onCopy) != VK_SUCCESS || pCommand->size < argsSize || pCommand->size > commandsSize - cursor) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+
+        commandCount += 1;
+        cursor = vkbCaptureGetNextCommand(cursor, pCommand);
+    }
+
+    if (commandCount != pHeader->commandCount) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    for (iWord = 0; iWord < commandsSize / sizeof(uintptr_t); iWord += 1) {
+        if ((pBitmap[iWord / 8] & (1 << (iWord % 8))) != 0 && pWords[iWord] >= commandsSize) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
+    for (iWord = 0; iWord < commandsSize / sizeof(uintptr_t); iWord += 1) {
+        if ((pBitmap[iWord / 8] & (1 << (iWord % 8))) != 0) {
+            pWords[iWord] += (uintptr_t)pCommands;
+        }
+    }
+
+    /* The pointers are now absolute so loading the same buffer again would be wrong. */
+    pHeader->magic = 0;
+
+    vkbCommandStreamInit(pStream, pCommands, commandsSize);
+    pStream->arena.cursor = commandsSize;
+    pStream->commandCount = commandCount;
+
+    return VK_SUCCESS;
+}
+
+VkResult vkbCommandStreamSave(const VkbCommandStream* pStream, void* pData, size_t* pDataSize)
+{
+    return vkbCaptureSaveStream(pStream, vkbCaptureGetCommandInfo, VKB_CAPTURE_MAGIC, VKB_COMMAND_STREAM_OPCODE_COUNT, pData, pDataSize);
+}
+
+VkResult vkbCommandStreamLoad(VkbCommandStream* pStream, void* pData, size_t dataSize)
+{
+    return vkbCaptureLoadStream(pStream, vkbCaptureGetCommandInfo, VKB_CAPTURE_MAGIC, VKB_COMMAND_STREAM_OPCODE_COUNT, pData, dataSize);
+}
+
+VkResult vkbCommandStreamRemapHandles(VkbCommandStream* pStream, VkbRemapHandleProc onRemap, void* pUserData)
+{
+    VkbCaptureRemap remap;
+    size_t cursor;
+
+    if (pStream == NULL || onRemap == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    remap.onRemap   = onRemap;
+    remap.pUserData = pUserData;
+
+    cursor = 0;
+    while (cursor < pStream->arena.cursor) {
+        VkbCommandStreamHeader* pHeader = (VkbCommandStreamHeader*)((unsigned char*)pStream->arena.pData + cursor);
+        vkbCaptureRemapCommand(&remap, pHeader);
+        cursor = vkbCaptureGetNextCommand(cursor, pHeader);
+    }
+
+    return VK_SUCCESS;
+}
+
+/*
+The size of the chunks calls are recorded into. Each thread that makes calls has one of its own. A call that doesn't fit into a
+chunk of this size gets a bigger chunk to itself.
+*/
+#ifndef VKB_CAPTURE_CHUNK_SIZE
+#define VKB_CAPTURE_CHUNK_SIZE          (1024 * 1024)
+#endif
+
+/* The number of full chunks that can be waiting to be written before recording waits for the writer to catch up. */
+#ifndef VKB_CAPTURE_MAX_PENDING_CHUNKS
+#define VKB_CAPTURE_MAX_PENDING_CHUNKS  16
+#endif
+
+/* The granularity at which changes to mapped memory are found. */
+#ifndef VKB_CAPTURE_MEMORY_BLOCK_SIZE
+#define VKB_CAPTURE_MEMORY_BLOCK_SIZE   256
+#endif
+
+/* The opcode of a change to mapped memory. The opcodes of the calls come after it. */
+#define VKB_CAPTURE_OPCODE_MEMORY       1
+
+#ifdef _WIN32
+typedef HANDLE VkbThread;
+typedef CONDITION_VARIABLE VkbCond;
+typedef DWORD VkbThreadKey;
+#define vkbCondInit(pCond)                  InitializeConditionVariable(pCond)
+#define vkbCondUninit(pCond)                ((void)(pCond))
+#define vkbCondWait(pCond, pMutex)          SleepConditionVariableCS(pCond, pMutex, INFINITE)
+#define vkbCondBroadcast(pCond)             WakeAllConditionVariable(pCond)
+#define vkbThreadKeyGet(key)                TlsGetValue(key)
+#define vkbThreadKeySet(key, pValue)        TlsSetValue(key, pValue)
+#else
+typedef pthread_t VkbThread;
+typedef pthread_cond_t VkbCond;
+typedef pthread_key_t VkbThreadKey;
+#define vkbCondInit(pCond)                  pthread_cond_init(pCond, NULL)
+#define vkbCondUninit(pCond)                pthread_cond_destroy(pCond)
+#define vkbCondWait(pCond, pMutex)          pthread_cond_wait(pCond, pMutex)
+#define vkbCondBroadcast(pCond)             pthread_cond_broadcast(pCond)
+#define vkbThreadKeyGet(key)                pthread_getspecific(key)
+#define vkbThreadKeySet(key, pValue)        pthread_setspecific(key, pValue)
+#endif
+
+/* Every recorded call starts with this. */
+typedef struct
+{
+    VkbCommandStreamHeader stream;
+    uint64_t sequence;          /* The order of the call across every thread. See vkbCaptureReserveSequence(). */
+} VkbCaptureCallHeader;
+
+typedef struct
+{
+    VkbCaptureCallHeader header;
+    VkDeviceMemory memory;
+    VkDeviceSize offset;        /* From the start of the allocation. */
+    VkDeviceSize size;
+    const void* pData;
+} VkbCaptureMemoryUpdate;
+
+static void vkbCaptureCopyMemoryUpdate(VkbDeepCopyArena* pArena, const VkbCommandStreamHeader* pArgs, VkbCommandStreamHeader* pCommand)
+{
+    const VkbCaptureMemoryUpdate* pSrc = (const VkbCaptureMemoryUpdate*)pArgs;
+    VkbCaptureMemoryUpdate* pDst = (VkbCaptureMemoryUpdate*)pCommand;
+    void* pCopy = vkbDeepCopyBytes(pArena, pSrc->pData, (size_t)pSrc->size);
+
+    if (pDst != NULL) {
+        pDst->pData = pCopy;
+    }
+}
+
+typedef struct VkbCaptureChunk
+{
+    struct VkbCaptureChunk* pNext;
+    size_t capacity;
+    VkbCommandStream stream;    /* Over the memory that follows the chunk. */
+} VkbCaptureChunk;
+
+typedef struct VkbCaptureThread
+{
+    struct VkbCaptureThread* pNext;
+    VkbCaptureChunk* pChunk;    /* Only used by the thread itself until the capture ends. */
+} VkbCaptureThread;
+
+typedef struct
+{
+    VkDeviceMemory memory;
+    VkDeviceSize allocationSize;    /* 0 if it was allocated before the capture began. */
+    VkDeviceSize offset;            /* The start of the mapped range. */
+    size_t size;
+    unsigned char* pMapped;         /* NULL when it's not mapped. */
+    unsigned char* pShadow;         /* What the mapped range held when it was last compared. */
+} VkbCaptureMemory;
+
+typedef struct
+{
+    volatile uint64_t isActive;
+    volatile uint64_t sequence;
+    volatile uint64_t callCount;
+    volatile uint64_t memoryUpdateCount;
+    volatile uint64_t droppedCount;
+    volatile uint64_t chunkCount;
+    volatile uint64_t byteCount;
+    VkbCaptureWriteProc onWrite;
+    void* pUserData;
+    VkbThreadKey threadKey;
+    VkbThread writer;
+    VkResult writeResult;           /* Only used by the writer until it has finished. */
+    void* pWriteBuffer;
+    size_t writeBufferSize;
+    VkbMutex lock;                  /* For the chunks and threads below. */
+    VkbCond pendingCond;            /* Signalled when a chunk is queued and when the capture ends. */
+    VkbCond writtenCond;            /* Signalled when a chunk has been written. */
+    VkbCaptureChunk* pFirstPending;
+    VkbCaptureChunk* pLastPending;
+    uint32_t pendingCount;
+    VkbCaptureChunk* pFreeChunks;
+    VkbCaptureThread* pThreads;
+    VkBool32 isEnding;
+    VkbMutex memoryLock;            /* For the memory below. */
+    VkbCaptureMemory* pMemory;
+    size_t memoryCount;
+    size_t memoryCapacity;
+} VkbCaptureState;
+
+static VkbCaptureState g_vkbCapture;
+static VkbAPI g_vkbCaptureNext;     /* The functions the captured functions call into. */
+
+static VkbCaptureChunk* vkbCaptureAllocChunk(size_t capacity)
+{
+    size_t headerSize = (sizeof(VkbCaptureChunk) + (VKB_ARENA_ALIGNMENT - 1)) & ~(size_t)(VKB_ARENA_ALIGNMENT - 1);
+    VkbCaptureChunk* pChunk;
+
+    pChunk = (VkbCaptureChunk*)VKBIND_MALLOC(headerSize + capacity);
+    if (pChunk == NULL) {
+        return NULL;
+    }
+
+    pChunk->pNext    = NULL;
+    pChunk->capacity = capacity;
+    vkbCommandStreamInit(&pChunk->stream, (unsigned char*)pChunk + headerSize, capacity);
+
+    return pChunk;
+}
+
+/* Hands a chunk over to the writer. The lock must be held. */
+static void vkbCaptureQueueChunk(VkbCaptureChunk* pChunk)
+{
+    pChunk->pNext = NULL;
+    if (g_vkbCapture.pLastPending != NULL) {
+        g_vkbCapture.pLastPending->pNext = pChunk;
+    } else {
+        g_vkbCapture.pFirstPending = pChunk;
+    }
+    g_vkbCapture.pLastPending  = pChunk;
+    g_vkbCapture.pendingCount += 1;
+
+    vkbCondBroadcast(&g_vkbCapture.pendingCond);
+}
+
+/* Queues the chunk a thread has filled, if it has one, and returns a chunk with room for at least commandSize bytes. */
+static VkbCaptureChunk* vkbCaptureSwapChunk(VkbCaptureChunk* pFullChunk, size_t commandSize)
+{
+    VkbCaptureChunk* pChunk = NULL;
+    VkbCaptureChunk** ppFreeChunk;
+
+    vkbMutexLock(&g_vkbCapture.lock);
+    {
+        if (pFullChunk != NULL) {
+            /* The writer empties the queue even when writing fails so this doesn't wait forever. */
+            while (g_vkbCapture.pendingCount >= VKB_CAPTURE_MAX_PENDING_CHUNKS) {
+                vkbCondWait(&g_vkbCapture.writtenCond, &g_vkbCapture.lock);
+            }
+            vkbCaptureQueueChunk(pFullChunk);
+        }
+
+        for (ppFreeChunk = &g_vkbCapture.pFreeChunks; *ppFreeChunk != NULL; ppFreeChunk = &(*ppFreeChunk)->pNext) {
+            if ((*ppFreeChunk)->capacity >= commandSize) {
+                pChunk = *ppFreeChunk;
+                *ppFreeChunk = pChunk->pNext;
+                break;
+            }
+        }
+    }
+    vkbMutexUnlock(&g_vkbCapture.lock);
+
+    if (pChunk == NULL) {
+        pChunk = vkbCaptureAllocChunk((commandSize > VKB_CAPTURE_CHUNK_SIZE) ? commandSize : VKB_CAPTURE_CHUNK_SIZE);
+    }
+
+    return pChunk;
+}
+
+static VkbCaptureThread* vkbCaptureGetThread(void)
+{
+    VkbCaptureThread* pThread = (VkbCaptureThread*)vkbThreadKeyGet(g_vkbCapture.threadKey);
+    if (pThread != NULL) {
+        return pThread;
+    }
+
+    pThread = (VkbCaptureThread*)VKBIND_MALLOC(sizeof(*pThread));
+    if (pThread == NULL) {
+        return NULL;
+    }
+
+    pThread->pChunk = NULL;
+
+    /* The list is for finding the chunk of every thread when the capture ends. */
+    vkbMutexLock(&g_vkbCapture.lock);
+    {
+        pThread->pNext = g_vkbCapture.pThreads;
+        g_vkbCapture.pThreads = pThread;
+    }
+    vkbMutexUnlock(&g_vkbCapture.lock);
+
+    vkbThreadKeySet(g_vkbCapture.threadKey, pThread);
+
+    return pThread;
+}
+
+/*
+Calls are numbered when they're recorded, which is after they return, so a handle is always returned before it's used. Calls that
+destroy, free or release objects take their number with this before they're made instead. Once the driver has released a handle it
+can return it again from a call on another thread, and that call has to come after the one that released it when replayed.
+*/
+static uint64_t vkbCaptureReserveSequence(void)
+{
+    return vkbAtomicIncrement64(&g_vkbCapture.sequence);
+}
+
+/*
+Records a call, or a change to mapped memory, into the chunk of the calling thread. pArgs is the structure holding the arguments of
+the call and onCopy copies what they point to.
+*/
+static void vkbCaptureRecord(VkbCaptureCallHeader* pArgs, size_t argsSize, VkbCommandStreamCopyProc onCopy)
+{
+    VkbCaptureThread* pThread;
+    size_t commandSize;
+
+    /* Calls made through a copy of the captured function pointers after the capture has ended aren't recorded. */
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return;
+    }
+
+    pThread = vkbCaptureGetThread();
+    if (pThread == NULL) {
+        vkbAtomicIncrement64(&g_vkbCapture.droppedCount);
+        return;
+    }
+
+    if (pArgs->sequence == 0) {
+        pArgs->sequence = vkbAtomicIncrement64(&g_vkbCapture.sequence);
+    }
+    commandSize = vkbCommandStreamMeasure(&pArgs->stream, argsSize, onCopy);
+
+    if (pThread->pChunk == NULL || vkbCommandStreamPushMeasured(&pThread->pChunk->stream, &pArgs->stream, argsSize, onCopy, commandSize) != VK_SUCCESS) {
+        pThread->pChunk = vkbCaptureSwapChunk(pThread->pChunk, commandSize);
+        if (pThread->pChunk == NULL || vkbCommandStreamPushMeasured(&pThread->pChunk->stream, &pArgs->stream, argsSize, onCopy, commandSize) != VK_SUCCESS) {
+            vkbAtomicIncrement64(&g_vkbCapture.droppedCount);
+            return;
+        }
+    }
+
+    if (pArgs->stream.opcode == VKB_CAPTURE_OPCODE_MEMORY) {
+        vkbAtomicIncrement64(&g_vkbCapture.memoryUpdateCount);
+    } else {
+        vkbAtomicIncrement64(&g_vkbCapture.callCount);
+    }
+}
+
+/* The memory lock must be held for everything below that works with VkbCaptureMemory. */
+static VkbCaptureMemory* vkbCaptureFindMemory(VkDeviceMemory memory)
+{
+    size_t iMemory;
+
+    for (iMemory = 0; iMemory < g_vkbCapture.memoryCount; iMemory += 1) {
+        if (g_vkbCapture.pMemory[iMemory].memory == memory) {
+            return &g_vkbCapture.pMemory[iMemory];
+        }
+    }
+
+    return NULL;
+}
+
+static VkbCaptureMemory* vkbCaptureTrackMemory(VkDeviceMemory memory, VkDeviceSize allocationSize)
+{
+    VkbCaptureMemory* pMemory = vkbCaptureFindMemory(memory);
+
+    if (pMemory == NULL) {
+        if (g_vkbCapture.memoryCount == g_vkbCapture.memoryCapacity) {
+            size_t newCapacity = (g_vkbCapture.memoryCapacity == 0) ? 64 : g_vkbCapture.memoryCapacity * 2;
+            VkbCaptureMemory* pNewMemory = (VkbCaptureMemory*)VKBIND_MALLOC(sizeof(*pNewMemory) * newCapacity);
+            if (pNewMemory == NULL) {
+                return NULL;
+            }
+
+            if (g_vkbCapture.memoryCount > 0) {
+                memcpy(pNewMemory, g_vkbCapture.pMemory, sizeof(*pNewMemory) * g_vkbCapture.memoryCount);
+            }
+            VKBIND_FREE(g_vkbCapture.pMemory);
+
+            g_vkbCapture.pMemory        = pNewMemory;
+            g_vkbCapture.memoryCapacity = newCapacity;
+        }
+
+        pMemory = &g_vkbCapture.pMemory[g_vkbCapture.memoryCount];
+        g_vkbCapture.memoryCount += 1;
+
+        memset(pMemory, 0, sizeof(*pMemory));
+        pMemory->memory = memory;
+    }
+
+    if (allocationSize != 0) {
+        pMemory->allocationSize = allocationSize;
+    }
+
+    return pMemory;
+}
+
+static void vkbCaptureUntrackMemory(VkbCaptureMemory* pMemory)
+{
+    VKBIND_FREE(pMemory->pShadow);
+
+    g_vkbCapture.memoryCount -= 1;
+    *pMemory = g_vkbCapture.pMemory[g_vkbCapture.memoryCount];
+}
+
+static void vkbCaptureRecordMemory(const VkbCaptureMemory* pMemory, size_t offset, size_t size)
+{
+    VkbCaptureMemoryUpdate args;
+
+    memset(&args, 0, sizeof(args));
+    args.header.stream.opcode = VKB_CAPTURE_OPCODE_MEMORY;
+    args.memory = pMemory->memory;
+    args.offset = pMemory->offset + offset;
+    args.size   = size;
+    args.pData  = pMemory->pShadow + offset;    /* Unlike the mapped memory, this can't change while it's being copied. */
+
+    vkbCaptureRecord(&args.header, sizeof(args), vkbCaptureCopyMemoryUpdate);
+}
+
+/* Records the blocks of a mapped range that changed since it was last compared, merging neighbouring blocks. */
+static void vkbCaptureDiffMemory(VkbCaptureMemory* pMemory)
+{
+    size_t offset;
+    size_t blockSize;
+    size_t runOffset = 0;
+    size_t runSize = 0;
+
+    for (offset = 0; offset < pMemory->size; offset += blockSize) {
+        blockSize = pMemory->size - offset;
+        if (blockSize > VKB_CAPTURE_MEMORY_BLOCK_SIZE) {
+            blockSize = VKB_CAPTURE_MEMORY_BLOCK_SIZE;
+        }
+
+        if (memcmp(pMemory->pMapped + offset, pMemory->pShadow + offset, blockSize) != 0) {
+            memcpy(pMemory->pShadow + offset, pMemory->pMapped + offset, blockSize);
+            if (runSize == 0) {
+                runOffset = offset;
+            }
+            runSize += blockSize;
+
+            /* Big changes are split up so no single record is much bigger than a chunk. */
+            if (runSize < VKB_CAPTURE_CHUNK_SIZE) {
+                continue;
+            }
+        }
+
+        if (runSize > 0) {
+            vkbCaptureRecordMemory(pMemory, runOffset, runSize);
+            runSize = 0;
+        }
+    }
+
+    if (runSize > 0) {
+        vkbCaptureRecordMemory(pMemory, runOffset, runSize);
+    }
+}
+
+static void vkbCaptureAllocated(VkDeviceMemory memory, VkDeviceSize allocationSize)
+{
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return;
+    }
+
+    vkbMutexLock(&g_vkbCapture.memoryLock);
+    {
+        vkbCaptureTrackMemory(memory, allocationSize);
+    }
+    vkbMutexUnlock(&g_vkbCapture.memoryLock);
+}
+
+static void vkbCaptureFreed(VkDeviceMemory memory)
+{
+    VkbCaptureMemory* pMemory;
+
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return;
+    }
+
+    /* Freeing memory unmaps it, but whatever was written since the last submit can't be used anymore so it's not recorded. */
+    vkbMutexLock(&g_vkbCapture.memoryLock);
+    {
+        pMemory = vkbCaptureFindMemory(memory);
+        if (pMemory != NULL) {
+            vkbCaptureUntrackMemory(pMemory);
+        }
+    }
+    vkbMutexUnlock(&g_vkbCapture.memoryLock);
+}
+
+static void vkbCaptureMapped(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void* pMapped)
+{
+    VkbCaptureMemory* pMemory;
+
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0 || pMapped == NULL) {
+        return;
+    }
+
+    vkbMutexLock(&g_vkbCapture.memoryLock);
+    {
+        pMemory = vkbCaptureTrackMemory(memory, 0);
+        if (pMemory != NULL) {
+            if (size == VK_WHOLE_SIZE) {
+                size = (pMemory->allocationSize > offset) ? pMemory->allocationSize - offset : 0;
+            }
+
+            VKBIND_FREE(pMemory->pShadow);
+            pMemory->pShadow = NULL;
+            pMemory->pMapped = NULL;
+
+            /* What's in the memory now was either recorded when it was written or written by the device, so only the changes count. */
+            if (size > 0 && size == (size_t)size) {
+                pMemory->pShadow = (unsigned char*)VKBIND_MALLOC((size_t)size);
+                if (pMemory->pShadow != NULL) {
+                    memcpy(pMemory->pShadow, pMapped, (size_t)size);
+                    pMemory->pMapped = (unsigned char*)pMapped;
+                    pMemory->offset  = offset;
+                    pMemory->size    = (size_t)size;
+                }
+            }
+        }
+    }
+    vkbMutexUnlock(&g_vkbCapture.memoryLock);
+}
+
+static void vkbCaptureUnmapped(VkDeviceMemory memory)
+{
+    VkbCaptureMemory* pMemory;
+
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return;
+    }
+
+    vkbMutexLock(&g_vkbCapture.memoryLock);
+    {
+        pMemory = vkbCaptureFindMemory(memory);
+        if (pMemory != NULL && pMemory->pMapped != NULL) {
+            vkbCaptureDiffMemory(pMemory);
+
+            VKBIND_FREE(pMemory->pShadow);
+            pMemory->pShadow = NULL;
+            pMemory->pMapped = NULL;
+        }
+    }
+    vkbMutexUnlock(&g_vkbCapture.memoryLock);
+}
+
+/* Called before anything that lets the device see what's in mapped memory. */
+static void vkbCaptureFlushMapped(void)
+{
+    size_t iMemory;
+
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return;
+    }
+
+    vkbMutexLock(&g_vkbCapture.memoryLock);
+    {
+        for (iMemory = 0; iMemory < g_vkbCapture.memoryCount; iMemory += 1) {
+            if (g_vkbCapture.pMemory[iMemory].pMapped != NULL) {
+                vkbCaptureDiffMemory(&g_vkbCapture.pMemory[iMemory]);
+            }
+        }
+    }
+    vkbMutexUnlock(&g_vkbCapture.memoryLock);
+}
+
+typedef struct
+{
+    VkObjectType objectType;
+    uint64_t captured;          /* 0 when the entry is empty. */
+    uint64_t replayed;
+} VkbCaptureReplayHandle;
+
+typedef struct
+{
+    VkDeviceMemory memory;      /* The replayed memory. */
+    VkDeviceSize offset;
+    unsigned char* pMapped;
+} VkbCaptureReplayMapping;
+
+typedef struct VkbCaptureReplayAllocation
+{
+    struct VkbCaptureReplayAllocation* pNext;
+    uint64_t padding;           /* Keeps what follows aligned to 8 bytes. */
+} VkbCaptureReplayAllocation;
+
+typedef struct
+{
+    VkbCaptureRemap remap;                      /* Looks handles up in the table below. */
+    VkbRemapHandleProc onRemap;                 /* For the handles that weren't returned by a replayed call. */
+    void* pUserData;
+    VkbCaptureReplayHandle* pHandles;           /* Open addressing. The capacity is a power of two. */
+    size_t handleCount;
+    size_t handleCapacity;
+    VkbCaptureReplayMapping* pMappings;
+    size_t mappingCount;
+    size_t mappingCapacity;
+    VkbCaptureReplayAllocation* pAllocations;   /* Freed after each call. */
+    VkResult result;                            /* VK_ERROR_OUT_OF_HOST_MEMORY when something couldn't be allocated. */
+} VkbCaptureReplay;
+
+#define VKB_CAPTURE_HASH_MULTIPLIER (((uint64_t)0x9E3779B9 << 32) | 0x7F4A7C15)
+
+static size_t vkbCaptureReplayFindHandle(const VkbCaptureReplayHandle* pHandles, size_t capacity, VkObjectType objectType, uint64_t captured)
+{
+    uint64_t hash = (captured ^ ((uint64_t)(uint32_t)objectType << 32)) * VKB_CAPTURE_HASH_MULTIPLIER;
+    size_t iHandle = (size_t)(hash ^ (hash >> 32)) & (capacity - 1);
+
+    while (pHandles[iHandle].captured != 0 && (pHandles[iHandle].captured != captured || pHandles[iHandle].objectType != objectType)) {
+        iHandle = (iHandle + 1) & (capacity - 1);
+    }
+
+    return iHandle;
+}
+
+/* Makes a replayed call use the handle that was returned by the replay in place of the one that was captured. */
+static void vkbCaptureReplayMapHandle(VkbCaptureReplay* pReplay, VkObjectType objectType, uint64_t captured, uint64_t replayed)
+{
+    size_t iHandle;
+
+    if (captured == 0 || replayed == 0) {
+        return;
+    }
+
+    if ((pReplay->handleCount + 1) * 2 > pReplay->handleCapacity) {
+        size_t newCapacity = (pReplay->handleCapacity == 0) ? 256 : pReplay->handleCapacity * 2;
+        VkbCaptureReplayHandle* pNewHandles = (VkbCaptureReplayHandle*)VKBIND_MALLOC(sizeof(*pNewHandles) * newCapacity);
+        if (pNewHandles == NULL) {
+            pReplay->result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            return;
+        }
+
+        memset(pNewHandles, 0, sizeof(*pNewHandles) * newCapacity);
+        for (iHandle = 0; iHandle < pReplay->handleCapacity; iHandle += 1) {
+            const VkbCaptureReplayHandle* pHandle = &pReplay->pHandles[iHandle];
+            if (pHandle->captured != 0) {
+                pNewHandles[vkbCaptureReplayFindHandle(pNewHandles, newCapacity, pHandle->objectType, pHandle->captured)] = *pHandle;
+            }
+        }
+        VKBIND_FREE(pReplay->pHandles);
+
+        pReplay->pHandles       = pNewHandles;
+        pReplay->handleCapacity = newCapacity;
+    }
+
+    /* Handles can be reused after their object is destroyed, so a handle that has been seen before gets the new one. */
+    iHandle = vkbCaptureReplayFindHandle(pReplay->pHandles, pReplay->handleCapacity, objectType, captured);
+    if (pReplay->pHandles[iHandle].captured == 0) {
+        pReplay->pHandles[iHandle].objectType = objectType;
+        pReplay->pHandles[iHandle].captured   = captured;
+        pReplay->handleCount += 1;
+    }
+    pReplay->pHandles[iHandle].replayed = replayed;
+}
+
+static uint64_t vkbCaptureReplayRemapHandle(void* pUserData, VkObjectType objectType, uint64_t handle)
+{
+    VkbCaptureReplay* pReplay = (VkbCaptureReplay*)pUserData;
+
+    if (pReplay->handleCapacity > 0) {
+        size_t iHandle = vkbCaptureReplayFindHandle(pReplay->pHandles, pReplay->handleCapacity, objectType, handle);
+        if (pReplay->pHandles[iHandle].captured != 0) {
+            return pReplay->pHandles[iHandle].replayed;
+        }
+    }
+
+    if (pReplay->onRemap != NULL) {
+        return pReplay->onRemap(pReplay->pUserData, objectType, handle);
+    }
+
+    return handle;
+}
+
+/* Copies the captured output of a call before the replayed call overwrites it. The copy is freed after the call. */
+static void* vkbCaptureReplayCopy(VkbCaptureReplay* pReplay, const void* pData, size_t size)
+{
+    VkbCaptureReplayAllocation* pAllocation;
+
+    if (size == 0) {
+        return NULL;
+    }
+
+    pAllocation = (VkbCaptureReplayAllocation*)VKBIND_MALLOC(sizeof(*pAllocation) + size);
+    if (pAllocation == NULL) {
+        pReplay->result = VK_ERROR_OUT_OF_HOST_MEMORY;
+        return NULL;
+    }
+
+    pAllocation->pNext = pReplay->pAllocations;
+    pReplay->pAllocations = pAllocation;
+
+    memcpy(pAllocation + 1, pData, size);
+    return pAllocation + 1;
+}
+
+static void vkbCaptureReplayFreeAllocations(VkbCaptureReplay* pReplay)
+{
+    while (pReplay->pAllocations != NULL) {
+        VkbCaptureReplayAllocation* pAllocation = pReplay->pAllocations;
+        pReplay->pAllocations = pAllocation->pNext;
+        VKBIND_FREE(pAllocation);
+    }
+}
+
+static void vkbCaptureReplayUnmapped(VkbCaptureReplay* pReplay, VkDeviceMemory memory)
+{
+    size_t iMapping;
+
+    for (iMapping = 0; iMapping < pReplay->mappingCount; iMapping += 1) {
+        if (pReplay->pMappings[iMapping].memory == memory) {
+            pReplay->mappingCount -= 1;
+            pReplay->pMappings[iMapping] = pReplay->pMappings[pReplay->mappingCount];
+            return;
+        }
+    }
+}
+
+static void vkbCaptureReplayMapped(VkbCaptureReplay* pReplay, VkDeviceMemory memory, VkDeviceSize offset, void* pMapped)
+{
+    if (pMapped == NULL) {
+        return;
+    }
+
+    vkbCaptureReplayUnmapped(pReplay, memory);
+
+    if (pReplay->mappingCount == pReplay->mappingCapacity) {
+        size_t newCapacity = (pReplay->mappingCapacity == 0) ? 64 : pReplay->mappingCapacity * 2;
+        VkbCaptureReplayMapping* pNewMappings = (VkbCaptureReplayMapping*)VKBIND_MALLOC(sizeof(*pNewMappings) * newCapacity);
+        if (pNewMappings == NULL) {
+            pReplay->result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            return;
+        }
+
+        if (pReplay->mappingCount > 0) {
+            memcpy(pNewMappings, pReplay->pMappings, sizeof(*pNewMappings) * pReplay->mappingCount);
+        }
+        VKBIND_FREE(pReplay->pMappings);
+
+        pReplay->pMappings       = pNewMappings;
+        pReplay->mappingCapacity = newCapacity;
+    }
+
+    pReplay->pMappings[pReplay->mappingCount].memory  = memory;
+    pReplay->pMappings[pReplay->mappingCount].offset  = offset;
+    pReplay->pMappings[pReplay->mappingCount].pMapped = (unsigned char*)pMapped;
+    pReplay->mappingCount += 1;
+}
+
+/* Changes to memory that the replay hasn't mapped, such as memory that was mapped before the capture began, are skipped. */
+static void vkbCaptureReplayMemoryUpdate(VkbCaptureReplay* pReplay, VkbCaptureMemoryUpdate* pUpdate)
+{
+    VkbCaptureRemap* pRemap = &pReplay->remap;
+    size_t iMapping;
+
+    VKB_CAPTURE_REMAP_NON_DISPATCHABLE(pRemap, VK_OBJECT_TYPE_DEVICE_MEMORY, VkDeviceMemory, pUpdate->memory);
+
+    for (iMapping = 0; iMapping < pReplay->mappingCount; iMapping += 1) {
+        const VkbCaptureReplayMapping* pMapping = &pReplay->pMappings[iMapping];
+        if (pMapping->memory == pUpdate->memory && pUpdate->offset >= pMapping->offset) {
+            memcpy(pMapping->pMapped + (size_t)(pUpdate->offset - pMapping->offset), pUpdate->pData, (size_t)pUpdate->size);
+            return;
+        }
+    }
+}
+
+/*<<capture_calls>>*/
+
+static void vkbCaptureWriteChunk(VkbCaptureChunk* pChunk)
+{
+    size_t dataSize;
+    VkResult result;
+
+    if (pChunk->stream.commandCount == 0) {
+        return;
+    }
+
+    /* Once a write has failed nothing else is written so the calls that were written are still in order. */
+    if (g_vkbCapture.writeResult != VK_SUCCESS) {
+        vkbAtomicAdd64(&g_vkbCapture.droppedCount, pChunk->stream.commandCount);
+        return;
+    }
+
+    vkbCaptureSaveStream(&pChunk->stream, vkbCaptureCallGetInfo, VKB_CAPTURE_CHUNK_MAGIC, VKB_CAPTURE_OPCODE_COUNT, NULL, &dataSize);
+    if (dataSize > g_vkbCapture.writeBufferSize) {
+        VKBIND_FREE(g_vkbCapture.pWriteBuffer);
+        g_vkbCapture.pWriteBuffer    = VKBIND_MALLOC(dataSize);
+        g_vkbCapture.writeBufferSize = (g_vkbCapture.pWriteBuffer != NULL) ? dataSize : 0;
+    }
+
+    if (g_vkbCapture.pWriteBuffer != NULL) {
+        result = vkbCaptureSaveStream(&pChunk->stream, vkbCaptureCallGetInfo, VKB_CAPTURE_CHUNK_MAGIC, VKB_CAPTURE_OPCODE_COUNT, g_vkbCapture.pWriteBuffer, &dataSize);
+    } else {
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    if (result == VK_SUCCESS) {
+        result = g_vkbCapture.onWrite(g_vkbCapture.pUserData, g_vkbCapture.pWriteBuffer, dataSize);
+    }
+
+    if (result != VK_SUCCESS) {
+        g_vkbCapture.writeResult = result;
+        vkbAtomicAdd64(&g_vkbCapture.droppedCount, pChunk->stream.commandCount);
+        return;
+    }
+
+    vkbAtomicIncrement64(&g_vkbCapture.chunkCount);
+    vkbAtomicAdd64(&g_vkbCapture.byteCount, dataSize);
+}
+
+static void vkbCaptureWriterMain(void)
+{
+    for (;;) {
+        VkbCaptureChunk* pChunk;
+
+        vkbMutexLock(&g_vkbCapture.lock);
         {
-            pAPI->vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+            while (g_vkbCapture.pFirstPending == NULL && !g_vkbCapture.isEnding) {
+                vkbCondWait(&g_vkbCapture.pendingCond, &g_vkbCapture.lock);
+            }
+
+            pChunk = g_vkbCapture.pFirstPending;
+            if (pChunk != NULL) {
+                g_vkbCapture.pFirstPending = pChunk->pNext;
+                if (g_vkbCapture.pFirstPending == NULL) {
+                    g_vkbCapture.pLastPending = NULL;
+                }
+                g_vkbCapture.pendingCount -= 1;
+            }
+        }
+        vkbMutexUnlock(&g_vkbCapture.lock);
+
+        /* The queue is only empty at this point when the capture has ended. */
+        if (pChunk == NULL) {
+            break;
+        }
+
+        vkbCaptureWriteChunk(pChunk);
+        vkbCommandStreamReset(&pChunk->stream);
+
+        /* Chunks that are bigger than usual were for a single big call so they're not kept. */
+        if (pChunk->capacity > VKB_CAPTURE_CHUNK_SIZE) {
+            VKBIND_FREE(pChunk);
+            pChunk = NULL;
+        }
+
+        vkbMutexLock(&g_vkbCapture.lock);
+        {
+            if (pChunk != NULL) {
+                pChunk->pNext = g_vkbCapture.pFreeChunks;
+                g_vkbCapture.pFreeChunks = pChunk;
+            }
+            vkbCondBroadcast(&g_vkbCapture.writtenCond);
         }
-        #endif
+        vkbMutexUnlock(&g_vkbCapture.lock);
     }
+}
 
-    if (pAPI->vkGetInstanceProcAddr == NULL) {
-        return VK_ERROR_INITIALIZATION_FAILED;  /* We don't have a vkGetInstanceProcAddr(). We need to abort. */
+#ifdef _WIN32
+static DWORD WINAPI vkbCaptureWriterThread(LPVOID pUnused)
+{
+    (void)pUnused;
+    vkbCaptureWriterMain();
+    return 0;
+}
+#else
+static void* vkbCaptureWriterThread(void* pUnused)
+{
+    (void)pUnused;
+    vkbCaptureWriterMain();
+    return NULL;
+}
+#endif
+
+/* Frees everything the capture allocated. The writer must have finished. */
+static void vkbCaptureUninit(void)
+{
+    size_t iMemory;
+
+    while (g_vkbCapture.pFreeChunks != NULL) {
+        VkbCaptureChunk* pChunk = g_vkbCapture.pFreeChunks;
+        g_vkbCapture.pFreeChunks = pChunk->pNext;
+        VKBIND_FREE(pChunk);
     }
 
-    /*<<load_instance_api>>*/
+    for (iMemory = 0; iMemory < g_vkbCapture.memoryCount; iMemory += 1) {
+        VKBIND_FREE(g_vkbCapture.pMemory[iMemory].pShadow);
+    }
+    VKBIND_FREE(g_vkbCapture.pMemory);
+    g_vkbCapture.pMemory        = NULL;
+    g_vkbCapture.memoryCount    = 0;
+    g_vkbCapture.memoryCapacity = 0;
 
-    return VK_SUCCESS;
+    VKBIND_FREE(g_vkbCapture.pWriteBuffer);
+    g_vkbCapture.pWriteBuffer    = NULL;
+    g_vkbCapture.writeBufferSize = 0;
+
+    vkbCondUninit(&g_vkbCapture.writtenCond);
+    vkbCondUninit(&g_vkbCapture.pendingCond);
+    vkbMutexUninit(&g_vkbCapture.memoryLock);
+    vkbMutexUninit(&g_vkbCapture.lock);
+
+#ifdef _WIN32
+    TlsFree(g_vkbCapture.threadKey);
+#else
+    pthread_key_delete(g_vkbCapture.threadKey);
+#endif
 }
 
-VkResult vkbInitDeviceAPI(VkDevice device, VkbAPI* pAPI)
+VkResult vkbBeginCapture(VkbAPI* pAPI, VkbCaptureWriteProc onWrite, void* pUserData)
 {
-    if (g_vkbInitCount == 0) {
-        return VK_ERROR_INITIALIZATION_FAILED;  /* vkbind not initialized. */
+    VkBool32 isWriterRunning;
+
+    if (onWrite == NULL || vkbAtomicLoad64(&g_vkbCapture.isActive) != 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
 
+#if defined(VKBIND_NO_GLOBAL_API)
     if (pAPI == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+    }
+#endif
+
+    memset(&g_vkbCapture, 0, sizeof(g_vkbCapture));
+    g_vkbCapture.onWrite     = onWrite;
+    g_vkbCapture.pUserData   = pUserData;
+    g_vkbCapture.writeResult = VK_SUCCESS;
+
+    /* A new key every time means threads that recorded into a previous capture start again with nothing. */
+#ifdef _WIN32
+    g_vkbCapture.threadKey = TlsAlloc();
+    if (g_vkbCapture.threadKey == TLS_OUT_OF_INDEXES) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+#else
+    if (pthread_key_create(&g_vkbCapture.threadKey, NULL) != 0) {
         return VK_ERROR_INITIALIZATION_FAILED;
     }
+#endif
 
-    /* We need to handle vkGetDeviceProcAddr() in a special way to ensure it's using the device-specific version instead of the per-instance version. */
-    if (pAPI->vkGetDeviceProcAddr == NULL) {
-        #if !defined(VKBIND_NO_GLOBAL_API)
-        {
-            pAPI->vkGetDeviceProcAddr = vkGetDeviceProcAddr;
-        }
-        #endif
+    vkbMutexInit(&g_vkbCapture.lock);
+    vkbMutexInit(&g_vkbCapture.memoryLock);
+    vkbCondInit(&g_vkbCapture.pendingCond);
+    vkbCondInit(&g_vkbCapture.writtenCond);
+
+#ifdef _WIN32
+    g_vkbCapture.writer = CreateThread(NULL, 0, vkbCaptureWriterThread, NULL, 0, NULL);
+    isWriterRunning = (g_vkbCapture.writer != NULL) ? VK_TRUE : VK_FALSE;
+#else
+    isWriterRunning = (pthread_create(&g_vkbCapture.writer, NULL, vkbCaptureWriterThread, NULL) == 0) ? VK_TRUE : VK_FALSE;
+#endif
+    if (!isWriterRunning) {
+        vkbCaptureUninit();
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    if (pAPI->vkGetDeviceProcAddr == NULL) {
-        return VK_ERROR_INITIALIZATION_FAILED;  /* Don't have access to vkGetDeviceProcAddr(). Make sure vkbInitInstanceAPI() is called first on pAPI. */
+    vkbAtomicStore64(&g_vkbCapture.isActive, 1);
+
+#if !defined(VKBIND_NO_GLOBAL_API)
+    if (pAPI == NULL) {
+        VkbAPI globalAPI;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        vkbCaptureInstallAPI(&globalAPI);
+        return vkbBindAPI(&globalAPI);
     }
+#endif
 
-    pAPI->vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr)pAPI->vkGetDeviceProcAddr(device, "vkGetDeviceProcAddr");
-    /*<<load_device_api>>*/
+    vkbCaptureInstallAPI(pAPI);
 
     return VK_SUCCESS;
 }
 
-VkResult vkbBindAPI(const VkbAPI* pAPI)
+VkResult vkbEndCapture(VkbAPI* pAPI)
 {
+    VkbCaptureThread* pThread;
+
+    if (vkbAtomicLoad64(&g_vkbCapture.isActive) == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
     if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        VkbAPI globalAPI;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        vkbCaptureUninstallAPI(&globalAPI);
+        vkbBindAPI(&globalAPI);
+    #endif
+    } else {
+        vkbCaptureUninstallAPI(pAPI);
+    }
+
+    vkbAtomicStore64(&g_vkbCapture.isActive, 0);
+
+    /* Nothing is being recorded anymore so the chunks of every thread can be queued from here. */
+    vkbMutexLock(&g_vkbCapture.lock);
+    {
+        while (g_vkbCapture.pThreads != NULL) {
+            pThread = g_vkbCapture.pThreads;
+            g_vkbCapture.pThreads = pThread->pNext;
+
+            if (pThread->pChunk != NULL) {
+                vkbCaptureQueueChunk(pThread->pChunk);
+            }
+            VKBIND_FREE(pThread);
+        }
+
+        g_vkbCapture.isEnding = VK_TRUE;
+        vkbCondBroadcast(&g_vkbCapture.pendingCond);
+    }
+    vkbMutexUnlock(&g_vkbCapture.lock);
+
+#ifdef _WIN32
+    WaitForSingleObject(g_vkbCapture.writer, INFINITE);
+    CloseHandle(g_vkbCapture.writer);
+#else
+    pthread_join(g_vkbCapture.writer, NULL);
+#endif
+
+    vkbCaptureUninit();
+
+    return g_vkbCapture.writeResult;
+}
+
+void vkbGetCaptureStats(VkbCaptureStats* pStats)
+{
+    if (pStats == NULL) {
+        return;
+    }
+
+    pStats->callCount         = vkbAtomicLoad64(&g_vkbCapture.callCount);
+    pStats->memoryUpdateCount = vkbAtomicLoad64(&g_vkbCapture.memoryUpdateCount);
+    pStats->droppedCount      = vkbAtomicLoad64(&g_vkbCapture.droppedCount);
+    pStats->chunkCount        = vkbAtomicLoad64(&g_vkbCapture.chunkCount);
+    pStats->byteCount         = vkbAtomicLoad64(&g_vkbCapture.byteCount);
+}
+
+static int vkbCaptureCompareCalls(const void* pA, const void* pB)
+{
+    uint64_t sequenceA = (*(VkbCaptureCallHeader* const*)pA)->sequence;
+    uint64_t sequenceB = (*(VkbCaptureCallHeader* const*)pB)->sequence;
+
+    if (sequenceA != sequenceB) {
+        return (sequenceA < sequenceB) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+VkResult vkbReplayCapture(void* pData, size_t dataSize, VkbAPI* pAPI, VkbRemapHandleProc onRemap, void* pUserData)
+{
+#if !defined(VKBIND_NO_GLOBAL_API)
+    VkbAPI globalAPI;
+#endif
+    VkbCaptureReplay replay;
+    VkbCaptureCallHeader** ppCalls;
+    size_t callCount;
+    size_t iCall;
+    size_t cursor;
+    VkResult result;
+
+    if (pData == NULL || ((uintptr_t)pData & (VKB_ARENA_ALIGNMENT - 1)) != 0) {
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-#if defined(VKBIND_NO_GLOBAL_API)
-    return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled. */
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        vkbInitFromGlobalAPI(&globalAPI);
+        pAPI = &globalAPI;
+    #else
+        return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+    #endif
+    }
+
+    /* Loading a chunk checks it and turns the offsets in it back into pointers. */
+    callCount = 0;
+    cursor = 0;
+    while (cursor < dataSize) {
+        VkbCommandStream chunk;
+
+        result = vkbCaptureLoadStream(&chunk, vkbCaptureCallGetInfo, VKB_CAPTURE_CHUNK_MAGIC, VKB_CAPTURE_OPCODE_COUNT, (unsigned char*)pData + cursor, dataSize - cursor);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        callCount += chunk.commandCount;
+        cursor += vkbCaptureGetSavedSize(chunk.arena.cursor);
+    }
+
+    if (callCount == 0) {
+        return VK_SUCCESS;
+    }
+
+    ppCalls = (VkbCaptureCallHeader**)VKBIND_MALLOC(sizeof(*ppCalls) * callCount);
+    if (ppCalls == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    /* Each thread recorded into its own chunks so the calls are put back into the order they returned in. */
+    iCall = 0;
+    cursor = 0;
+    while (cursor < dataSize) {
+        const VkbCaptureHeader* pHeader = (const VkbCaptureHeader*)((unsigned char*)pData + cursor);
+        unsigned char* pCommands = (unsigned char*)pData + cursor + sizeof(VkbCaptureHeader);
+        size_t commandsSize = (size_t)pHeader->dataSize;
+        size_t commandCursor = 0;
+
+        while (commandCursor < commandsSize && iCall < callCount) {
+            VkbCaptureCallHeader* pCall = (VkbCaptureCallHeader*)(pCommands + commandCursor);
+            ppCalls[iCall] = pCall;
+            iCall += 1;
+            commandCursor = vkbCaptureGetNextCommand(commandCursor, &pCall->stream);
+        }
+
+        cursor += vkbCaptureGetSavedSize(commandsSize);
+    }
+
+    qsort(ppCalls, callCount, sizeof(*ppCalls), vkbCaptureCompareCalls);
+
+    memset(&replay, 0, sizeof(replay));
+    replay.remap.onRemap   = vkbCaptureReplayRemapHandle;
+    replay.remap.pUserData = &replay;
+    replay.onRemap         = onRemap;
+    replay.pUserData       = pUserData;
+    replay.result          = VK_SUCCESS;
+
+    result = VK_SUCCESS;
+    for (iCall = 0; iCall < callCount; iCall += 1) {
+        if (ppCalls[iCall]->stream.opcode == VKB_CAPTURE_OPCODE_MEMORY) {
+            vkbCaptureReplayMemoryUpdate(&replay, (VkbCaptureMemoryUpdate*)ppCalls[iCall]);
+        } else {
+            result = vkbCaptureReplayCall(&replay, pAPI, ppCalls[iCall]);
+        }
+
+        vkbCaptureReplayFreeAllocations(&replay);
+        if (result == VK_SUCCESS) {
+            result = replay.result;
+        }
+        if (result != VK_SUCCESS) {
+            break;
+        }
+    }
+
+    VKBIND_FREE(replay.pHandles);
+    VKBIND_FREE(replay.pMappings);
+    VKBIND_FREE(ppCalls);
+
+    return result;
+}
+#endif  /* VKBIND_CAPTURE */
+
+#ifdef VKBIND_EXTERNSYNC_CHECK
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <string.h>
+
+/*
+The number of objects that can be claimed at the same time. Must be a power of two. Slots are freed when their object is released
+so this only needs to cover the calls that are in flight.
+*/
+#ifndef VKB_EXTERNSYNC_SLOT_COUNT
+#define VKB_EXTERNSYNC_SLOT_COUNT   4096
+#endif
+
+/* The number of slots starting from the one an object hashes to that it can go in. Every claim looks at all of them. */
+#ifndef VKB_EXTERNSYNC_PROBE_COUNT
+#define VKB_EXTERNSYNC_PROBE_COUNT  32
+#endif
+
+#define VKB_EXTERNSYNC_MIX1 (((uint64_t)0xBF58476D << 32) | 0x1CE4E5B9)
+#define VKB_EXTERNSYNC_MIX2 (((uint64_t)0x94D049BB << 32) | 0x133111EB)
+
+#if defined(_WIN32)
+#define VKB_EXTERNSYNC_THREAD_ID()  ((uint64_t)GetCurrentThreadId())
 #else
-    /*<<set_global_api_from_struct>>*/
+#define VKB_EXTERNSYNC_THREAD_ID()  ((uint64_t)(uintptr_t)pthread_self())
+#endif
 
-    return VK_SUCCESS;
+#if defined(_MSC_VER)
+#define VKB_EXTERNSYNC_CALL_SITE()  _ReturnAddress()
+#elif defined(__GNUC__)
+#define VKB_EXTERNSYNC_CALL_SITE()  __builtin_return_address(0)
+#else
+#define VKB_EXTERNSYNC_CALL_SITE()  NULL
 #endif
+
+typedef struct
+{
+    const char* pCommandName;
+    const char* pParameterName;
+} VkbExternSyncSite;
+
+/*
+The table is read and written by every thread so everything in it goes through the atomics. A slot is taken by setting its owner
+to the ID of the claiming call and given back by setting it to 0. Only the owner writes to the rest of the slot. Objects that hash
+to different slots can compete for the same free slot, which the owner being taken with a compare and exchange settles. Claims of
+the same object always hash to the same slot and take its lock while they look for each other and publish their slot, which is
+what makes two calls claiming the same object at the same time see each other.
+*/
+typedef struct
+{
+    volatile uint64_t lock;         /* Held while claiming an object that hashes to this slot. Releasing doesn't need it. */
+    volatile uint64_t owner;        /* The ID of the call that has claimed the object, or 0 if the slot is free. */
+    volatile uint64_t handle;       /* Set last when claiming and cleared first when releasing. */
+    volatile uint64_t objectType;
+    volatile uint64_t site;         /* A pointer to a VkbExternSyncSite. */
+    volatile uint64_t threadId;
+    volatile uint64_t pCallSite;
+} VkbExternSyncSlot;
+
+/* The functions the checks of an install call into and where they report conflicts. */
+typedef struct
+{
+    VkBool32 isUsed;
+    VkbAPI next;
+    VkbExternSyncConflictProc onConflict;
+    void* pUserData;
+} VkbExternSyncInstall;
+
+typedef struct
+{
+    uint64_t id;
+    uint64_t threadId;
+    const void* pCallSite;
+    const VkbExternSyncInstall* pInstall;
+} VkbExternSyncCallState;
+
+static VkbExternSyncSlot g_vkbExternSyncSlots[VKB_EXTERNSYNC_SLOT_COUNT];
+static volatile uint64_t g_vkbExternSyncCallCounter;
+static volatile uint64_t g_vkbExternSyncConflictCount;
+static volatile uint64_t g_vkbExternSyncUncheckedCount;
+
+static void vkbExternSyncBeginCall(VkbExternSyncCallState* pCall, const VkbExternSyncInstall* pInstall, const void* pCallSite)
+{
+    pCall->id        = vkbAtomicIncrement64(&g_vkbExternSyncCallCounter);
+    pCall->threadId  = VKB_EXTERNSYNC_THREAD_ID();
+    pCall->pCallSite = pCallSite;
+    pCall->pInstall  = pInstall;
+}
+
+static uint32_t vkbExternSyncHash(VkObjectType objectType, uint64_t handle)
+{
+    uint64_t h = handle + (uint64_t)(uint32_t)objectType * VKB_EXTERNSYNC_MIX2;
+    h ^= h >> 30;
+    h *= VKB_EXTERNSYNC_MIX1;
+    h ^= h >> 27;
+    h *= VKB_EXTERNSYNC_MIX2;
+    h ^= h >> 31;
+    return (uint32_t)h & (VKB_EXTERNSYNC_SLOT_COUNT - 1);
+}
+
+/*
+Claims an object for a call, or reports a conflict if another call has claimed it. This looks at each slot the object can go in
+once, taking the first free one along the way and giving it back if the object turns out to be claimed already.
+*/
+static void vkbExternSyncClaim(const VkbExternSyncCallState* pCall, const VkbExternSyncSite* pSite, VkObjectType objectType, uint64_t handle)
+{
+    VkbExternSyncConflict conflict;
+    VkbExternSyncSlot* pHomeSlot;
+    VkbExternSyncSlot* pClaimedSlot = NULL;
+    VkBool32 isConflict = VK_FALSE;
+    uint32_t iSlot;
+    uint32_t iProbe;
+
+    if (handle == 0) {
+        return;
+    }
+
+    memset(&conflict, 0, sizeof(conflict));
+
+    iSlot     = vkbExternSyncHash(objectType, handle);
+    pHomeSlot = &g_vkbExternSyncSlots[iSlot];
+
+    while (!vkbAtomicCompareExchange64(&pHomeSlot->lock, 0, 1)) {
+        /* Only held for as long as it takes to look through the slots. */
+    }
+
+    for (iProbe = 0; iProbe < VKB_EXTERNSYNC_PROBE_COUNT; iProbe += 1) {
+        VkbExternSyncSlot* pSlot = &g_vkbExternSyncSlots[(iSlot + iProbe) & (VKB_EXTERNSYNC_SLOT_COUNT - 1)];
+        uint64_t owner = vkbAtomicLoad64(&pSlot->owner);
+        uint64_t site;
+        uint64_t threadId;
+        uint64_t pCallSite;
+
+        if (owner == 0) {
+            if (pClaimedSlot == NULL && vkbAtomicCompareExchange64(&pSlot->owner, 0, pCall->id)) {
+                pClaimedSlot = pSlot;
+            }
+            continue;
+        }
+
+        if (vkbAtomicLoad64(&pSlot->handle) != handle || vkbAtomicLoad64(&pSlot->objectType) != (uint64_t)objectType) {
+            continue;
+        }
+
+        if (owner == pCall->id) {
+            break;  /* The same object more than once in the same call. */
+        }
+
+        site      = vkbAtomicLoad64(&pSlot->site);
+        threadId  = vkbAtomicLoad64(&pSlot->threadId);
+        pCallSite = vkbAtomicLoad64(&pSlot->pCallSite);
+
+        /* IDs are never reused so if the owner is the same, the slot wasn't given back and taken again while we were reading it. */
+        if (vkbAtomicLoad64(&pSlot->owner) != owner) {
+            continue;
+        }
+
+        conflict.other.pCommandName   = ((const VkbExternSyncSite*)(uintptr_t)site)->pCommandName;
+        conflict.other.pParameterName = ((const VkbExternSyncSite*)(uintptr_t)site)->pParameterName;
+        conflict.other.threadId       = threadId;
+        conflict.other.pCallSite      = (const void*)(uintptr_t)pCallSite;
+        isConflict = VK_TRUE;
+        break;
+    }
+
+    if (iProbe < VKB_EXTERNSYNC_PROBE_COUNT) {
+        /* The object is claimed already so the slot isn't needed. Conflicting calls don't claim the object. */
+        if (pClaimedSlot != NULL) {
+            vkbAtomicStore64(&pClaimedSlot->owner, 0);
+        }
+    } else if (pClaimedSlot != NULL) {
+        vkbAtomicStore64(&pClaimedSlot->objectType, (uint64_t)objectType);
+        vkbAtomicStore64(&pClaimedSlot->site,       (uint64_t)(uintptr_t)pSite);
+        vkbAtomicStore64(&pClaimedSlot->threadId,   pCall->threadId);
+        vkbAtomicStore64(&pClaimedSlot->pCallSite,  (uint64_t)(uintptr_t)pCall->pCallSite);
+        vkbAtomicStore64(&pClaimedSlot->handle,     handle);
+    } else {
+        vkbAtomicIncrement64(&g_vkbExternSyncUncheckedCount);
+    }
+
+    vkbAtomicStore64(&pHomeSlot->lock, 0);
+
+    if (!isConflict) {
+        return;
+    }
+
+    conflict.objectType             = objectType;
+    conflict.handle                 = handle;
+    conflict.current.pCommandName   = pSite->pCommandName;
+    conflict.current.pParameterName = pSite->pParameterName;
+    conflict.current.threadId       = pCall->threadId;
+    conflict.current.pCallSite      = pCall->pCallSite;
+
+    vkbAtomicIncrement64(&g_vkbExternSyncConflictCount);
+    if (pCall->pInstall->onConflict != NULL) {
+        pCall->pInstall->onConflict(pCall->pInstall->pUserData, &conflict);
+    }
+}
+
+static void vkbExternSyncRelease(const VkbExternSyncCallState* pCall, VkObjectType objectType, uint64_t handle)
+{
+    uint32_t iSlot;
+    uint32_t iProbe;
+
+    if (handle == 0) {
+        return;
+    }
+
+    /* Only the call that claimed the object has a slot for it. Objects that didn't get a slot or were in conflict aren't found. */
+    iSlot = vkbExternSyncHash(objectType, handle);
+    for (iProbe = 0; iProbe < VKB_EXTERNSYNC_PROBE_COUNT; iProbe += 1) {
+        VkbExternSyncSlot* pSlot = &g_vkbExternSyncSlots[(iSlot + iProbe) & (VKB_EXTERNSYNC_SLOT_COUNT - 1)];
+        if (vkbAtomicLoad64(&pSlot->owner) == pCall->id && vkbAtomicLoad64(&pSlot->handle) == handle && vkbAtomicLoad64(&pSlot->objectType) == (uint64_t)objectType) {
+            vkbAtomicStore64(&pSlot->handle, 0);
+            vkbAtomicStore64(&pSlot->owner,  0);
+            return;
+        }
+    }
+}
+
+/*<<externsync_check>>*/
+
+VkResult vkbInstallExternSyncCheck(VkbAPI* pAPI, VkbExternSyncConflictProc onConflict, void* pUserData)
+{
+    uint32_t iInstall;
+
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        VkbAPI globalAPI;
+        VkResult result;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        result = vkbInstallExternSyncCheck(&globalAPI, onConflict, pUserData);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        return vkbBindAPI(&globalAPI);
+    #else
+        return VK_ERROR_INITIALIZATION_FAILED;  /* The global API has been disabled so the caller must provide a VkbAPI object. */
+    #endif
+    }
+
+    for (iInstall = 0; iInstall < VKB_EXTERNSYNC_MAX_INSTALLS; iInstall += 1) {
+        if (g_vkbExternSyncInstalls[iInstall].isUsed && vkbExternSyncIsInstalledAPI(pAPI, iInstall)) {
+            break;
+        }
+    }
+
+    if (iInstall == VKB_EXTERNSYNC_MAX_INSTALLS) {
+        for (iInstall = 0; iInstall < VKB_EXTERNSYNC_MAX_INSTALLS; iInstall += 1) {
+            if (!g_vkbExternSyncInstalls[iInstall].isUsed) {
+                break;
+            }
+        }
+
+        if (iInstall == VKB_EXTERNSYNC_MAX_INSTALLS) {
+            return VK_ERROR_TOO_MANY_OBJECTS;
+        }
+
+        memset(&g_vkbExternSyncInstalls[iInstall].next, 0, sizeof(g_vkbExternSyncInstalls[iInstall].next));
+        g_vkbExternSyncInstalls[iInstall].isUsed = VK_TRUE;
+    }
+
+    g_vkbExternSyncInstalls[iInstall].onConflict = onConflict;
+    g_vkbExternSyncInstalls[iInstall].pUserData  = pUserData;
+    vkbExternSyncInstallAPI(pAPI, iInstall);
+
+    return VK_SUCCESS;
+}
+
+void vkbUninstallExternSyncCheck(VkbAPI* pAPI)
+{
+    uint32_t iInstall;
+
+    if (pAPI == NULL) {
+    #if !defined(VKBIND_NO_GLOBAL_API)
+        VkbAPI globalAPI;
+
+        vkbInitFromGlobalAPI(&globalAPI);
+        vkbUninstallExternSyncCheck(&globalAPI);
+        vkbBindAPI(&globalAPI);
+    #endif
+        return;
+    }
+
+    for (iInstall = 0; iInstall < VKB_EXTERNSYNC_MAX_INSTALLS; iInstall += 1) {
+        if (g_vkbExternSyncInstalls[iInstall].isUsed && vkbExternSyncIsInstalledAPI(pAPI, iInstall)) {
+            vkbExternSyncUninstallAPI(pAPI, iInstall);
+            g_vkbExternSyncInstalls[iInstall].isUsed = VK_FALSE;
+        }
+    }
+}
+
+void vkbGetExternSyncCheckStats(VkbExternSyncCheckStats* pStats)
+{
+    if (pStats == NULL) {
+        return;
+    }
+
+    pStats->conflictCount  = vkbAtomicLoad64(&g_vkbExternSyncConflictCount);
+    pStats->uncheckedCount = vkbAtomicLoad64(&g_vkbExternSyncUncheckedCount);
 }
+#endif  /* VKBIND_EXTERNSYNC_CHECK */
 
 #endif  /* VKBIND_IMPLEMENTATION */
 